@@ -23,7 +23,8 @@
 --[-------------------------------------------------------]
 --[ Includes                                              ]
 --[-------------------------------------------------------]
-require "Interaction"	-- Interaction script component class
+require "ScriptProfiler"	-- Script profiler, measures the script functions called by C++
+require "Interaction"		-- Interaction script component class
 
 
 --[-------------------------------------------------------]
@@ -81,6 +82,34 @@ Application = {
 			end
 		end
 
+		--@brief
+		--  Returns whether or not the application runs within the benchmark mode
+		--
+		--@return
+		--  'true' if the application runs within the benchmark mode (headless deterministic camcorder flythrough), else 'false'
+		function this.IsBenchmarkMode()
+			-- The "IsBenchmarkMode()"-method is implemented within the dungeon executable
+			if cppApplication.IsBenchmarkMode ~= nil then
+				return cppApplication:IsBenchmarkMode()
+			else
+				return false
+			end
+		end
+
+		--@brief
+		--  Returns the name of the camcorder track to play within the benchmark mode
+		--
+		--@return
+		--  The name of the camcorder track to play within the benchmark mode (e.g. "Movie" or "ShortMovie"), empty string if not within the benchmark mode
+		function this.GetBenchmarkTrack()
+			-- The "GetBenchmarkTrack()"-method is implemented within the dungeon executable
+			if cppApplication.GetBenchmarkTrack ~= nil then
+				return cppApplication:GetBenchmarkTrack()
+			else
+				return ""
+			end
+		end
+
 		--@brief
 		--  Returns whether or not this is an internal release
 		--
@@ -103,13 +132,63 @@ Application = {
 		function this.GetCamcorder()
 			-- Create the camcorder instance right now?
 			if cppCamcorder == nil then
-				cppCamcorder = PL.ClassManager.CreateByConstructor("PLEngine::Camcorder", "ParameterConstructor", "Param0=\"" .. tostring(cppApplication) .. "\"")
+				-- The "TrackCamcorder"-class is implemented within the dungeon executable and plays the compact tracks, it has the interface of "PLEngine::Camcorder"
+				cppCamcorder = PL.ClassManager.CreateByConstructor("TrackCamcorder", "ParameterConstructor", "Param0=\"" .. tostring(cppApplication) .. "\"")
+				if cppCamcorder == nil then
+					cppCamcorder = PL.ClassManager.CreateByConstructor("PLEngine::Camcorder", "ParameterConstructor", "Param0=\"" .. tostring(cppApplication) .. "\"")
+				end
 			end
 
 			-- Return the camcorder instance
 			return cppCamcorder
 		end
 
+		--@brief
+		--  Starts recording the current camera
+		--
+		--@param[in] name
+		--  Name of the recording (e.g. "Test"), can be played by using the camcorder
+		function this.StartRecord(name)
+			-- The "StartRecord()"-method is implemented within the dungeon executable and streams the keys to disk while recording
+			if cppApplication.StartRecord ~= nil then
+				cppApplication:StartRecord(name)
+			else
+				local camcorder = this.GetCamcorder()
+				if camcorder ~= nil then
+					camcorder:StartRecord(name)
+				end
+			end
+		end
+
+		--@brief
+		--  Stops recording the camera
+		function this.StopRecord()
+			-- The "StopRecord()"-method is implemented within the dungeon executable
+			if cppApplication.StopRecord ~= nil then
+				cppApplication:StopRecord()
+			else
+				local camcorder = this.GetCamcorder()
+				if camcorder ~= nil then
+					camcorder:StopRecord()
+				end
+			end
+		end
+
+		--@brief
+		--  Returns whether or not the camera is recorded
+		--
+		--@return
+		--  'true' if the camera is recorded, else 'false'
+		function this.IsRecording()
+			-- The "IsRecording()"-method is implemented within the dungeon executable
+			if cppApplication.IsRecording ~= nil then
+				return cppApplication:IsRecording()
+			else
+				local camcorder = this.GetCamcorder()
+				return camcorder ~= nil and camcorder:IsRecording()
+			end
+		end
+
 		--@brief
 		--  Returns the ingame GUI instance, or nil in case there's no instance
 		--
@@ -347,13 +426,13 @@ Application = {
 		--[ Public class constructor implementation               ]
 		--[-------------------------------------------------------]
 		-- Use the script function "OnCameraSet" as slot and connect it with the RTTI "SignalCameraSet"-signal of our RTTI application class instance
-		cppApplication.SignalCameraSet.Connect(this.OnCameraSet)
+		cppApplication.SignalCameraSet.Connect(ScriptProfiler.Wrap("Application.OnCameraSet", this.OnCameraSet))
 
 		-- Use the script function "OnSceneLoadingFinished" as slot and connect it with the RTTI "SignalSceneLoadingFinished"-signal of our RTTI application class instance
-		cppApplication.SignalSceneLoadingFinished.Connect(this.OnSceneLoadingFinished)
+		cppApplication.SignalSceneLoadingFinished.Connect(ScriptProfiler.Wrap("Application.OnSceneLoadingFinished", this.OnSceneLoadingFinished))
 
 		-- Use the script function "OnLoadProgress" as slot and connect it with the RTTI "SignalLoadProgress"-signal of our RTTI scene container class instance
-		cppApplication:GetScene().SignalLoadProgress.Connect(this.OnLoadProgress)
+		cppApplication:GetScene().SignalLoadProgress.Connect(ScriptProfiler.Wrap("Application.OnLoadProgress", this.OnLoadProgress))
 
 
 		-- Return the created class instance
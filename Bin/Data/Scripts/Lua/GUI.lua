@@ -43,6 +43,16 @@ GUI = {
 		--[-------------------------------------------------------]
 		local this 				= {}	-- A private class attribute -> Emulates the C++ "this"-pointer by using a Lua table
 		local _backgroundBlur 	= 0		-- GUI background blur (0 = no blur, 1 = full blur)
+		local _blurHandles		= nil	-- Attribute handles of the blur modifier for typed writes, nil if the C++ application doesn't provide them
+
+		-- Get the attribute handles once, setting the attributes through them every frame doesn't format and parse strings
+		if cppApplication.GetAttributeHandle ~= nil then
+			_blurHandles = {
+				effectWeight = cppApplication:GetAttributeHandle("EffectWeight"),
+				bloomScale   = cppApplication:GetAttributeHandle("BloomScale"),
+				strength     = cppApplication:GetAttributeHandle("Strength"),
+			}
+		end
 
 
 		--[-------------------------------------------------------]
@@ -80,9 +90,15 @@ GUI = {
 					end
 					if sceneNodeModifier ~= nil then
 						local factor = math.sin(_backgroundBlur*math.pi/2)
-						sceneNodeModifier.EffectWeight = factor
-						sceneNodeModifier.BloomScale   = 0.8 + (1 - factor)*3
-						sceneNodeModifier.Strength     = string.format("%f %f", 1 + factor*3, 1 + factor*4)
+						if _blurHandles ~= nil then
+							cppApplication:SetAttributeFloat(sceneNodeModifier, _blurHandles.effectWeight, factor)
+							cppApplication:SetAttributeFloat(sceneNodeModifier, _blurHandles.bloomScale, 0.8 + (1 - factor)*3)
+							cppApplication:SetAttributeVector2(sceneNodeModifier, _blurHandles.strength, 1 + factor*3, 1 + factor*4)
+						else
+							sceneNodeModifier.EffectWeight = factor
+							sceneNodeModifier.BloomScale   = 0.8 + (1 - factor)*3
+							sceneNodeModifier.Strength     = string.format("%f %f", 1 + factor*3, 1 + factor*4)
+						end
 					end
 				else
 					-- Remove "PLPostProcessEffects::SNMPostProcessBlur" modifier
@@ -23,8 +23,9 @@
 --[-------------------------------------------------------]
 --[ Includes                                              ]
 --[-------------------------------------------------------]
-require "GUI"		-- GUI script component class
-require "MakingOf"	-- Making of script component class
+require "ScriptProfiler"	-- Script profiler, measures the script functions called by C++
+require "GUI"				-- GUI script component class
+require "MakingOf"			-- Making of script component class
 
 
 --[-------------------------------------------------------]
@@ -66,6 +67,7 @@ Interaction = {
 		local this						= {}										-- A private class attribute -> Emulates the C++ "this"-pointer by using a Lua table
 		local _gui						= GUI.new(cppApplication, luaApplication)	-- An instance of the GUI script component class
 		local _oldFilmPostProcess 		= 0											-- Old film post process effect factor (0 = not visible, 1 = fully visible)
+		local _effectWeightHandle		= nil										-- "EffectWeight" attribute handle for typed writes, nil if the C++ application doesn't provide it
 		local _mode						= Interaction.Mode.UNKNOWN					-- The current interaction mode
 		local _modeBackup				= Interaction.Mode.UNKNOWN					-- A mode backup, used for camcorder recording
 		local _walkCameraSceneNode		= nil										-- Walk camera scene node
@@ -87,6 +89,12 @@ Interaction = {
 		)
 
 
+		-- Get the attribute handle once, setting the attribute through it every frame doesn't format and parse strings
+		if cppApplication.GetAttributeHandle ~= nil then
+			_effectWeightHandle = cppApplication:GetAttributeHandle("EffectWeight")
+		end
+
+
 		--[-------------------------------------------------------]
 		--[ Private class methods                                 ]
 		--[-------------------------------------------------------]
@@ -121,7 +129,11 @@ Interaction = {
 						sceneNodeModifier = cameraSceneNode:AddModifier("PLPostProcessEffects::SNMPostProcessOldFilm")
 					end
 					if sceneNodeModifier ~= nil then
-						sceneNodeModifier.EffectWeight = _oldFilmPostProcess
+						if _effectWeightHandle ~= nil then
+							cppApplication:SetAttributeFloat(sceneNodeModifier, _effectWeightHandle, _oldFilmPostProcess)
+						else
+							sceneNodeModifier.EffectWeight = _oldFilmPostProcess
+						end
 					end
 				else
 					-- Remove "PLPostProcessEffects::SNMPostProcessOldFilm" modifier
@@ -266,7 +278,10 @@ Interaction = {
 					if _mode == Interaction.Mode.MOVIE then
 						-- Start the playback
 						if camcorder ~= nil then
-							if luaApplication.IsInternalRelease() then
+							if luaApplication.IsBenchmarkMode() then
+								-- Play the requested benchmark track
+								camcorder:StartPlayback(luaApplication.GetBenchmarkTrack())
+							elseif luaApplication.IsInternalRelease() then
 								-- Just a short movie for the internal release - else we would have to wait to long to test the demo
 								camcorder:StartPlayback("ShortMovie")
 							else
@@ -296,7 +311,7 @@ Interaction = {
 			local inputController = cppApplication:GetInputController()
 			if inputController ~= nil then
 				-- Use the script function "OnControl" as slot and connect it with the RTTI "SignalOnControl"-signal of our RTTI controller class instance
-				inputController.SignalOnControl.Connect(this.OnControl)
+				inputController.SignalOnControl.Connect(ScriptProfiler.Wrap("Interaction.OnControl", this.OnControl))
 			end
 
 			-- Get the scene container
@@ -318,8 +333,8 @@ Interaction = {
 				_makingOfCameraSceneNode = scene:GetByName("Container.WineCellar.MakingOfCamera")
 			end
 
-			-- The offical release should always start with the movie mode
-			if luaApplication.IsInternalRelease() then
+			-- The offical release and the benchmark should always start with the movie mode
+			if luaApplication.IsInternalRelease() and not luaApplication.IsBenchmarkMode() then
 				-- Internal release
 				this.OnSetMode(Interaction.Mode.WALK, false)
 			else
@@ -331,8 +346,14 @@ Interaction = {
 		--@brief
 		--  Slot function is called by C++ when the camcorder playback has been finished
 		function this.OnMoviePlaybackFinished()
-			-- Change into the making of mode
-			this.OnSetMode(Interaction.Mode.MAKINGOF, true)
+			-- The benchmark is finished as soon as the movie is finished
+			if luaApplication.IsBenchmarkMode() then
+				-- Exit the application, the benchmark result is written by C++
+				cppApplication:Exit(0)
+			else
+				-- Change into the making of mode
+				this.OnSetMode(Interaction.Mode.MAKINGOF, true)
+			end
 		end
 
 		--@brief
@@ -418,17 +439,13 @@ Interaction = {
 				["KeyboardR"] = function()
 					-- Was the button just hit? This key is only allowed in the internal release as well as only if not movie nor making of mode...
 					if control:IsHit() and luaApplication.IsInternalRelease() and _mode ~= Interaction.Mode.MOVIE and _mode ~= Interaction.Mode.MAKINGOF then
-						-- Get the camcorder component
-						local camcorder = luaApplication.GetCamcorder()
-						if camcorder ~= nil then
-							-- Toggle camcorder recording
-							if camcorder:IsRecording() then
-								camcorder:StopRecord()
-								luaApplication.ShowText("Record stopped", 5)
-							else
-								camcorder:StartRecord("Test")
-								luaApplication.ShowText("Record started", 5)
-							end
+						-- Toggle camcorder recording
+						if luaApplication.IsRecording() then
+							luaApplication.StopRecord()
+							luaApplication.ShowText("Record stopped", 5)
+						else
+							luaApplication.StartRecord("Test")
+							luaApplication.ShowText("Record started", 5)
 						end
 					end
 				end,
@@ -507,17 +524,17 @@ Interaction = {
 		--[ Public class constructor implementation               ]
 		--[-------------------------------------------------------]
 		-- Use the script function "OnSceneLoadingFinished" as slot and connect it with the RTTI "SignalSceneLoadingFinished"-signal of our RTTI application class instance
-		cppApplication.SignalSceneLoadingFinished.Connect(this.OnSceneLoadingFinished)
+		cppApplication.SignalSceneLoadingFinished.Connect(ScriptProfiler.Wrap("Interaction.OnSceneLoadingFinished", this.OnSceneLoadingFinished))
 
 		-- Use the script function "OnSetMode" as slot and connect it with the RTTI "SignalSetMode"-signal of our RTTI application class instance
 		if cppApplication.SignalSetMode ~= nil then	-- Signal is implemented in the dungeon executable
-			cppApplication.SignalSetMode.Connect(this.OnSetMode)
+			cppApplication.SignalSetMode.Connect(ScriptProfiler.Wrap("Interaction.OnSetMode", this.OnSetMode))
 		end
 
 		-- Use the script function "OnMoviePlaybackFinished" as slot and connect it with the RTTI "SignalPlaybackFinished"-signal of our RTTI camcorder class instance
 		local camcorder = luaApplication.GetCamcorder()
 		if camcorder ~= nil then
-			camcorder.SignalPlaybackFinished.Connect(this.OnMoviePlaybackFinished)
+			camcorder.SignalPlaybackFinished.Connect(ScriptProfiler.Wrap("Interaction.OnMoviePlaybackFinished", this.OnMoviePlaybackFinished))
 		end
 
 		-- By default, the mouse cursor is visible
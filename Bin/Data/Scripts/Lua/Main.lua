@@ -35,8 +35,9 @@ package.path = PL.GetApplication():GetScriptDirectory() .. '?.lua;' .. package.p
 --[-------------------------------------------------------]
 --[ Includes                                              ]
 --[-------------------------------------------------------]
-require "Options"		-- Options
-require "Application"	-- Application script component class
+require "Options"			-- Options
+require "ScriptProfiler"	-- Script profiler, measures the script functions called by C++
+require "Application"		-- Application script component class
 
 
 --[-------------------------------------------------------]
@@ -71,9 +72,9 @@ end
 
 --@brief
 --  Update function called by C++
-function OnUpdate()
+OnUpdate = ScriptProfiler.Wrap("OnUpdate", function()
 	-- Update the instance of the application script component class
 	if application ~= nil then
 		application.Update()
 	end
-end
+end)
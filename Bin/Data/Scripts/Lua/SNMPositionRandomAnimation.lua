@@ -22,6 +22,8 @@
 
 -- This script is called by the scene "Scripts.scene"
 -- -> The global variable "this" points to the C++ RTTI scene node modifier class instance invoking the script
+-- -> Superseded by the native C++ scene node modifier "SNMPositionRandomAnimation" which has the same public variables as attributes,
+--    the scene cache migrates scenes still using this script automatically
 
 
 --[-------------------------------------------------------]
@@ -36,7 +38,8 @@ package.path = PL.GetApplication():GetBaseDirectory() .. 'Data/Scripts/Lua/?.lua
 --[-------------------------------------------------------]
 --[ Includes                                              ]
 --[-------------------------------------------------------]
-require "StringTools"	-- String tools, required for "string.split()"
+require "StringTools"		-- String tools, required for "string.split()"
+require "ScriptProfiler"	-- Script profiler, measures the script functions called by C++
 
 
 --[-------------------------------------------------------]
@@ -63,6 +66,8 @@ local math_random					= math.random
 local string_format					= string.format
 local PL_Timing_GetTimeDifference	= PL.Timing.GetTimeDifference
 local sceneNode						= nil	-- Owner scene node (will not change)
+local application					= nil	-- C++ RTTI application class instance (will not change)
+local positionHandle				= nil	-- "Position" attribute handle for typed writes, nil if the C++ application doesn't provide it
 
 
 --[-------------------------------------------------------]
@@ -80,11 +85,17 @@ function OnInit()
 	-- Initialize local current and destination position
 	currentPosition = { 0, 0, 0, }
 	destinationPosition = { 0, 0, 0, }
+
+	-- Get the position attribute handle, setting the position through it every frame doesn't format and parse strings
+	application = PL.GetApplication()
+	if application.GetAttributeHandle ~= nil then
+		positionHandle = application:GetAttributeHandle("Position")
+	end
 end
 
 --@brief
 --  Update function called by C++
-function OnUpdate()
+OnUpdate = ScriptProfiler.Wrap("SNMPositionRandomAnimation.OnUpdate", function()
 	-- Update our timer
 	local timeDifference = PL_Timing_GetTimeDifference()*PublicVariables.Speed
 
@@ -120,5 +131,9 @@ function OnUpdate()
 	end
 
 	-- Set current scene node position
-	sceneNode.Position = string_format("%f %f %f", originalPosition[1] + currentPosition[1], originalPosition[2] + currentPosition[2], originalPosition[3] + currentPosition[3])
-end
+	if positionHandle ~= nil then
+		application:SetAttributeVector3(sceneNode, positionHandle, originalPosition[1] + currentPosition[1], originalPosition[2] + currentPosition[2], originalPosition[3] + currentPosition[3])
+	else
+		sceneNode.Position = string_format("%f %f %f", originalPosition[1] + currentPosition[1], originalPosition[2] + currentPosition[2], originalPosition[3] + currentPosition[3])
+	end
+end)
@@ -0,0 +1,161 @@
+--/*********************************************************\
+-- *  File: ScriptProfiler.lua                             *
+-- *
+-- *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+-- *
+-- *  This file is part of PixelLight.
+-- *
+-- *  PixelLight is free software: you can redistribute it and/or modify
+-- *  it under the terms of the GNU Lesser General Public License as published by
+-- *  the Free Software Foundation, either version 3 of the License, or
+-- *  (at your option) any later version.
+-- *
+-- *  PixelLight is distributed in the hope that it will be useful,
+-- *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- *  GNU Lesser General Public License for more details.
+-- *
+-- *  You should have received a copy of the GNU Lesser General Public License
+-- *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+--\*********************************************************/
+
+
+-- The script profiler measures the script functions called by C++ (see the C++ class "ScriptProfiler", console command "scriptprofiler")
+-- -> Each Lua state (the application script and each script scene node modifier) has its own instance of this module
+-- -> While profiling, the automatic garbage collector is disabled and the collector runs explicitly after each outermost
+--    wrapped call, with the work the automatic collector would have done for the allocated memory - so the garbage
+--    collection pauses show up as function "Lua GC" instead of within the function which happened to allocate
+
+
+--[-------------------------------------------------------]
+--[ Local definitions                                     ]
+--[-------------------------------------------------------]
+local PollInterval	= 30		-- The C++ application is asked every 30 outermost calls whether or not profiling is enabled
+local PauseDisabled	= 100000	-- Garbage collector pause while profiling, the automatic collector doesn't start a new cycle
+
+
+--[-------------------------------------------------------]
+--[ Local variables                                       ]
+--[-------------------------------------------------------]
+local cppApplication	= nil	-- C++ RTTI application class instance, nil if it doesn't provide the script profiler (e.g. within PLViewer)
+local enabled			= false	-- Is profiling enabled?
+local pollCounter		= 0		-- Outermost calls until the C++ application is asked again
+local depth				= 0		-- Depth of the current wrapped call
+local pause				= 0		-- Garbage collector pause to restore when profiling is disabled
+local collectedHeap		= 0		-- Lua heap size (in KiB) after the last explicit garbage collection
+
+
+--[-------------------------------------------------------]
+--[ Performance optimization using fast local variables   ]
+--[-------------------------------------------------------]
+local collectgarbage = collectgarbage
+local pcall			 = pcall
+local error			 = error
+local select		 = select
+local pack			 = table.pack or function(...) return { n = select("#", ...), ... } end	-- "table.pack()" is new in Lua 5.2
+local unpack		 = table.unpack or unpack												-- "unpack()" became "table.unpack()" in Lua 5.2
+
+
+--[-------------------------------------------------------]
+--[ Local functions                                       ]
+--[-------------------------------------------------------]
+--@brief
+--  Asks the C++ application whether or not profiling is enabled and switches the garbage collector mode
+local function Poll()
+	-- Get the C++ RTTI application class instance
+	if cppApplication == nil then
+		local application = PL.GetApplication()
+		if application == nil or application.IsScriptProfilerEnabled == nil then
+			-- Script profiler is implemented in the dungeon executable, don't ask again
+			pollCounter = math.huge
+			return
+		end
+		cppApplication = application
+	end
+
+	-- Switch the garbage collector mode
+	local newEnabled = cppApplication:IsScriptProfilerEnabled()
+	if newEnabled ~= enabled then
+		enabled = newEnabled
+		if enabled then
+			pause = collectgarbage("setpause", PauseDisabled)
+			collectedHeap = collectgarbage("count")
+		else
+			collectgarbage("setpause", pause)
+		end
+	end
+end
+
+--@brief
+--  Runs the garbage collector with the work the automatic collector would have done for the memory allocated since the last run
+local function CollectGarbage()
+	local heap = collectgarbage("count")
+	local allocated = heap - collectedHeap
+	if allocated >= 1 then
+		cppApplication:BeginScriptFunction("Lua GC")
+		collectgarbage("step", math.floor(allocated))
+		collectedHeap = collectgarbage("count")
+		cppApplication:EndScriptFunction(collectedHeap - heap)	-- The heap growth is negative, it's the collected memory
+	end
+end
+
+
+--[-------------------------------------------------------]
+--[ Global functions                                      ]
+--[-------------------------------------------------------]
+ScriptProfiler = {}
+
+--@brief
+--  Wraps a script function called by C++ so that it's measured by the script profiler
+--
+--@param[in] name
+--  Function name shown by the script profiler (e.g. "Interaction.OnControl")
+--@param[in] func
+--  Function to wrap, its return values are passed through
+--
+--@return
+--  The wrapping function, while the script profiler is disabled it costs a counter decrement per outermost call
+--
+--@note
+--  - Errors raised by the function are passed through as well, after the measurement of the call was completed
+--
+--@remarks
+--  Usage example:
+--    inputController.SignalOnControl.Connect(ScriptProfiler.Wrap("Interaction.OnControl", this.OnControl))
+function ScriptProfiler.Wrap(name, func)
+	return function(...)
+		-- Ask the C++ application from time to time, but never within a measured call
+		if depth == 0 then
+			pollCounter = pollCounter - 1
+			if pollCounter <= 0 then
+				pollCounter = PollInterval
+				Poll()
+			end
+		end
+
+		-- Just call the function while profiling is disabled
+		if not enabled then
+			return func(...)
+		end
+
+		-- Measure the call, there's no automatic garbage collection so the heap growth is what the function allocated - the
+		-- call is protected, an error must not leave the C++ script profiler within the function and the depth increased
+		depth = depth + 1
+		cppApplication:BeginScriptFunction(name)
+		local heap = collectgarbage("count")
+		local results = pack(pcall(func, ...))
+		cppApplication:EndScriptFunction(collectgarbage("count") - heap)
+		depth = depth - 1
+
+		-- Collect the garbage of the outermost call
+		if depth == 0 then
+			CollectGarbage()
+		end
+
+		-- Pass the error or the return values of the function through
+		if not results[1] then
+			error(results[2], 0)
+		end
+		return unpack(results, 2, results.n)
+	end
+end
@@ -0,0 +1,309 @@
+/*********************************************************\
+ *  File: CacheBuilder.cpp                               *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/Xml/Xml.h>
+#include <PLCore/File/File.h>
+#include <PLCore/File/Directory.h>
+#include <PLCore/System/System.h>
+#include <PLCore/System/Process.h>
+#include <PLMath/Vector3.h>
+#include "Scene/PhysicsCacheManifest.h"
+#include "CacheBuilder.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+static const char *WorkerStatusExtension = ".done";	/**< Extension of the file a worker creates next to its worker scene when it was successful */
+
+
+//[-------------------------------------------------------]
+//[ RTTI interface                                        ]
+//[-------------------------------------------------------]
+pl_class_metadata(CacheBuilder, "", DungeonTool, "Offline physics cache builder application class")
+	// Constructors
+	pl_constructor_0_metadata(DefaultConstructor,	"Default constructor",	"")
+pl_class_metadata_end(CacheBuilder)
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+CacheBuilder::CacheBuilder() : DungeonTool()
+{
+	// Set application title
+	SetTitle("PixelLight dungeon physics cache builder");
+
+	// Add the command line options
+	m_cCommandLine.AddOption("Scene",  "-s", "--scene",  "Filename of the scene to build the physics cache for", "Data/Scenes/Dungeon.scene");
+	m_cCommandLine.AddOption("Jobs",   "-j", "--jobs",   "Number of worker processes, 0 for one per CPU", "0");
+	m_cCommandLine.AddOption("Worker", "",   "--worker", "Internal: Cook the physics bodies of the given worker scene", "");
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+CacheBuilder::~CacheBuilder()
+{
+}
+
+
+//[-------------------------------------------------------]
+//[ Protected virtual PLCore::CoreApplication functions   ]
+//[-------------------------------------------------------]
+void CacheBuilder::Main()
+{
+	// Worker or builder?
+	const String sWorkerScene = m_cCommandLine.GetValue("Worker");
+	bool bResult;
+	if (sWorkerScene.GetLength()) {
+		// "PLCore::Process" doesn't provide the exit code of a process, so a worker reports its success to the
+		// builder by creating a status file next to its worker scene
+		bResult = Cook(sWorkerScene);
+		if (bResult) {
+			File cStatusFile(sWorkerScene + WorkerStatusExtension);
+			bResult = cStatusFile.Open(File::FileCreate | File::FileWrite);
+			if (!bResult)
+				PL_LOG(Error, "Failed to write the worker status file '" + cStatusFile.GetUrl().GetNativePath() + '\'')
+		}
+	} else {
+		bResult = Build(m_cCommandLine.GetValue("Scene"), m_cCommandLine.GetValue("Jobs").GetUInt32());
+	}
+	if (!bResult)
+		Exit(1);
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Builds the physics cache of a scene by using worker processes
+*/
+bool CacheBuilder::Build(const String &sSceneFilename, uint32 nNumOfWorkers)
+{
+	// Load the XML scene
+	XmlDocument cDocument;
+	if (!cDocument.Load(m_sBaseDirectory + sSceneFilename)) {
+		PL_LOG(Error, "Failed to load the scene '" + m_sBaseDirectory + sSceneFilename + '\'')
+		return false;
+	}
+	const XmlElement *pSceneElement = cDocument.GetFirstChildElement("Scene");
+	const XmlElement *pWorldElement = nullptr;
+	if (pSceneElement) {
+		for (const XmlElement *pElement=pSceneElement->GetFirstChildElement("Container"); pElement && !pWorldElement; pElement=pElement->GetNextSiblingElement("Container")) {
+			if (String(pElement->GetAttribute("Class")) == "PLPhysics::SCPhysicsWorld")
+				pWorldElement = pElement;
+		}
+	}
+	if (!pWorldElement || !pWorldElement->GetAttribute("CacheDirectory").GetLength()) {
+		PL_LOG(Error, "The scene has no physics world with a cache directory")
+		return false;
+	}
+
+	// The cache directory within the scene is relative to the directory of the executable, the workers get an absolute one
+	const String sCacheDirectory = Url(GetApplicationContext().GetExecutableDirectory() + '/' + pWorldElement->GetAttribute("CacheDirectory")).Collapse().GetUrl();
+	Directory cCacheDirectory(sCacheDirectory);
+	if (!cCacheDirectory.Exists())
+		cCacheDirectory.CreateRecursive();
+
+	// Delete the outdated cache files, the workers cook them again
+	PhysicsCacheManifest cManifest(sCacheDirectory, m_sBaseDirectory);
+	cManifest.Validate();
+
+	// Collect the physics bodies to cook
+	Array<String> lstKeys;
+	Array<const XmlElement*> lstNodes;
+	Array<const XmlElement*> lstModifiers;
+	CollectBodies(*pWorldElement, lstKeys, lstNodes, lstModifiers);
+	PL_LOG(Info, String::Format("Found %u unique physics bodies", lstNodes.GetNumOfElements()))
+
+	// One worker per CPU by default, but not more workers than bodies
+	if (!nNumOfWorkers)
+		nNumOfWorkers = System::GetInstance()->GetNumOfCPUs();
+	if (nNumOfWorkers > lstNodes.GetNumOfElements())
+		nNumOfWorkers = lstNodes.GetNumOfElements();
+
+	// Write the worker scenes, the bodies are distributed round robin so each worker gets a mix of big and small meshes
+	const String sWorkDirectory = sCacheDirectory + "/_Build";
+	Directory cWorkDirectory(sWorkDirectory);
+	if (!cWorkDirectory.Exists())
+		cWorkDirectory.CreateRecursive();
+	Array<String> lstWorkerScenes;
+	for (uint32 nWorker=0; nWorker<nNumOfWorkers; nWorker++) {
+		XmlDocument cWorkerDocument;
+		cWorkerDocument.LinkEndChild(*new XmlDeclaration("1.0", "ISO-8859-1", ""));
+		XmlElement &cWorkerSceneElement = *new XmlElement("Scene");
+		cWorkerSceneElement.SetAttribute("Version", "1");
+
+		// The physics world with all attributes of the original one (they may influence the cooking)
+		XmlElement &cWorkerWorldElement = *new XmlElement("Container");
+		for (const XmlAttribute *pAttribute=pWorldElement->GetFirstAttribute(); pAttribute; pAttribute=pAttribute->GetNext())
+			cWorkerWorldElement.SetAttribute(pAttribute->GetName(), pAttribute->GetValue());
+		cWorkerWorldElement.SetAttribute("CacheDirectory", sCacheDirectory);
+
+		// The physics bodies of this worker, the position doesn't influence the cooking
+		for (uint32 i=nWorker; i<lstNodes.GetNumOfElements(); i+=nNumOfWorkers) {
+			XmlElement &cNodeElement = *new XmlElement("Node");
+			cNodeElement.SetAttribute("Class", "PLScene::SNMesh");
+			cNodeElement.SetAttribute("Name",  String::Format("Body%u", i));
+			cNodeElement.SetAttribute("Mesh",  lstNodes[i]->GetAttribute("Mesh"));
+			if (lstNodes[i]->GetAttribute("Scale").GetLength())
+				cNodeElement.SetAttribute("Scale", lstNodes[i]->GetAttribute("Scale"));
+			XmlElement &cModifierElement = *new XmlElement("Modifier");
+			for (const XmlAttribute *pAttribute=lstModifiers[i]->GetFirstAttribute(); pAttribute; pAttribute=pAttribute->GetNext())
+				cModifierElement.SetAttribute(pAttribute->GetName(), pAttribute->GetValue());
+			cNodeElement.LinkEndChild(cModifierElement);
+			cWorkerWorldElement.LinkEndChild(cNodeElement);
+		}
+		cWorkerSceneElement.LinkEndChild(cWorkerWorldElement);
+		cWorkerDocument.LinkEndChild(cWorkerSceneElement);
+
+		// Save the worker scene
+		const String sWorkerScene = sWorkDirectory + String::Format("/Worker%u.scene", nWorker);
+		if (!cWorkerDocument.Save(sWorkerScene)) {
+			PL_LOG(Error, "Failed to write the worker scene '" + sWorkerScene + '\'')
+			return false;
+		}
+		lstWorkerScenes.Add(sWorkerScene);
+	}
+
+	// Start the workers
+	PL_LOG(Info, String::Format("Cooking within %u worker processes", nNumOfWorkers))
+	const String sExecutable = GetApplicationContext().GetExecutableFilename();
+	Array<Process*> lstProcesses;
+	for (uint32 i=0; i<lstWorkerScenes.GetNumOfElements(); i++) {
+		// Remove a status file which may be left over by an aborted build
+		File(lstWorkerScenes[i] + WorkerStatusExtension).Delete();
+
+		// A worker which can't be started is a null pointer within the list
+		Process *pProcess = new Process();
+		if (!pProcess->Execute(sExecutable, "--worker \"" + Url(lstWorkerScenes[i]).GetNativePath() + '\"')) {
+			PL_LOG(Error, "Failed to start worker process " + lstWorkerScenes[i])
+			delete pProcess;
+			pProcess = nullptr;
+		}
+		lstProcesses.Add(pProcess);
+	}
+
+	// Wait for the workers and check their results, a worker which crashed or failed didn't create its status file
+	uint32 nNumOfFailed = 0;
+	for (uint32 i=0; i<lstProcesses.GetNumOfElements(); i++) {
+		if (lstProcesses[i]) {
+			while (lstProcesses[i]->IsRunning())
+				System::GetInstance()->Sleep(100);
+			delete lstProcesses[i];
+
+			File cStatusFile(lstWorkerScenes[i] + WorkerStatusExtension);
+			if (cStatusFile.Exists()) {
+				cStatusFile.Delete();
+			} else {
+				PL_LOG(Error, "Worker process " + lstWorkerScenes[i] + " failed")
+				nNumOfFailed++;
+			}
+		} else {
+			nNumOfFailed++;
+		}
+	}
+
+	// Remove the worker scenes
+	for (uint32 i=0; i<lstWorkerScenes.GetNumOfElements(); i++)
+		File(lstWorkerScenes[i]).Delete();
+	cWorkDirectory.Delete();
+
+	// Don't record a partial cache within the manifest, the next build cooks the missing bodies again
+	if (nNumOfFailed) {
+		PL_LOG(Error, String::Format("%u of %u worker processes failed, the physics cache manifest is not updated", nNumOfFailed, lstWorkerScenes.GetNumOfElements()))
+		return false; // Error!
+	}
+
+	// Add the cooked cache files to the manifest
+	const uint32 nNumOfCooked = cManifest.Update();
+	PL_LOG(Info, String::Format("Added %u cooked cache files to the physics cache manifest", nNumOfCooked))
+
+	// Done
+	return true;
+}
+
+/**
+*  @brief
+*    Collects the physics bodies to cook
+*/
+void CacheBuilder::CollectBodies(const XmlElement &cElement, Array<String> &lstKeys, Array<const XmlElement*> &lstNodes, Array<const XmlElement*> &lstModifiers) const
+{
+	for (const XmlElement *pElement=cElement.GetFirstChildElement(); pElement; pElement=pElement->GetNextSiblingElement()) {
+		const String sType = pElement->GetValue();
+		if (sType == "Container") {
+			// Walk into cells and other containers
+			CollectBodies(*pElement, lstKeys, lstNodes, lstModifiers);
+		} else if (sType == "Node") {
+			// Physics bodies with collision data which is worth to be cached
+			for (const XmlElement *pModifier=pElement->GetFirstChildElement("Modifier"); pModifier; pModifier=pModifier->GetNextSiblingElement("Modifier")) {
+				const String sClass = pModifier->GetAttribute("Class");
+				if (sClass == "PLPhysics::SNMPhysicsBodyMesh" || sClass == "PLPhysics::SNMPhysicsBodyConvexHull") {
+					// Unify the mesh filename and the scale, each combination has to be cooked just once
+					String sMesh = pElement->GetAttribute("Mesh");
+					sMesh.Replace('\\', '/');
+					PLMath::Vector3 vScale(1.0f, 1.0f, 1.0f);
+					vScale.FromString(pElement->GetAttribute("Scale"));
+					const String sKey = sClass + '|' + sMesh + '|' + vScale.ToString();
+					if (sMesh.GetLength() && !lstKeys.IsElement(sKey)) {
+						lstKeys.Add(sKey);
+						lstNodes.Add(pElement);
+						lstModifiers.Add(pModifier);
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+*  @brief
+*    Cooks the physics bodies of a worker scene, called within a worker process
+*/
+bool CacheBuilder::Cook(const String &sSceneFilename)
+{
+	// Load the worker scene using the null renderer, the physics backend cooks the collision data of the physics
+	// bodies which are not cached yet while they are created
+	const bool bResult = (LoadScene(sSceneFilename, "Worker") != nullptr);
+	UnloadScene();
+
+	// Done
+	return bResult;
+}
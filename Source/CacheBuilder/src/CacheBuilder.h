@@ -0,0 +1,145 @@
+/*********************************************************\
+ *  File: CacheBuilder.h                                 *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEONCACHEBUILDER_CACHEBUILDER_H__
+#define __DUNGEONCACHEBUILDER_CACHEBUILDER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "DungeonTool.h"
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLCore {
+	class XmlElement;
+}
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Offline physics cache builder application class
+*
+*  @remarks
+*    Cooks the collision data of all physics bodies of a scene into the physics cache so the dungeon never has to
+*    cook them on the first start. The scene is scanned for scene nodes with a "PLPhysics::SNMPhysicsBodyMesh" or
+*    "PLPhysics::SNMPhysicsBodyConvexHull" modifier, each unique combination of modifier class, mesh and scale is
+*    cooked just once. The cooking itself is done by the physics backend while loading the physics bodies, so
+*    the builder distributes the combinations over several worker scenes and loads each of them within an own
+*    process of this application ("--worker") using the null renderer - one process per CPU by default.
+*    Finally, the physics cache manifest is updated (see "PhysicsCacheManifest") - but only if all workers
+*    reported success, a partial cache is never recorded.
+*
+*    The physics cache directory within the scene is resolved relative to the executable directory - like the dungeon
+*    does when it's started from there (see "DungeonTool").
+*/
+class CacheBuilder : public DungeonTool {
+
+
+	//[-------------------------------------------------------]
+	//[ RTTI interface                                        ]
+	//[-------------------------------------------------------]
+	pl_class_def()
+	pl_class_def_end
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*/
+		CacheBuilder();
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		virtual ~CacheBuilder();
+
+
+	//[-------------------------------------------------------]
+	//[ Protected virtual PLCore::CoreApplication functions   ]
+	//[-------------------------------------------------------]
+	protected:
+		virtual void Main() override;
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Builds the physics cache of a scene by using worker processes
+		*
+		*  @param[in] sSceneFilename
+		*    Filename of the XML scene, relative to the base directory
+		*  @param[in] nNumOfWorkers
+		*    Number of worker processes, 0 for one per CPU
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool Build(const PLCore::String &sSceneFilename, PLCore::uint32 nNumOfWorkers);
+
+		/**
+		*  @brief
+		*    Collects the physics bodies to cook
+		*
+		*  @param[in]  cElement
+		*    XML element to start with
+		*  @param[out] lstKeys
+		*    Receives the keys ("<modifier class>|<mesh>|<scale>") of the collected bodies, used to skip duplicates
+		*  @param[out] lstNodes
+		*    Receives the scene node XML elements of the collected bodies
+		*  @param[out] lstModifiers
+		*    Receives the physics body modifier XML elements of the collected bodies
+		*/
+		void CollectBodies(const PLCore::XmlElement &cElement, PLCore::Array<PLCore::String> &lstKeys, PLCore::Array<const PLCore::XmlElement*> &lstNodes, PLCore::Array<const PLCore::XmlElement*> &lstModifiers) const;
+
+		/**
+		*  @brief
+		*    Cooks the physics bodies of a worker scene, called within a worker process
+		*
+		*  @param[in] sSceneFilename
+		*    Filename of the worker scene
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool Cook(const PLCore::String &sSceneFilename);
+
+
+};
+
+
+#endif // __DUNGEONCACHEBUILDER_CACHEBUILDER_H__
@@ -0,0 +1,112 @@
+##################################################
+## Dungeon tools
+##
+## Shared setup of the offline tools next to the dungeon executable (e.g. "CacheBuilder"), each tool only lists its
+## source files, include directories and libraries. The tool application base class within "DungeonTool" is added to
+## each tool. The tools are CMake-only, they have no Visual Studio project.
+##################################################
+
+##################################################
+## MACRO: add_dungeon_tool
+##
+## Add the console executable "${target}" of a dungeon tool, copy it next to the dungeon executable after each build
+## and add the custom target "run_target" which runs the copied executable from there
+##################################################
+macro(add_dungeon_tool run_target)
+	# Set target system (console)
+	set(system "")
+
+	##################################################
+	## Tool application base class
+	##################################################
+	add_sources(
+		${CMAKE_CURRENT_SOURCE_DIR}/../DungeonTool/DungeonTool.cpp
+	)
+	add_include_directories(
+		${CMAKE_CURRENT_SOURCE_DIR}/../DungeonTool
+		${PL_PLCORE_INCLUDE_DIR}
+		${PL_PLMATH_INCLUDE_DIR}
+		${PL_PLGRAPHICS_INCLUDE_DIR}
+		${PL_PLRENDERER_INCLUDE_DIR}
+		${PL_PLMESH_INCLUDE_DIR}
+		${PL_PLSCENE_INCLUDE_DIR}
+	)
+	add_libs(
+		${PL_PLCORE_LIBRARY}
+		${PL_PLMATH_LIBRARY}
+		${PL_PLGRAPHICS_LIBRARY}
+		${PL_PLRENDERER_LIBRARY}
+		${PL_PLMESH_LIBRARY}
+		${PL_PLSCENE_LIBRARY}
+	)
+
+	##################################################
+	## Preprocessor definitions
+	##################################################
+	if(WIN32)
+		add_compile_defs(
+			${WIN32_COMPILE_DEFS}
+			_CONSOLE
+		)
+	elseif(LINUX)
+		add_compile_defs(
+			${LINUX_COMPILE_DEFS}
+		)
+	endif()
+
+	##################################################
+	## Compiler flags
+	##################################################
+	if(WIN32)
+		add_compile_flags(
+			${WIN32_COMPILE_FLAGS}
+		)
+	elseif(LINUX)
+		add_compile_flags(
+			${LINUX_COMPILE_FLAGS}
+		)
+	endif()
+
+	##################################################
+	## Linker flags
+	##################################################
+	if(WIN32)
+		add_linker_flags(
+			${WIN32_LINKER_FLAGS}
+		)
+	elseif(LINUX)
+		add_linker_flags(
+			${LINUX_LINKER_FLAGS}
+		)
+	endif()
+
+	##################################################
+	## Build
+	##################################################
+	add_executable(${target} ${system} ${src})
+	target_link_libraries (${target} ${libs})
+	set_project_properties(${target})
+
+	##################################################
+	## Post-Build
+	##################################################
+
+	# Executable
+	add_custom_command(TARGET ${target}
+		COMMAND ${CMAKE_COMMAND} -E copy ${CMAKE_CURRENT_BINARY_DIR}/${target}${CMAKE_EXECUTABLE_SUFFIX} "${CMAKE_SOURCE_DIR}/Bin/${PL_ARCHBITSIZE}"
+	)
+
+	# Run the copied executable, the tools resolve the data relative to their own directory
+	add_custom_target(${run_target}
+		COMMAND "${CMAKE_SOURCE_DIR}/Bin/${PL_ARCHBITSIZE}/${target}${CMAKE_EXECUTABLE_SUFFIX}"
+		WORKING_DIRECTORY "${CMAKE_SOURCE_DIR}/Bin/${PL_ARCHBITSIZE}"
+	)
+	add_dependencies(${run_target} ${target})
+
+	##################################################
+	## Install
+	##################################################
+	install(TARGETS ${target}
+		DESTINATION Bin/${CMAKETOOLS_TARGET_ARCHBITSIZE}	COMPONENT SDK
+	)
+endmacro(add_dungeon_tool run_target)
@@ -0,0 +1,146 @@
+/*********************************************************\
+ *  File: DungeonTool.cpp                                *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/File/Url.h>
+#include <PLCore/Tools/LoadableManager.h>
+#include <PLRenderer/RendererContext.h>
+#include <PLScene/Scene/SceneContext.h>
+#include <PLScene/Scene/SceneContainer.h>
+#include "DungeonTool.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLRenderer;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ RTTI interface                                        ]
+//[-------------------------------------------------------]
+pl_class_metadata(DungeonTool, "", PLCore::CoreApplication, "Offline dungeon tool application base class")
+pl_class_metadata_end(DungeonTool)
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+DungeonTool::DungeonTool() : CoreApplication(),
+	m_pRendererContext(nullptr),
+	m_pSceneContext(nullptr),
+	m_pSceneContainer(nullptr)
+{
+	// Put the log and configuration files in the same directory the executable is in, like the dungeon does
+	SetMultiUser(false);
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+DungeonTool::~DungeonTool()
+{
+	UnloadScene();
+}
+
+
+//[-------------------------------------------------------]
+//[ Protected functions                                   ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Loads a scene using the null renderer
+*/
+SceneContainer *DungeonTool::LoadScene(const String &sSceneFilename, const String &sName)
+{
+	UnloadScene();
+
+	// Meshes require a renderer, the null renderer is enough
+	m_pRendererContext = RendererContext::CreateInstance("PLRendererNull::Renderer", NULL_HANDLE);
+	if (!m_pRendererContext) {
+		PL_LOG(Error, "Failed to create the null renderer")
+		return nullptr; // Error!
+	}
+
+	// Create the scene context and load the scene
+	m_pSceneContext = new SceneContext(*m_pRendererContext);
+	SceneContainer *pRootContainer = m_pSceneContext->GetRoot();
+	if (pRootContainer) {
+		m_pSceneContainer = static_cast<SceneContainer*>(pRootContainer->Create("PLScene::SceneContainer", sName));
+		if (m_pSceneContainer && !m_pSceneContainer->LoadByFilename(sSceneFilename)) {
+			m_pSceneContainer->Delete();
+			m_pSceneContainer = nullptr;
+		}
+	}
+	if (!m_pSceneContainer)
+		PL_LOG(Error, "Failed to load the scene '" + (Url(sSceneFilename).IsAbsolute() ? sSceneFilename : m_sBaseDirectory + sSceneFilename) + '\'')
+
+	// Done
+	return m_pSceneContainer;
+}
+
+/**
+*  @brief
+*    Unloads the scene and destroys the null renderer
+*/
+void DungeonTool::UnloadScene()
+{
+	// The scene container first, its scene nodes use the scene context
+	if (m_pSceneContainer) {
+		m_pSceneContainer->Delete();
+		m_pSceneContainer = nullptr;
+	}
+	if (m_pSceneContext) {
+		delete m_pSceneContext;
+		m_pSceneContext = nullptr;
+	}
+	if (m_pRendererContext) {
+		delete m_pRendererContext;
+		m_pRendererContext = nullptr;
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Protected virtual PLCore::CoreApplication functions   ]
+//[-------------------------------------------------------]
+void DungeonTool::OnInit()
+{
+	// Call base implementation
+	CoreApplication::OnInit();
+
+	// The executable is within "Bin/x86" or "Bin/x64", the data within "Bin" - exactly as for the dungeon
+	m_sBaseDirectory = Url(GetApplicationContext().GetExecutableDirectory() + "/../").Collapse().GetUrl();
+	if (m_sBaseDirectory.GetLength() && m_sBaseDirectory[m_sBaseDirectory.GetLength() - 1] != '/')
+		m_sBaseDirectory += '/';
+	LoadableManager::GetInstance()->AddBaseDir(m_sBaseDirectory);
+}
@@ -0,0 +1,135 @@
+/*********************************************************\
+ *  File: DungeonTool.h                                  *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+#ifndef __DUNGEONTOOL_DUNGEONTOOL_H__
+#define __DUNGEONTOOL_DUNGEONTOOL_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Application/CoreApplication.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLRenderer {
+	class RendererContext;
+}
+namespace PLScene {
+	class SceneContext;
+	class SceneContainer;
+}
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Offline dungeon tool application base class
+*
+*  @remarks
+*    The tool executables are placed next to the dungeon executable (see "DungeonTool.cmake"), the filenames are
+*    relative to the directory the "Data" directory is in - like the dungeon does when it's started from there. The
+*    tools loading a scene use the null renderer, it keeps the vertex and index data of the meshes and is enough to get
+*    the bounding boxes.
+*/
+class DungeonTool : public PLCore::CoreApplication {
+
+
+	//[-------------------------------------------------------]
+	//[ RTTI interface                                        ]
+	//[-------------------------------------------------------]
+	pl_class_def()
+	pl_class_def_end
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*/
+		DungeonTool();
+
+		/**
+		*  @brief
+		*    Destructor, unloads the scene
+		*/
+		virtual ~DungeonTool();
+
+
+	//[-------------------------------------------------------]
+	//[ Protected functions                                   ]
+	//[-------------------------------------------------------]
+	protected:
+		/**
+		*  @brief
+		*    Loads a scene using the null renderer, the previously loaded scene is unloaded
+		*
+		*  @param[in] sSceneFilename
+		*    Filename of the XML scene, relative to the base directory
+		*  @param[in] sName
+		*    Name of the scene container the scene is loaded into
+		*
+		*  @return
+		*    The scene container the scene was loaded into, null pointer on error (the error is written into the log)
+		*/
+		PLScene::SceneContainer *LoadScene(const PLCore::String &sSceneFilename, const PLCore::String &sName);
+
+		/**
+		*  @brief
+		*    Unloads the scene and destroys the null renderer
+		*/
+		void UnloadScene();
+
+
+	//[-------------------------------------------------------]
+	//[ Protected virtual PLCore::CoreApplication functions   ]
+	//[-------------------------------------------------------]
+	protected:
+		virtual void OnInit() override;
+
+
+	//[-------------------------------------------------------]
+	//[ Protected data                                        ]
+	//[-------------------------------------------------------]
+	protected:
+		PLCore::String m_sBaseDirectory;	/**< Base directory of the application (the directory "Data" is in), ends with a slash */
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLRenderer::RendererContext *m_pRendererContext;	/**< Null renderer context, can be a null pointer */
+		PLScene::SceneContext		*m_pSceneContext;		/**< Scene context, can be a null pointer */
+		PLScene::SceneContainer		*m_pSceneContainer;		/**< Scene container the scene was loaded into, can be a null pointer */
+
+
+};
+
+
+#endif // __DUNGEONTOOL_DUNGEONTOOL_H__
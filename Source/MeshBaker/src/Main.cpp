@@ -0,0 +1,48 @@
+/*********************************************************\
+ *  File: Main.cpp                                       *
+ *      PixelLight dungeon demo offline mesh baker
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Main.h>
+#include "MeshBaker.h"
+
+
+//[-------------------------------------------------------]
+//[ Module definition                                     ]
+//[-------------------------------------------------------]
+pl_module_application("DungeonMeshBaker", "MeshBaker")
+	pl_module_vendor("Copyright (C) 2002-2012 by The PixelLight Team")
+	pl_module_license("GNU Lesser General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version")
+	pl_module_description("PixelLight dungeon demo offline mesh baker")
+pl_module_end
+
+
+//[-------------------------------------------------------]
+//[ Program entry point                                   ]
+//[-------------------------------------------------------]
+int PLMain(const PLCore::String &sExecutableFilename, const PLCore::Array<PLCore::String> &lstArguments)
+{
+	MeshBaker cApplication;
+	return cApplication.Run(sExecutableFilename, lstArguments);
+}
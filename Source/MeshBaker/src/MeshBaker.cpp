@@ -0,0 +1,463 @@
+/*********************************************************\
+ *  File: MeshBaker.cpp                                  *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <string.h>
+#include <PLCore/Log/Log.h>
+#include <PLCore/File/Directory.h>
+#include <PLMath/AABoundingBox.h>
+#include <PLRenderer/Renderer/IndexBuffer.h>
+#include <PLRenderer/Renderer/VertexBuffer.h>
+#include <PLRenderer/Material/Material.h>
+#include <PLRenderer/Material/ParameterManager.h>
+#include <PLMesh/Mesh.h>
+#include <PLMesh/Geometry.h>
+#include <PLMesh/MeshHandler.h>
+#include <PLMesh/MeshManager.h>
+#include <PLMesh/MeshLODLevel.h>
+#include <PLMesh/MeshMorphTarget.h>
+#include <PLScene/Scene/SNMesh.h>
+#include <PLScene/Scene/SceneContext.h>
+#include <PLScene/Scene/SceneContainer.h>
+#include "Tools/SpatialTools.h"
+#include "Scene/SceneCuller.h"
+#include "Scene/MeshInstancer.h"
+#include "MeshBaker.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+using namespace PLRenderer;
+using namespace PLMesh;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ Local functions                                       ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Returns the vertex layout of a vertex buffer as text, vertex buffers with the same layout can be merged by copying
+*/
+static String GetVertexLayout(VertexBuffer &cVertexBuffer)
+{
+	String sLayout;
+	for (uint32 i=0; i<cVertexBuffer.GetNumOfVertexAttributes(); i++) {
+		const VertexBuffer::Attribute *pAttribute = cVertexBuffer.GetVertexAttribute(i);
+		if (pAttribute)
+			sLayout += String::Format("%d:%u:%d;", pAttribute->nSemantic, pAttribute->nChannel, pAttribute->nType);
+	}
+	return sLayout;
+}
+
+/**
+*  @brief
+*    Returns the number of vertices referenced by a geometry of the first level of detail of a mesh, 0 on error
+*/
+static uint32 GetNumOfReferencedVertices(Mesh &cMesh, uint32 nGeometry)
+{
+	uint32 nNumOfVertices = 0;
+	const uint32	nNumOfMeshVertices = cMesh.GetMorphTarget(0)->GetVertexBuffer()->GetNumOfElements();
+	IndexBuffer		&cIndexBuffer	   = *cMesh.GetLODLevel(0)->GetIndexBuffer();
+	const Geometry	&cGeometry		   = (*cMesh.GetLODLevel(0)->GetGeometries())[nGeometry];
+	if (cIndexBuffer.Lock(Lock::ReadOnly)) {
+		bool *pbReferenced = new bool[nNumOfMeshVertices];
+		memset(pbReferenced, 0, nNumOfMeshVertices*sizeof(bool));
+		for (uint32 i=cGeometry.GetStartIndex(); i<cGeometry.GetStartIndex()+cGeometry.GetIndexSize(); i++) {
+			const uint32 nVertex = cIndexBuffer.GetData(i);
+			if (nVertex < nNumOfMeshVertices && !pbReferenced[nVertex]) {
+				pbReferenced[nVertex] = true;
+				nNumOfVertices++;
+			}
+		}
+		delete [] pbReferenced;
+		cIndexBuffer.Unlock();
+	}
+	return nNumOfVertices;
+}
+
+
+//[-------------------------------------------------------]
+//[ RTTI interface                                        ]
+//[-------------------------------------------------------]
+pl_class_metadata(MeshBaker, "", DungeonTool, "Offline mesh baker application class")
+	// Constructors
+	pl_constructor_0_metadata(DefaultConstructor,	"Default constructor",	"")
+pl_class_metadata_end(MeshBaker)
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+MeshBaker::MeshBaker() : DungeonTool()
+{
+	// Set application title
+	SetTitle("PixelLight dungeon mesh baker");
+
+	// Add the command line options
+	m_cCommandLine.AddOption("Scene", "-s", "--scene", "Filename of the scene to bake the mesh batches for", "Data/Scenes/Dungeon.scene");
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+MeshBaker::~MeshBaker()
+{
+}
+
+
+//[-------------------------------------------------------]
+//[ Protected virtual PLCore::CoreApplication functions   ]
+//[-------------------------------------------------------]
+void MeshBaker::Main()
+{
+	// Bake
+	if (!Bake(m_cCommandLine.GetValue("Scene")))
+		Exit(1);
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Bakes the mesh batch cache of a scene
+*/
+bool MeshBaker::Bake(const String &sSceneFilename)
+{
+	// The cache is keyed by the content hash of the XML scene
+	const String sSceneHash = MeshBatchCache::GetContentHash(sSceneFilename);
+	if (!sSceneHash.GetLength()) {
+		PL_LOG(Error, "Failed to load the scene '" + m_sBaseDirectory + sSceneFilename + '\'')
+		return false;
+	}
+
+	// Load the scene using the null renderer, it keeps the vertex and index data
+	SceneContainer *pContainer = LoadScene(sSceneFilename, "Scene");
+	const bool bResult = (pContainer && Bake(*pContainer, sSceneFilename, sSceneHash));
+	UnloadScene();
+
+	// Done
+	return bResult;
+}
+
+/**
+*  @brief
+*    Bakes the mesh batch cache of a loaded scene
+*/
+bool MeshBaker::Bake(SceneContainer &cSceneContainer, const String &sSceneFilename, const String &sSceneHash)
+{
+	// Create the cache directory
+	const String sDirectory = MeshBatchCache::GetDirectory(sSceneFilename);
+	Directory cDirectory(m_sBaseDirectory + sDirectory);
+	if (!cDirectory.Exists() && !cDirectory.CreateRecursive()) {
+		PL_LOG(Error, "Failed to create the directory '" + m_sBaseDirectory + sDirectory + '\'')
+		return false;
+	}
+
+	// Merge the static meshes
+	Array<String> lstMeshes;
+	Array<MeshBatchCache::SBatch*> lstBatches;
+	bool bResult = MergeContainer(cSceneContainer, cSceneContainer, sDirectory, lstMeshes, lstBatches);
+
+	// Write the manifest, the batch meshes are written already
+	if (bResult) {
+		bResult = MeshBatchCache::Save(m_sBaseDirectory + sDirectory + "Batches.xml", sSceneHash, lstMeshes, lstBatches);
+		if (bResult) {
+			uint32 nNumOfNodes = 0;
+			for (uint32 i=0; i<lstBatches.GetNumOfElements(); i++)
+				nNumOfNodes += lstBatches[i]->lstNodes.GetNumOfElements();
+			PL_LOG(Info, String::Format("Wrote %u batches merging %u static meshes into '", lstBatches.GetNumOfElements(), nNumOfNodes) + sDirectory + '\'')
+		} else {
+			PL_LOG(Error, "Failed to write the mesh batch cache '" + m_sBaseDirectory + sDirectory + "Batches.xml'")
+		}
+	}
+
+	// Cleanup
+	for (uint32 i=0; i<lstBatches.GetNumOfElements(); i++)
+		delete lstBatches[i];
+
+	// Done
+	return bResult;
+}
+
+/**
+*  @brief
+*    Merges the static meshes of a container and of its child containers, recursive
+*/
+bool MeshBaker::MergeContainer(SceneContainer &cSceneContainer, SceneContainer &cContainer, const String &sDirectory, Array<String> &lstMeshes, Array<MeshBatchCache::SBatch*> &lstBatches)
+{
+	// Collect the static meshes, child containers are merged on their own so the batches stay within the cells
+	Array<SNMesh*> lstSceneNodes;
+	Array<String> lstFilenames;
+	for (uint32 i=0; i<cContainer.GetNumOfElements(); i++) {
+		SceneNode *pSceneNode = cContainer.GetByIndex(i);
+		if (pSceneNode) {
+			if (pSceneNode->IsContainer()) {
+				if (!MergeContainer(cSceneContainer, static_cast<SceneContainer&>(*pSceneNode), sDirectory, lstMeshes, lstBatches))
+					return false; // Error!
+			} else if (SceneCuller::IsStaticMesh(*pSceneNode)) {
+				lstSceneNodes.Add(static_cast<SNMesh*>(pSceneNode));
+				const DynVar *pMesh = pSceneNode->GetAttribute("Mesh");
+				lstFilenames.Add(pMesh ? pMesh->GetString() : "");
+			}
+		}
+	}
+
+	// Repeated meshes are batched by the instancer at load time, which keeps their levels of detail - it's asked which
+	// ones it's going to batch, so meshes it would reject (e.g. too many vertices or different materials) are merged here
+	Array<SNMesh*> lstInstanced;
+	MeshInstancer::WillBatch(cContainer, lstInstanced);
+
+	// Group the geometries by material, flags and vertex layout
+	Array<SGroup*> lstGroups;
+	for (uint32 nSceneNode=0; nSceneNode<lstSceneNodes.GetNumOfElements(); nSceneNode++) {
+		SNMesh		 &cSNMesh	   = *lstSceneNodes[nSceneNode];
+		const String &sFilename	   = lstFilenames[nSceneNode];
+		MeshHandler	 *pMeshHandler = cSNMesh.GetMeshHandler();
+		Mesh		 *pMesh		   = pMeshHandler ? pMeshHandler->GetResource() : nullptr;
+		Matrix3x4 mTransform;
+		if (!sFilename.GetLength() || !pMesh || !MeshInstancer::IsBatchable(*pMesh) || lstInstanced.IsElement(&cSNMesh) ||
+			!cSNMesh.GetTransformMatrixTo(cContainer, mTransform))
+			continue;
+
+		// Transparent materials are drawn back to front per scene node, a merged scene node is hidden as a whole
+		bool bOpaque = true;
+		for (uint32 i=0; i<pMeshHandler->GetNumOfMaterials() && bOpaque; i++) {
+			Material *pMaterial = pMeshHandler->GetMaterial(i);
+			if (!pMaterial || pMaterial->GetParameterManager().GetParameter("Opacity"))
+				bOpaque = false;
+		}
+		if (!bOpaque)
+			continue;
+
+		// Add a part per geometry of the first level of detail
+		const Array<Geometry> &lstGeometries = *pMesh->GetLODLevel(0)->GetGeometries();
+		const String		   sLayout		 = GetVertexLayout(*pMesh->GetMorphTarget(0)->GetVertexBuffer());
+		const AABoundingBox	  &cBox			 = cSNMesh.GetContainerAABoundingBox();
+		for (uint32 nGeometry=0; nGeometry<lstGeometries.GetNumOfElements(); nGeometry++) {
+			Material *pMaterial = pMeshHandler->GetMaterial(lstGeometries[nGeometry].GetMaterial());
+			if (!pMaterial || !lstGeometries[nGeometry].GetIndexSize())
+				continue;
+
+			// Find the group of the part
+			SGroup *pGroup = nullptr;
+			for (uint32 i=0; i<lstGroups.GetNumOfElements() && !pGroup; i++) {
+				if (lstGroups[i]->pMaterial == pMaterial && lstGroups[i]->nFlags == cSNMesh.GetFlags() && lstGroups[i]->sLayout == sLayout)
+					pGroup = lstGroups[i];
+			}
+			if (!pGroup) {
+				pGroup = new SGroup;
+				pGroup->pMaterial = pMaterial;
+				pGroup->nFlags	  = cSNMesh.GetFlags();
+				pGroup->sLayout	  = sLayout;
+				lstGroups.Add(pGroup);
+			}
+			SPart &sPart = pGroup->lstParts.Add();
+			sPart.pSceneNode = &cSNMesh;
+			sPart.pMesh		 = pMesh;
+			sPart.nGeometry	 = nGeometry;
+			sPart.nVertices	 = GetNumOfReferencedVertices(*pMesh, nGeometry);
+			sPart.mTransform = mTransform;
+			sPart.vCenter	 = (cBox.vMin + cBox.vMax)*0.5f;
+		}
+		if (!lstMeshes.IsElement(sFilename))
+			lstMeshes.Add(sFilename);
+	}
+
+	// Write the batches
+	bool bResult = true;
+	for (uint32 nGroup=0; nGroup<lstGroups.GetNumOfElements(); nGroup++) {
+		SGroup *pGroup = lstGroups[nGroup];
+		if (bResult)
+			bResult = AddBatches(cSceneContainer, cContainer, *pGroup, 0, pGroup->lstParts.GetNumOfElements(), sDirectory, lstBatches);
+		delete pGroup;
+	}
+
+	// Done
+	return bResult;
+}
+
+/**
+*  @brief
+*    Writes the batches of a group
+*/
+bool MeshBaker::AddBatches(SceneContainer &cSceneContainer, SceneContainer &cContainer, SGroup &sGroup, uint32 nFirst, uint32 nCount, const String &sDirectory, Array<MeshBatchCache::SBatch*> &lstBatches)
+{
+	// Split the parts at the median along the axis they are spread the most, so each batch covers a compact region
+	uint32 nNumOfVertices = 0;
+	for (uint32 i=nFirst; i<nFirst+nCount; i++)
+		nNumOfVertices += sGroup.lstParts[i].nVertices;
+	if (nNumOfVertices > MaxVerticesPerBatch && nCount > 1) {
+		SpatialTools::SortByCenter(&sGroup.lstParts[nFirst], nCount);
+		const uint32 nHalf = nCount/2;
+		return AddBatches(cSceneContainer, cContainer, sGroup, nFirst, nHalf, sDirectory, lstBatches) &&
+			   AddBatches(cSceneContainer, cContainer, sGroup, nFirst + nHalf, nCount - nHalf, sDirectory, lstBatches);
+	}
+
+	// Describe the batch, the container is addressed relative to the scene container
+	MeshBatchCache::SBatch *pBatch = new MeshBatchCache::SBatch;
+	if (&cContainer != &cSceneContainer)
+		pBatch->sContainer = cContainer.GetAbsoluteName().GetSubstring(cSceneContainer.GetAbsoluteName().GetLength() + 1);
+	pBatch->sName  = String::Format("MeshBatch%u", lstBatches.GetNumOfElements());
+	pBatch->sMesh  = sDirectory + String::Format("Batch%u.mesh", lstBatches.GetNumOfElements());
+	pBatch->nFlags = sGroup.nFlags;
+	for (uint32 i=nFirst; i<nFirst+nCount; i++) {
+		const String sName = sGroup.lstParts[i].pSceneNode->GetName();
+		if (!pBatch->lstNodes.IsElement(sName))
+			pBatch->lstNodes.Add(sName);
+	}
+	lstBatches.Add(pBatch);
+
+	// Write the mesh
+	if (!cContainer.GetSceneContext() || !WriteBatch(cContainer.GetSceneContext()->GetMeshManager(), sGroup, nFirst, nCount, pBatch->sMesh)) {
+		PL_LOG(Error, "Failed to write the batch mesh '" + m_sBaseDirectory + pBatch->sMesh + '\'')
+		return false;
+	}
+
+	// Done
+	return true;
+}
+
+/**
+*  @brief
+*    Writes the mesh of a batch
+*/
+bool MeshBaker::WriteBatch(MeshManager &cMeshManager, const SGroup &sGroup, uint32 nFirst, uint32 nCount, const String &sFilename) const
+{
+	uint32 nNumOfVertices = 0, nNumOfIndices = 0;
+	for (uint32 i=nFirst; i<nFirst+nCount; i++) {
+		nNumOfVertices += sGroup.lstParts[i].nVertices;
+		nNumOfIndices  += (*sGroup.lstParts[i].pMesh->GetLODLevel(0)->GetGeometries())[sGroup.lstParts[i].nGeometry].GetIndexSize();
+	}
+	Mesh *pMesh = nNumOfVertices ? cMeshManager.CreateMesh(sFilename) : nullptr;
+	if (!pMesh)
+		return false; // Error!
+	pMesh->AddMaterial(sGroup.pMaterial);
+
+	// Create the vertex and index buffers, all parts have the same vertex layout
+	bool bResult = false;
+	VertexBuffer &cFirstVertexBuffer = *sGroup.lstParts[nFirst].pMesh->GetMorphTarget(0)->GetVertexBuffer();
+	MeshMorphTarget *pMorphTarget  = pMesh->AddMorphTarget();
+	VertexBuffer	*pVertexBuffer = pMorphTarget ? pMorphTarget->GetVertexBuffer() : nullptr;
+	MeshLODLevel	*pLODLevel	   = pMesh->AddLODLevel();
+	if (pVertexBuffer && pLODLevel) {
+		for (uint32 i=0; i<cFirstVertexBuffer.GetNumOfVertexAttributes(); i++) {
+			const VertexBuffer::Attribute *pAttribute = cFirstVertexBuffer.GetVertexAttribute(i);
+			pVertexBuffer->AddVertexAttribute(pAttribute->nSemantic, pAttribute->nChannel, pAttribute->nType);
+		}
+		pLODLevel->CreateIndexBuffer();
+		pLODLevel->CreateGeometries();
+		IndexBuffer		*pIndexBuffer	= pLODLevel->GetIndexBuffer();
+		Array<Geometry> *plstGeometries = pLODLevel->GetGeometries();
+		if (pIndexBuffer && plstGeometries && pVertexBuffer->Allocate(nNumOfVertices, Usage::Static) && pVertexBuffer->GetVertexSize() == cFirstVertexBuffer.GetVertexSize()) {
+			pIndexBuffer->SetElementTypeByMaximumIndex(nNumOfVertices - 1);
+			uint8 *pData = pIndexBuffer->Allocate(nNumOfIndices, Usage::Static) ? static_cast<uint8*>(pVertexBuffer->Lock(Lock::WriteOnly)) : nullptr;
+			if (pData) {
+				if (pIndexBuffer->Lock(Lock::WriteOnly)) {
+					// Copy the referenced vertices of each part, the positions are transformed into container space and the directions are rotated
+					const uint32 nVertexSize = pVertexBuffer->GetVertexSize();
+					uint32 nVertex = 0, nIndex = 0;
+					Vector3 vMin, vMax;
+					bResult = true;
+					for (uint32 nPart=nFirst; nPart<nFirst+nCount && bResult; nPart++) {
+						const SPart	   &sPart				= sGroup.lstParts[nPart];
+						VertexBuffer   &cSourceVertexBuffer = *sPart.pMesh->GetMorphTarget(0)->GetVertexBuffer();
+						IndexBuffer	   &cSourceIndexBuffer	= *sPart.pMesh->GetLODLevel(0)->GetIndexBuffer();
+						const Geometry &cSourceGeometry		= (*sPart.pMesh->GetLODLevel(0)->GetGeometries())[sPart.nGeometry];
+						const uint32	nNumOfSourceVertices = cSourceVertexBuffer.GetNumOfElements();
+						const uint8 *pSourceData = static_cast<const uint8*>(cSourceVertexBuffer.Lock(Lock::ReadOnly));
+						bResult = false;
+						if (pSourceData) {
+							if (cSourceIndexBuffer.Lock(Lock::ReadOnly)) {
+								// New index of each source vertex, -1 if it's not copied yet
+								int *pnVertices = new int[nNumOfSourceVertices];
+								for (uint32 i=0; i<nNumOfSourceVertices; i++)
+									pnVertices[i] = -1;
+								bResult = true;
+								for (uint32 i=cSourceGeometry.GetStartIndex(); i<cSourceGeometry.GetStartIndex()+cSourceGeometry.GetIndexSize() && bResult; i++) {
+									const uint32 nSourceVertex = cSourceIndexBuffer.GetData(i);
+									if (nSourceVertex >= nNumOfSourceVertices) {
+										bResult = false;
+									} else {
+										if (pnVertices[nSourceVertex] < 0) {
+											memcpy(pData + nVertex*nVertexSize, pSourceData + nSourceVertex*nVertexSize, nVertexSize);
+											const Vector3 vPosition = MeshInstancer::TransformVertex(*pVertexBuffer, nVertex, sPart.mTransform);
+											if (!nVertex) {
+												vMin = vMax = vPosition;
+											} else {
+												if (vMin.x > vPosition.x) vMin.x = vPosition.x;
+												if (vMin.y > vPosition.y) vMin.y = vPosition.y;
+												if (vMin.z > vPosition.z) vMin.z = vPosition.z;
+												if (vMax.x < vPosition.x) vMax.x = vPosition.x;
+												if (vMax.y < vPosition.y) vMax.y = vPosition.y;
+												if (vMax.z < vPosition.z) vMax.z = vPosition.z;
+											}
+											pnVertices[nSourceVertex] = nVertex++;
+										}
+										pIndexBuffer->SetData(nIndex++, pnVertices[nSourceVertex]);
+									}
+								}
+								delete [] pnVertices;
+								cSourceIndexBuffer.Unlock();
+							}
+							cSourceVertexBuffer.Unlock();
+						}
+					}
+
+					// All parts are drawn at once
+					if (bResult) {
+						Geometry &cGeometry = plstGeometries->Add();
+						cGeometry.SetPrimitiveType(Primitive::TriangleList);
+						cGeometry.SetMaterial(0);
+						cGeometry.SetStartIndex(0);
+						cGeometry.SetIndexSize(nIndex);
+						pMesh->SetBoundingBox(vMin, vMax);
+					}
+					pIndexBuffer->Unlock();
+				}
+				pVertexBuffer->Unlock();
+			}
+		}
+	}
+
+	// Write the mesh
+	if (bResult)
+		bResult = pMesh->SaveByFilename(m_sBaseDirectory + sFilename);
+
+	// Cleanup
+	delete pMesh;
+
+	// Done
+	return bResult;
+}
@@ -0,0 +1,242 @@
+/*********************************************************\
+ *  File: MeshBaker.h                                    *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEONMESHBAKER_MESHBAKER_H__
+#define __DUNGEONMESHBAKER_MESHBAKER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLMath/Vector3.h>
+#include <PLMath/Matrix3x4.h>
+#include "DungeonTool.h"
+#include "Scene/MeshBatchCache.h"
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLRenderer {
+	class Material;
+}
+namespace PLMesh {
+	class Mesh;
+	class MeshManager;
+}
+namespace PLScene {
+	class SNMesh;
+	class SceneContainer;
+}
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Offline mesh baker application class
+*
+*  @remarks
+*    Merges the unique static meshes of each container of a scene per material into batch meshes and writes them
+*    together with a manifest into the cache directory of the scene (see "MeshBatchCache"). The meshes the instancer
+*    batches at load time are left to it (see "MeshInstancer::WillBatch()"). The scene is loaded using the null
+*    renderer. The geometries of the first level of detail of the meshes are grouped by material, scene node flags and
+*    vertex layout. The referenced vertices of each geometry are copied and transformed into container space, groups
+*    with more than "MaxVerticesPerBatch" vertices are split at the median along the axis their meshes are spread the
+*    most, so a batch covers a compact region and uses 16 bit indices. The filenames are relative to the base
+*    directory (see "DungeonTool").
+*/
+class MeshBaker : public DungeonTool {
+
+
+	//[-------------------------------------------------------]
+	//[ RTTI interface                                        ]
+	//[-------------------------------------------------------]
+	pl_class_def()
+	pl_class_def_end
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 MaxVerticesPerBatch = 65536;	/**< Maximum number of vertices of a batch, unless a single geometry has more */
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*/
+		MeshBaker();
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		virtual ~MeshBaker();
+
+
+	//[-------------------------------------------------------]
+	//[ Protected virtual PLCore::CoreApplication functions   ]
+	//[-------------------------------------------------------]
+	protected:
+		virtual void Main() override;
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Part of a batch, a geometry of a mesh scene node
+		*/
+		struct SPart {
+			PLScene::SNMesh	  *pSceneNode;	/**< Mesh scene node, always valid */
+			PLMesh::Mesh	  *pMesh;		/**< Mesh of the scene node, always valid */
+			PLCore::uint32	   nGeometry;	/**< Index of the geometry within the first level of detail */
+			PLCore::uint32	   nVertices;	/**< Number of vertices referenced by the geometry */
+			PLMath::Matrix3x4  mTransform;	/**< Transform into container space */
+			PLMath::Vector3	   vCenter;		/**< Center of the bounding box within container space */
+		};
+
+		/**
+		*  @brief
+		*    Group of parts which can be merged
+		*/
+		struct SGroup {
+			PLRenderer::Material *pMaterial;	/**< Material, always valid */
+			PLCore::uint32		  nFlags;		/**< Scene node flags */
+			PLCore::String		  sLayout;		/**< Vertex layout */
+			PLCore::Array<SPart>  lstParts;		/**< Parts */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Bakes the mesh batch cache of a scene
+		*
+		*  @param[in] sSceneFilename
+		*    Filename of the XML scene, relative to the base directory
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool Bake(const PLCore::String &sSceneFilename);
+
+		/**
+		*  @brief
+		*    Bakes the mesh batch cache of a loaded scene
+		*
+		*  @param[in] cSceneContainer
+		*    Scene container the scene was loaded into
+		*  @param[in] sSceneFilename
+		*    Filename of the XML scene, relative to the base directory
+		*  @param[in] sSceneHash
+		*    Content hash of the XML scene
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool Bake(PLScene::SceneContainer &cSceneContainer, const PLCore::String &sSceneFilename, const PLCore::String &sSceneHash);
+
+		/**
+		*  @brief
+		*    Merges the static meshes of a container and of its child containers, recursive
+		*
+		*  @param[in]      cSceneContainer
+		*    Scene container the scene was loaded into
+		*  @param[in]      cContainer
+		*    Container to merge, the child containers are merged on their own
+		*  @param[in]      sDirectory
+		*    Cache directory, relative to the base directory
+		*  @param[in, out] lstMeshes
+		*    Filenames of the merged mesh files, new ones are added
+		*  @param[in, out] lstBatches
+		*    Batches, new ones are added
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool MergeContainer(PLScene::SceneContainer &cSceneContainer, PLScene::SceneContainer &cContainer, const PLCore::String &sDirectory,
+							PLCore::Array<PLCore::String> &lstMeshes, PLCore::Array<MeshBatchCache::SBatch*> &lstBatches);
+
+		/**
+		*  @brief
+		*    Writes the batches of a group
+		*
+		*  @param[in]      cSceneContainer
+		*    Scene container the scene was loaded into
+		*  @param[in]      cContainer
+		*    Container of the group
+		*  @param[in, out] sGroup
+		*    Group, the parts are sorted
+		*  @param[in]      nFirst
+		*    Index of the first part to batch
+		*  @param[in]      nCount
+		*    Number of parts to batch
+		*  @param[in]      sDirectory
+		*    Cache directory, relative to the base directory
+		*  @param[in, out] lstBatches
+		*    Batches, new ones are added
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool AddBatches(PLScene::SceneContainer &cSceneContainer, PLScene::SceneContainer &cContainer, SGroup &sGroup, PLCore::uint32 nFirst, PLCore::uint32 nCount,
+						const PLCore::String &sDirectory, PLCore::Array<MeshBatchCache::SBatch*> &lstBatches);
+
+		/**
+		*  @brief
+		*    Writes the mesh of a batch
+		*
+		*  @param[in] cMeshManager
+		*    Mesh manager creating the mesh
+		*  @param[in] sGroup
+		*    Group of the batch
+		*  @param[in] nFirst
+		*    Index of the first part of the batch
+		*  @param[in] nCount
+		*    Number of parts of the batch
+		*  @param[in] sFilename
+		*    Filename of the mesh
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool WriteBatch(PLMesh::MeshManager &cMeshManager, const SGroup &sGroup, PLCore::uint32 nFirst, PLCore::uint32 nCount, const PLCore::String &sFilename) const;
+
+
+};
+
+
+#endif // __DUNGEONMESHBAKER_MESHBAKER_H__
@@ -0,0 +1,245 @@
+/*********************************************************\
+ *  File: PVSBaker.cpp                                   *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLMath/Polygon.h>
+#include <PLMath/Matrix3x4.h>
+#include <PLMath/AABoundingBox.h>
+#include <PLScene/Scene/SCCell.h>
+#include <PLScene/Scene/SNCellPortal.h>
+#include "Scene/CellPVS.h"
+#include "Scene/SceneCuller.h"
+#include "PVSBaker.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ RTTI interface                                        ]
+//[-------------------------------------------------------]
+pl_class_metadata(PVSBaker, "", DungeonTool, "Offline potentially visible set baker application class")
+	// Constructors
+	pl_constructor_0_metadata(DefaultConstructor,	"Default constructor",	"")
+pl_class_metadata_end(PVSBaker)
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+PVSBaker::PVSBaker() : DungeonTool()
+{
+	// Set application title
+	SetTitle("PixelLight dungeon potentially visible set baker");
+
+	// Add the command line options
+	m_cCommandLine.AddOption("Scene",	"-s", "--scene",   "Filename of the scene to bake the potentially visible set for", "Data/Scenes/Dungeon.scene");
+	m_cCommandLine.AddOption("Samples", "-n", "--samples", "Number of sampled positions per axis within each cell, the bounding box faces included", "8");
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+PVSBaker::~PVSBaker()
+{
+}
+
+
+//[-------------------------------------------------------]
+//[ Protected virtual PLCore::CoreApplication functions   ]
+//[-------------------------------------------------------]
+void PVSBaker::Main()
+{
+	// Bake
+	const uint32 nNumOfSamples = m_cCommandLine.GetValue("Samples").GetUInt32();
+	if (!Bake(m_cCommandLine.GetValue("Scene"), nNumOfSamples ? nNumOfSamples : 1))
+		Exit(1);
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Bakes the potentially visible set of a scene
+*/
+bool PVSBaker::Bake(const String &sSceneFilename, uint32 nNumOfSamples)
+{
+	// The potentially visible set is keyed by the content hash of the XML scene
+	const String sSceneHash = CellPVS::GetSceneHash(sSceneFilename);
+	if (!sSceneHash.GetLength()) {
+		PL_LOG(Error, "Failed to load the scene '" + m_sBaseDirectory + sSceneFilename + '\'')
+		return false;
+	}
+
+	// Load the scene using the null renderer, it's enough to get the bounding boxes
+	SceneContainer *pContainer = LoadScene(sSceneFilename, "Scene");
+	const bool bResult = (pContainer && Bake(*pContainer, sSceneFilename, sSceneHash, nNumOfSamples));
+	UnloadScene();
+
+	// Done
+	return bResult;
+}
+
+/**
+*  @brief
+*    Bakes the potentially visible set of a loaded scene
+*/
+bool PVSBaker::Bake(SceneContainer &cSceneContainer, const String &sSceneFilename, const String &sSceneHash, uint32 nNumOfSamples)
+{
+	// Collect the cells
+	Array<SceneContainer*> lstCells;
+	CollectCells(cSceneContainer, lstCells);
+	if (!lstCells.GetNumOfElements()) {
+		PL_LOG(Error, "The scene '" + sSceneFilename + "' has no cells")
+		return false;
+	}
+	Array<String> lstNames;
+	for (uint32 i=0; i<lstCells.GetNumOfElements(); i++)
+		lstNames.Add(lstCells[i]->GetName());
+	CellPVS cCellPVS;
+	cCellPVS.SetCells(lstNames);
+
+	// The portals are followed by the scene culler, so the baked set matches the runtime portal traversal
+	SceneCuller cSceneCuller(cSceneContainer);
+	for (uint32 nCell=0; nCell<lstCells.GetNumOfElements(); nCell++) {
+		SceneContainer &cCell = *lstCells[nCell];
+
+		// A cell always sees itself and the cells its portals lead to
+		cCellPVS.SetVisible(nCell, nCell);
+		for (uint32 i=0; i<cCell.GetNumOfElements(); i++) {
+			SceneNode *pSceneNode = cCell.GetByIndex(i);
+			if (pSceneNode && pSceneNode->IsInstanceOf("PLScene::SNCellPortal")) {
+				SNCellPortal &cCellPortal = static_cast<SNCellPortal&>(*pSceneNode);
+				const int nTargetCell = lstCells.GetIndex(cCellPortal.GetTargetCellInstance());
+				if (nTargetCell >= 0) {
+					cCellPVS.SetVisible(nCell, nTargetCell);
+
+					// Sample the vertices, the edge centers and the center of the portal polygon - the runtime doesn't narrow the view
+					// through a portal the camera is (almost) within, and the camera on a portal can be within both cells
+					const Array<Vector3> &lstVertices = cCellPortal.GetPolygon().GetVertexList();
+					Matrix3x4 mPortal;
+					if (lstVertices.GetNumOfElements() && pSceneNode->GetTransformMatrixTo(cSceneContainer, mPortal)) {
+						Vector3 vCenter = Vector3::Zero;
+						for (uint32 nVertex=0; nVertex<lstVertices.GetNumOfElements(); nVertex++) {
+							const Vector3 &vVertex = lstVertices[nVertex];
+							vCenter += vVertex;
+							for (uint32 nSample=0; nSample<2; nSample++) {
+								const Vector3 vPosition = mPortal*(nSample ? (vVertex + lstVertices[(nVertex + 1)%lstVertices.GetNumOfElements()])*0.5f : vVertex);
+								SamplePosition(cSceneCuller, lstCells, nCell, vPosition, cCellPVS);
+								SamplePosition(cSceneCuller, lstCells, nTargetCell, vPosition, cCellPVS);
+							}
+						}
+						vCenter = mPortal*(vCenter*(1.0f/lstVertices.GetNumOfElements()));
+						SamplePosition(cSceneCuller, lstCells, nCell, vCenter, cCellPVS);
+						SamplePosition(cSceneCuller, lstCells, nTargetCell, vCenter, cCellPVS);
+					}
+				}
+			}
+		}
+
+		// Sample a regular grid spanning the bounding box of the cell, the faces, edges and corners included - the runtime
+		// assigns the camera to a cell if it's within the bounding box, borders included. The bounding box is within the
+		// space of the cell parent.
+		SceneContainer *pCellParent = cCell.GetContainer();
+		Matrix3x4 mTransform;
+		if (pCellParent && pCellParent->GetTransformMatrixTo(cSceneContainer, mTransform)) {
+			const AABoundingBox &cBox = cCell.GetContainerAABoundingBox();
+			const Vector3 vStep = (nNumOfSamples > 1) ? (cBox.vMax - cBox.vMin)*(1.0f/(nNumOfSamples - 1)) : Vector3::Zero;
+			const Vector3 vFirst = (nNumOfSamples > 1) ? cBox.vMin : (cBox.vMin + cBox.vMax)*0.5f;
+			for (uint32 nX=0; nX<nNumOfSamples; nX++) {
+				for (uint32 nY=0; nY<nNumOfSamples; nY++) {
+					for (uint32 nZ=0; nZ<nNumOfSamples; nZ++)
+						SamplePosition(cSceneCuller, lstCells, nCell, mTransform*Vector3(vFirst.x + vStep.x*nX, vFirst.y + vStep.y*nY, vFirst.z + vStep.z*nZ), cCellPVS);
+				}
+			}
+		}
+	}
+
+	// Report the cells, the portal samples add to the target cells as well so this is done after sampling all cells
+	for (uint32 nCell=0; nCell<lstCells.GetNumOfElements(); nCell++) {
+		const SceneContainer &cCell = *lstCells[nCell];
+		uint32 nNumOfVisibleCells = 0;
+		for (uint32 i=0; i<lstCells.GetNumOfElements(); i++) {
+			if (cCellPVS.IsVisible(nCell, i))
+				nNumOfVisibleCells++;
+		}
+		PL_LOG(Info, String::Format("'%s': %u of %u cells potentially visible", cCell.GetName().GetASCII(), nNumOfVisibleCells, lstCells.GetNumOfElements()))
+	}
+
+	// Write the potentially visible set next to the scene
+	const String sPVSFilename = CellPVS::GetFilename(sSceneFilename);
+	if (!cCellPVS.Save(m_sBaseDirectory + sPVSFilename, sSceneHash)) {
+		PL_LOG(Error, "Failed to write the potentially visible set '" + m_sBaseDirectory + sPVSFilename + '\'')
+		return false;
+	}
+	PL_LOG(Info, "Wrote the potentially visible set '" + sPVSFilename + '\'')
+
+	// Done
+	return true;
+}
+
+/**
+*  @brief
+*    Marks the cells visible from a position as potentially visible from a cell
+*/
+void PVSBaker::SamplePosition(SceneCuller &cSceneCuller, const Array<SceneContainer*> &lstCells, uint32 nCell, const Vector3 &vPosition, CellPVS &cCellPVS)
+{
+	cSceneCuller.GetVisibleCells(*lstCells[nCell], vPosition, m_lstVisibleCells);
+	for (uint32 i=0; i<m_lstVisibleCells.GetNumOfElements(); i++) {
+		const int nVisibleCell = lstCells.GetIndex(m_lstVisibleCells[i]);
+		if (nVisibleCell >= 0)
+			cCellPVS.SetVisible(nCell, nVisibleCell);
+	}
+}
+
+/**
+*  @brief
+*    Collects the cells
+*/
+void PVSBaker::CollectCells(SceneContainer &cContainer, Array<SceneContainer*> &lstCells) const
+{
+	for (uint32 i=0; i<cContainer.GetNumOfElements(); i++) {
+		SceneNode *pSceneNode = cContainer.GetByIndex(i);
+		if (pSceneNode && pSceneNode->IsContainer()) {
+			// Cells within cells are not supported, like within the scene culler
+			if (pSceneNode->IsInstanceOf("PLScene::SCCell"))
+				lstCells.Add(static_cast<SceneContainer*>(pSceneNode));
+			else
+				CollectCells(static_cast<SceneContainer&>(*pSceneNode), lstCells);
+		}
+	}
+}
@@ -0,0 +1,173 @@
+/*********************************************************\
+ *  File: PVSBaker.h                                     *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEONPVSBAKER_PVSBAKER_H__
+#define __DUNGEONPVSBAKER_PVSBAKER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Container/Array.h>
+#include "DungeonTool.h"
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLMath {
+	class Vector3;
+}
+namespace PLScene {
+	class SceneContainer;
+}
+class CellPVS;
+class SceneCuller;
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Offline potentially visible set baker application class
+*
+*  @remarks
+*    Computes which cells of a scene can be seen from which cells and stores this next to the scene (see "CellPVS").
+*    The scene is loaded using the null renderer, then a regular grid of positions spanning the bounding box of each
+*    cell (faces, edges and corners included) and the vertices, edge centers and center of each portal polygon are
+*    sampled, the portal positions for both cells the portal connects. From each position the portals are followed
+*    into any direction exactly like the scene culler does at runtime, each cell reached is potentially visible from
+*    the cell. A cell always sees itself and the cells its portals lead to, so a too coarse grid can't make a neighbour
+*    cell disappear. The filenames are relative to the base directory (see "DungeonTool").
+*/
+class PVSBaker : public DungeonTool {
+
+
+	//[-------------------------------------------------------]
+	//[ RTTI interface                                        ]
+	//[-------------------------------------------------------]
+	pl_class_def()
+	pl_class_def_end
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*/
+		PVSBaker();
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		virtual ~PVSBaker();
+
+
+	//[-------------------------------------------------------]
+	//[ Protected virtual PLCore::CoreApplication functions   ]
+	//[-------------------------------------------------------]
+	protected:
+		virtual void Main() override;
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Bakes the potentially visible set of a scene
+		*
+		*  @param[in] sSceneFilename
+		*    Filename of the XML scene, relative to the base directory
+		*  @param[in] nNumOfSamples
+		*    Number of sampled positions per axis within each cell
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool Bake(const PLCore::String &sSceneFilename, PLCore::uint32 nNumOfSamples);
+
+		/**
+		*  @brief
+		*    Bakes the potentially visible set of a loaded scene
+		*
+		*  @param[in] cSceneContainer
+		*    Scene container the scene was loaded into
+		*  @param[in] sSceneFilename
+		*    Filename of the XML scene, relative to the base directory
+		*  @param[in] sSceneHash
+		*    Content hash of the XML scene
+		*  @param[in] nNumOfSamples
+		*    Number of sampled positions per axis within each cell, the bounding box faces included
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool Bake(PLScene::SceneContainer &cSceneContainer, const PLCore::String &sSceneFilename, const PLCore::String &sSceneHash, PLCore::uint32 nNumOfSamples);
+
+		/**
+		*  @brief
+		*    Collects the cells
+		*
+		*  @param[in]  cContainer
+		*    Container to start with
+		*  @param[out] lstCells
+		*    Receives the cells
+		*/
+		void CollectCells(PLScene::SceneContainer &cContainer, PLCore::Array<PLScene::SceneContainer*> &lstCells) const;
+
+		/**
+		*  @brief
+		*    Marks the cells visible from a position as potentially visible from a cell
+		*
+		*  @param[in]  cSceneCuller
+		*    Scene culler following the portals
+		*  @param[in]  lstCells
+		*    Cells of the scene
+		*  @param[in]  nCell
+		*    Index of the cell the position is in
+		*  @param[in]  vPosition
+		*    Position within scene container space
+		*  @param[out] cCellPVS
+		*    Receives the visible cells
+		*/
+		void SamplePosition(SceneCuller &cSceneCuller, const PLCore::Array<PLScene::SceneContainer*> &lstCells, PLCore::uint32 nCell, const PLMath::Vector3 &vPosition, CellPVS &cCellPVS);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::Array<PLScene::SceneContainer*> m_lstVisibleCells;	/**< Cells visible from the currently sampled position */
+
+
+};
+
+
+#endif // __DUNGEONPVSBAKER_PVSBAKER_H__
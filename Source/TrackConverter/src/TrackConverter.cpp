@@ -0,0 +1,196 @@
+/*********************************************************\
+ *  File: TrackConverter.cpp                             *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/Xml/Xml.h>
+#include <PLCore/File/File.h>
+#include <PLCore/File/Directory.h>
+#include <PLCore/File/FileSearch.h>
+#include <PLCore/Tools/Chunk.h>
+#include <PLMath/Vector3.h>
+#include <PLMath/Quaternion.h>
+#include "Tools/CamcorderTrack.h"
+#include "TrackConverter.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+
+
+//[-------------------------------------------------------]
+//[ RTTI interface                                        ]
+//[-------------------------------------------------------]
+pl_class_metadata(TrackConverter, "", DungeonTool, "Offline camcorder track converter application class")
+	// Constructors
+	pl_constructor_0_metadata(DefaultConstructor,	"Default constructor",	"")
+pl_class_metadata_end(TrackConverter)
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+TrackConverter::TrackConverter() : DungeonTool()
+{
+	// Set application title
+	SetTitle("PixelLight dungeon camcorder track converter");
+
+	// Add the command line options
+	m_cCommandLine.AddOption("Camcorder",	  "-c", "--camcorder",		"Filename of the camcorder recording to convert, all within \"Data/Camcorder\" if empty", "");
+	m_cCommandLine.AddOption("PositionError", "",	"--position-error", "Maximum position error of the key reduction", "0.005");
+	m_cCommandLine.AddOption("RotationError", "",	"--rotation-error", "Maximum rotation error of the key reduction in degree", "0.1");
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+TrackConverter::~TrackConverter()
+{
+}
+
+
+//[-------------------------------------------------------]
+//[ Protected virtual PLCore::CoreApplication functions   ]
+//[-------------------------------------------------------]
+void TrackConverter::Main()
+{
+	// Collect the camcorder recordings to convert
+	Array<String> lstFilenames;
+	const String sCamcorder = m_cCommandLine.GetValue("Camcorder");
+	if (sCamcorder.GetLength()) {
+		lstFilenames.Add(sCamcorder);
+	} else {
+		Directory cDirectory(m_sBaseDirectory + "Data/Camcorder");
+		if (cDirectory.Exists()) {
+			FileSearch cSearch(cDirectory);
+			while (cSearch.HasNextFile()) {
+				const String sFilename = cSearch.GetNextFile();
+				if (Url(sFilename).GetExtension() == "cam")
+					lstFilenames.Add("Data/Camcorder/" + sFilename);
+			}
+		}
+	}
+
+	// Convert them
+	const float fMaxPositionError = m_cCommandLine.GetValue("PositionError").GetFloat();
+	const float fMaxRotationError = m_cCommandLine.GetValue("RotationError").GetFloat();
+	bool bResult = true;
+	for (uint32 i=0; i<lstFilenames.GetNumOfElements(); i++) {
+		if (!Convert(lstFilenames[i], fMaxPositionError, fMaxRotationError))
+			bResult = false;
+	}
+	if (!bResult)
+		Exit(1);
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Converts a camcorder recording into a camcorder track
+*/
+bool TrackConverter::Convert(const String &sFilename, float fMaxPositionError, float fMaxRotationError)
+{
+	// Load the camcorder recording
+	XmlDocument cDocument;
+	if (!cDocument.Load(m_sBaseDirectory + sFilename)) {
+		PL_LOG(Error, "Failed to load the camcorder recording '" + m_sBaseDirectory + sFilename + '\'')
+		return false;
+	}
+	const XmlElement *pCamcorderElement = cDocument.GetFirstChildElement("Camcorder");
+	const XmlElement *pPositionElement  = pCamcorderElement ? pCamcorderElement->GetFirstChildElement("PositionKeys") : nullptr;
+	const XmlElement *pRotationElement  = pCamcorderElement ? pCamcorderElement->GetFirstChildElement("RotationKeys") : nullptr;
+	if (!pPositionElement || !pRotationElement || !pPositionElement->GetFirstChild() || !pRotationElement->GetFirstChild()) {
+		PL_LOG(Error, "The camcorder recording '" + sFilename + "' has no position and rotation keys")
+		return false;
+	}
+
+	// Both key chunks have to be recorded with the same frame rate, a track has one time line
+	const float fFramesPerSecond = pPositionElement->GetAttribute("FramesPerSecond").GetFloat();
+	if (fFramesPerSecond <= 0.0f || fFramesPerSecond != pRotationElement->GetAttribute("FramesPerSecond").GetFloat()) {
+		PL_LOG(Error, "The position and rotation keys of the camcorder recording '" + sFilename + "' have different frame rates")
+		return false;
+	}
+
+	// Load the key chunks
+	const String sPositionKeys = pPositionElement->GetFirstChild()->GetValue();
+	const String sRotationKeys = pRotationElement->GetFirstChild()->GetValue();
+	Chunk cPositionChunk;
+	if (!cPositionChunk.LoadByFilename(sPositionKeys) || cPositionChunk.GetElementType() != Chunk::Float || cPositionChunk.GetNumOfComponentsPerElement() != 3) {
+		PL_LOG(Error, "Failed to load the position keys '" + sPositionKeys + '\'')
+		return false;
+	}
+	Chunk cRotationChunk;
+	if (!cRotationChunk.LoadByFilename(sRotationKeys) || cRotationChunk.GetElementType() != Chunk::Float || cRotationChunk.GetNumOfComponentsPerElement() != 4) {
+		PL_LOG(Error, "Failed to load the rotation keys '" + sRotationKeys + '\'')
+		return false;
+	}
+
+	// Gather the keys, the camcorder may have stopped one chunk a frame before the other one
+	const uint32 nNumOfFrames = (cPositionChunk.GetNumOfElements() < cRotationChunk.GetNumOfElements()) ? cPositionChunk.GetNumOfElements() : cRotationChunk.GetNumOfElements();
+	if (!nNumOfFrames) {
+		PL_LOG(Error, "The camcorder recording '" + sFilename + "' has no frames")
+		return false;
+	}
+	Array<Vector3> lstPositions;
+	Array<Quaternion> lstRotations;
+	lstPositions.Resize(nNumOfFrames, false, false);
+	lstRotations.Resize(nNumOfFrames, false, false);
+	const float *pfPosition = reinterpret_cast<const float*>(cPositionChunk.GetData());
+	const float *pfRotation = reinterpret_cast<const float*>(cRotationChunk.GetData());
+	for (uint32 nFrame=0; nFrame<nNumOfFrames; nFrame++, pfPosition+=3, pfRotation+=4) {
+		lstPositions.Add(Vector3(pfPosition[0], pfPosition[1], pfPosition[2]));
+		lstRotations.Add(Quaternion(pfRotation[0], pfRotation[1], pfRotation[2], pfRotation[3]));	// w, x, y, z
+	}
+
+	// Write the track next to the camcorder recording
+	const Url cUrl(sFilename);
+	const String sTrackFilename = cUrl.CutFilename() + cUrl.GetTitle() + ".track";
+	if (!CamcorderTrack::Save(m_sBaseDirectory + sTrackFilename, fFramesPerSecond, lstPositions, lstRotations, fMaxPositionError, fMaxRotationError)) {
+		PL_LOG(Error, "Failed to write the camcorder track '" + m_sBaseDirectory + sTrackFilename + '\'')
+		return false;
+	}
+
+	// Report the gain
+	CamcorderTrack cTrack;
+	File cTrackFile(m_sBaseDirectory + sTrackFilename);
+	if (cTrack.Open(sTrackFilename)) {
+		const uint32 nRawSize = cPositionChunk.GetTotalNumOfBytes() + cRotationChunk.GetTotalNumOfBytes();
+		PL_LOG(Info, String::Format("'%s': %u frames, %u position keys, %u rotation keys, %u bytes instead of %u bytes", sTrackFilename.GetASCII(),
+									nNumOfFrames, cTrack.GetNumOfPositionKeys(), cTrack.GetNumOfRotationKeys(), static_cast<uint32>(cTrackFile.GetSize()), nRawSize))
+	}
+
+	// Done
+	return true;
+}
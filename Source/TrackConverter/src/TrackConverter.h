@@ -0,0 +1,105 @@
+/*********************************************************\
+ *  File: TrackConverter.h                               *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEONTRACKCONVERTER_TRACKCONVERTER_H__
+#define __DUNGEONTRACKCONVERTER_TRACKCONVERTER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "DungeonTool.h"
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Offline camcorder track converter application class
+*
+*  @remarks
+*    Converts camcorder recordings (a ".cam" file referencing the raw position and rotation key chunks) into compact
+*    camcorder tracks (see "CamcorderTrack"), the track is written next to the ".cam" file (e.g. "Data/Camcorder/Movie.cam"
+*    becomes "Data/Camcorder/Movie.track"). By default, all recordings within "Data/Camcorder" are converted. The
+*    filenames are relative to the base directory (see "DungeonTool").
+*/
+class TrackConverter : public DungeonTool {
+
+
+	//[-------------------------------------------------------]
+	//[ RTTI interface                                        ]
+	//[-------------------------------------------------------]
+	pl_class_def()
+	pl_class_def_end
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*/
+		TrackConverter();
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		virtual ~TrackConverter();
+
+
+	//[-------------------------------------------------------]
+	//[ Protected virtual PLCore::CoreApplication functions   ]
+	//[-------------------------------------------------------]
+	protected:
+		virtual void Main() override;
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Converts a camcorder recording into a camcorder track
+		*
+		*  @param[in] sFilename
+		*    Filename of the camcorder recording (".cam"), relative to the base directory
+		*  @param[in] fMaxPositionError
+		*    Maximum position error of the key reduction
+		*  @param[in] fMaxRotationError
+		*    Maximum rotation error of the key reduction in degree
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool Convert(const PLCore::String &sFilename, float fMaxPositionError, float fMaxRotationError);
+
+
+};
+
+
+#endif // __DUNGEONTRACKCONVERTER_TRACKCONVERTER_H__
@@ -24,11 +24,18 @@
 //[ Includes                                              ]
 //[-------------------------------------------------------]
 #include <PLCore/Base/Class.h>
+#include <PLCore/Log/Log.h>
+#include <PLCore/File/Url.h>
 #include <PLCore/Script/Script.h>
+#include <PLCore/Script/FuncScriptPtr.h>
 #include <PLCore/System/System.h>
 #include <PLCore/Tools/Timing.h>
 #include <PLCore/Tools/Localization.h>
+#include <PLMath/Vector2.h>
+#include <PLMath/Rectangle.h>
+#include <PLGraphics/Color/Color4.h>
 #include <PLRenderer/RendererContext.h>
+#include <PLRenderer/Renderer/Renderer.h>
 #include <PLRenderer/Material/MaterialManager.h>
 #include <PLRenderer/Material/ParameterManager.h>
 #include <PLScene/Compositing/SceneRenderer.h>
@@ -38,6 +45,25 @@
 #include <PLScene/Scene/SceneNodeModifier.h>
 #include <PLEngine/Compositing/Console/SNConsoleBase.h>
 #include <PLEngine/Controller/SNPhysicsMouseInteraction.h>
+#include "Scene/SceneCache.h"
+#include "Scene/CellStreamer.h"
+#include "Scene/CamcorderPrefetcher.h"
+#include "Scene/MeshBatchCache.h"
+#include "Scene/MeshInstancer.h"
+#include "Scene/SceneCuller.h"
+#include "Scene/CamcorderRecorder.h"
+#include "Scene/SceneLoadReport.h"
+#include "Scene/SceneLoadTracer.h"
+#include "Scene/SceneLoaderCache.h"
+#include "Scene/AttributeHandle.h"
+#include "Tools/Profiler.h"
+#include "Tools/WorkerPool.h"
+#include "Tools/TraceCapture.h"
+#include "Tools/HitchRecorder.h"
+#include "Tools/Telemetry.h"
+#include "Tools/ScriptProfiler.h"
+#include "Scene/PhysicsCacheManifest.h"
+#include "Benchmark.h"
 #include "Application.h"
 
 
@@ -61,8 +87,22 @@ using namespace PLPhysics;
 		// Methods
 		pl_method_0_metadata(IsExpertMode,						pl_ret_type(bool),	"Returns whether or not the application runs within the expert mode. Returns 'true' if the application runs within the expert mode, else 'false' (no additional help texts).",															"")
 		pl_method_0_metadata(IsRepeatMode,						pl_ret_type(bool),	"Returns whether or not the application runs within the repeat mode. Returns 'true' if the application runs within the repeat mode (\"movie -> making of -> movie\" instead of \"movie -> making of -> interactive\"), else 'false'.",	"")
+		pl_method_0_metadata(IsBenchmarkMode,					pl_ret_type(bool),	"Returns whether or not the application runs within the benchmark mode. Returns 'true' if the application runs within the benchmark mode (headless deterministic camcorder flythrough), else 'false'.",													"")
+		pl_method_0_metadata(GetBenchmarkTrack,					pl_ret_type(PLCore::String),	"Returns the name of the camcorder track to play within the benchmark mode (e.g. \"Movie\" or \"ShortMovie\"), empty string if not within the benchmark mode.",															"")
 		pl_method_0_metadata(IsInternalRelease,					pl_ret_type(bool),	"Returns whether or not this is an internal release. Returns 'true' if this is an internal release, else 'false'.",																														"")
+		pl_method_1_metadata(StartRecord,						pl_ret_type(bool),	const PLCore::String&,	"Starts recording the current camera, name of the recording (e.g. \"Test\") as first parameter. Returns 'true' if all went fine, else 'false'.",													"")
+		pl_method_0_metadata(StopRecord,						pl_ret_type(void),	"Stops recording the camera",																																																"")
+		pl_method_0_metadata(IsRecording,						pl_ret_type(bool),	"Returns whether or not the camera is recorded. Returns 'true' if the camera is recorded, else 'false'.",																																"")
 		pl_method_0_metadata(UpdateMousePickingPullAnimation,	pl_ret_type(void),	"Updates the mouse picking pull animation",																																																"")
+		pl_method_0_metadata(IsScriptProfilerEnabled,			pl_ret_type(bool),	"Returns whether or not the script profiler is enabled (console command \"scriptprofiler\"). Returns 'true' if the script profiler is enabled, else 'false'.",	"")
+		pl_method_1_metadata(BeginScriptFunction,				pl_ret_type(void),	const PLCore::String&,	"Begins a script function call for the script profiler, function name (e.g. \"Interaction.OnControl\") as first parameter",	"")
+		pl_method_1_metadata(EndScriptFunction,					pl_ret_type(void),	float,	"Ends the current script function call for the script profiler, Lua heap growth (in KiB) during the call as first parameter",	"")
+		pl_method_1_metadata(GetAttributeHandle,				pl_ret_type(int),	const PLCore::String&,	"Returns a handle for typed per frame writes of an attribute, attribute name (e.g. \"EffectWeight\") as first parameter. Returns the attribute handle, the same handle is returned for the same name.",	"")
+		pl_method_3_metadata(SetAttributeFloat,					pl_ret_type(void),	PLCore::Object*,	int,	float,	"Sets a float attribute through an attribute handle, object as first parameter, attribute handle as second parameter, value as third parameter",	"")
+		pl_method_3_metadata(SetAttributeInt,					pl_ret_type(void),	PLCore::Object*,	int,	int,	"Sets an integer attribute through an attribute handle, object as first parameter, attribute handle as second parameter, value as third parameter",	"")
+		pl_method_4_metadata(SetAttributeVector2,				pl_ret_type(void),	PLCore::Object*,	int,	float,	float,	"Sets a two component float vector attribute through an attribute handle, object as first parameter, attribute handle as second parameter, x and y as third and fourth parameter",	"")
+		pl_method_5_metadata(SetAttributeVector3,				pl_ret_type(void),	PLCore::Object*,	int,	float,	float,	float,	"Sets a three component float vector attribute through an attribute handle, object as first parameter, attribute handle as second parameter, x, y and z as third to fifth parameter",	"")
+		pl_method_6_metadata(SetAttributeColor,					pl_ret_type(void),	PLCore::Object*,	int,	float,	float,	float,	float,	"Sets a color attribute through an attribute handle, object as first parameter, attribute handle as second parameter, red, green, blue and alpha as third to sixth parameter",	"")
 		// Signals
 		pl_signal_2_metadata(SignalSetMode,	PLCore::uint32,	bool,	"Signal indicating that a new interaction mode has been chosen, mode index as first parameter(0 = Walk mode, 1 = Free mode, 2 = Ghost mode, 3 = Movie mode, 4 = Making of mode), 'true' as second parameter to show mode changed text",	"")
 	pl_class_metadata_end(Application)
@@ -76,16 +116,38 @@ using namespace PLPhysics;
 *    Constructor
 */
 Application::Application(Frontend &cFrontend) : ScriptApplication(cFrontend, "Data/Scripts/Lua/Main.lua", "Dungeon", PLT("PixelLight dungeon demo"), System::GetInstance()->GetDataDirName("PixelLight")),
-	m_fMousePickingPullAnimation(0.0f)
+	m_fMousePickingPullAnimation(0.0f),
+	m_pBenchmark(nullptr),
+	m_pWorkerPool(new WorkerPool()),
+	m_pCellStreamer(nullptr),
+	m_pCamcorderPrefetcher(nullptr),
+	m_pMeshBatchCache(nullptr),
+	m_pMeshInstancer(nullptr),
+	m_pSceneCuller(nullptr),
+	m_pCamcorderRecorder(nullptr),
+	m_pTraceCapture(nullptr),
+	m_pHitchRecorder(nullptr),
+	m_pTelemetry(nullptr),
+	m_fScriptUpdateTime(0.0f),
+	m_fSceneUpdateTime(0.0f),
+	m_bProfilerShown(false),
+	m_pWarpPointAttribute(new AttributeHandle("WarpPoint")),
+	m_pWarpScaleAttribute(new AttributeHandle("WarpScale")),
+	m_pWarpDimensionAttribute(new AttributeHandle("WarpDimension"))
 {
 	// The demo is published as a simple archive, so, put the log and configuration files in the same directory the executable is
 	// in - as a result, the user only has to remove this directory and the demo is completly gone from the system :D
 	SetMultiUser(false);
 
+	// The scene cache loader is created by the loadable system, so tell it about the shared worker pool
+	SceneLoaderCache::SetWorkerPool(m_pWorkerPool);
+
 	// This application accepts all the standard parameters that are defined in the application
 	// base class (such as --help etc.). The last parameter however is the filename to load, so add that.
 	m_cCommandLine.AddFlag("Expert", "-e", "--expert", "Expert mode, no additional help texts", false);
 	m_cCommandLine.AddFlag("Repeat", "-r", "--repeat", "If movie and making of is finished, start the movie again instead of switching to �nteractive mode", false);
+	m_cCommandLine.AddOption("Benchmark", "-b", "--benchmark", "Benchmark mode, plays the given camcorder track (e.g. \"Movie\" or \"ShortMovie\") with a fixed timestep and exits when it's finished", "");
+	m_cCommandLine.AddOption("BenchmarkOutput", "", "--benchmark-output", "Name of the CSV file the per-frame benchmark times are written into", "");
 }
 
 /**
@@ -94,6 +156,44 @@ Application::Application(Frontend &cFrontend) : ScriptApplication(cFrontend, "Da
 */
 Application::~Application()
 {
+	// Destroy the benchmark, if there's one
+	if (m_pBenchmark)
+		delete m_pBenchmark;
+
+	// Destroy the culler, the instancer, the mesh batch cache, the camcorder prefetcher and the cell streamer, if there are ones
+	if (m_pSceneCuller)
+		delete m_pSceneCuller;
+	if (m_pMeshInstancer)
+		delete m_pMeshInstancer;
+	if (m_pMeshBatchCache)
+		delete m_pMeshBatchCache;
+	if (m_pCamcorderPrefetcher)
+		delete m_pCamcorderPrefetcher;
+	if (m_pCellStreamer)
+		delete m_pCellStreamer;
+
+	// Destroy the worker pool, after its users
+	SceneLoaderCache::SetWorkerPool(nullptr);
+	delete m_pWorkerPool;
+
+	// Destroy the camcorder recorder, if there's one
+	if (m_pCamcorderRecorder)
+		delete m_pCamcorderRecorder;
+
+	// Destroy the trace capture, the hitch recorder and the telemetry sink, if there are ones
+	if (m_pTraceCapture)
+		delete m_pTraceCapture;
+	if (m_pHitchRecorder)
+		delete m_pHitchRecorder;
+	if (m_pTelemetry)
+		delete m_pTelemetry;
+
+	// Destroy the attribute handles
+	delete m_pWarpPointAttribute;
+	delete m_pWarpScaleAttribute;
+	delete m_pWarpDimensionAttribute;
+	for (uint32 i=0; i<m_lstAttributeHandles.GetNumOfElements(); i++)
+		delete m_lstAttributeHandles[i];
 }
 
 /**
@@ -102,8 +202,8 @@ Application::~Application()
 */
 bool Application::IsExpertMode() const
 {
-	// Check 'Expert' commando line flag
-	return m_cCommandLine.IsValueSet("Expert");
+	// Check 'Expert' commando line flag - the benchmark mode never shows additional help texts, too
+	return (m_cCommandLine.IsValueSet("Expert") || IsBenchmarkMode());
 }
 
 /**
@@ -116,6 +216,26 @@ bool Application::IsRepeatMode() const
 	return m_cCommandLine.IsValueSet("Repeat");
 }
 
+/**
+*  @brief
+*    Returns whether or not the application runs within the benchmark mode
+*/
+bool Application::IsBenchmarkMode() const
+{
+	// Check 'Benchmark' commando line option
+	return (m_cCommandLine.GetValue("Benchmark").GetLength() != 0);
+}
+
+/**
+*  @brief
+*    Returns the name of the camcorder track to play within the benchmark mode
+*/
+String Application::GetBenchmarkTrack() const
+{
+	// Return the 'Benchmark' commando line option
+	return m_cCommandLine.GetValue("Benchmark");
+}
+
 /**
 *  @brief
 *    Returns whether or not this is an internal release
@@ -129,6 +249,142 @@ bool Application::IsInternalRelease() const
 	#endif
 }
 
+/**
+*  @brief
+*    Starts recording the current camera
+*/
+bool Application::StartRecord(const String &sName)
+{
+	SceneNode *pCameraSceneNode = reinterpret_cast<SceneNode*>(GetCamera());
+	if (!pCameraSceneNode)
+		return false;
+
+	// Create the camcorder recorder on the first recording
+	if (!m_pCamcorderRecorder)
+		m_pCamcorderRecorder = new CamcorderRecorder(GetBaseDirectory());
+	return m_pCamcorderRecorder->StartRecord(sName, *pCameraSceneNode);
+}
+
+/**
+*  @brief
+*    Stops recording the camera
+*/
+void Application::StopRecord()
+{
+	if (m_pCamcorderRecorder)
+		m_pCamcorderRecorder->StopRecord();
+}
+
+/**
+*  @brief
+*    Returns whether or not the camera is recorded
+*/
+bool Application::IsRecording() const
+{
+	return (m_pCamcorderRecorder && m_pCamcorderRecorder->IsRecording());
+}
+
+/**
+*  @brief
+*    Returns whether or not the profiler window should be shown
+*/
+bool Application::IsProfilerShown() const
+{
+	return m_bProfilerShown;
+}
+
+/**
+*  @brief
+*    Returns whether or not the script profiler is enabled
+*/
+bool Application::IsScriptProfilerEnabled() const
+{
+	return ScriptProfiler::IsEnabled();
+}
+
+/**
+*  @brief
+*    Begins a script function call for the script profiler
+*/
+void Application::BeginScriptFunction(const String &sName)
+{
+	ScriptProfiler::Begin(sName);
+}
+
+/**
+*  @brief
+*    Ends the current script function call for the script profiler
+*/
+void Application::EndScriptFunction(float fHeapGrowth)
+{
+	ScriptProfiler::End(fHeapGrowth);
+}
+
+/**
+*  @brief
+*    Returns a handle for typed per frame writes of an attribute
+*/
+int Application::GetAttributeHandle(const String &sName)
+{
+	// Scripts get their handles once, so a linear search is fine
+	for (uint32 i=0; i<m_lstAttributeHandles.GetNumOfElements(); i++) {
+		if (m_lstAttributeHandles[i]->GetName() == sName)
+			return static_cast<int>(i);
+	}
+	m_lstAttributeHandles.Add(new AttributeHandle(sName));
+	return static_cast<int>(m_lstAttributeHandles.GetNumOfElements() - 1);
+}
+
+/**
+*  @brief
+*    Sets a float attribute through an attribute handle
+*/
+void Application::SetAttributeFloat(Object *pObject, int nHandle, float fValue)
+{
+	if (pObject && nHandle >= 0 && static_cast<uint32>(nHandle) < m_lstAttributeHandles.GetNumOfElements())
+		m_lstAttributeHandles[nHandle]->SetFloat(*pObject, fValue);
+}
+
+/**
+*  @brief
+*    Sets an integer attribute through an attribute handle
+*/
+void Application::SetAttributeInt(Object *pObject, int nHandle, int nValue)
+{
+	if (pObject && nHandle >= 0 && static_cast<uint32>(nHandle) < m_lstAttributeHandles.GetNumOfElements())
+		m_lstAttributeHandles[nHandle]->SetInt(*pObject, nValue);
+}
+
+/**
+*  @brief
+*    Sets a two component float vector attribute through an attribute handle
+*/
+void Application::SetAttributeVector2(Object *pObject, int nHandle, float fX, float fY)
+{
+	if (pObject && nHandle >= 0 && static_cast<uint32>(nHandle) < m_lstAttributeHandles.GetNumOfElements())
+		m_lstAttributeHandles[nHandle]->SetVector2(*pObject, Vector2(fX, fY));
+}
+
+/**
+*  @brief
+*    Sets a three component float vector attribute through an attribute handle
+*/
+void Application::SetAttributeVector3(Object *pObject, int nHandle, float fX, float fY, float fZ)
+{
+	if (pObject && nHandle >= 0 && static_cast<uint32>(nHandle) < m_lstAttributeHandles.GetNumOfElements())
+		m_lstAttributeHandles[nHandle]->SetVector3(*pObject, Vector3(fX, fY, fZ));
+}
+
+/**
+*  @brief
+*    Sets a color attribute through an attribute handle
+*/
+void Application::SetAttributeColor(Object *pObject, int nHandle, float fR, float fG, float fB, float fA)
+{
+	if (pObject && nHandle >= 0 && static_cast<uint32>(nHandle) < m_lstAttributeHandles.GetNumOfElements())
+		m_lstAttributeHandles[nHandle]->SetColor(*pObject, PLGraphics::Color4(fR, fG, fB, fA));
+}
+
 
 //[-------------------------------------------------------]
 //[ Private functions                                     ]
@@ -139,6 +395,8 @@ bool Application::IsInternalRelease() const
 */
 void Application::UpdateMousePickingPullAnimation()
 {
+	ProfilerScope cProfilerScope("Mouse picking pull animation");
+
 	// Get the current time difference
 	const float fTimeDiff = Timing::GetInstance()->GetTimeDifference();
 
@@ -164,9 +422,10 @@ void Application::UpdateMousePickingPullAnimation()
 					if (!pSceneNodeModifier)
 						pSceneNodeModifier = pCameraSceneNode->AddModifier("PLPostProcessEffects::SNMPostProcessPull");
 					if (pSceneNodeModifier) {
-						pSceneNodeModifier->SetAttribute("WarpPoint",	  String::Format("%d %d", vMousePos.x, GetFrontend().GetHeight()-vMousePos.y));
-						pSceneNodeModifier->SetAttribute("WarpScale",	  -5.0f  + Math::Sin(m_fMousePickingPullAnimation)*Math::Cos(m_fMousePickingPullAnimation/4)*10.0f);
-						pSceneNodeModifier->SetAttribute("WarpDimension", 150.0f + Math::Cos(m_fMousePickingPullAnimation)*Math::Sin(m_fMousePickingPullAnimation/6)*60.0f);
+						// Typed writes, there's no need to format and parse strings every frame
+						m_pWarpPointAttribute->SetVector2i(*pSceneNodeModifier, Vector2i(vMousePos.x, GetFrontend().GetHeight()-vMousePos.y));
+						m_pWarpScaleAttribute->SetFloat(*pSceneNodeModifier, -5.0f  + Math::Sin(m_fMousePickingPullAnimation)*Math::Cos(m_fMousePickingPullAnimation/4)*10.0f);
+						m_pWarpDimensionAttribute->SetFloat(*pSceneNodeModifier, 150.0f + Math::Cos(m_fMousePickingPullAnimation)*Math::Sin(m_fMousePickingPullAnimation/6)*60.0f);
 					}
 				} else {
 					// Remove "PLPostProcessEffects::SNMPostProcessPull" modifier
@@ -178,16 +437,301 @@ void Application::UpdateMousePickingPullAnimation()
 }
 
 
+/**
+*  @brief
+*    Console command "profiler", toggles the profiler window
+*/
+void Application::ConsoleCommandProfiler(ConsoleCommand &cCommand)
+{
+	// The ingame GUI shows and hides the profiler window during its update
+	m_bProfilerShown = !m_bProfilerShown;
+}
+
+/**
+*  @brief
+*    Console command "trace <frames> <filename>", captures the given number of frames into a Chrome trace
+*/
+void Application::ConsoleCommandTrace(ConsoleCommand &cCommand)
+{
+	// Only one capture at a time
+	if (m_pTraceCapture) {
+		PL_LOG(Warning, "The trace '" + m_pTraceCapture->GetFilename() + "' is still captured")
+		return;
+	}
+
+	// Get the parameters, by default the trace is written into the directory the executable is in
+	const int nNumOfFrames = cCommand.GetVar(0).GetInt();
+	String sFilename = cCommand.GetVar(1).GetString();
+	if (nNumOfFrames <= 0 || !sFilename.GetLength()) {
+		PL_LOG(Error, "Usage: trace <frames> <filename>, e.g. \"trace 300 out.json\"")
+		return;
+	}
+	if (!Url(sFilename).IsAbsolute())
+		sFilename = GetApplicationContext().GetExecutableDirectory() + '/' + sFilename;
+
+	// Start the capture, it's updated once per frame
+	m_pTraceCapture = new TraceCapture(sFilename, static_cast<uint32>(nNumOfFrames));
+}
+
+/**
+*  @brief
+*    Console command "loadreport", writes the load report of the last loaded scene into the log
+*/
+void Application::ConsoleCommandLoadReport(ConsoleCommand &cCommand)
+{
+	SceneLoadReport::Log();
+}
+
+/**
+*  @brief
+*    Console command "scriptprofiler", toggles the script profiler
+*/
+void Application::ConsoleCommandScriptProfiler(ConsoleCommand &cCommand)
+{
+	// The scripts notice the change within the next frames, the collected data is written when the script profiler is disabled
+	if (ScriptProfiler::IsEnabled()) {
+		ScriptProfiler::Log();
+		ScriptProfiler::Disable();
+	} else {
+		ScriptProfiler::Enable();
+		PL_LOG(Info, "Script profiler enabled, enter \"scriptprofiler\" again in order to write the result into the log")
+	}
+}
+
+/**
+*  @brief
+*    Console command "culling", toggles the culling of the static meshes
+*/
+void Application::ConsoleCommandCulling(ConsoleCommand &cCommand)
+{
+	if (m_pSceneCuller) {
+		// Write the counters of the last frame, destroying the culler makes all meshes visible again
+		const SceneCuller::SStatistics &sStatistics = m_pSceneCuller->GetStatistics();
+		PL_LOG(Info, String::Format("Culling disabled, last frame: %u visited cells, %u rejected cells, %u visited nodes, %u culled meshes (%u hidden by %u occluder triangles), %u drawn meshes (%u shadow casters outside of the view)",
+									sStatistics.nNumOfVisitedCells, sStatistics.nNumOfRejectedCells, sStatistics.nNumOfVisitedNodes, sStatistics.nNumOfCulledMeshes, sStatistics.nNumOfOccludedMeshes,
+									sStatistics.nNumOfOccluderTriangles, sStatistics.nNumOfDrawnMeshes, sStatistics.nNumOfShadowCasters))
+		delete m_pSceneCuller;
+		m_pSceneCuller = nullptr;
+	} else if (GetScene()) {
+		m_pSceneCuller = new SceneCuller(*GetScene(), m_sSceneFilename, GetConfig().GetVar("DungeonConfig", "OcclusionCulling").GetBool() ? m_pWorkerPool : nullptr);
+		PL_LOG(Info, "Culling enabled, enter \"culling\" again in order to write the counters of the last frame into the log")
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Protected virtual PLCore::AbstractFrontend functions  ]
+//[-------------------------------------------------------]
+void Application::OnDraw()
+{
+	// Get the current time
+	const uint64 nStartTime = System::GetInstance()->GetMicroseconds();
+
+	// Cull the static meshes
+	if (m_pSceneCuller) {
+		ProfilerScope cProfilerScope("Culling");
+		m_pSceneCuller->Update(GetCamera(), Rectangle(0.0f, 0.0f, static_cast<float>(GetFrontend().GetWidth()), static_cast<float>(GetFrontend().GetHeight())));
+	}
+
+	// Call base implementation
+	{
+		ProfilerScope cProfilerScope("Render");
+		ScriptApplication::OnDraw();
+	}
+
+	// The draw calls show how well the culling and the instancing work
+	if (Profiler::IsEnabled() && GetRendererContext())
+		Profiler::SetNumOfDrawCalls(GetRendererContext()->GetRenderer().GetStatistics().nDrawPrimitivCalls);
+
+	// Add the frame to the benchmark, the frame ends with the drawing
+	if (m_pBenchmark && m_pBenchmark->IsRunning()) {
+		Benchmark::Frame sFrame;
+		sFrame.fRenderTime		 = static_cast<float>(System::GetInstance()->GetMicroseconds() - nStartTime)/1000.0f;
+		sFrame.fScriptUpdateTime = m_fScriptUpdateTime;
+		sFrame.fSceneUpdateTime	 = m_fSceneUpdateTime;
+		sFrame.fFrameTime		 = 0.0f;
+		m_pBenchmark->AddFrame(sFrame);
+	}
+}
+
+void Application::OnUpdate()
+{
+	// A new frame starts with the update, the previous one ended with the drawing
+	Profiler::NextFrame();
+	if (m_pBenchmark)
+		m_pBenchmark->NextFrame();
+
+	// Check the finished frame for a hitch and add it to the telemetry
+	if (m_pHitchRecorder)
+		m_pHitchRecorder->Update();
+	if (m_pTelemetry)
+		m_pTelemetry->Update();
+
+	// Capture the events of the finished frame, the trace capture is destroyed as soon as its file is written
+	if (m_pTraceCapture) {
+		m_pTraceCapture->Update();
+		if (m_pTraceCapture->IsFinished()) {
+			delete m_pTraceCapture;
+			m_pTraceCapture = nullptr;
+		}
+	}
+
+	// Get the current time
+	const uint64 nStartTime = System::GetInstance()->GetMicroseconds();
+
+	// Update the scene - "ScriptApplication::OnUpdate()" is not called because we want to know how much
+	// time the scene update and the script update take, so we call the script update function on our own
+	{
+		ProfilerScope cProfilerScope("Scene update");
+		EngineApplication::OnUpdate();
+	}
+	const uint64 nSceneUpdateEndTime = System::GetInstance()->GetMicroseconds();
+	m_fSceneUpdateTime = static_cast<float>(nSceneUpdateEndTime - nStartTime)/1000.0f;
+
+	// Stream the cell contents and prepare the cells ahead of the camcorder playback, not within the scene update because scene nodes are created and destroyed
+	SceneNode *pCameraSceneNode = reinterpret_cast<SceneNode*>(GetCamera());
+	if (m_pCellStreamer) {
+		ProfilerScope cProfilerScope("Cell streaming");
+		m_pCellStreamer->Update(pCameraSceneNode);
+	}
+	if (m_pCamcorderPrefetcher) {
+		ProfilerScope cProfilerScope("Camcorder prefetching");
+		m_pCamcorderPrefetcher->Update(pCameraSceneNode);
+	}
+
+	// Add the keys of the camcorder recording, the files are written by the writer thread of the recorder
+	if (m_pCamcorderRecorder)
+		m_pCamcorderRecorder->Update();
+
+	// Call the update function of the script, the streaming and recording above are not part of the script update time
+	const uint64 nScriptUpdateStartTime = System::GetInstance()->GetMicroseconds();
+	Script *pScript = GetScript();
+	if (pScript) {
+		ProfilerScope cProfilerScope("Script update");
+		FuncScriptPtr<void>(pScript, "OnUpdate").Call(Params<void>());
+	}
+	m_fScriptUpdateTime = static_cast<float>(System::GetInstance()->GetMicroseconds() - nScriptUpdateStartTime)/1000.0f;
+}
+
+
 //[-------------------------------------------------------]
 //[ Protected virtual PLCore::CoreApplication functions   ]
 //[-------------------------------------------------------]
 void Application::OnInit()
 {
+	// Name the main thread within traces
+	Profiler::SetThreadName("Main");
+
+	// Create the benchmark right now, the script loads the scene during initialization
+	if (IsBenchmarkMode())
+		m_pBenchmark = new Benchmark(GetBenchmarkTrack(), GetConfig().GetVar("DungeonConfig", "BenchmarkTimeStep").GetFloat());
+
 	// Call base implementation
 	ScriptApplication::OnInit();
 
 	// Enable/disable edit mode
 	SetEditModeEnabled(GetConfig().GetVar("DungeonConfig", "EditModeEnabled").GetBool());
+
+	// Record a trace around each hitch, created after the initial scene loading which is no hitch, by default the traces are written into the directory the executable is in
+	const float fHitchThreshold = GetConfig().GetVar("DungeonConfig", "HitchThreshold").GetFloat();
+	if (fHitchThreshold > 0.0f)
+		m_pHitchRecorder = new HitchRecorder(GetApplicationContext().GetExecutableDirectory() + "/Hitches", fHitchThreshold, GetConfig().GetVar("DungeonConfig", "HitchTraceTime").GetFloat());
+
+	// Append the frame time percentiles and the memory to the telemetry log, it's next to the log file
+	const float fTelemetryInterval = GetConfig().GetVar("DungeonConfig", "TelemetryInterval").GetFloat();
+	if (fTelemetryInterval > 0.0f)
+		m_pTelemetry = new Telemetry(GetApplicationContext().GetExecutableDirectory() + "/Telemetry.log", fTelemetryInterval);
+}
+
+void Application::OnDeInit()
+{
+	// Write down the benchmark result
+	if (m_pBenchmark) {
+		m_pBenchmark->Stop();
+
+		// Get the name of the CSV file, by default it's written into the directory the executable is in
+		String sFilename = m_cCommandLine.GetValue("BenchmarkOutput");
+		if (!sFilename.GetLength())
+			sFilename = GetApplicationContext().GetExecutableDirectory() + "/Benchmark" + m_pBenchmark->GetTrack() + ".csv";
+		m_pBenchmark->Save(sFilename);
+
+		// Destroy the benchmark
+		delete m_pBenchmark;
+		m_pBenchmark = nullptr;
+	}
+
+	// Destroy the culler, the instancer, the mesh batch cache, the camcorder prefetcher and the cell streamer
+	if (m_pSceneCuller) {
+		delete m_pSceneCuller;
+		m_pSceneCuller = nullptr;
+	}
+	if (m_pMeshInstancer) {
+		delete m_pMeshInstancer;
+		m_pMeshInstancer = nullptr;
+	}
+	if (m_pMeshBatchCache) {
+		delete m_pMeshBatchCache;
+		m_pMeshBatchCache = nullptr;
+	}
+	if (m_pCamcorderPrefetcher) {
+		delete m_pCamcorderPrefetcher;
+		m_pCamcorderPrefetcher = nullptr;
+	}
+	if (m_pCellStreamer) {
+		delete m_pCellStreamer;
+		m_pCellStreamer = nullptr;
+	}
+
+	// Destroy the camcorder recorder, this completes a running recording
+	if (m_pCamcorderRecorder) {
+		delete m_pCamcorderRecorder;
+		m_pCamcorderRecorder = nullptr;
+	}
+
+	// Destroy the trace capture, this writes the frames captured so far
+	if (m_pTraceCapture) {
+		delete m_pTraceCapture;
+		m_pTraceCapture = nullptr;
+	}
+
+	// Destroy the hitch recorder, this waits for the hitch traces which are still written
+	if (m_pHitchRecorder) {
+		delete m_pHitchRecorder;
+		m_pHitchRecorder = nullptr;
+	}
+
+	// Destroy the telemetry sink, this appends the current interval
+	if (m_pTelemetry) {
+		delete m_pTelemetry;
+		m_pTelemetry = nullptr;
+	}
+
+	// Call base implementation
+	ScriptApplication::OnDeInit();
+}
+
+
+//[-------------------------------------------------------]
+//[ Protected virtual PLRenderer::RendererApplication functions ]
+//[-------------------------------------------------------]
+void Application::OnCreateRendererContext()
+{
+	// Within the benchmark mode, use the renderer API configured for benchmarking (usually the null renderer)
+	const String sRendererAPI = IsBenchmarkMode() ? GetConfig().GetVar("DungeonConfig", "BenchmarkRendererAPI") : "";
+	if (sRendererAPI.GetLength()) {
+		// Temporarily overwrite the renderer API, the original one is restored so that it's not written into the configuration file
+		const String sOriginalRendererAPI = GetConfig().GetVar("PLRenderer::Config", "RendererAPI");
+		GetConfig().SetVar("PLRenderer::Config", "RendererAPI", sRendererAPI);
+
+		// Call base implementation
+		ScriptApplication::OnCreateRendererContext();
+
+		// Restore the original renderer API
+		GetConfig().SetVar("PLRenderer::Config", "RendererAPI", sOriginalRendererAPI);
+	} else {
+		// Call base implementation
+		ScriptApplication::OnCreateRendererContext();
+	}
 }
 
 
@@ -231,10 +775,15 @@ void Application::OnCreateRootScene()
 				SNConsoleBase *pConsole = static_cast<SNConsoleBase*>(pSceneNode);
 
 				// Register default commands
-				pConsole->RegisterCommand(0,	"quit",			"",	"",	Functor<void, ConsoleCommand &>(&EngineApplication::ConsoleCommandQuit, this));
-				pConsole->RegisterCommand(0,	"exit",			"",	"",	Functor<void, ConsoleCommand &>(&EngineApplication::ConsoleCommandQuit, this));
-				pConsole->RegisterCommand(0,	"bye",			"",	"",	Functor<void, ConsoleCommand &>(&EngineApplication::ConsoleCommandQuit, this));
-				pConsole->RegisterCommand(0,	"logout",		"",	"",	Functor<void, ConsoleCommand &>(&EngineApplication::ConsoleCommandQuit, this));
+				pConsole->RegisterCommand(0,	"quit",				"",		"",	Functor<void, ConsoleCommand &>(&EngineApplication::ConsoleCommandQuit, this));
+				pConsole->RegisterCommand(0,	"exit",				"",		"",	Functor<void, ConsoleCommand &>(&EngineApplication::ConsoleCommandQuit, this));
+				pConsole->RegisterCommand(0,	"bye",				"",		"",	Functor<void, ConsoleCommand &>(&EngineApplication::ConsoleCommandQuit, this));
+				pConsole->RegisterCommand(0,	"logout",			"",		"",	Functor<void, ConsoleCommand &>(&EngineApplication::ConsoleCommandQuit, this));
+				pConsole->RegisterCommand(0,	"profiler",			"",		"",	Functor<void, ConsoleCommand &>(&Application::ConsoleCommandProfiler, this));
+				pConsole->RegisterCommand(0,	"trace",			"IS",	"",	Functor<void, ConsoleCommand &>(&Application::ConsoleCommandTrace, this));
+				pConsole->RegisterCommand(0,	"loadreport",		"",		"",	Functor<void, ConsoleCommand &>(&Application::ConsoleCommandLoadReport, this));
+				pConsole->RegisterCommand(0,	"scriptprofiler",	"",		"",	Functor<void, ConsoleCommand &>(&Application::ConsoleCommandScriptProfiler, this));
+				pConsole->RegisterCommand(0,	"culling",			"",		"",	Functor<void, ConsoleCommand &>(&Application::ConsoleCommandCulling, this));
 
 				// Set active state
 				pConsole->SetActive(m_bEditModeEnabled);
@@ -252,8 +801,134 @@ void Application::OnCreateRootScene()
 //[-------------------------------------------------------]
 bool Application::LoadScene(const String &sFilename)
 {
-	// Call base implementation
-	const bool bResult = ScriptApplication::LoadScene(sFilename);
+	ProfilerScope cProfilerScope("Load scene");
+	SceneLoadReport::Begin(sFilename);
+	m_sSceneFilename = sFilename;
+
+	// The culler, the instancer, the mesh batch cache, the camcorder prefetcher and the cell streamer of the previous scene must not survive it
+	if (m_pSceneCuller) {
+		delete m_pSceneCuller;
+		m_pSceneCuller = nullptr;
+	}
+	if (m_pMeshInstancer) {
+		delete m_pMeshInstancer;
+		m_pMeshInstancer = nullptr;
+	}
+	if (m_pMeshBatchCache) {
+		delete m_pMeshBatchCache;
+		m_pMeshBatchCache = nullptr;
+	}
+	if (m_pCamcorderPrefetcher) {
+		delete m_pCamcorderPrefetcher;
+		m_pCamcorderPrefetcher = nullptr;
+	}
+	if (m_pCellStreamer) {
+		delete m_pCellStreamer;
+		m_pCellStreamer = nullptr;
+	}
+
+	// Delete the outdated physics cache files, the physics backend just cooks the changed meshes again while loading the scene
+	PhysicsCacheManifest cPhysicsCacheManifest(GetBaseDirectory() + "_Cache/PLPhysicsNewton", GetBaseDirectory());
+	{
+		SceneLoadPhase cPhase("Physics cache validation");
+		cPhysicsCacheManifest.Validate();
+	}
+
+	// Stream the contents of the cells, just the cells around the start camera are loaded with the scene - the
+	// streamer provides a copy of the XML scene without the contents of the further cells
+	String sLoadFilename = sFilename;
+	if (GetConfig().GetVar("DungeonConfig", "CellStreamingEnabled").GetBool()) {
+		SceneLoadPhase cPhase("Cell streaming setup");
+		m_pCellStreamer = new CellStreamer(sFilename, GetBaseDirectory() + "_Cache/Scenes", GetConfig().GetVar("DungeonConfig", "CellStreamingHops").GetUInt32(),
+										   GetConfig().GetVar("DungeonConfig", "CellStreamingBudget").GetUInt32(), *m_pWorkerPool);
+		if (m_pCellStreamer->GetNumOfCells()) {
+			sLoadFilename = m_pCellStreamer->GetSceneFilename();
+		} else {
+			delete m_pCellStreamer;
+			m_pCellStreamer = nullptr;
+		}
+	}
+
+	// Load the compiled binary scene cache, if there's one (it's compiled on demand) - the XML scene is the fallback
+	bool bResult = false;
+	if (GetConfig().GetVar("DungeonConfig", "SceneCacheEnabled").GetBool()) {
+		SceneLoadPhase cPhase("Scene cache loading");
+		const String sCacheFilename = SceneCache(GetBaseDirectory() + "_Cache/Scenes").Prepare(sLoadFilename);
+		if (sCacheFilename.GetLength())
+			bResult = ScriptApplication::LoadScene(sCacheFilename);
+	}
+
+	// Call base implementation - the XML scene loader has no hook for the scene load report, so the tracer looks for the created scene nodes and modifiers
+	if (!bResult) {
+		SceneLoadPhase cPhase("Scene XML loading");
+		if (GetScene()) {
+			SceneLoadTracer cTracer(*GetScene());
+			bResult = ScriptApplication::LoadScene(sLoadFilename);
+		} else {
+			bResult = ScriptApplication::LoadScene(sLoadFilename);
+		}
+	}
+
+	// Add the newly cooked physics cache files to the manifest
+	{
+		SceneLoadPhase cPhase("Physics cache update");
+		cPhysicsCacheManifest.Update();
+	}
+
+	// Let the cell streamer take over the loaded cells
+	if (m_pCellStreamer) {
+		if (bResult && GetScene()) {
+			m_pCellStreamer->SetSceneContainer(*GetScene());
+		} else {
+			delete m_pCellStreamer;
+			m_pCellStreamer = nullptr;
+		}
+	}
+
+	// Prepare the cells ahead of the camcorder playback, works together with the cell streamer
+	const float fCamcorderPrefetchTime = GetConfig().GetVar("DungeonConfig", "CamcorderPrefetchTime").GetFloat();
+	if (bResult && GetScene() && fCamcorderPrefetchTime > 0.0f) {
+		SceneLoadPhase cPhase("Camcorder prefetching setup");
+		m_pCamcorderPrefetcher = new CamcorderPrefetcher(*GetScene(), m_pCellStreamer, fCamcorderPrefetchTime, *m_pWorkerPool);
+		if (!m_pCamcorderPrefetcher->GetNumOfCells()) {
+			delete m_pCamcorderPrefetcher;
+			m_pCamcorderPrefetcher = nullptr;
+		}
+	}
+
+	// Draw the unique static meshes of each cell by the baked batches of the mesh batch cache, if it's up-to-date
+	if (bResult && GetScene() && !m_pCellStreamer && GetConfig().GetVar("DungeonConfig", "MeshBatchCacheEnabled").GetBool()) {
+		SceneLoadPhase cPhase("Mesh batch cache loading");
+		m_pMeshBatchCache = new MeshBatchCache(*GetScene(), sFilename);
+		if (!m_pMeshBatchCache->GetNumOfBatches()) {
+			delete m_pMeshBatchCache;
+			m_pMeshBatchCache = nullptr;
+		}
+	}
+
+	// Draw the repeated static meshes by batches, streamed cells would lose their batches when they are unloaded
+	if (bResult && GetScene() && !m_pCellStreamer && GetConfig().GetVar("DungeonConfig", "InstancingEnabled").GetBool()) {
+		SceneLoadPhase cPhase("Instancing setup");
+		m_pMeshInstancer = new MeshInstancer(*GetScene());
+		if (!m_pMeshInstancer->GetNumOfBatches()) {
+			delete m_pMeshInstancer;
+			m_pMeshInstancer = nullptr;
+		}
+	}
+
+	// Cull the static meshes and the batches, after the cell streamer had its first look at the cells
+	if (bResult && GetScene() && GetConfig().GetVar("DungeonConfig", "CullingEnabled").GetBool()) {
+		SceneLoadPhase cPhase("Culling setup");
+		m_pSceneCuller = new SceneCuller(*GetScene(), sFilename, GetConfig().GetVar("DungeonConfig", "OcclusionCulling").GetBool() ? m_pWorkerPool : nullptr);
+		if (!m_pSceneCuller->GetNumOfMeshes()) {
+			delete m_pSceneCuller;
+			m_pSceneCuller = nullptr;
+		}
+	}
+
+	// The camcorder playback was started when the scene loading was finished, start the benchmark
+	if (m_pBenchmark)
+		m_pBenchmark->Start();
 
 	// Get the renderer context
 	RendererContext *pRendererContext = GetRendererContext();
@@ -279,6 +954,10 @@ bool Application::LoadScene(const String &sFilename)
 		}
 	}
 
+	// Write the scene load report into the log, the "loadreport" console command writes it again
+	SceneLoadReport::End();
+	SceneLoadReport::Log();
+
 	// Done
 	return bResult;
 }
@@ -289,8 +968,7 @@ bool Application::LoadScene(const String &sFilename)
 //[-------------------------------------------------------]
 void Application::OnCreateScene(SceneContainer &cContainer)
 {
-	// Set scene container flags
-	cContainer.SetFlags(SceneNode::NoCulling);
+	// The static meshes are culled by the scene culler, so the scene container flags are left alone
 
 	// Setup scene surface painter
 	SurfacePainter *pPainter = GetPainter();
@@ -28,9 +28,30 @@
 //[-------------------------------------------------------]
 //[ Includes                                              ]
 //[-------------------------------------------------------]
+#include <PLCore/Container/Array.h>
 #include <PLEngine/Application/ScriptApplication.h>
 
 
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLEngine {
+	class ConsoleCommand;
+}
+class Benchmark;
+class WorkerPool;
+class CellStreamer;
+class CamcorderPrefetcher;
+class MeshBatchCache;
+class MeshInstancer;
+class SceneCuller;
+class CamcorderRecorder;
+class TraceCapture;
+class HitchRecorder;
+class Telemetry;
+class AttributeHandle;
+
+
 //[-------------------------------------------------------]
 //[ Classes                                               ]
 //[-------------------------------------------------------]
@@ -87,6 +108,24 @@ class Application : public PLEngine::ScriptApplication {
 		*/
 		bool IsRepeatMode() const;
 
+		/**
+		*  @brief
+		*    Returns whether or not the application runs within the benchmark mode
+		*
+		*  @return
+		*    'true' if the application runs within the benchmark mode (headless deterministic camcorder flythrough), else 'false'
+		*/
+		bool IsBenchmarkMode() const;
+
+		/**
+		*  @brief
+		*    Returns the name of the camcorder track to play within the benchmark mode
+		*
+		*  @return
+		*    The name of the camcorder track to play within the benchmark mode (e.g. "Movie" or "ShortMovie"), empty string if not within the benchmark mode
+		*/
+		PLCore::String GetBenchmarkTrack() const;
+
 		/**
 		*  @brief
 		*    Returns whether or not this is an internal release
@@ -96,6 +135,170 @@ class Application : public PLEngine::ScriptApplication {
 		*/
 		bool IsInternalRelease() const;
 
+		/**
+		*  @brief
+		*    Starts recording the current camera
+		*
+		*  @param[in] sName
+		*    Name of the recording (e.g. "Test" writes "Data/Camcorder/Test.cam", play it with "camcorder:StartPlayback(\"Test\")")
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*
+		*  @note
+		*    - Replaces "PLEngine::Camcorder::StartRecord()", the keys are streamed to disk while recording (see "CamcorderRecorder")
+		*/
+		bool StartRecord(const PLCore::String &sName);
+
+		/**
+		*  @brief
+		*    Stops recording the camera
+		*/
+		void StopRecord();
+
+		/**
+		*  @brief
+		*    Returns whether or not the camera is recorded
+		*
+		*  @return
+		*    'true' if the camera is recorded, else 'false'
+		*/
+		bool IsRecording() const;
+
+		/**
+		*  @brief
+		*    Returns whether or not the profiler window should be shown
+		*
+		*  @return
+		*    'true' if the profiler window should be shown, else 'false'
+		*
+		*  @note
+		*    - Toggled by the console command "profiler"
+		*/
+		bool IsProfilerShown() const;
+
+		/**
+		*  @brief
+		*    Returns whether or not the script profiler is enabled
+		*
+		*  @return
+		*    'true' if the script profiler is enabled, else 'false'
+		*
+		*  @note
+		*    - Toggled by the console command "scriptprofiler", polled by the Lua module "ScriptProfiler.lua"
+		*/
+		bool IsScriptProfilerEnabled() const;
+
+		/**
+		*  @brief
+		*    Begins a script function call for the script profiler
+		*
+		*  @param[in] sName
+		*    Function name (e.g. "Interaction.OnControl")
+		*/
+		void BeginScriptFunction(const PLCore::String &sName);
+
+		/**
+		*  @brief
+		*    Ends the current script function call for the script profiler
+		*
+		*  @param[in] fHeapGrowth
+		*    Lua heap growth (in KiB) during the call
+		*/
+		void EndScriptFunction(float fHeapGrowth);
+
+		/**
+		*  @brief
+		*    Returns a handle for typed per frame writes of an attribute
+		*
+		*  @param[in] sName
+		*    Attribute name (e.g. "EffectWeight")
+		*
+		*  @return
+		*    The attribute handle, the same handle is returned for the same name
+		*
+		*  @note
+		*    - Scripts get the handle once and pass it to "SetAttributeFloat()" and the like every frame (see "AttributeHandle")
+		*/
+		int GetAttributeHandle(const PLCore::String &sName);
+
+		/**
+		*  @brief
+		*    Sets a float attribute through an attribute handle
+		*
+		*  @param[in] pObject
+		*    Object to set the attribute of, can be a null pointer
+		*  @param[in] nHandle
+		*    Attribute handle returned by "GetAttributeHandle()"
+		*  @param[in] fValue
+		*    Value to set
+		*/
+		void SetAttributeFloat(PLCore::Object *pObject, int nHandle, float fValue);
+
+		/**
+		*  @brief
+		*    Sets an integer attribute through an attribute handle
+		*
+		*  @param[in] pObject
+		*    Object to set the attribute of, can be a null pointer
+		*  @param[in] nHandle
+		*    Attribute handle returned by "GetAttributeHandle()"
+		*  @param[in] nValue
+		*    Value to set
+		*/
+		void SetAttributeInt(PLCore::Object *pObject, int nHandle, int nValue);
+
+		/**
+		*  @brief
+		*    Sets a two component float vector attribute through an attribute handle
+		*
+		*  @param[in] pObject
+		*    Object to set the attribute of, can be a null pointer
+		*  @param[in] nHandle
+		*    Attribute handle returned by "GetAttributeHandle()"
+		*  @param[in] fX
+		*    X component of the value to set
+		*  @param[in] fY
+		*    Y component of the value to set
+		*/
+		void SetAttributeVector2(PLCore::Object *pObject, int nHandle, float fX, float fY);
+
+		/**
+		*  @brief
+		*    Sets a three component float vector attribute through an attribute handle
+		*
+		*  @param[in] pObject
+		*    Object to set the attribute of, can be a null pointer
+		*  @param[in] nHandle
+		*    Attribute handle returned by "GetAttributeHandle()"
+		*  @param[in] fX
+		*    X component of the value to set
+		*  @param[in] fY
+		*    Y component of the value to set
+		*  @param[in] fZ
+		*    Z component of the value to set
+		*/
+		void SetAttributeVector3(PLCore::Object *pObject, int nHandle, float fX, float fY, float fZ);
+
+		/**
+		*  @brief
+		*    Sets a color attribute through an attribute handle
+		*
+		*  @param[in] pObject
+		*    Object to set the attribute of, can be a null pointer
+		*  @param[in] nHandle
+		*    Attribute handle returned by "GetAttributeHandle()"
+		*  @param[in] fR
+		*    Red component of the value to set
+		*  @param[in] fG
+		*    Green component of the value to set
+		*  @param[in] fB
+		*    Blue component of the value to set
+		*  @param[in] fA
+		*    Alpha component of the value to set, ignored for RGB color attributes
+		*/
+		void SetAttributeColor(PLCore::Object *pObject, int nHandle, float fR, float fG, float fB, float fA);
+
 
 	//[-------------------------------------------------------]
 	//[ Private functions                                     ]
@@ -107,12 +310,73 @@ class Application : public PLEngine::ScriptApplication {
 		*/
 		void UpdateMousePickingPullAnimation();
 
+		/**
+		*  @brief
+		*    Console command "profiler", toggles the profiler window
+		*
+		*  @param[in] cCommand
+		*    Console command
+		*/
+		void ConsoleCommandProfiler(PLEngine::ConsoleCommand &cCommand);
+
+		/**
+		*  @brief
+		*    Console command "trace <frames> <filename>", captures the given number of frames into a Chrome trace (e.g. "trace 300 out.json")
+		*
+		*  @param[in] cCommand
+		*    Console command
+		*/
+		void ConsoleCommandTrace(PLEngine::ConsoleCommand &cCommand);
+
+		/**
+		*  @brief
+		*    Console command "loadreport", writes the load report of the last loaded scene into the log
+		*
+		*  @param[in] cCommand
+		*    Console command
+		*/
+		void ConsoleCommandLoadReport(PLEngine::ConsoleCommand &cCommand);
+
+		/**
+		*  @brief
+		*    Console command "scriptprofiler", toggles the script profiler and writes its result into the log when it's disabled
+		*
+		*  @param[in] cCommand
+		*    Console command
+		*/
+		void ConsoleCommandScriptProfiler(PLEngine::ConsoleCommand &cCommand);
+
+		/**
+		*  @brief
+		*    Console command "culling", toggles the culling of the static meshes and writes the counters of the last frame into the log when it's disabled
+		*
+		*  @param[in] cCommand
+		*    Console command
+		*/
+		void ConsoleCommandCulling(PLEngine::ConsoleCommand &cCommand);
+
+
+	//[-------------------------------------------------------]
+	//[ Protected virtual PLCore::AbstractFrontend functions  ]
+	//[-------------------------------------------------------]
+	protected:
+		virtual void OnDraw() override;
+		virtual void OnUpdate() override;
+
 
 	//[-------------------------------------------------------]
 	//[ Protected virtual PLCore::CoreApplication functions   ]
 	//[-------------------------------------------------------]
 	protected:
 		virtual void OnInit() override;
+		virtual void OnDeInit() override;
+
+
+	//[-------------------------------------------------------]
+	//[ Protected virtual PLRenderer::RendererApplication functions ]
+	//[-------------------------------------------------------]
+	protected:
+		virtual void OnCreateRendererContext() override;
 
 
 	//[-------------------------------------------------------]
@@ -140,7 +404,26 @@ class Application : public PLEngine::ScriptApplication {
 	//[ Private data                                          ]
 	//[-------------------------------------------------------]
 	private:
-		float m_fMousePickingPullAnimation;	/**< Mouse picking pull animation */
+		float							 m_fMousePickingPullAnimation;	/**< Mouse picking pull animation */
+		Benchmark						*m_pBenchmark;					/**< Benchmark instance, can be a null pointer */
+		WorkerPool						*m_pWorkerPool;					/**< Worker pool shared by the cell streamer, the camcorder prefetcher and the culler, always valid */
+		CellStreamer					*m_pCellStreamer;				/**< Cell streamer of the current scene, can be a null pointer */
+		CamcorderPrefetcher				*m_pCamcorderPrefetcher;		/**< Camcorder prefetcher of the current scene, can be a null pointer */
+		PLCore::String					 m_sSceneFilename;				/**< Filename of the current XML scene, the culler finds its potentially visible set next to it */
+		MeshBatchCache					*m_pMeshBatchCache;				/**< Merged static meshes of the current scene, can be a null pointer */
+		MeshInstancer					*m_pMeshInstancer;				/**< Instancer of the repeated static meshes of the current scene, can be a null pointer */
+		SceneCuller						*m_pSceneCuller;				/**< Culler of the static meshes of the current scene, can be a null pointer */
+		CamcorderRecorder				*m_pCamcorderRecorder;			/**< Camcorder recorder, created on the first recording, can be a null pointer */
+		TraceCapture					*m_pTraceCapture;				/**< Running trace capture, can be a null pointer */
+		HitchRecorder					*m_pHitchRecorder;				/**< Hitch recorder, can be a null pointer */
+		Telemetry						*m_pTelemetry;					/**< Telemetry sink, can be a null pointer */
+		float							 m_fScriptUpdateTime;			/**< Script update time of the current frame (in milliseconds) */
+		float							 m_fSceneUpdateTime;			/**< Scene update time of the current frame (in milliseconds) */
+		bool							 m_bProfilerShown;				/**< Should the profiler window be shown? */
+		AttributeHandle					*m_pWarpPointAttribute;			/**< "WarpPoint" attribute handle of the mouse picking pull animation, always valid */
+		AttributeHandle					*m_pWarpScaleAttribute;			/**< "WarpScale" attribute handle of the mouse picking pull animation, always valid */
+		AttributeHandle					*m_pWarpDimensionAttribute;		/**< "WarpDimension" attribute handle of the mouse picking pull animation, always valid */
+		PLCore::Array<AttributeHandle*>	 m_lstAttributeHandles;			/**< Attribute handles of the scripts, the index is the handle */
 
 
 };
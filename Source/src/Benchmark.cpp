@@ -0,0 +1,258 @@
+/*********************************************************\
+ *  File: Benchmark.cpp                                  *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/File/File.h>
+#include <PLCore/System/System.h>
+#include <PLCore/Tools/Timing.h>
+#include "Benchmark.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+static const float DefaultTimeStep		 = 0.04f;			/**< Fixed simulated timestep (in seconds) used instead of an invalid one, the default of "BenchmarkTimeStep" */
+static const float ClampedTimeDifference = 0.00001f;		/**< Time difference (in seconds) each frame is clamped to before it's scaled up to the timestep, far below any real frame time */
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+Benchmark::Benchmark(const String &sTrack, float fTimeStep) :
+	m_sTrack(sTrack),
+	m_fTimeStep(fTimeStep),
+	m_bRunning(false),
+	m_fOriginalFPSLimit(0.0f),
+	m_fOriginalMaxTimeDiff(0.0f),
+	m_bOriginalSlowMotion(false),
+	m_fOriginalSlowMotionFactor(1.0f),
+	m_nFrameStartTime(0)
+{
+	// The timestep scales the time difference, a timestep of zero or below (or not a number at all) can't be used
+	if (!(m_fTimeStep > 0.0f)) {
+		PL_LOG(Warning, String::Format("Benchmark: The timestep %g is invalid, using %g seconds instead", m_fTimeStep, DefaultTimeStep))
+		m_fTimeStep = DefaultTimeStep;
+	}
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+Benchmark::~Benchmark()
+{
+	// Restore the original timing settings
+	Stop();
+}
+
+/**
+*  @brief
+*    Returns the name of the camcorder track to play
+*/
+const String &Benchmark::GetTrack() const
+{
+	return m_sTrack;
+}
+
+/**
+*  @brief
+*    Returns the fixed simulated timestep
+*/
+float Benchmark::GetTimeStep() const
+{
+	return m_fTimeStep;
+}
+
+/**
+*  @brief
+*    Returns whether or not the benchmark is currently running
+*/
+bool Benchmark::IsRunning() const
+{
+	return m_bRunning;
+}
+
+/**
+*  @brief
+*    Starts the benchmark
+*/
+void Benchmark::Start()
+{
+	if (!m_bRunning) {
+		Timing *pTiming = Timing::GetInstance();
+
+		// Backup the original timing settings
+		m_fOriginalFPSLimit			= pTiming->GetFPSLimit();
+		m_fOriginalMaxTimeDiff		= pTiming->GetMaxTimeDifference();
+		m_bOriginalSlowMotion		= pTiming->IsSlowMotion();
+		m_fOriginalSlowMotionFactor	= pTiming->GetSlowMotionFactor(false);
+
+		// Force the fixed simulated timestep without throttling the frames: The maximum time difference clamps the
+		// measured time difference of every frame to a tiny constant and the slow motion factor scales this constant up
+		// to exactly one timestep - so every frame advances the simulated time by exactly one timestep, independent of
+		// how fast the used renderer is, while the frames are rendered as fast as possible
+		pTiming->SetFPSLimit(0.0f);
+		pTiming->SetMaxTimeDifference(ClampedTimeDifference);
+		pTiming->SetSlowMotionFactor(m_fTimeStep/ClampedTimeDifference);
+		pTiming->SetSlowMotion(true);
+
+		// Discard previously recorded frames
+		m_lstFrames.Reset();
+		m_nFrameStartTime = 0;
+
+		// Write a log message
+		PL_LOG(Info, "Benchmark: Started camcorder track '" + m_sTrack + String::Format("' with a fixed timestep of %g seconds", m_fTimeStep))
+
+		// The benchmark is now running
+		m_bRunning = true;
+	}
+}
+
+/**
+*  @brief
+*    Stops the benchmark
+*/
+void Benchmark::Stop()
+{
+	if (m_bRunning) {
+		// Restore the original timing settings
+		Timing *pTiming = Timing::GetInstance();
+		pTiming->SetFPSLimit(m_fOriginalFPSLimit);
+		pTiming->SetMaxTimeDifference(m_fOriginalMaxTimeDiff);
+		pTiming->SetSlowMotionFactor(m_fOriginalSlowMotionFactor);
+		pTiming->SetSlowMotion(m_bOriginalSlowMotion);
+
+		// Write a log message
+		PL_LOG(Info, String::Format("Benchmark: Stopped after %u frames", m_lstFrames.GetNumOfElements()))
+
+		// The benchmark is no longer running
+		m_bRunning = false;
+	}
+}
+
+/**
+*  @brief
+*    Marks the start of a new frame
+*/
+void Benchmark::NextFrame()
+{
+	if (m_bRunning)
+		m_nFrameStartTime = System::GetInstance()->GetMicroseconds();
+}
+
+/**
+*  @brief
+*    Adds a frame
+*/
+void Benchmark::AddFrame(const Frame &cFrame)
+{
+	if (m_bRunning) {
+		// The frame ends right now, the time until the next frame starts (e.g. a wait of the frontend) is not part of the frame
+		Frame &cNewFrame = m_lstFrames.Add(cFrame);
+		cNewFrame.fFrameTime = m_nFrameStartTime ? static_cast<float>(System::GetInstance()->GetMicroseconds() - m_nFrameStartTime)/1000.0f : 0.0f;
+	}
+}
+
+/**
+*  @brief
+*    Returns the recorded frames
+*/
+const Array<Benchmark::Frame> &Benchmark::GetFrames() const
+{
+	return m_lstFrames;
+}
+
+/**
+*  @brief
+*    Writes the recorded frames into a CSV file
+*/
+bool Benchmark::Save(const String &sFilename) const
+{
+	// Open the file
+	File cFile(sFilename);
+	if (cFile.Open(File::FileCreate | File::FileWrite)) {
+		// Write the header
+		cFile.PutS("Frame,FrameTime,ScriptUpdateTime,SceneUpdateTime,RenderTime\n");
+
+		// Write one line per recorded frame (all times in milliseconds)
+		for (uint32 i=0; i<m_lstFrames.GetNumOfElements(); i++) {
+			const Frame &cFrame = m_lstFrames[i];
+			cFile.PutS(String::Format("%u,%.4f,%.4f,%.4f,%.4f\n", i, cFrame.fFrameTime, cFrame.fScriptUpdateTime, cFrame.fSceneUpdateTime, cFrame.fRenderTime));
+		}
+
+		// Close the file
+		cFile.Close();
+
+		// Write a log message
+		PL_LOG(Info, String::Format("Benchmark: Wrote %u frames into '", m_lstFrames.GetNumOfElements()) + sFilename + '\'')
+
+		// Done
+		return true;
+	} else {
+		// Error!
+		PL_LOG(Error, "Benchmark: Failed to write '" + sFilename + '\'')
+		return false;
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+Benchmark::Benchmark(const Benchmark &cSource) :
+	m_fTimeStep(0.0f),
+	m_bRunning(false),
+	m_fOriginalFPSLimit(0.0f),
+	m_fOriginalMaxTimeDiff(0.0f),
+	m_bOriginalSlowMotion(false),
+	m_fOriginalSlowMotionFactor(1.0f),
+	m_nFrameStartTime(0)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+Benchmark &Benchmark::operator =(const Benchmark &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
@@ -0,0 +1,221 @@
+/*********************************************************\
+ *  File: Benchmark.h                                    *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_BENCHMARK_H__
+#define __DUNGEON_BENCHMARK_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include <PLCore/Container/Array.h>
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Deterministic flythrough benchmark
+*
+*  @remarks
+*    While the benchmark is running, the global timing is forced to a fixed simulated timestep so that
+*    every run of a camcorder track produces exactly the same sequence of frames. For each frame the
+*    measured frame, script update, scene update and render times are recorded and can be written
+*    into a CSV file.
+*/
+class Benchmark {
+
+
+	//[-------------------------------------------------------]
+	//[ Public structures                                     ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Measured times of a single frame (all values in milliseconds)
+		*/
+		struct Frame {
+			float fFrameTime;			/**< Frame time, the wall time from the start of the frame to the end of the drawing (without any wait between the frames) */
+			float fScriptUpdateTime;	/**< Script update time */
+			float fSceneUpdateTime;		/**< Scene update time */
+			float fRenderTime;			/**< Render time */
+			bool operator ==(const Frame &cOther) const {
+				return (fFrameTime == cOther.fFrameTime && fScriptUpdateTime == cOther.fScriptUpdateTime && fSceneUpdateTime == cOther.fSceneUpdateTime && fRenderTime == cOther.fRenderTime);
+			}
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] sTrack
+		*    Name of the camcorder track to play (e.g. "Movie" or "ShortMovie")
+		*  @param[in] fTimeStep
+		*    Fixed simulated timestep in seconds, must be above zero (else the default of 0.04 seconds is used)
+		*/
+		Benchmark(const PLCore::String &sTrack, float fTimeStep);
+
+		/**
+		*  @brief
+		*    Destructor
+		*
+		*  @note
+		*    - Restores the original timing settings in case the benchmark is still running
+		*/
+		~Benchmark();
+
+		/**
+		*  @brief
+		*    Returns the name of the camcorder track to play
+		*
+		*  @return
+		*    Name of the camcorder track to play
+		*/
+		const PLCore::String &GetTrack() const;
+
+		/**
+		*  @brief
+		*    Returns the fixed simulated timestep
+		*
+		*  @return
+		*    Fixed simulated timestep in seconds
+		*/
+		float GetTimeStep() const;
+
+		/**
+		*  @brief
+		*    Returns whether or not the benchmark is currently running
+		*
+		*  @return
+		*    'true' if the benchmark is currently running and frames are recorded, else 'false'
+		*/
+		bool IsRunning() const;
+
+		/**
+		*  @brief
+		*    Starts the benchmark
+		*
+		*  @remarks
+		*    Switches the global timing to the fixed simulated timestep and starts the frame recording.
+		*    Previously recorded frames are discarded.
+		*/
+		void Start();
+
+		/**
+		*  @brief
+		*    Stops the benchmark
+		*
+		*  @remarks
+		*    Restores the original timing settings, the recorded frames are kept.
+		*/
+		void Stop();
+
+		/**
+		*  @brief
+		*    Marks the start of a new frame, call this once per frame right at the start of the frame
+		*/
+		void NextFrame();
+
+		/**
+		*  @brief
+		*    Adds a frame, call this once per frame right at the end of the frame
+		*
+		*  @param[in] cFrame
+		*    Measured times of the frame to add, ignored if the benchmark is not running - the frame time is measured from the last "NextFrame()" call on
+		*/
+		void AddFrame(const Frame &cFrame);
+
+		/**
+		*  @brief
+		*    Returns the recorded frames
+		*
+		*  @return
+		*    The recorded frames
+		*/
+		const PLCore::Array<Frame> &GetFrames() const;
+
+		/**
+		*  @brief
+		*    Writes the recorded frames into a CSV file
+		*
+		*  @param[in] sFilename
+		*    Name of the CSV file to write
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool Save(const PLCore::String &sFilename) const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		Benchmark(const Benchmark &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		Benchmark &operator =(const Benchmark &cSource);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::String		 m_sTrack;						/**< Name of the camcorder track to play */
+		float				 m_fTimeStep;					/**< Fixed simulated timestep in seconds */
+		bool				 m_bRunning;					/**< Is the benchmark currently running? */
+		float				 m_fOriginalFPSLimit;			/**< FPS limit before the benchmark was started */
+		float				 m_fOriginalMaxTimeDiff;		/**< Maximum time difference before the benchmark was started */
+		bool				 m_bOriginalSlowMotion;			/**< Slow motion state before the benchmark was started */
+		float				 m_fOriginalSlowMotionFactor;	/**< Slow motion factor before the benchmark was started */
+		PLCore::uint64		 m_nFrameStartTime;				/**< Start time of the current frame (in microseconds), 0 before the first frame */
+		PLCore::Array<Frame> m_lstFrames;					/**< Recorded frames */
+
+
+};
+
+
+#endif // __DUNGEON_BENCHMARK_H__
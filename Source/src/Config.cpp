@@ -37,11 +37,25 @@
 
 	pl_class_metadata(DungeonConfig, "", DungeonConfigGroup, "Dungeon configuration class")
 		// Attributes
-		pl_attribute_metadata(SoundAPI,			PLCore::String,	"PLSoundOpenAL::SoundManager",	ReadWrite,	"Name of the sound API to use",	"")
+		pl_attribute_metadata(SoundAPI,				PLCore::String,	"PLSoundOpenAL::SoundManager",	ReadWrite,	"Name of the sound API to use",																	"")
+		pl_attribute_metadata(BenchmarkRendererAPI,	PLCore::String,	"PLRendererNull::Renderer",		ReadWrite,	"Name of the renderer API to use within the benchmark mode, empty string to use the configured one",	"")
+		pl_attribute_metadata(BenchmarkTimeStep,		float,			0.04f,							ReadWrite,	"Fixed simulated timestep (in seconds) used within the benchmark mode",							"")
+		pl_attribute_metadata(SceneCacheEnabled,		bool,			true,							ReadWrite,	"Load scenes from compiled binary scene caches within \"_Cache/Scenes\"?",					"")
+		pl_attribute_metadata(CellStreamingEnabled,	bool,			false,							ReadWrite,	"Stream the contents of the scene cells depending on the cell the camera is in?",			"")
+		pl_attribute_metadata(CellStreamingHops,		PLCore::uint32,	1,								ReadWrite,	"Number of portal hops from the camera cell within which cells stay resident",				"")
+		pl_attribute_metadata(CellStreamingBudget,	PLCore::uint32,	256,							ReadWrite,	"Memory budget (in MiB) of the resident cells, further cells are unloaded when it's exceeded",	"")
+		pl_attribute_metadata(CamcorderPrefetchTime,	float,			5.0f,							ReadWrite,	"Time (in seconds) the cells are prepared ahead of the camcorder playback, 0 to disable",		"")
+		pl_attribute_metadata(CullingEnabled,			bool,			true,							ReadWrite,	"Cull the static meshes through a bounding volume hierarchy per cell and the cell portals?",	"")
+		pl_attribute_metadata(OcclusionCulling,			bool,			true,							ReadWrite,	"Hide the static meshes behind big opaque meshes by using a software depth buffer?",			"")
+		pl_attribute_metadata(MeshBatchCacheEnabled,	bool,			true,							ReadWrite,	"Draw the unique static meshes of each cell by the merged batches baked by \"DungeonMeshBaker\"?",	"")
+		pl_attribute_metadata(InstancingEnabled,		bool,			true,							ReadWrite,	"Draw repeated static meshes sharing a material by merged instance batches?",					"")
+		pl_attribute_metadata(HitchThreshold,			float,			100.0f,							ReadWrite,	"Frame time (in milliseconds) above which a hitch trace is written into \"Hitches\", 0 to disable",	"")
+		pl_attribute_metadata(HitchTraceTime,			float,			3.0f,							ReadWrite,	"Time (in seconds) before a hitch which is written into the hitch trace",						"")
+		pl_attribute_metadata(TelemetryInterval,		float,			10.0f,							ReadWrite,	"Interval (in minutes) the frame time percentiles and the memory are appended to \"Telemetry.log\", 0 to disable",	"")
 	#ifdef INTERNALRELEASE
-		pl_attribute_metadata(EditModeEnabled,	bool,			true,							ReadWrite,	"Edit mode enabled?",			"")
+		pl_attribute_metadata(EditModeEnabled,		bool,			true,							ReadWrite,	"Edit mode enabled?",																			"")
 	#else
-		pl_attribute_metadata(EditModeEnabled,	bool,			false,							ReadWrite,	"Edit mode enabled?",			"")
+		pl_attribute_metadata(EditModeEnabled,		bool,			false,							ReadWrite,	"Edit mode enabled?",																			"")
 	#endif
 		// Constructors
 		pl_constructor_0_metadata(DefaultConstructor,	"Default constructor",	"")
@@ -101,6 +115,20 @@ DungeonConfigGroup &DungeonConfigGroup::operator =(const DungeonConfigGroup &cSo
 */
 DungeonConfig::DungeonConfig() :
 	SoundAPI(this),
+	BenchmarkRendererAPI(this),
+	BenchmarkTimeStep(this),
+	SceneCacheEnabled(this),
+	CellStreamingEnabled(this),
+	CellStreamingHops(this),
+	CellStreamingBudget(this),
+	CamcorderPrefetchTime(this),
+	CullingEnabled(this),
+	OcclusionCulling(this),
+	MeshBatchCacheEnabled(this),
+	InstancingEnabled(this),
+	HitchThreshold(this),
+	HitchTraceTime(this),
+	TelemetryInterval(this),
 	EditModeEnabled(this)
 {
 }
@@ -123,6 +151,20 @@ DungeonConfig::~DungeonConfig()
 */
 DungeonConfig::DungeonConfig(const DungeonConfig &cSource) :
 	SoundAPI(this),
+	BenchmarkRendererAPI(this),
+	BenchmarkTimeStep(this),
+	SceneCacheEnabled(this),
+	CellStreamingEnabled(this),
+	CellStreamingHops(this),
+	CellStreamingBudget(this),
+	CamcorderPrefetchTime(this),
+	CullingEnabled(this),
+	OcclusionCulling(this),
+	MeshBatchCacheEnabled(this),
+	InstancingEnabled(this),
+	HitchThreshold(this),
+	HitchTraceTime(this),
+	TelemetryInterval(this),
 	EditModeEnabled(this)
 {
 	// No implementation because the copy constructor is never used
@@ -110,11 +110,25 @@ class DungeonConfig : public DungeonConfigGroup {
 	//[-------------------------------------------------------]
 	pl_class_def()
 		// Attributes
-		pl_attribute_directvalue(SoundAPI,			PLCore::String,	"PLSoundOpenAL::SoundManager",	ReadWrite)
+		pl_attribute_directvalue(SoundAPI,				PLCore::String,	"PLSoundOpenAL::SoundManager",	ReadWrite)
+		pl_attribute_directvalue(BenchmarkRendererAPI,	PLCore::String,	"PLRendererNull::Renderer",		ReadWrite)
+		pl_attribute_directvalue(BenchmarkTimeStep,		float,			0.04f,							ReadWrite)
+		pl_attribute_directvalue(SceneCacheEnabled,		bool,			true,							ReadWrite)
+		pl_attribute_directvalue(CellStreamingEnabled,	bool,			false,							ReadWrite)
+		pl_attribute_directvalue(CellStreamingHops,		PLCore::uint32,	1,								ReadWrite)
+		pl_attribute_directvalue(CellStreamingBudget,	PLCore::uint32,	256,							ReadWrite)
+		pl_attribute_directvalue(CamcorderPrefetchTime,	float,			5.0f,							ReadWrite)
+		pl_attribute_directvalue(CullingEnabled,		bool,			true,							ReadWrite)
+		pl_attribute_directvalue(OcclusionCulling,		bool,			true,							ReadWrite)
+		pl_attribute_directvalue(MeshBatchCacheEnabled,	bool,			true,							ReadWrite)
+		pl_attribute_directvalue(InstancingEnabled,		bool,			true,							ReadWrite)
+		pl_attribute_directvalue(HitchThreshold,		float,			100.0f,							ReadWrite)
+		pl_attribute_directvalue(HitchTraceTime,		float,			3.0f,							ReadWrite)
+		pl_attribute_directvalue(TelemetryInterval,		float,			10.0f,							ReadWrite)
 	#ifdef INTERNALRELEASE
-		pl_attribute_directvalue(EditModeEnabled,	bool,			true,							ReadWrite)
+		pl_attribute_directvalue(EditModeEnabled,		bool,			true,							ReadWrite)
 	#else
-		pl_attribute_directvalue(EditModeEnabled,	bool,			false,							ReadWrite)
+		pl_attribute_directvalue(EditModeEnabled,		bool,			false,							ReadWrite)
 	#endif
 	pl_class_def_end
 
@@ -30,9 +30,11 @@
 #include <PLScene/Scene/SceneContainer.h>
 #include <PLFrontendPLGui/Compositing/SNGui.h>
 #include "Application.h"
+#include "Tools/Profiler.h"
 #include "Gui/WindowMenu.h"
 #include "Gui/WindowText.h"
 #include "Gui/WindowResolution.h"
+#include "Gui/WindowProfiler.h"
 #include "Gui/IngameGui.h"
 
 
@@ -84,7 +86,8 @@ IngameGui::IngameGui(Application &cApplication) :
 	m_pIngameGui(nullptr),
 	m_pMenu(nullptr),
 	m_pText(nullptr),
-	m_pResolution(nullptr)
+	m_pResolution(nullptr),
+	m_pProfiler(nullptr)
 {
 	// Get scene container
 	SceneContainer *pSceneContainer = m_pApplication->GetRootScene();
@@ -121,6 +124,11 @@ IngameGui::IngameGui(Application &cApplication) :
 				m_pResolution->SetPos(Vector2i(220, 345));
 				m_pResolution->SetSize(Vector2i(m_pIngameGui->GetDefaultScreen()->GetSize().x - 240, 100));
 
+				// Create profiler window
+				m_pProfiler = new WindowProfiler(pRoot);
+				m_pProfiler->SetPos(Vector2i(10, 10));
+				m_pProfiler->SetSize(Vector2i(820, 420));
+
 				// Connect signals
 				m_pMenu->SignalCommand.Connect(SlotOnMenu);
 				m_pResolution->SignalResolutionChanged.Connect(SlotOnResolution);
@@ -160,6 +168,8 @@ Application &IngameGui::GetApplication() const
 */
 void IngameGui::Update()
 {
+	ProfilerScope cProfilerScope("GUI update");
+
 	// Get time difference
 	const float fTimeDiff = Timing::GetInstance()->GetTimeDifference()*2;
 
@@ -170,6 +180,15 @@ void IngameGui::Update()
 		m_pText->Update(fTimeDiff);
 	if (m_pResolution)
 		m_pResolution->Update(fTimeDiff);
+
+	// The profiler window is not part of the menu, it's shown as long as the application wants it to - and redrawn each frame
+	if (m_pProfiler) {
+		if (m_pProfiler->GetBlend() != m_pApplication->IsProfilerShown())
+			m_pProfiler->SetBlend(m_pApplication->IsProfilerShown());
+		m_pProfiler->Update(fTimeDiff);
+		if (m_pProfiler->IsVisible())
+			m_pProfiler->Redraw();
+	}
 }
 
 /**
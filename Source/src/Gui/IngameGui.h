@@ -47,6 +47,7 @@ class WindowMenu;
 class WindowText;
 class Application;
 class WindowResolution;
+class WindowProfiler;
 
 
 //[-------------------------------------------------------]
@@ -192,6 +193,7 @@ class IngameGui : public PLCore::Object {
 		WindowMenu			*m_pMenu;			/**< Main menu */
 		WindowText			*m_pText;			/**< Text window */
 		WindowResolution	*m_pResolution;		/**< Resolution options */
+		WindowProfiler		*m_pProfiler;		/**< Frame profiler, toggled by the console command "profiler" */
 
 
 };
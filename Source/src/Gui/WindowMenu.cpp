@@ -26,6 +26,7 @@
 #include <PLGui/Gui/Gui.h>
 #include <PLGui/Gui/Resources/Font.h>
 #include <PLGui/Gui/Resources/Graphics.h>
+#include "Tools/Profiler.h"
 #include "Gui/WindowMenu.h"
 
 
@@ -78,6 +79,8 @@ WindowMenu::WindowMenu(Widget *pParent) : WindowBase(pParent),
 //[-------------------------------------------------------]
 void WindowMenu::OnDraw(Graphics &cGraphics)
 {
+	ProfilerScope cProfilerScope("GUI draw");
+
 	// Draw widget background
 	DrawBackground(cGraphics);
 
@@ -0,0 +1,244 @@
+/*********************************************************\
+ *  File: WindowProfiler.cpp                             *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLMath/Math.h>
+#include <PLGui/Gui/Gui.h>
+#include <PLGui/Gui/Resources/Font.h>
+#include <PLGui/Gui/Resources/Graphics.h>
+#include "Tools/AllocationTracker.h"
+#include "Gui/WindowProfiler.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLGraphics;
+using namespace PLMath;
+using namespace PLGui;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+static const float MaxGraphTime	= 1000.0f/30.0f;	/**< Frame time (in milliseconds) at the top of the graph */
+static const int   GraphTop		= 30;				/**< Y position of the top of the graph */
+static const int   GraphHeight	= 120;				/**< Height of the graph */
+static const int   TableTop		= 165;				/**< Y position of the scope tables */
+static const int   RowHeight	= 15;				/**< Height of a row within the scope tables */
+static const Color4 ScopeColors[8] = {				/**< Colors of the top level scopes */
+	Color4(0.9f, 0.3f, 0.3f, 1.0f),
+	Color4(0.3f, 0.8f, 0.3f, 1.0f),
+	Color4(0.3f, 0.5f, 1.0f, 1.0f),
+	Color4(0.9f, 0.8f, 0.2f, 1.0f),
+	Color4(0.8f, 0.4f, 0.9f, 1.0f),
+	Color4(0.2f, 0.8f, 0.8f, 1.0f),
+	Color4(1.0f, 0.6f, 0.2f, 1.0f),
+	Color4(0.6f, 0.6f, 0.4f, 1.0f)
+};
+
+
+//[-------------------------------------------------------]
+//[ RTTI interface                                        ]
+//[-------------------------------------------------------]
+pl_class_metadata(WindowProfiler, "", WindowBase, "Window that displays the frame profiler")
+pl_class_metadata_end(WindowProfiler)
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+WindowProfiler::WindowProfiler(Widget *pParent) : WindowBase(pParent),
+	m_pFont(new Font(*GetGui())),
+	m_cColorText(0.9f, 0.9f, 0.9f, 1.0f),
+	m_cColorOther(0.5f, 0.5f, 0.5f, 1.0f),
+	m_bProfiling(false)
+{
+	// Load font from file
+	m_pFont->LoadFromFile("Data/Fonts/arial.ttf", 12);
+
+	// Set background
+	SetBackgroundColor(Color4(0.0f, 0.0f, 0.0f, 0.6f));
+
+	// No colors assigned yet
+	for (uint32 i=0; i<8; i++)
+		m_pszNames[i] = nullptr;
+}
+
+
+//[-------------------------------------------------------]
+//[ Protected virtual PLGui::Widget functions             ]
+//[-------------------------------------------------------]
+void WindowProfiler::OnDraw(Graphics &cGraphics)
+{
+	ProfilerScope cProfilerScope("GUI draw");
+
+	// Draw widget background
+	DrawBackground(cGraphics);
+
+	// Nothing recorded yet?
+	const uint32 nNumOfFrames = Profiler::GetNumOfFrames();
+	if (!nNumOfFrames) {
+		cGraphics.DrawText(*m_pFont, m_cColorText, Color4::Transparent, Vector2i(10, 8), "Profiler - waiting for the first frame");
+		return;
+	}
+
+	// Title with the last frame, the allocations are only known if the allocation tracker is compiled in
+	const Profiler::SFrame &sLastFrame = Profiler::GetFrame(0);
+	String sTitle = String::Format("Profiler - frame %u: %.2f ms", sLastFrame.nFrame, sLastFrame.fTime);
+	if (sLastFrame.nNumOfDrawCalls)
+		sTitle += String::Format(", %u draw calls", sLastFrame.nNumOfDrawCalls);
+	if (AllocationTracker::IsEnabled())
+		sTitle += String::Format(", %u allocations (%.1f KiB)", sLastFrame.nNumOfAllocations, sLastFrame.nAllocatedBytes/1024.0f);
+	cGraphics.DrawText(*m_pFont, m_cColorText, Color4::Transparent, Vector2i(10, 8), sTitle);
+
+	// Reference lines at 60 and 30 frames per second
+	const int nWidth  = GetSize().x - 20;
+	const int nBottom = GraphTop + GraphHeight;
+	const int nY60	  = nBottom - static_cast<int>(GraphHeight*(1000.0f/60.0f)/MaxGraphTime);
+	cGraphics.DrawLine(m_cColorOther, Vector2i(10, nY60), Vector2i(10 + nWidth, nY60));
+	cGraphics.DrawLine(m_cColorOther, Vector2i(10, GraphTop), Vector2i(10 + nWidth, GraphTop));
+
+	// One stacked bar per frame, the oldest frame on the left
+	const int nBarWidth = nWidth/Profiler::NumOfFrames;
+	uint32 nSlowestFrame = 0;
+	for (uint32 nFrame=0; nFrame<nNumOfFrames; nFrame++) {
+		const Profiler::SFrame &sFrame = Profiler::GetFrame(nFrame);
+		if (sFrame.fTime > Profiler::GetFrame(nSlowestFrame).fTime)
+			nSlowestFrame = nFrame;
+		const int nX = 10 + (Profiler::NumOfFrames - 1 - nFrame)*nBarWidth;
+
+		// The whole frame
+		const int nFrameHeight = static_cast<int>(GraphHeight*Math::Min(sFrame.fTime, MaxGraphTime)/MaxGraphTime);
+		cGraphics.DrawBox(m_cColorOther, Vector2i(nX, nBottom - nFrameHeight), Vector2i(nX + nBarWidth - 1, nBottom));
+
+		// The top level scopes on top of each other
+		float fTime = 0.0f;
+		for (uint32 i=0; i<sFrame.nNumOfScopes && fTime<MaxGraphTime; i++) {
+			const Profiler::SScope &sScope = sFrame.sScopes[i];
+			if (sScope.nParent == Profiler::NoParent) {
+				const int nY1 = nBottom - static_cast<int>(GraphHeight*fTime/MaxGraphTime);
+				fTime = Math::Min(fTime + sScope.fTime, MaxGraphTime);
+				const int nY2 = nBottom - static_cast<int>(GraphHeight*fTime/MaxGraphTime);
+				if (nY2 < nY1)
+					cGraphics.DrawBox(GetScopeColor(sScope.pszName), Vector2i(nX, nY2), Vector2i(nX + nBarWidth - 1, nY1));
+			}
+		}
+	}
+
+	// The scopes of the last frame and of the slowest frame, so the cause of a spike can be seen
+	DrawScopes(cGraphics, sLastFrame, "Last frame", 10, TableTop);
+	const Profiler::SFrame &sSlowestFrame = Profiler::GetFrame(nSlowestFrame);
+	DrawScopes(cGraphics, sSlowestFrame, String::Format("Slowest frame %u: %.2f ms", sSlowestFrame.nFrame, sSlowestFrame.fTime), 10 + nWidth/2, TableTop);
+}
+
+
+//[-------------------------------------------------------]
+//[ Protected virtual WindowBase functions                ]
+//[-------------------------------------------------------]
+void WindowProfiler::OnSetBlend(bool bBlend)
+{
+	// Record as long as the window is shown
+	if (bBlend && !m_bProfiling) {
+		Profiler::Enable();
+		m_bProfiling = true;
+	} else if (!bBlend && m_bProfiling) {
+		Profiler::Disable();
+		m_bProfiling = false;
+	}
+}
+
+void WindowProfiler::OnBlend(float fBlend)
+{
+	// Set blending
+	SetTransparency(PLGui::AlphaTransparency, Color4(0.0f, 0.0f, 0.0f, fBlend));
+
+	// Show/hide the widget depending on the blend state
+	SetVisible(fBlend > 0.0f);
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Destructor
+*/
+WindowProfiler::~WindowProfiler()
+{
+	// Stop recording
+	if (m_bProfiling)
+		Profiler::Disable();
+
+	// Destroy the font
+	delete m_pFont;
+}
+
+/**
+*  @brief
+*    Draws the scope hierarchy of a frame
+*/
+void WindowProfiler::DrawScopes(Graphics &cGraphics, const Profiler::SFrame &sFrame, const String &sTitle, int nX, int nY)
+{
+	const int nColumnWidth = (GetSize().x - 20)/2 - 20;
+	cGraphics.DrawText(*m_pFont, m_cColorText, Color4::Transparent, Vector2i(nX, nY), sTitle);
+	nY += RowHeight + 4;
+
+	// The scopes are stored in the order they were entered the first time, so the children follow their parent
+	for (uint32 i=0; i<sFrame.nNumOfScopes && nY+RowHeight<=GetSize().y; i++, nY+=RowHeight) {
+		const Profiler::SScope &sScope = sFrame.sScopes[i];
+		const Color4 &cColor = (sScope.nParent == Profiler::NoParent) ? GetScopeColor(sScope.pszName) : m_cColorText;
+		cGraphics.DrawText(*m_pFont, cColor, Color4::Transparent, Vector2i(nX + sScope.nDepth*12, nY), sScope.pszName);
+		String sTime = (sScope.nCalls > 1) ? String::Format("%.2f ms (%ux)", sScope.fTime, sScope.nCalls) : String::Format("%.2f ms", sScope.fTime);
+		if (AllocationTracker::IsEnabled() && sScope.nNumOfAllocations)
+			sTime = String::Format("%u alloc  ", sScope.nNumOfAllocations) + sTime;
+		cGraphics.DrawText(*m_pFont, cColor, Color4::Transparent, Vector2i(nX + nColumnWidth - cGraphics.GetTextWidth(*m_pFont, sTime), nY), sTime);
+	}
+}
+
+/**
+*  @brief
+*    Returns the color of a top level scope
+*/
+const Color4 &WindowProfiler::GetScopeColor(const char *pszName)
+{
+	// Look for the assigned color, or assign a free one
+	for (uint32 i=0; i<8; i++) {
+		if (m_pszNames[i] == pszName)
+			return ScopeColors[i];
+		if (!m_pszNames[i]) {
+			m_pszNames[i] = pszName;
+			return ScopeColors[i];
+		}
+	}
+
+	// All colors are in use
+	return m_cColorOther;
+}
@@ -0,0 +1,148 @@
+/*********************************************************\
+ *  File: WindowProfiler.h                               *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __BRIDGE_WINDOW_PROFILER_H__
+#define __BRIDGE_WINDOW_PROFILER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLGraphics/Color/Color4.h>
+#include "Tools/Profiler.h"
+#include "Gui/WindowBase.h"
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLGui {
+	class Font;
+}
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Window that displays the frame profiler (see "Profiler")
+*
+*  @remarks
+*    Shows the time of the last frames as stacked bars of the top level scopes, as well as the scope hierarchy of the
+*    last frame and of the slowest shown frame. The profiler is enabled as long as the window is blended in.
+*/
+class WindowProfiler : public WindowBase {
+
+
+	//[-------------------------------------------------------]
+	//[ RTTI interface                                        ]
+	//[-------------------------------------------------------]
+	pl_class_def()
+	pl_class_def_end
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] pParent
+		*    Parent widget, can be a null pointer
+		*/
+		WindowProfiler(Widget *pParent = nullptr);
+
+
+	//[-------------------------------------------------------]
+	//[ Protected virtual PLGui::Widget functions             ]
+	//[-------------------------------------------------------]
+	protected:
+		virtual void OnDraw(PLGui::Graphics &cGraphics) override;
+
+
+	//[-------------------------------------------------------]
+	//[ Protected virtual WindowBase functions                ]
+	//[-------------------------------------------------------]
+	protected:
+		virtual void OnSetBlend(bool bBlend) override;
+		virtual void OnBlend(float fBlend) override;
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		virtual ~WindowProfiler();
+
+		/**
+		*  @brief
+		*    Draws the scope hierarchy of a frame
+		*
+		*  @param[in] cGraphics
+		*    Graphics object used for painting
+		*  @param[in] sFrame
+		*    Frame to draw
+		*  @param[in] sTitle
+		*    Title of the table
+		*  @param[in] nX
+		*    X position of the table
+		*  @param[in] nY
+		*    Y position of the table
+		*/
+		void DrawScopes(PLGui::Graphics &cGraphics, const Profiler::SFrame &sFrame, const PLCore::String &sTitle, int nX, int nY);
+
+		/**
+		*  @brief
+		*    Returns the color of a top level scope
+		*
+		*  @param[in] pszName
+		*    Scope name
+		*
+		*  @return
+		*    The color of the scope, the same name results in the same color
+		*/
+		const PLGraphics::Color4 &GetScopeColor(const char *pszName);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLGui::Font			*m_pFont;			/**< Text font, always valid! */
+		PLGraphics::Color4	 m_cColorText;		/**< Text color */
+		PLGraphics::Color4	 m_cColorOther;		/**< Color of the frame time not covered by a top level scope */
+		const char			*m_pszNames[8];		/**< Names of the top level scopes the colors are assigned to, null pointer for a free color */
+		bool				 m_bProfiling;		/**< Is the profiler enabled by this window? */
+
+
+};
+
+
+#endif // __BRIDGE_WINDOW_PROFILER_H__
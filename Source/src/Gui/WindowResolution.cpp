@@ -30,6 +30,7 @@
 #include <PLRenderer/RendererContext.h>
 #include <PLRenderer/Renderer/Renderer.h>
 #include "Application.h"
+#include "Tools/Profiler.h"
 #include "Gui/WindowResolution.h"
 
 
@@ -150,6 +151,8 @@ const DisplayMode *WindowResolution::GetDisplayMode() const
 //[-------------------------------------------------------]
 void WindowResolution::OnDraw(Graphics &cGraphics)
 {
+	ProfilerScope cProfilerScope("GUI draw");
+
 	// Draw widget background
 	DrawBackground(cGraphics);
 
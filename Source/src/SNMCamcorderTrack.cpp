@@ -0,0 +1,210 @@
+/*********************************************************\
+ *  File: SNMCamcorderTrack.cpp                          *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/Tools/Timing.h>
+#include <PLMath/Matrix3x4.h>
+#include <PLMath/Quaternion.h>
+#include <PLScene/Scene/SceneContext.h>
+#include <PLScene/Scene/SceneContainer.h>
+#include "Tools/Profiler.h"
+#include "SNMCamcorderTrack.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ RTTI interface                                        ]
+//[-------------------------------------------------------]
+pl_class_metadata(SNMCamcorderTrack, "", PLScene::SceneNodeModifier, "Scene node modifier class playing a compact camcorder track")
+	// Attributes
+	pl_attribute_metadata(Track,				PLCore::String,	"",		ReadWrite,	"Filename of the camcorder track (\".track\") to play",																			"")
+	pl_attribute_metadata(Time,				float,			0.0f,	ReadWrite,	"Current time in seconds, set it to jump to any point of the track",															"")
+	pl_attribute_metadata(Speed,				float,			1.0f,	ReadWrite,	"Playback speed, 0 to pause",																									"")
+	pl_attribute_metadata(CoordinateSystem,	PLCore::String,	"",		ReadWrite,	"Scene container (relative to the scene node container) the keys are relative to, if empty the keys are relative to the scene node container",	"")
+	// Constructors
+	pl_constructor_1_metadata(ParameterConstructor,	PLScene::SceneNode&,	"Parameter constructor",	"")
+	// Methods
+	pl_method_0_metadata(GetDuration,	pl_ret_type(float),	"Returns the duration of the track in seconds, 0 if there's no valid track",	"")
+	// Signals
+	pl_signal_0_metadata(SignalFinished,	"The end of the track has been reached",	"")
+	// Slots
+	pl_slot_0_metadata(OnUpdate,	"Called when the scene node modifier needs to be updated",	"")
+pl_class_metadata_end(SNMCamcorderTrack)
+
+
+//[-------------------------------------------------------]
+//[ Public RTTI get/set functions                         ]
+//[-------------------------------------------------------]
+String SNMCamcorderTrack::GetTrack() const
+{
+	return m_sTrack;
+}
+
+void SNMCamcorderTrack::SetTrack(const String &sValue)
+{
+	if (m_sTrack != sValue) {
+		m_sTrack = sValue;
+
+		// Open the track, it's mapped into memory so even long tracks are opened at once
+		if (m_sTrack.GetLength()) {
+			if (!m_cTrack.Open(m_sTrack))
+				PL_LOG(Error, "Failed to open the camcorder track '" + m_sTrack + '\'')
+		} else {
+			m_cTrack.Close();
+		}
+		m_bFinished = false;
+		Apply();
+	}
+}
+
+float SNMCamcorderTrack::GetTime() const
+{
+	return m_fTime;
+}
+
+void SNMCamcorderTrack::SetTime(float fValue)
+{
+	// Seeking is just a binary search within the keys
+	m_fTime		= fValue;
+	m_bFinished = false;
+	Apply();
+}
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+SNMCamcorderTrack::SNMCamcorderTrack(SceneNode &cSceneNode) : SceneNodeModifier(cSceneNode),
+	Track(this),
+	Time(this),
+	Speed(this),
+	CoordinateSystem(this),
+	SlotOnUpdate(this),
+	m_fTime(0.0f),
+	m_bFinished(false)
+{
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+SNMCamcorderTrack::~SNMCamcorderTrack()
+{
+}
+
+/**
+*  @brief
+*    Returns the duration of the track
+*/
+float SNMCamcorderTrack::GetDuration() const
+{
+	return m_cTrack.GetDuration();
+}
+
+
+//[-------------------------------------------------------]
+//[ Protected virtual SceneNodeModifier functions         ]
+//[-------------------------------------------------------]
+void SNMCamcorderTrack::OnActivate(bool bActivate)
+{
+	// Connect/disconnect event handler
+	SceneContext *pSceneContext = GetSceneContext();
+	if (pSceneContext) {
+		if (bActivate)
+			pSceneContext->EventUpdate.Connect(SlotOnUpdate);
+		else
+			pSceneContext->EventUpdate.Disconnect(SlotOnUpdate);
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Called when the scene node modifier needs to be updated
+*/
+void SNMCamcorderTrack::OnUpdate()
+{
+	ProfilerScope cProfilerScope("Camcorder track");
+
+	if (m_cTrack.IsOpen()) {
+		// Advance the time
+		m_fTime += Timing::GetInstance()->GetTimeDifference()*Speed;
+		Apply();
+
+		// End of the track reached?
+		if (!m_bFinished && m_fTime >= m_cTrack.GetDuration()) {
+			m_bFinished = true;
+			SignalFinished();
+		}
+	}
+}
+
+/**
+*  @brief
+*    Applies the track at the current time to the owner scene node
+*/
+void SNMCamcorderTrack::Apply()
+{
+	if (m_cTrack.IsOpen()) {
+		// Evaluate the track
+		Vector3 vPosition;
+		Quaternion qRotation;
+		m_cTrack.GetPosition(m_fTime, vPosition);
+		m_cTrack.GetRotation(m_fTime, qRotation);
+
+		// Transform the keys into the scene node container, if required
+		SceneNode &cSceneNode = GetSceneNode();
+		SceneContainer *pContainer = cSceneNode.GetContainer();
+		if (pContainer && CoordinateSystem.Get().GetLength()) {
+			SceneNode *pCoordinateSystem = pContainer->GetByName(CoordinateSystem.Get());
+			Matrix3x4 mTransform;
+			if (pCoordinateSystem && pCoordinateSystem != pContainer && pCoordinateSystem->GetTransformMatrixTo(*pContainer, mTransform)) {
+				vPosition = mTransform*vPosition;
+				Quaternion qTransform;
+				qTransform.FromRotationMatrix(mTransform);
+				qRotation = qTransform*qRotation;
+			}
+		}
+
+		// Set the new transform
+		cSceneNode.GetTransform().SetPosition(vPosition);
+		cSceneNode.GetTransform().SetRotation(qRotation);
+	}
+}
@@ -0,0 +1,142 @@
+/*********************************************************\
+ *  File: SNMCamcorderTrack.h                            *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_CAMCORDERTRACK_MODIFIER_H__
+#define __DUNGEON_CAMCORDERTRACK_MODIFIER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLScene/Scene/SceneNodeModifier.h>
+#include "Tools/CamcorderTrack.h"
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Scene node modifier class playing a compact camcorder track (see "CamcorderTrack")
+*
+*  @remarks
+*    Sets the position and rotation of the owner scene node to the ones of the track at the current time. The time
+*    can be set at any moment (e.g. "modifier.Time = 120" within a script) to jump to any point of the track at once.
+*    When the end of the track is reached, the modifier stays at the last key and emits "SignalFinished".
+*/
+class SNMCamcorderTrack : public PLScene::SceneNodeModifier {
+
+
+	//[-------------------------------------------------------]
+	//[ RTTI interface                                        ]
+	//[-------------------------------------------------------]
+	pl_class_def()
+		// Attributes
+		pl_attribute_getset		(SNMCamcorderTrack,	Track,				PLCore::String,	"",		ReadWrite)
+		pl_attribute_getset		(SNMCamcorderTrack,	Time,				float,			0.0f,	ReadWrite)
+		pl_attribute_directvalue(					Speed,				float,			1.0f,	ReadWrite)
+		pl_attribute_directvalue(					CoordinateSystem,	PLCore::String,	"",		ReadWrite)
+		// Signals
+		pl_signal_0_def(SignalFinished)
+		// Slots
+		pl_slot_0_def(SNMCamcorderTrack, OnUpdate)
+	pl_class_def_end
+
+
+	//[-------------------------------------------------------]
+	//[ Public RTTI get/set functions                         ]
+	//[-------------------------------------------------------]
+	public:
+		PLCore::String GetTrack() const;
+		void SetTrack(const PLCore::String &sValue);
+		float GetTime() const;
+		void SetTime(float fValue);
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cSceneNode
+		*    Owner scene node
+		*/
+		SNMCamcorderTrack(PLScene::SceneNode &cSceneNode);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		virtual ~SNMCamcorderTrack();
+
+		/**
+		*  @brief
+		*    Returns the duration of the track
+		*
+		*  @return
+		*    The duration of the track in seconds, 0 if there's no valid track
+		*/
+		float GetDuration() const;
+
+
+	//[-------------------------------------------------------]
+	//[ Protected virtual PLScene::SceneNodeModifier functions]
+	//[-------------------------------------------------------]
+	protected:
+		virtual void OnActivate(bool bActivate) override;
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Called when the scene node modifier needs to be updated
+		*/
+		void OnUpdate();
+
+		/**
+		*  @brief
+		*    Applies the track at the current time to the owner scene node
+		*/
+		void Apply();
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::String m_sTrack;	/**< Filename of the track */
+		float		   m_fTime;		/**< Current time in seconds */
+		CamcorderTrack m_cTrack;	/**< The opened track */
+		bool		   m_bFinished;	/**< Was the end of the track reached? */
+
+
+};
+
+
+#endif // __DUNGEON_CAMCORDERTRACK_MODIFIER_H__
@@ -23,9 +23,7 @@
 //[-------------------------------------------------------]
 //[ Includes                                              ]
 //[-------------------------------------------------------]
-#include <PLCore/Tools/Timing.h>
-#include <PLScene/Scene/SNLight.h>
-#include <PLScene/Scene/SceneContext.h>
+#include "Scene/LightAnimationManager.h"
 #include "SNMLightRandomAnimation.h"
 
 
@@ -33,7 +31,6 @@
 //[ Namespace                                             ]
 //[-------------------------------------------------------]
 using namespace PLCore;
-using namespace PLMath;
 using namespace PLGraphics;
 using namespace PLScene;
 
@@ -55,11 +52,59 @@ pl_class_metadata(SNMLightRandomAnimation, "", PLScene::SceneNodeModifier, "Scen
 	pl_attribute_metadata(Flags,		pl_flag_type_def3(SNMLightRandomAnimation, EFlags),	0,										ReadWrite,			"Flags",			"")
 	// Constructors
 	pl_constructor_1_metadata(ParameterConstructor,	PLScene::SceneNode&,	"Parameter constructor",	"")
-	// Slots
-	pl_slot_0_metadata(OnUpdate,	"Called when the scene node needs to be updated",	"")
 pl_class_metadata_end(SNMLightRandomAnimation)
 
 
+//[-------------------------------------------------------]
+//[ Public RTTI get/set functions                         ]
+//[-------------------------------------------------------]
+float SNMLightRandomAnimation::GetSpeed() const
+{
+	return m_fSpeed;
+}
+
+void SNMLightRandomAnimation::SetSpeed(float fValue)
+{
+	m_fSpeed = fValue;
+	if (m_bActive)
+		LightAnimationManager::UpdateLight(*this);
+}
+
+float SNMLightRandomAnimation::GetRadius() const
+{
+	return m_fRadius;
+}
+
+void SNMLightRandomAnimation::SetRadius(float fValue)
+{
+	m_fRadius = fValue;
+	if (m_bActive)
+		LightAnimationManager::UpdateLight(*this);
+}
+
+const Color3 &SNMLightRandomAnimation::GetFixColor() const
+{
+	return m_cFixColor;
+}
+
+void SNMLightRandomAnimation::SetFixColor(const Color3 &cValue)
+{
+	m_cFixColor = cValue;
+	if (m_bActive)
+		LightAnimationManager::UpdateLight(*this);
+}
+
+void SNMLightRandomAnimation::SetFlags(uint32 nValue)
+{
+	// Call base implementation
+	SceneNodeModifier::SetFlags(nValue);
+
+	// Inform the light animation manager
+	if (m_bActive)
+		LightAnimationManager::UpdateLight(*this);
+}
+
+
 //[-------------------------------------------------------]
 //[ Public functions                                      ]
 //[-------------------------------------------------------]
@@ -73,9 +118,13 @@ SNMLightRandomAnimation::SNMLightRandomAnimation(SceneNode &cSceneNode) : SceneN
 	FixColor(this),
 	Color(this),
 	Flags(this),
-	SlotOnUpdate(this),
+	m_fSpeed(2.0f),
+	m_fRadius(0.5f),
+	m_cFixColor(0.5f, 0.5f, 0.5f),
+	m_bActive(false),
 	m_fCurrentIntensity(1.0f),
-	m_fDestinationIntensity(1.0f)
+	m_fDestinationIntensity(1.0f),
+	m_nRandomState(0)
 {
 }
 
@@ -85,6 +134,9 @@ SNMLightRandomAnimation::SNMLightRandomAnimation(SceneNode &cSceneNode) : SceneN
 */
 SNMLightRandomAnimation::~SNMLightRandomAnimation()
 {
+	// Ensure that the light animation manager doesn't use this instance any longer
+	if (m_bActive)
+		LightAnimationManager::RemoveLight(*this);
 }
 
 
@@ -93,73 +145,12 @@ SNMLightRandomAnimation::~SNMLightRandomAnimation()
 //[-------------------------------------------------------]
 void SNMLightRandomAnimation::OnActivate(bool bActivate)
 {
-	// Connect/disconnect event handler
-	SceneContext *pSceneContext = GetSceneContext();
-	if (pSceneContext) {
+	// Register/unregister within the light animation manager
+	if (bActivate != m_bActive) {
 		if (bActivate)
-			pSceneContext->EventUpdate.Connect(SlotOnUpdate);
+			LightAnimationManager::AddLight(*this);
 		else
-			pSceneContext->EventUpdate.Disconnect(SlotOnUpdate);
+			LightAnimationManager::RemoveLight(*this);
+		m_bActive = bActivate;
 	}
 }
-
-
-//[-------------------------------------------------------]
-//[ Private functions                                     ]
-//[-------------------------------------------------------]
-/**
-*  @brief
-*    Called when the scene node needs to be updated
-*/
-void SNMLightRandomAnimation::OnUpdate()
-{
-	// Set current scene node scale
-	SNLight &cLight = static_cast<SNLight&>(GetSceneNode());
-
-	// Animate color
-	const float fTimeDiff = Timing::GetInstance()->GetTimeDifference()*Speed;
-	if (m_fCurrentIntensity <= m_fDestinationIntensity) {
-		m_fCurrentIntensity += fTimeDiff;
-		if (m_fCurrentIntensity >= m_fDestinationIntensity) {
-			// Clamp
-			m_fCurrentIntensity = m_fDestinationIntensity;
-
-			// New destination
-			m_fDestinationIntensity = Math::GetRandNegFloat()*Radius;
-		}
-	} else {
-		m_fCurrentIntensity -= fTimeDiff;
-		if (m_fCurrentIntensity <= m_fDestinationIntensity) {
-			// Clamp
-			m_fCurrentIntensity = m_fDestinationIntensity;
-
-			// New destination
-			m_fDestinationIntensity = Math::GetRandNegFloat()*Radius;
-		}
-	}
-
-	// Set color
-	Color3 cColor = cLight.Color.Get();
-	Color3 cColorChanged = cColor*m_fCurrentIntensity;
-	if (GetFlags() & Multiply) {
-		// Red
-		cColor.r = (GetFlags() & NR) ? FixColor.Get().r : FixColor.Get().r*cColorChanged.r;
-		// Green
-		cColor.g = (GetFlags() & NG) ? FixColor.Get().g : FixColor.Get().g*cColorChanged.g;
-		// Blue
-		cColor.b = (GetFlags() & NB) ? FixColor.Get().b : FixColor.Get().b*cColorChanged.b;
-	} else {
-		// Red
-		cColor.r = (GetFlags() & NR) ? FixColor.Get().r : FixColor.Get().r+cColorChanged.r;
-		// Green
-		cColor.g = (GetFlags() & NG) ? FixColor.Get().g : FixColor.Get().g+cColorChanged.g;
-		// Blue
-		cColor.b = (GetFlags() & NB) ? FixColor.Get().b : FixColor.Get().b+cColorChanged.b;
-	}
-
-	// Clamp the color values between 0.0 and 1.0
-	cColor.Saturate();
-
-	// Finally, set the new color of the light
-	cLight.Color.Set(cColor);
-}
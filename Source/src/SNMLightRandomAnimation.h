@@ -40,11 +40,18 @@
 *    Scene node modifier class for a random light color animation
 *
 *  @remarks
-*    Animates the color of the light scene node over time.
+*    Animates the color of the light scene node over time. The modifier is just the authoring interface,
+*    all active instances are updated at once by the light animation manager (see "LightAnimationManager").
 */
 class SNMLightRandomAnimation : public PLScene::SceneNodeModifier {
 
 
+	//[-------------------------------------------------------]
+	//[ Friends                                               ]
+	//[-------------------------------------------------------]
+	friend class LightAnimationManager;
+
+
 	//[-------------------------------------------------------]
 	//[ Public definitions                                    ]
 	//[-------------------------------------------------------]
@@ -73,17 +80,28 @@ class SNMLightRandomAnimation : public PLScene::SceneNodeModifier {
 	//[-------------------------------------------------------]
 	pl_class_def()
 		// Attributes
-		pl_attribute_directvalue(Speed,		float,					2.0f,									ReadWrite)
-		pl_attribute_directvalue(Radius,	float,					0.5f,									ReadWrite)
-		pl_attribute_directvalue(FixColor,	PLGraphics::Color3,		PLGraphics::Color3(0.5f, 0.5f, 0.5f),	ReadWrite)
-		pl_attribute_directvalue(Color,		PLGraphics::Color3,		PLGraphics::Color3(1.0f, 1.0f, 1.0f),	ReadWrite)
+		pl_attribute_getset		(SNMLightRandomAnimation,	Speed,		float,					2.0f,									ReadWrite)
+		pl_attribute_getset		(SNMLightRandomAnimation,	Radius,		float,					0.5f,									ReadWrite)
+		pl_attribute_getset		(SNMLightRandomAnimation,	FixColor,	PLGraphics::Color3,		PLGraphics::Color3(0.5f, 0.5f, 0.5f),	ReadWrite)
+		pl_attribute_directvalue(							Color,		PLGraphics::Color3,		PLGraphics::Color3(1.0f, 1.0f, 1.0f),	ReadWrite)
 			// Overwritten PLScene::SceneNodeModifier attributes
-		pl_attribute_getset(SNMLightRandomAnimation, Flags,		PLCore::uint32,	0,										ReadWrite)
-		// Slots
-		pl_slot_0_def(SNMLightRandomAnimation, OnUpdate)
+		pl_attribute_getset		(SNMLightRandomAnimation,	Flags,		PLCore::uint32,			0,										ReadWrite)
 	pl_class_def_end
 
 
+	//[-------------------------------------------------------]
+	//[ Public RTTI get/set functions                         ]
+	//[-------------------------------------------------------]
+	public:
+		float GetSpeed() const;
+		void SetSpeed(float fValue);
+		float GetRadius() const;
+		void SetRadius(float fValue);
+		const PLGraphics::Color3 &GetFixColor() const;
+		void SetFixColor(const PLGraphics::Color3 &cValue);
+		void SetFlags(PLCore::uint32 nValue);
+
+
 	//[-------------------------------------------------------]
 	//[ Public functions                                      ]
 	//[-------------------------------------------------------]
@@ -111,23 +129,17 @@ class SNMLightRandomAnimation : public PLScene::SceneNodeModifier {
 		virtual void OnActivate(bool bActivate) override;
 
 
-	//[-------------------------------------------------------]
-	//[ Private functions                                     ]
-	//[-------------------------------------------------------]
-	private:
-		/**
-		*  @brief
-		*    Called when the scene node needs to be updated
-		*/
-		void OnUpdate();
-
-
 	//[-------------------------------------------------------]
 	//[ Private data                                          ]
 	//[-------------------------------------------------------]
 	private:
-		float m_fCurrentIntensity;		/**< Current intensity */
-		float m_fDestinationIntensity;	/**< Destination intensity */
+		float			   m_fSpeed;				/**< Animation speed */
+		float			   m_fRadius;				/**< Animation radius */
+		PLGraphics::Color3 m_cFixColor;				/**< Fix color */
+		bool			   m_bActive;				/**< Registered within the light animation manager? */
+		float			   m_fCurrentIntensity;		/**< Current intensity, kept by the light animation manager while the modifier is inactive */
+		float			   m_fDestinationIntensity;	/**< Destination intensity, kept by the light animation manager while the modifier is inactive */
+		PLCore::uint32	   m_nRandomState;			/**< Random number stream state, 0 if the stream wasn't seeded yet */
 
 
 };
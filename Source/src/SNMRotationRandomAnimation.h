@@ -0,0 +1,75 @@
+/*********************************************************\
+ *  File: SNMRotationRandomAnimation.h                   *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+
+#ifndef __DUNGEON_ROTATIONRANDOMANIMATION_H__
+#define __DUNGEON_ROTATIONRANDOMANIMATION_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "SNMTransformRandomAnimation.h"
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Scene node modifier class for a random rotation animation
+*/
+class SNMRotationRandomAnimation : public SNMTransformRandomAnimation {
+
+
+	//[-------------------------------------------------------]
+	//[ RTTI interface                                        ]
+	//[-------------------------------------------------------]
+	pl_class_def()
+	pl_class_def_end
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cSceneNode
+		*    Owner scene node
+		*/
+		SNMRotationRandomAnimation(PLScene::SceneNode &cSceneNode);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		virtual ~SNMRotationRandomAnimation();
+
+
+};
+
+
+#endif // __DUNGEON_ROTATIONRANDOMANIMATION_H__
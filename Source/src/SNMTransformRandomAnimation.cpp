@@ -0,0 +1,130 @@
+/*********************************************************\
+ *  File: SNMTransformRandomAnimation.cpp                *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "Scene/TransformAnimationManager.h"
+#include "SNMTransformRandomAnimation.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ RTTI interface                                        ]
+//[-------------------------------------------------------]
+pl_class_metadata(SNMTransformRandomAnimation, "", PLScene::SceneNodeModifier, "Abstract scene node modifier base class for a random transform animation")
+	// Attributes
+	pl_attribute_metadata(Speed,	float,	0.01f,	ReadWrite,	"Animation speed (units of the animated transform component per second)",	"")
+	pl_attribute_metadata(Radius,	float,	0.01f,	ReadWrite,	"Animation radius (units of the animated transform component)",				"")
+pl_class_metadata_end(SNMTransformRandomAnimation)
+
+
+//[-------------------------------------------------------]
+//[ Public RTTI get/set functions                         ]
+//[-------------------------------------------------------]
+float SNMTransformRandomAnimation::GetSpeed() const
+{
+	return m_fSpeed;
+}
+
+void SNMTransformRandomAnimation::SetSpeed(float fValue)
+{
+	m_fSpeed = fValue;
+	if (m_bActive)
+		TransformAnimationManager::UpdateModifier(*this);
+}
+
+float SNMTransformRandomAnimation::GetRadius() const
+{
+	return m_fRadius;
+}
+
+void SNMTransformRandomAnimation::SetRadius(float fValue)
+{
+	m_fRadius = fValue;
+	if (m_bActive)
+		TransformAnimationManager::UpdateModifier(*this);
+}
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Returns the animated transform component
+*/
+SNMTransformRandomAnimation::EComponent SNMTransformRandomAnimation::GetComponent() const
+{
+	return m_nComponent;
+}
+
+
+//[-------------------------------------------------------]
+//[ Protected functions                                   ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+SNMTransformRandomAnimation::SNMTransformRandomAnimation(SceneNode &cSceneNode, EComponent nComponent) : SceneNodeModifier(cSceneNode),
+	Speed(this),
+	Radius(this),
+	m_nComponent(nComponent),
+	m_fSpeed(0.01f),
+	m_fRadius(0.01f),
+	m_bActive(false)
+{
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+SNMTransformRandomAnimation::~SNMTransformRandomAnimation()
+{
+	// Ensure that the transform animation manager doesn't use this instance any longer
+	if (m_bActive)
+		TransformAnimationManager::RemoveModifier(*this);
+}
+
+
+//[-------------------------------------------------------]
+//[ Protected virtual SceneNodeModifier functions         ]
+//[-------------------------------------------------------]
+void SNMTransformRandomAnimation::OnActivate(bool bActivate)
+{
+	// Register/unregister within the transform animation manager
+	if (bActivate != m_bActive) {
+		if (bActivate)
+			TransformAnimationManager::AddModifier(*this);
+		else
+			TransformAnimationManager::RemoveModifier(*this);
+		m_bActive = bActivate;
+	}
+}
@@ -0,0 +1,141 @@
+/*********************************************************\
+ *  File: SNMTransformRandomAnimation.h                  *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_TRANSFORMRANDOMANIMATION_H__
+#define __DUNGEON_TRANSFORMRANDOMANIMATION_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLScene/Scene/SceneNodeModifier.h>
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Abstract scene node modifier base class for a random transform animation
+*
+*  @remarks
+*    Moves one transform component (position, rotation or scale) of the owner scene node randomly around
+*    the value it had when the modifier was activated. The modifier is just the authoring interface, all
+*    active instances are updated at once by the transform animation manager (see "TransformAnimationManager").
+*    When the modifier is deactivated, the original value is restored.
+*/
+class SNMTransformRandomAnimation : public PLScene::SceneNodeModifier {
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Animated transform component
+		*/
+		enum EComponent {
+			Position = 0,	/**< Position */
+			Rotation = 1,	/**< Rotation (Euler angles in degree) */
+			Scale    = 2	/**< Scale */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ RTTI interface                                        ]
+	//[-------------------------------------------------------]
+	pl_class_def()
+		// Attributes
+		pl_attribute_getset(SNMTransformRandomAnimation,	Speed,	float,	0.01f,	ReadWrite)
+		pl_attribute_getset(SNMTransformRandomAnimation,	Radius,	float,	0.01f,	ReadWrite)
+	pl_class_def_end
+
+
+	//[-------------------------------------------------------]
+	//[ Public RTTI get/set functions                         ]
+	//[-------------------------------------------------------]
+	public:
+		float GetSpeed() const;
+		void SetSpeed(float fValue);
+		float GetRadius() const;
+		void SetRadius(float fValue);
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Returns the animated transform component
+		*
+		*  @return
+		*    The animated transform component
+		*/
+		EComponent GetComponent() const;
+
+
+	//[-------------------------------------------------------]
+	//[ Protected functions                                   ]
+	//[-------------------------------------------------------]
+	protected:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cSceneNode
+		*    Owner scene node
+		*  @param[in] nComponent
+		*    Animated transform component
+		*/
+		SNMTransformRandomAnimation(PLScene::SceneNode &cSceneNode, EComponent nComponent);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		virtual ~SNMTransformRandomAnimation();
+
+
+	//[-------------------------------------------------------]
+	//[ Protected virtual PLScene::SceneNodeModifier functions]
+	//[-------------------------------------------------------]
+	protected:
+		virtual void OnActivate(bool bActivate) override;
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		EComponent m_nComponent;	/**< Animated transform component */
+		float	   m_fSpeed;		/**< Animation speed */
+		float	   m_fRadius;		/**< Animation radius */
+		bool	   m_bActive;		/**< Registered within the transform animation manager? */
+
+
+};
+
+
+#endif // __DUNGEON_TRANSFORMRANDOMANIMATION_H__
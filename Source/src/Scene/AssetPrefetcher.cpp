@@ -0,0 +1,345 @@
+/*********************************************************\
+ *  File: AssetPrefetcher.cpp                            *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Xml/Xml.h>
+#include <PLCore/File/File.h>
+#include <PLCore/System/System.h>
+#include <PLCore/Core/MemoryManager.h>
+#include <PLCore/Tools/LoadableManager.h>
+#include "Tools/WorkerPool.h"
+#include "Scene/AssetPrefetcher.h"
+#include "Scene/SceneLoadReport.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+static const uint32 ReadBufferSize     = 256*1024;	/**< Size of the read buffer, the head of a file must fit into it for the dependency scan */
+static const uint32 MeshChunkMeshFile  = 0x0001;		/**< PixelLight mesh file: Mesh file chunk ID */
+static const uint32 MeshChunkMaterials = 0x0010;		/**< PixelLight mesh file: Materials chunk ID */
+static const uint32 MeshMagic          = 0x57754631;	/**< PixelLight mesh file: Magic number */
+static const uint32 MaterialNameSize   = 256;		/**< PixelLight mesh file: Size of a material name */
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Job prefetching a single asset
+*/
+class AssetPrefetchJob : public WorkerPool::Job {
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cPrefetcher
+		*    Owner asset prefetcher
+		*  @param[in] sFilename
+		*    Filename of the asset to prefetch
+		*/
+		AssetPrefetchJob(AssetPrefetcher &cPrefetcher, const String &sFilename) :
+			m_pPrefetcher(&cPrefetcher),
+			m_sFilename(sFilename)
+		{
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Public virtual WorkerPool::Job functions              ]
+	//[-------------------------------------------------------]
+	public:
+		virtual void Execute() override
+		{
+			m_pPrefetcher->ProcessAsset(m_sFilename);
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		AssetPrefetcher *m_pPrefetcher;	/**< Owner asset prefetcher, always valid */
+		String			 m_sFilename;	/**< Filename of the asset to prefetch */
+
+
+};
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+AssetPrefetcher::AssetPrefetcher(WorkerPool &cWorkerPool) :
+	m_pWorkerPool(&cWorkerPool),
+	m_nNumOfProcessedAssets(0),
+	m_nNumOfRunningJobs(0),
+	m_nNumOfReadBytes(0),
+	m_bCancelled(false)
+{
+	// Copy the base directories, the loadable manager must only be used by the main thread
+	LoadableManager *pLoadableManager = LoadableManager::GetInstance();
+	for (uint32 i=0; i<pLoadableManager->GetNumOfBaseDirs(); i++)
+		m_lstBaseDirectories.Add(pLoadableManager->GetBaseDir(i));
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+AssetPrefetcher::~AssetPrefetcher()
+{
+	// Skip the remaining assets
+	m_cMutex.Lock();
+	m_bCancelled = true;
+	m_cMutex.Unlock();
+
+	// Wait for the jobs of this prefetcher, they reference this instance
+	for (;;) {
+		m_cMutex.Lock();
+		const uint32 nNumOfRunningJobs = m_nNumOfRunningJobs;
+		m_cMutex.Unlock();
+		if (!nNumOfRunningJobs)
+			break;
+		System::GetInstance()->Sleep(1);
+	}
+}
+
+/**
+*  @brief
+*    Prefetches an asset and its dependencies
+*/
+void AssetPrefetcher::Prefetch(const String &sFilename)
+{
+	// Unify the filename so each asset is just known once
+	String sAsset = sFilename;
+	sAsset.Replace('\\', '/');
+
+	// Add the job, if the asset is not known yet
+	m_cMutex.Lock();
+	const bool bNew = (!m_bCancelled && sAsset.GetLength() && !m_lstAssets.IsElement(sAsset));
+	if (bNew) {
+		m_lstAssets.Add(sAsset);
+		m_nNumOfRunningJobs++;
+	}
+	m_cMutex.Unlock();
+	if (bNew)
+		m_pWorkerPool->AddJob(*new AssetPrefetchJob(*this, sAsset));
+}
+
+/**
+*  @brief
+*    Returns the prefetch progress
+*/
+float AssetPrefetcher::GetProgress()
+{
+	m_cMutex.Lock();
+	const float fProgress = m_lstAssets.GetNumOfElements() ? static_cast<float>(m_nNumOfProcessedAssets)/m_lstAssets.GetNumOfElements() : 1.0f;
+	m_cMutex.Unlock();
+	return fProgress;
+}
+
+/**
+*  @brief
+*    Returns the number of already read bytes
+*/
+uint64 AssetPrefetcher::GetNumOfReadBytes()
+{
+	m_cMutex.Lock();
+	const uint64 nNumOfReadBytes = m_nNumOfReadBytes;
+	m_cMutex.Unlock();
+	return nNumOfReadBytes;
+}
+
+/**
+*  @brief
+*    Returns whether or not all known assets are processed
+*/
+bool AssetPrefetcher::IsFinished()
+{
+	m_cMutex.Lock();
+	const bool bFinished = (m_nNumOfProcessedAssets == m_lstAssets.GetNumOfElements());
+	m_cMutex.Unlock();
+	return bFinished;
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+AssetPrefetcher::AssetPrefetcher(const AssetPrefetcher &cSource) :
+	m_pWorkerPool(nullptr),
+	m_nNumOfProcessedAssets(0),
+	m_nNumOfRunningJobs(0),
+	m_nNumOfReadBytes(0),
+	m_bCancelled(false)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+AssetPrefetcher &AssetPrefetcher::operator =(const AssetPrefetcher &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Processes an asset, called by the worker threads
+*/
+void AssetPrefetcher::ProcessAsset(const String &sFilename)
+{
+	// Cancelled?
+	m_cMutex.Lock();
+	const bool bCancelled = m_bCancelled;
+	m_cMutex.Unlock();
+
+	const uint64 nStartTime = System::GetInstance()->GetMicroseconds();
+	uint32 nReadBytes = 0;
+	File cFile;
+	if (!bCancelled && OpenAsset(sFilename, cFile)) {
+		const String sExtension = Url(sFilename).GetExtension().ToLower();
+		if (sExtension == "mat") {
+			// Materials are tiny, parse them right away
+			nReadBytes = cFile.GetSize();
+			PrefetchMaterialDependencies(cFile);
+		} else {
+			// Read the whole file, this brings it into the operation system file cache
+			uint8 *pBuffer = new uint8[ReadBufferSize];
+			uint32 nRead = cFile.Read(pBuffer, 1, ReadBufferSize);
+			if (sExtension == "mesh")
+				PrefetchMeshDependencies(pBuffer, nRead);
+			while (nRead) {
+				nReadBytes += nRead;
+				nRead = cFile.Read(pBuffer, 1, ReadBufferSize);
+			}
+			delete [] pBuffer;
+
+			// Textures may come with a texture parameter file
+			if (sExtension == "dds" || sExtension == "png" || sExtension == "tga" || sExtension == "jpg")
+				Prefetch(Url(sFilename).CutExtension() + ".plt");
+		}
+		cFile.Close();
+
+		// The read time includes the dependency scan, but not the prefetching of the dependencies as they are separate jobs
+		SceneLoadReport::AddAssetRead(sFilename, System::GetInstance()->GetMicroseconds() - nStartTime, nReadBytes);
+	}
+
+	// Done
+	m_cMutex.Lock();
+	m_nNumOfProcessedAssets++;
+	m_nNumOfRunningJobs--;
+	m_nNumOfReadBytes += nReadBytes;
+	m_cMutex.Unlock();
+}
+
+/**
+*  @brief
+*    Opens an asset by using the base directories
+*/
+bool AssetPrefetcher::OpenAsset(const String &sFilename, File &cFile) const
+{
+	// Try the filename as it is
+	cFile.Assign(sFilename);
+	if (cFile.Open(File::FileRead))
+		return true;
+
+	// Try the base directories
+	for (uint32 i=0; i<m_lstBaseDirectories.GetNumOfElements(); i++) {
+		cFile.Assign(m_lstBaseDirectories[i] + '/' + sFilename);
+		if (cFile.Open(File::FileRead))
+			return true;
+	}
+
+	// Error!
+	return false;
+}
+
+/**
+*  @brief
+*    Prefetches the materials of a mesh
+*/
+void AssetPrefetcher::PrefetchMeshDependencies(const uint8 *pData, uint32 nSize)
+{
+	// Mesh file chunk: uint32 ID, uint32 size, uint32 magic, uint32 version - followed by the sub chunks, the first one
+	// is the materials chunk: uint32 ID, uint32 size, uint32 number of materials, char[256] per material
+	uint32 nHeader[7];
+	if (nSize >= sizeof(nHeader)) {
+		MemoryManager::Copy(nHeader, pData, sizeof(nHeader));
+		if (nHeader[0] == MeshChunkMeshFile && nHeader[2] == MeshMagic && nHeader[4] == MeshChunkMaterials) {
+			const uint32 nNumOfMaterials = nHeader[6];
+			for (uint32 i=0; i<nNumOfMaterials && sizeof(nHeader) + (i + 1)*MaterialNameSize <= nSize; i++) {
+				const char *pszName = reinterpret_cast<const char*>(pData + sizeof(nHeader) + i*MaterialNameSize);
+				uint32 nLength = 0;
+				while (nLength < MaterialNameSize && pszName[nLength] != '\0')
+					nLength++;
+				if (nLength && nLength < MaterialNameSize)
+					Prefetch(String(pszName, true, nLength));
+			}
+		}
+	}
+}
+
+/**
+*  @brief
+*    Prefetches the textures and effects of a material
+*/
+void AssetPrefetcher::PrefetchMaterialDependencies(File &cFile)
+{
+	XmlDocument cDocument;
+	if (cDocument.Load(cFile)) {
+		const XmlElement *pMaterialElement = cDocument.GetFirstChildElement("Material");
+		if (pMaterialElement) {
+			for (const XmlElement *pElement=pMaterialElement->GetFirstChildElement(); pElement; pElement=pElement->GetNextSiblingElement()) {
+				const String sValue = pElement->GetValue();
+				if (sValue == "Texture" || sValue == "Effect")
+					Prefetch(pElement->GetText());
+			}
+		}
+	}
+}
@@ -0,0 +1,224 @@
+/*********************************************************\
+ *  File: AssetPrefetcher.h                              *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_ASSETPREFETCHER_H__
+#define __DUNGEON_ASSETPREFETCHER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include <PLCore/System/Mutex.h>
+#include <PLCore/Container/Array.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLCore {
+	class File;
+}
+class WorkerPool;
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Asset prefetcher
+*
+*  @remarks
+*    Reads assets on worker threads ahead of the main thread so the main thread finds them within the
+*    operation system file cache. Dependencies are discovered on the worker threads as well: meshes are
+*    scanned for the materials they use and materials for their textures and effects, texture parameter
+*    files (".plt") are prefetched together with their textures.
+*
+*    The final decoding and the upload to the renderer stay on the main thread because the PixelLight
+*    resource managers and the renderer must only be used by the main thread.
+*/
+class AssetPrefetcher {
+
+
+	//[-------------------------------------------------------]
+	//[ Friends                                               ]
+	//[-------------------------------------------------------]
+	friend class AssetPrefetchJob;
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cWorkerPool
+		*    Worker pool to use, must stay valid as long as the prefetcher exists
+		*
+		*  @note
+		*    - Must be called by the main thread, the base directories of the loadable manager are copied
+		*/
+		AssetPrefetcher(WorkerPool &cWorkerPool);
+
+		/**
+		*  @brief
+		*    Destructor
+		*
+		*  @note
+		*    - Assets which are not read yet are skipped, blocks until the running prefetch jobs are finished
+		*/
+		~AssetPrefetcher();
+
+		/**
+		*  @brief
+		*    Prefetches an asset and its dependencies
+		*
+		*  @param[in] sFilename
+		*    Filename of the asset (e.g. "Data\Meshes\Dungeon\kanal2_Stones.mesh"), relative to a base directory
+		*
+		*  @note
+		*    - Each asset is prefetched just once, further requests are ignored
+		*/
+		void Prefetch(const PLCore::String &sFilename);
+
+		/**
+		*  @brief
+		*    Returns the prefetch progress
+		*
+		*  @return
+		*    The prefetch progress (0.0-1.0), 1.0 if there's nothing to prefetch
+		*
+		*  @note
+		*    - As dependencies are discovered while prefetching the progress may go down
+		*/
+		float GetProgress();
+
+		/**
+		*  @brief
+		*    Returns the number of already read bytes
+		*
+		*  @return
+		*    The number of already read bytes
+		*/
+		PLCore::uint64 GetNumOfReadBytes();
+
+		/**
+		*  @brief
+		*    Returns whether or not all known assets are processed
+		*
+		*  @return
+		*    'true' if all known assets are processed, else 'false'
+		*/
+		bool IsFinished();
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		AssetPrefetcher(const AssetPrefetcher &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		AssetPrefetcher &operator =(const AssetPrefetcher &cSource);
+
+		/**
+		*  @brief
+		*    Processes an asset, called by the worker threads
+		*
+		*  @param[in] sFilename
+		*    Filename of the asset
+		*/
+		void ProcessAsset(const PLCore::String &sFilename);
+
+		/**
+		*  @brief
+		*    Opens an asset by using the base directories
+		*
+		*  @param[in]  sFilename
+		*    Filename of the asset
+		*  @param[out] cFile
+		*    Receives the opened file
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool OpenAsset(const PLCore::String &sFilename, PLCore::File &cFile) const;
+
+		/**
+		*  @brief
+		*    Prefetches the materials of a mesh
+		*
+		*  @param[in] pData
+		*    Start of the mesh file
+		*  @param[in] nSize
+		*    Number of valid bytes
+		*/
+		void PrefetchMeshDependencies(const PLCore::uint8 *pData, PLCore::uint32 nSize);
+
+		/**
+		*  @brief
+		*    Prefetches the textures and effects of a material
+		*
+		*  @param[in] cFile
+		*    Opened material file
+		*/
+		void PrefetchMaterialDependencies(PLCore::File &cFile);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		WorkerPool					  *m_pWorkerPool;				/**< Worker pool to use, always valid */
+		PLCore::Array<PLCore::String>  m_lstBaseDirectories;		/**< Copy of the loadable manager base directories */
+		PLCore::Mutex				   m_cMutex;					/**< Mutex protecting the following data */
+		PLCore::Array<PLCore::String>  m_lstAssets;					/**< Known assets */
+		PLCore::uint32				   m_nNumOfProcessedAssets;		/**< Number of processed assets */
+		PLCore::uint32				   m_nNumOfRunningJobs;			/**< Number of queued and running jobs of this prefetcher */
+		PLCore::uint64				   m_nNumOfReadBytes;			/**< Number of read bytes */
+		bool						   m_bCancelled;				/**< Skip the remaining assets? */
+
+
+};
+
+
+#endif // __DUNGEON_ASSETPREFETCHER_H__
@@ -0,0 +1,257 @@
+/*********************************************************\
+ *  File: AttributeHandle.cpp                            *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Base/Class.h>
+#include <PLCore/Base/Var/Var.h>
+#include <PLCore/Base/Var/VarDesc.h>
+#include <PLMath/Type/TypeVector2.h>
+#include <PLMath/Type/TypeVector2i.h>
+#include <PLMath/Type/TypeVector3.h>
+#include <PLGraphics/Type/TypeColor3.h>
+#include <PLGraphics/Type/TypeColor4.h>
+#include <PLScene/Scene/SceneNode.h>
+#include "Scene/AttributeHandle.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+using namespace PLGraphics;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+AttributeHandle::AttributeHandle(const String &sName) :
+	m_sName(sName),
+	m_pClass(nullptr),
+	m_pVarDesc(nullptr),
+	m_nTarget(Attribute)
+{
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+AttributeHandle::~AttributeHandle()
+{
+}
+
+/**
+*  @brief
+*    Returns the attribute name
+*/
+const String &AttributeHandle::GetName() const
+{
+	return m_sName;
+}
+
+/**
+*  @brief
+*    Sets a float attribute
+*/
+bool AttributeHandle::SetFloat(Object &cObject, float fValue)
+{
+	DynVar *pDynVar = GetAttribute(cObject);
+	if (pDynVar) {
+		pDynVar->SetFloat(fValue);
+
+		// Done
+		return true;
+	}
+
+	// Error!
+	return false;
+}
+
+/**
+*  @brief
+*    Sets an integer attribute
+*/
+bool AttributeHandle::SetInt(Object &cObject, int nValue)
+{
+	DynVar *pDynVar = GetAttribute(cObject);
+	if (pDynVar) {
+		pDynVar->SetInt(nValue);
+
+		// Done
+		return true;
+	}
+
+	// Error!
+	return false;
+}
+
+/**
+*  @brief
+*    Sets a two component float vector attribute
+*/
+bool AttributeHandle::SetVector2(Object &cObject, const Vector2 &vValue)
+{
+	DynVar *pDynVar = GetAttribute(cObject);
+	if (pDynVar) {
+		pDynVar->SetVar(Var<Vector2>(vValue));
+
+		// Done
+		return true;
+	}
+
+	// Error!
+	return false;
+}
+
+/**
+*  @brief
+*    Sets a two component integer vector attribute
+*/
+bool AttributeHandle::SetVector2i(Object &cObject, const Vector2i &vValue)
+{
+	DynVar *pDynVar = GetAttribute(cObject);
+	if (pDynVar) {
+		pDynVar->SetVar(Var<Vector2i>(vValue));
+
+		// Done
+		return true;
+	}
+
+	// Error!
+	return false;
+}
+
+/**
+*  @brief
+*    Sets a three component float vector attribute
+*/
+bool AttributeHandle::SetVector3(Object &cObject, const Vector3 &vValue)
+{
+	DynVar *pDynVar = GetAttribute(cObject);
+	if (pDynVar) {
+		// The transform of a scene node is written directly, this doesn't even touch the RTTI
+		switch (m_nTarget) {
+			case Attribute:
+				pDynVar->SetVar(Var<Vector3>(vValue));
+				break;
+
+			case Position:
+				static_cast<SceneNode&>(cObject).SetPosition(vValue);
+				break;
+
+			case Rotation:
+				static_cast<SceneNode&>(cObject).SetRotation(vValue);
+				break;
+
+			case Scale:
+				static_cast<SceneNode&>(cObject).SetScale(vValue);
+				break;
+		}
+
+		// Done
+		return true;
+	}
+
+	// Error!
+	return false;
+}
+
+/**
+*  @brief
+*    Sets a color attribute
+*/
+bool AttributeHandle::SetColor(Object &cObject, const Color4 &cValue)
+{
+	DynVar *pDynVar = GetAttribute(cObject);
+	if (pDynVar) {
+		// The variable has to be of the attribute type, else the value would be converted through a string
+		if (pDynVar->GetTypeID() == Type<Color3>::TypeID)
+			pDynVar->SetVar(Var<Color3>(Color3(cValue.r, cValue.g, cValue.b)));
+		else
+			pDynVar->SetVar(Var<Color4>(cValue));
+
+		// Done
+		return true;
+	}
+
+	// Error!
+	return false;
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+AttributeHandle::AttributeHandle(const AttributeHandle &cSource)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+AttributeHandle &AttributeHandle::operator =(const AttributeHandle &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Returns the attribute of an object
+*/
+DynVar *AttributeHandle::GetAttribute(Object &cObject)
+{
+	// Look the descriptor up, if the object is of another class than the previous one
+	const Class *pClass = cObject.GetClass();
+	if (pClass != m_pClass) {
+		m_pClass   = pClass;
+		m_pVarDesc = pClass ? pClass->GetAttribute(m_sName) : nullptr;
+
+		// The transform attributes of scene nodes have typed setters
+		m_nTarget = Attribute;
+		if (pClass && pClass->IsDerivedFrom("PLScene::SceneNode")) {
+			if (m_sName == "Position")
+				m_nTarget = Position;
+			else if (m_sName == "Rotation")
+				m_nTarget = Rotation;
+			else if (m_sName == "Scale")
+				m_nTarget = Scale;
+		}
+	}
+
+	// Attributes described by the class are members of the object, the descriptor returns them without a lookup
+	return m_pVarDesc ? m_pVarDesc->GetAttribute(cObject) : cObject.GetAttribute(m_sName);
+}
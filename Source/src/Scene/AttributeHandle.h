@@ -0,0 +1,263 @@
+/*********************************************************\
+ *  File: AttributeHandle.h                              *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_ATTRIBUTEHANDLE_H__
+#define __DUNGEON_ATTRIBUTEHANDLE_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLCore {
+	class Class;
+	class Object;
+	class DynVar;
+	class VarDesc;
+}
+namespace PLMath {
+	class Vector2;
+	class Vector2i;
+	class Vector3;
+}
+namespace PLGraphics {
+	class Color4;
+}
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Attribute handle, writes RTTI attributes typed instead of through strings
+*
+*  @remarks
+*    "Object::SetAttribute()" looks the attribute up by its name each time and, for anything but a string, formats the
+*    value into a string which the attribute parses again - per frame writes like the parameters of a post process
+*    effect pay for this every frame. A handle looks the attribute descriptor up once per class and writes through the
+*    typed interface of the attribute afterwards:
+*    - Floats and integers are written through "DynVar::SetFloat()" and "DynVar::SetInt()"
+*    - Vectors and colors are passed into "DynVar::SetVar()" as variable of the attribute type
+*    - "Position", "Rotation" and "Scale" of scene nodes are written through the transform setters of the scene node
+*
+*    The handle only remembers the class and not the object, so one handle can be used for any number of objects of the
+*    same class and it can't dangle when an object is destroyed. When it's used with an object of another class, the
+*    descriptor is looked up again. Attributes which are not described by the class (e.g. dynamic ones) are looked up by
+*    name each time, but are still written typed.
+*
+*  @note
+*    - Scripts use handles through the application (see "Application::GetAttributeHandle()")
+*/
+class AttributeHandle {
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] sName
+		*    Attribute name (e.g. "EffectWeight")
+		*/
+		AttributeHandle(const PLCore::String &sName);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		~AttributeHandle();
+
+		/**
+		*  @brief
+		*    Returns the attribute name
+		*
+		*  @return
+		*    The attribute name
+		*/
+		const PLCore::String &GetName() const;
+
+		/**
+		*  @brief
+		*    Sets a float attribute
+		*
+		*  @param[in] cObject
+		*    Object to set the attribute of
+		*  @param[in] fValue
+		*    Value to set
+		*
+		*  @return
+		*    'true' if all went fine, else 'false' (the object has no such attribute)
+		*/
+		bool SetFloat(PLCore::Object &cObject, float fValue);
+
+		/**
+		*  @brief
+		*    Sets an integer attribute
+		*
+		*  @param[in] cObject
+		*    Object to set the attribute of
+		*  @param[in] nValue
+		*    Value to set
+		*
+		*  @return
+		*    'true' if all went fine, else 'false' (the object has no such attribute)
+		*/
+		bool SetInt(PLCore::Object &cObject, int nValue);
+
+		/**
+		*  @brief
+		*    Sets a two component float vector attribute
+		*
+		*  @param[in] cObject
+		*    Object to set the attribute of
+		*  @param[in] vValue
+		*    Value to set
+		*
+		*  @return
+		*    'true' if all went fine, else 'false' (the object has no such attribute)
+		*/
+		bool SetVector2(PLCore::Object &cObject, const PLMath::Vector2 &vValue);
+
+		/**
+		*  @brief
+		*    Sets a two component integer vector attribute
+		*
+		*  @param[in] cObject
+		*    Object to set the attribute of
+		*  @param[in] vValue
+		*    Value to set
+		*
+		*  @return
+		*    'true' if all went fine, else 'false' (the object has no such attribute)
+		*/
+		bool SetVector2i(PLCore::Object &cObject, const PLMath::Vector2i &vValue);
+
+		/**
+		*  @brief
+		*    Sets a three component float vector attribute
+		*
+		*  @param[in] cObject
+		*    Object to set the attribute of
+		*  @param[in] vValue
+		*    Value to set
+		*
+		*  @return
+		*    'true' if all went fine, else 'false' (the object has no such attribute)
+		*/
+		bool SetVector3(PLCore::Object &cObject, const PLMath::Vector3 &vValue);
+
+		/**
+		*  @brief
+		*    Sets a color attribute
+		*
+		*  @param[in] cObject
+		*    Object to set the attribute of
+		*  @param[in] cValue
+		*    Value to set, alpha is ignored for RGB color attributes
+		*
+		*  @return
+		*    'true' if all went fine, else 'false' (the object has no such attribute)
+		*/
+		bool SetColor(PLCore::Object &cObject, const PLGraphics::Color4 &cValue);
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Where the attribute is written to
+		*/
+		enum ETarget {
+			Attribute,	/**< The RTTI attribute */
+			Position,	/**< The position of a scene node */
+			Rotation,	/**< The rotation (Euler angles in degree) of a scene node */
+			Scale		/**< The scale of a scene node */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		AttributeHandle(const AttributeHandle &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		AttributeHandle &operator =(const AttributeHandle &cSource);
+
+		/**
+		*  @brief
+		*    Returns the attribute of an object
+		*
+		*  @param[in] cObject
+		*    Object to return the attribute of
+		*
+		*  @return
+		*    The attribute, a null pointer if the object has no such attribute
+		*
+		*  @note
+		*    - Updates the cached class, descriptor and target if the object is of another class than the previous one
+		*/
+		PLCore::DynVar *GetAttribute(PLCore::Object &cObject);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::String		   m_sName;		/**< Attribute name */
+		const PLCore::Class	  *m_pClass;	/**< Class the descriptor was looked up for, can be a null pointer */
+		const PLCore::VarDesc *m_pVarDesc;	/**< Attribute descriptor of the class, a null pointer if the class doesn't describe the attribute */
+		ETarget				   m_nTarget;	/**< Where the attribute is written to */
+
+
+};
+
+
+#endif // __DUNGEON_ATTRIBUTEHANDLE_H__
@@ -0,0 +1,372 @@
+/*********************************************************\
+ *  File: CamcorderPrefetcher.cpp                        *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/Tools/Chunk.h>
+#include <PLCore/Tools/Timing.h>
+#include <PLMath/Vector3.h>
+#include <PLMath/Matrix3x4.h>
+#include <PLMath/AABoundingBox.h>
+#include <PLScene/Scene/SNMesh.h>
+#include <PLScene/Scene/SceneContainer.h>
+#include <PLScene/Scene/SceneNodeModifier.h>
+#include "Tools/CamcorderTrack.h"
+#include "Scene/CellStreamer.h"
+#include "Scene/AssetPrefetcher.h"
+#include "Scene/CamcorderPrefetcher.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+static const uint32 NumOfMeshesPerFrame = 8;	/**< Maximum number of meshes loaded per frame while preparing a cell */
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+CamcorderPrefetcher::CamcorderPrefetcher(SceneContainer &cSceneContainer, CellStreamer *pCellStreamer, float fLookAheadTime, WorkerPool &cWorkerPool) :
+	m_pCellStreamer(pCellStreamer),
+	m_fLookAheadTime(fLookAheadTime),
+	m_pWorkerPool(&cWorkerPool),
+	m_pModifier(nullptr),
+	m_bTrack(false),
+	m_fFramesPerSecond(0.0f),
+	m_fFrame(0.0f),
+	m_nNextCellEntry(0),
+	m_nNextMeshNode(0),
+	m_pPrefetcher(nullptr)
+{
+	// Get the cells
+	CollectCells(cSceneContainer);
+	m_lstPrepared.Resize(m_lstCells.GetNumOfElements());
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+CamcorderPrefetcher::~CamcorderPrefetcher()
+{
+	// Stop following the playback, running prefetches are stopped
+	StopPlayback();
+}
+
+/**
+*  @brief
+*    Returns the number of cells
+*/
+uint32 CamcorderPrefetcher::GetNumOfCells() const
+{
+	return m_lstCells.GetNumOfElements();
+}
+
+/**
+*  @brief
+*    Updates the prefetching, call this once per frame
+*/
+void CamcorderPrefetcher::Update(SceneNode *pCamera)
+{
+	// Did the camcorder start or stop a playback? The camcorder adds the keyframe animation modifiers to the camera while
+	// playing, the track camcorder (see "TrackCamcorder") the track modifier.
+	SceneNodeModifier *pModifier = pCamera ? pCamera->GetModifier("SNMCamcorderTrack") : nullptr;
+	const bool bTrack = (pModifier != nullptr);
+	if (!pModifier && pCamera)
+		pModifier = pCamera->GetModifier("PLScene::SNMPositionKeyframeAnimation");
+	const DynVar *pKeys = pModifier ? pModifier->GetAttribute(bTrack ? "Track" : "Keys") : nullptr;
+	if (pModifier != m_pModifier || (pKeys && pKeys->GetString() != m_sKeys)) {
+		StopPlayback();
+		if (pModifier)
+			StartPlayback(*pCamera, *pModifier, bTrack);
+	}
+	if (!m_pModifier)
+		return;
+
+	// Advance the playhead the same way the modifier does
+	if (m_bTrack) {
+		// The track can be seeked at any time, so the playhead follows the time of the track modifier
+		const DynVar *pTime = pModifier->GetAttribute("Time");
+		const float fFrame = pTime ? pTime->GetFloat()*m_fFramesPerSecond : m_fFrame;
+		if (fFrame < m_fFrame || fFrame > m_fFrame + m_fLookAheadTime*m_fFramesPerSecond)
+			Seek(fFrame);
+		else
+			m_fFrame = fFrame;
+	} else {
+		m_fFrame += Timing::GetInstance()->GetTimeDifference()*m_fFramesPerSecond;
+	}
+
+	// Queue the cells the camera enters within the look-ahead time
+	const float fLastFrame = m_fFrame + m_fLookAheadTime*m_fFramesPerSecond;
+	while (m_nNextCellEntry < m_lstCellEntries.GetNumOfElements() && m_lstCellEntries[m_nNextCellEntry].fFrame <= fLastFrame) {
+		const uint32 nCell = m_lstCellEntries[m_nNextCellEntry].nCell;
+		if (!m_lstPrepared[nCell]) {
+			m_lstPrepared[nCell] = true;
+			m_lstQueue.Add(nCell);
+		}
+		m_nNextCellEntry++;
+	}
+
+	// Continue preparing the queued cells
+	ContinuePrefetching();
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+CamcorderPrefetcher::CamcorderPrefetcher(const CamcorderPrefetcher &cSource) :
+	m_pCellStreamer(nullptr),
+	m_fLookAheadTime(0.0f),
+	m_pWorkerPool(nullptr),
+	m_pModifier(nullptr),
+	m_bTrack(false),
+	m_fFramesPerSecond(0.0f),
+	m_fFrame(0.0f),
+	m_nNextCellEntry(0),
+	m_nNextMeshNode(0),
+	m_pPrefetcher(nullptr)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+CamcorderPrefetcher &CamcorderPrefetcher::operator =(const CamcorderPrefetcher &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Collects the cells of a scene container and its children
+*/
+void CamcorderPrefetcher::CollectCells(SceneContainer &cContainer)
+{
+	for (uint32 i=0; i<cContainer.GetNumOfElements(); i++) {
+		SceneNode *pSceneNode = cContainer.GetByIndex(i);
+		if (pSceneNode && pSceneNode->IsContainer()) {
+			if (pSceneNode->IsInstanceOf("PLScene::SCCell"))
+				m_lstCells.Add(static_cast<SceneContainer*>(pSceneNode));
+			else
+				CollectCells(static_cast<SceneContainer&>(*pSceneNode));
+		}
+	}
+}
+
+/**
+*  @brief
+*    Starts following a camcorder playback
+*/
+void CamcorderPrefetcher::StartPlayback(SceneNode &cCamera, SceneNodeModifier &cModifier, bool bTrack)
+{
+	// The playback is followed even if the keys can't be used, so they are not loaded once again each frame
+	m_pModifier = &cModifier;
+	m_bTrack    = bTrack;
+	m_sKeys     = cModifier.GetAttribute(bTrack ? "Track" : "Keys") ? cModifier.GetAttribute(bTrack ? "Track" : "Keys")->GetString() : "";
+	if (!m_lstCells.GetNumOfElements())
+		return;
+
+	// Get the transform from the coordinate system of the keys into the coordinate system of the cells (the cells are usually within the physics world)
+	const String sCoordinateSystem = cModifier.GetAttribute("CoordinateSystem") ? cModifier.GetAttribute("CoordinateSystem")->GetString() : "";
+	SceneNode *pCoordinateSystem = (cCamera.GetContainer() && sCoordinateSystem.GetLength()) ? cCamera.GetContainer()->GetByName(sCoordinateSystem) : cCamera.GetContainer();
+	SceneContainer *pCellParent = m_lstCells[0]->GetContainer();
+	Matrix3x4 mTransform;
+	mTransform.SetIdentity();
+	if (!pCoordinateSystem || !pCellParent || (pCoordinateSystem != pCellParent && !pCoordinateSystem->GetTransformMatrixTo(*pCellParent, mTransform))) {
+		PL_LOG(Warning, "Camcorder prefetch: Unknown coordinate system '" + sCoordinateSystem + "' of '" + m_sKeys + '\'')
+		return;
+	}
+
+	// Get the position of each frame
+	Array<Vector3> lstPositions;
+	if (bTrack) {
+		// Sample the track at its frames per second, the time of the track modifier already includes its speed
+		CamcorderTrack cTrack;
+		if (!cTrack.Open(m_sKeys)) {
+			PL_LOG(Warning, "Camcorder prefetch: Failed to open the track '" + m_sKeys + '\'')
+			return;
+		}
+		m_fFramesPerSecond = cTrack.GetFramesPerSecond();
+		lstPositions.Resize(static_cast<uint32>(cTrack.GetDuration()*m_fFramesPerSecond + 0.5f) + 1);
+		for (uint32 nFrame=0; nFrame<lstPositions.GetNumOfElements(); nFrame++)
+			cTrack.GetPosition(nFrame/m_fFramesPerSecond, lstPositions[nFrame]);
+	} else {
+		// Get the frames per second and the speed of the keyframe animation
+		m_fFramesPerSecond = cModifier.GetAttribute("FramesPerSecond") ? cModifier.GetAttribute("FramesPerSecond")->GetFloat() : 24.0f;
+		if (cModifier.GetAttribute("Speed"))
+			m_fFramesPerSecond *= cModifier.GetAttribute("Speed")->GetFloat();
+
+		// Load the position keys
+		Chunk cChunk;
+		if (!cChunk.LoadByFilename(m_sKeys) || cChunk.GetElementType() != Chunk::Float || cChunk.GetNumOfComponentsPerElement() != 3) {
+			PL_LOG(Warning, "Camcorder prefetch: Failed to load the position keys '" + m_sKeys + '\'')
+			return;
+		}
+		const float *pfPosition = reinterpret_cast<const float*>(cChunk.GetData());
+		lstPositions.Resize(cChunk.GetNumOfElements());
+		for (uint32 nFrame=0; nFrame<lstPositions.GetNumOfElements(); nFrame++, pfPosition+=3)
+			lstPositions[nFrame].SetXYZ(pfPosition[0], pfPosition[1], pfPosition[2]);
+	}
+
+	// Find the points of time the camera enters a cell
+	int nPreviousCell = -1;
+	for (uint32 nFrame=0; nFrame<lstPositions.GetNumOfElements(); nFrame++) {
+		const Vector3 vPosition = mTransform*lstPositions[nFrame];
+		for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+			const AABoundingBox &cBox = m_lstCells[i]->GetContainerAABoundingBox();
+			if (vPosition.x >= cBox.vMin.x && vPosition.y >= cBox.vMin.y && vPosition.z >= cBox.vMin.z &&
+				vPosition.x <= cBox.vMax.x && vPosition.y <= cBox.vMax.y && vPosition.z <= cBox.vMax.z) {
+				if (static_cast<int>(i) != nPreviousCell) {
+					SCellEntry sCellEntry;
+					sCellEntry.fFrame = static_cast<float>(nFrame);
+					sCellEntry.nCell  = i;
+					m_lstCellEntries.Add(sCellEntry);
+					nPreviousCell = i;
+				}
+				break;
+			}
+		}
+	}
+	PL_LOG(Info, String::Format("Camcorder prefetch: '%s' enters %u cells within %u frames", m_sKeys.GetASCII(), m_lstCellEntries.GetNumOfElements(), lstPositions.GetNumOfElements()))
+}
+
+/**
+*  @brief
+*    Continues following the camcorder playback at another point of time
+*/
+void CamcorderPrefetcher::Seek(float fFrame)
+{
+	// Stop preparing the cells of the previous point of time
+	if (m_pPrefetcher) {
+		delete m_pPrefetcher;
+		m_pPrefetcher = nullptr;
+	}
+	m_lstQueue.Clear();
+	for (uint32 i=0; i<m_lstPrepared.GetNumOfElements(); i++)
+		m_lstPrepared[i] = false;
+	m_lstMeshNodes.Clear();
+	m_nNextMeshNode = 0;
+
+	// Continue with the cell the camera is within at the new point of time
+	m_nNextCellEntry = 0;
+	while (m_nNextCellEntry+1 < m_lstCellEntries.GetNumOfElements() && m_lstCellEntries[m_nNextCellEntry+1].fFrame <= fFrame)
+		m_nNextCellEntry++;
+	m_fFrame = fFrame;
+}
+
+/**
+*  @brief
+*    Stops following the camcorder playback
+*/
+void CamcorderPrefetcher::StopPlayback()
+{
+	// Stop prefetching
+	if (m_pPrefetcher) {
+		delete m_pPrefetcher;
+		m_pPrefetcher = nullptr;
+	}
+
+	// Reset
+	m_pModifier = nullptr;
+	m_bTrack    = false;
+	m_sKeys     = "";
+	m_fFramesPerSecond = 0.0f;
+	m_fFrame           = 0.0f;
+	m_lstCellEntries.Clear();
+	m_nNextCellEntry = 0;
+	m_lstQueue.Clear();
+	for (uint32 i=0; i<m_lstPrepared.GetNumOfElements(); i++)
+		m_lstPrepared[i] = false;
+	m_lstMeshNodes.Clear();
+	m_nNextMeshNode = 0;
+}
+
+/**
+*  @brief
+*    Continues preparing the queued cells
+*/
+void CamcorderPrefetcher::ContinuePrefetching()
+{
+	if (!m_lstQueue.GetNumOfElements())
+		return;
+	SceneContainer &cCell = *m_lstCells[m_lstQueue[0]];
+
+	// If the cells are streamed, wait until the streamer has loaded the contents of the cell
+	if (m_pCellStreamer && !m_pCellStreamer->RequestCell(cCell))
+		return;
+
+	// Prefetch the meshes of the cell on worker threads, the prefetcher discovers their materials and textures
+	if (!m_pPrefetcher && !m_lstMeshNodes.GetNumOfElements()) {
+		m_pPrefetcher = new AssetPrefetcher(*m_pWorkerPool);
+		for (uint32 i=0; i<cCell.GetNumOfElements(); i++) {
+			SceneNode *pSceneNode = cCell.GetByIndex(i);
+			if (pSceneNode && pSceneNode->IsInstanceOf("PLScene::SNMesh") && pSceneNode->GetAttribute("Mesh")) {
+				m_lstMeshNodes.Add(pSceneNode->GetName());
+				m_pPrefetcher->Prefetch(pSceneNode->GetAttribute("Mesh")->GetString());
+			}
+		}
+	}
+
+	// Wait until the files are within the operation system file cache
+	if (m_pPrefetcher) {
+		if (!m_pPrefetcher->IsFinished())
+			return;
+		delete m_pPrefetcher;
+		m_pPrefetcher = nullptr;
+	}
+
+	// Load the meshes, time sliced - scene nodes are looked up by name because they may have been destroyed in the meantime
+	for (uint32 nNumOfMeshes=0; m_nNextMeshNode<m_lstMeshNodes.GetNumOfElements() && nNumOfMeshes<NumOfMeshesPerFrame; nNumOfMeshes++) {
+		SceneNode *pSceneNode = cCell.GetByName(m_lstMeshNodes[m_nNextMeshNode++]);
+		if (pSceneNode && pSceneNode->IsInstanceOf("PLScene::SNMesh"))
+			static_cast<SNMesh*>(pSceneNode)->GetMeshHandler();
+	}
+
+	// The cell is prepared, continue with the next one within the next frame
+	if (m_nNextMeshNode >= m_lstMeshNodes.GetNumOfElements()) {
+		m_lstQueue.RemoveAtIndex(0);
+		m_lstMeshNodes.Clear();
+		m_nNextMeshNode = 0;
+	}
+}
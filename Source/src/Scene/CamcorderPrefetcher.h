@@ -0,0 +1,233 @@
+/*********************************************************\
+ *  File: CamcorderPrefetcher.h                          *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_CAMCORDERPREFETCHER_H__
+#define __DUNGEON_CAMCORDERPREFETCHER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include <PLCore/Container/Array.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLScene {
+	class SceneNode;
+	class SceneContainer;
+	class SceneNodeModifier;
+}
+class WorkerPool;
+class CellStreamer;
+class AssetPrefetcher;
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Predictive prefetcher following the camcorder playback
+*
+*  @remarks
+*    While the camcorder plays a track (e.g. "Movie"), the camera position keys are known in advance. The prefetcher
+*    maps the upcoming position keys to the "PLScene::SCCell" containers of the scene and prepares each cell the camera
+*    will enter within the look-ahead time:
+*    - If the cells are streamed (see "CellStreamer"), the cell is requested from the streamer and loaded in the background
+*    - The meshes of the cell are prefetched on worker threads (see "AssetPrefetcher")
+*    - Finally, the meshes are loaded time sliced on the main thread, so they are ready before they become visible for the first time
+*
+*    The playback is detected by the "PLScene::SNMPositionKeyframeAnimation" modifier the camcorder adds to the camera,
+*    its "Keys" attribute names the position keys chunk. Tracks are detected by the "SNMCamcorderTrack" modifier the
+*    track camcorder (see "TrackCamcorder") adds to the camera, its "Track" attribute names the track.
+*/
+class CamcorderPrefetcher {
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cSceneContainer
+		*    Scene container the scene was loaded into, must stay valid as long as the prefetcher exists
+		*  @param[in] pCellStreamer
+		*    Cell streamer of the scene, can be a null pointer, must stay valid as long as the prefetcher exists
+		*  @param[in] fLookAheadTime
+		*    Look-ahead time in seconds
+		*  @param[in] cWorkerPool
+		*    Worker pool prefetching the meshes, must stay valid as long as the prefetcher exists
+		*/
+		CamcorderPrefetcher(PLScene::SceneContainer &cSceneContainer, CellStreamer *pCellStreamer, float fLookAheadTime, WorkerPool &cWorkerPool);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		~CamcorderPrefetcher();
+
+		/**
+		*  @brief
+		*    Returns the number of cells
+		*
+		*  @return
+		*    The number of cells, 0 if the scene has no cells (the prefetcher has nothing to do)
+		*/
+		PLCore::uint32 GetNumOfCells() const;
+
+		/**
+		*  @brief
+		*    Updates the prefetching, call this once per frame
+		*
+		*  @param[in] pCamera
+		*    The current camera, can be a null pointer
+		*/
+		void Update(PLScene::SceneNode *pCamera);
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Point of time the camera enters a cell
+		*/
+		struct SCellEntry {
+			float		   fFrame;	/**< Frame of the position keys */
+			PLCore::uint32 nCell;	/**< Index of the cell */
+
+			bool operator ==(const SCellEntry &sCellEntry) const
+			{
+				return (fFrame == sCellEntry.fFrame && nCell == sCellEntry.nCell);
+			}
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		CamcorderPrefetcher(const CamcorderPrefetcher &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		CamcorderPrefetcher &operator =(const CamcorderPrefetcher &cSource);
+
+		/**
+		*  @brief
+		*    Collects the cells of a scene container and its children
+		*
+		*  @param[in] cContainer
+		*    Scene container
+		*/
+		void CollectCells(PLScene::SceneContainer &cContainer);
+
+		/**
+		*  @brief
+		*    Starts following a camcorder playback
+		*
+		*  @param[in] cCamera
+		*    Camera the camcorder plays back on
+		*  @param[in] cModifier
+		*    Position keyframe animation modifier or track modifier (see "SNMCamcorderTrack") of the camera
+		*  @param[in] bTrack
+		*    'true' if "cModifier" is a track modifier, else 'false'
+		*/
+		void StartPlayback(PLScene::SceneNode &cCamera, PLScene::SceneNodeModifier &cModifier, bool bTrack);
+
+		/**
+		*  @brief
+		*    Continues following the camcorder playback at another point of time
+		*
+		*  @param[in] fFrame
+		*    New frame of the playback
+		*
+		*  @remarks
+		*    The cells the playhead jumped over are not prepared, the cells prepared so far may have been unloaded by
+		*    the streamer in the meantime, so they are prepared once again.
+		*/
+		void Seek(float fFrame);
+
+		/**
+		*  @brief
+		*    Stops following the camcorder playback
+		*/
+		void StopPlayback();
+
+		/**
+		*  @brief
+		*    Continues preparing the queued cells
+		*/
+		void ContinuePrefetching();
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		CellStreamer							 *m_pCellStreamer;		/**< Cell streamer, can be a null pointer */
+		float									  m_fLookAheadTime;		/**< Look-ahead time in seconds */
+		PLCore::Array<PLScene::SceneContainer*>	  m_lstCells;			/**< Cells, always valid */
+		WorkerPool								 *m_pWorkerPool;		/**< Worker pool used for prefetching, always valid (shared, not owned) */
+		// Playback
+		PLScene::SceneNodeModifier				 *m_pModifier;			/**< Position keyframe animation modifier or track modifier of the playback, null pointer if there's no playback (do not dereference) */
+		bool									  m_bTrack;				/**< Is "m_pModifier" a track modifier (see "SNMCamcorderTrack")? */
+		PLCore::String							  m_sKeys;				/**< Position keys chunk or track of the playback */
+		float									  m_fFramesPerSecond;	/**< Frames per second of the position keys */
+		float									  m_fFrame;				/**< Current frame of the playback */
+		PLCore::Array<SCellEntry>				  m_lstCellEntries;		/**< Points of time the camera enters a cell, ordered by time */
+		PLCore::uint32							  m_nNextCellEntry;		/**< Index of the next cell entry to queue */
+		// Cells to prepare
+		PLCore::Array<PLCore::uint32>			  m_lstQueue;			/**< Indices of the cells to prepare, the first one is prepared first */
+		PLCore::Array<bool>						  m_lstPrepared;		/**< Per cell: already prepared during this playback? */
+		PLCore::Array<PLCore::String>			  m_lstMeshNodes;		/**< Names of the mesh scene nodes of the cell which is prepared */
+		PLCore::uint32							  m_nNextMeshNode;		/**< Index of the next mesh scene node to load */
+		AssetPrefetcher							 *m_pPrefetcher;		/**< Asset prefetcher of the cell which is prepared, can be a null pointer */
+
+
+};
+
+
+#endif // __DUNGEON_CAMCORDERPREFETCHER_H__
@@ -0,0 +1,502 @@
+/*********************************************************\
+ *  File: CamcorderRecorder.cpp                          *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#ifdef WIN32
+	#include <PLCore/PLCoreWindowsIncludes.h>
+#endif
+#include <PLCore/Log/Log.h>
+#include <PLCore/Xml/Xml.h>
+#include <PLCore/File/File.h>
+#include <PLCore/File/Directory.h>
+#include <PLCore/System/Thread.h>
+#include <PLCore/Tools/Chunk.h>
+#include <PLCore/Tools/Timing.h>
+#include <PLMath/Matrix3x4.h>
+#include <PLScene/Scene/SceneContainer.h>
+#include "Tools/Profiler.h"
+#include "Scene/CamcorderRecorder.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+static const uint32 ChunkMagic		   = 0x57754632;	/**< Magic number of the chunk file format, see "PLCore::ChunkLoaderPL" */
+static const uint32 ChunkVersion	   = 0;				/**< Version of the chunk file format */
+static const uint32 ChunkBlockOverhead = 16;			/**< Size of the chunk block header (semantic, element type, components, elements) in bytes */
+
+
+//[-------------------------------------------------------]
+//[ Local functions                                       ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Full memory barrier, orders the accesses to the ring buffer and its indices between the main thread and the writer thread
+*/
+static inline void MemoryFence()
+{
+	#ifdef WIN32
+		MemoryBarrier();
+	#else
+		__sync_synchronize();
+	#endif
+}
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Writer thread of a camcorder recorder
+*/
+class CamcorderWriterThread : public Thread {
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cRecorder
+		*    Owner camcorder recorder
+		*/
+		CamcorderWriterThread(CamcorderRecorder &cRecorder) :
+			m_pRecorder(&cRecorder)
+		{
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Public virtual PLCore::ThreadFunction functions       ]
+	//[-------------------------------------------------------]
+	public:
+		virtual int Run() override
+		{
+			m_pRecorder->Write();
+
+			// Done
+			return 0;
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		CamcorderRecorder *m_pRecorder;	/**< Owner camcorder recorder, always valid */
+
+
+};
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+CamcorderRecorder::CamcorderRecorder(const String &sBaseDirectory) :
+	m_sBaseDirectory(sBaseDirectory),
+	m_fTime(0.0f),
+	m_nNumOfAddedKeys(0),
+	m_nNumOfDroppedKeys(0),
+	m_nNumOfPendingDroppedKeys(0),
+	m_pWriterThread(nullptr),
+	m_nWriteIndex(0),
+	m_nReadIndex(0),
+	m_bStop(false),
+	m_nNumOfTrailingDroppedKeys(0),
+	m_bWriting(false),
+	m_cSemaphore(0, 0x7FFFFFFF),
+	m_pPositionFile(nullptr),
+	m_pRotationFile(nullptr),
+	m_nNumOfWrittenKeys(0),
+	m_nNumOfBlockKeys(0)
+{
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+CamcorderRecorder::~CamcorderRecorder()
+{
+	StopRecord();
+	JoinWriter();
+}
+
+/**
+*  @brief
+*    Starts a recording
+*/
+bool CamcorderRecorder::StartRecord(const String &sName, SceneNode &cSceneNode)
+{
+	// Stop the running recording, the writer thread of the last recording is usually finished long ago
+	StopRecord();
+	JoinWriter();
+
+	// The scene node has to be within a scene container, the camcorder moves it back into this one for the playback
+	SceneContainer *pContainer = cSceneNode.GetContainer();
+	if (!sName.GetLength() || !pContainer)
+		return false;
+
+	// Like the camcorder, the positions are relative to the parent of the scene container - the scene node can move from cell to cell
+	m_sName			  = sName;
+	m_sSceneContainer = pContainer->GetAbsoluteName();
+	m_sSceneNode	  = cSceneNode.GetName();
+	SceneContainer *pCoordinateSystem = pContainer->GetContainer();
+	m_sCoordinateSystem = pCoordinateSystem ? "Parent" : "";
+	m_cCoordinateSystemHandler.SetElement(pCoordinateSystem);
+
+	// Reset the ring buffer, the writer thread is not running
+	m_fTime						= 0.0f;
+	m_nNumOfAddedKeys			= 0;
+	m_nNumOfDroppedKeys			= 0;
+	m_nNumOfPendingDroppedKeys	= 0;
+	m_nWriteIndex				= 0;
+	m_nReadIndex				= 0;
+	m_nNumOfTrailingDroppedKeys	= 0;
+	m_nNumOfWrittenKeys			= 0;
+	m_nNumOfBlockKeys			= 0;
+	m_bStop						= false;
+	m_bWriting					= true;
+
+	// Add the first key and start the writer thread
+	m_cSceneNodeHandler.SetElement(&cSceneNode);
+	AddKey(cSceneNode);
+	m_pWriterThread = new CamcorderWriterThread(*this);
+	m_pWriterThread->Start();
+
+	// Done
+	PL_LOG(Info, "Camcorder recorder: Started recording '" + m_sName + '\'')
+	return true;
+}
+
+/**
+*  @brief
+*    Stops the recording
+*/
+void CamcorderRecorder::StopRecord()
+{
+	if (IsRecording()) {
+		m_cSceneNodeHandler.SetElement(nullptr);
+		m_cCoordinateSystemHandler.SetElement(nullptr);
+
+		// Request the stop, the writer thread writes the rest of the ring buffer and completes the files
+		m_nNumOfTrailingDroppedKeys = m_nNumOfPendingDroppedKeys;
+		MemoryFence();
+		m_bStop = true;
+		m_cSemaphore.Unlock();
+
+		// The writer thread couldn't keep up?
+		if (m_nNumOfDroppedKeys)
+			PL_LOG(Warning, String::Format("Camcorder recorder: Dropped %u of %u keys of recording '%s', the ring buffer was full - they are replaced by repeats of the keys before them", m_nNumOfDroppedKeys, m_nNumOfAddedKeys, m_sName.GetASCII()))
+		PL_LOG(Info, String::Format("Camcorder recorder: Stopped recording '%s' after %u keys", m_sName.GetASCII(), m_nNumOfAddedKeys))
+	}
+}
+
+/**
+*  @brief
+*    Returns whether or not a recording is running
+*/
+bool CamcorderRecorder::IsRecording() const
+{
+	return (m_pWriterThread && !m_bStop);
+}
+
+/**
+*  @brief
+*    Returns whether or not the writer thread is still writing a recording
+*/
+bool CamcorderRecorder::IsWriting() const
+{
+	return m_bWriting;
+}
+
+/**
+*  @brief
+*    Updates the recording, call this once per frame after the scene update
+*/
+void CamcorderRecorder::Update()
+{
+	if (IsRecording()) {
+		SceneNode *pSceneNode = m_cSceneNodeHandler.GetElement();
+		if (pSceneNode) {
+			// One key per frame of the recording, if the application is slower than the recording the current key is repeated
+			m_fTime += Timing::GetInstance()->GetTimeDifference();
+			while (static_cast<float>(m_nNumOfAddedKeys) <= m_fTime*FramesPerSecond)
+				AddKey(*pSceneNode);
+		} else {
+			// The recorded scene node is gone (e.g. the scene was reloaded)
+			StopRecord();
+		}
+	} else if (m_pWriterThread && !m_bWriting) {
+		// The writer thread is finished, get rid of it
+		JoinWriter();
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Waits for the writer thread of the last recording and destroys it
+*/
+void CamcorderRecorder::JoinWriter()
+{
+	if (m_pWriterThread) {
+		m_pWriterThread->Join();
+		delete m_pWriterThread;
+		m_pWriterThread = nullptr;
+	}
+}
+
+/**
+*  @brief
+*    Adds the current key of the recorded scene node to the ring buffer, called by the main thread
+*/
+void CamcorderRecorder::AddKey(SceneNode &cSceneNode)
+{
+	m_nNumOfAddedKeys++;
+
+	// Drop the key if the ring buffer is full, the main thread never waits for the disk - the first key is never dropped
+	// because the ring buffer is empty when a recording is started
+	const uint32 nWriteIndex = m_nWriteIndex;
+	if (nWriteIndex - m_nReadIndex >= BufferSize) {
+		m_nNumOfDroppedKeys++;
+		m_nNumOfPendingDroppedKeys++;
+		return;
+	}
+
+	// Get the position within the coordinate system
+	Vector3 vPosition = cSceneNode.GetTransform().GetPosition();
+	SceneContainer *pContainer = cSceneNode.GetContainer();
+	SceneNode *pCoordinateSystem = m_cCoordinateSystemHandler.GetElement();
+	if (pContainer && pCoordinateSystem && pContainer != pCoordinateSystem) {
+		Matrix3x4 mTransform;
+		if (pContainer->GetTransformMatrixTo(*pCoordinateSystem, mTransform))
+			vPosition = mTransform*vPosition;
+	}
+	const Quaternion &qRotation = cSceneNode.GetTransform().GetRotation();
+
+	// Fill the key
+	SKey &sKey = m_sKeys[nWriteIndex%BufferSize];
+	sKey.fPosition[0] = vPosition.x;
+	sKey.fPosition[1] = vPosition.y;
+	sKey.fPosition[2] = vPosition.z;
+	sKey.fRotation[0] = qRotation.w;
+	sKey.fRotation[1] = qRotation.x;
+	sKey.fRotation[2] = qRotation.y;
+	sKey.fRotation[3] = qRotation.z;
+
+	// The writer thread repeats the key before this one for each dropped key, the keys have no time stamps
+	sKey.nNumOfDroppedKeys = m_nNumOfPendingDroppedKeys;
+	m_nNumOfPendingDroppedKeys = 0;
+
+	// Publish the key, the key has to be visible to the writer thread before the index is
+	MemoryFence();
+	m_nWriteIndex = nWriteIndex + 1;
+
+	// Wake up the writer thread if a block is complete
+	if (!(m_nWriteIndex%BlockSize))
+		m_cSemaphore.Unlock();
+}
+
+/**
+*  @brief
+*    Writes the recording, called by the writer thread
+*/
+void CamcorderRecorder::Write()
+{
+	Profiler::SetThreadName("Camcorder writer");
+
+	// Create the chunk files, the number of keys within the headers is set when the recording is stopped
+	const String sDirectory = m_sBaseDirectory + "Data/Camcorder";
+	Directory cDirectory(sDirectory);
+	if (!cDirectory.Exists())
+		cDirectory.CreateRecursive();
+	m_pPositionFile = new File(sDirectory + '/' + m_sName + "_Position.chunk");
+	m_pRotationFile = new File(sDirectory + '/' + m_sName + "_Rotation.chunk");
+	if (!m_pPositionFile->Open(File::FileCreate | File::FileWrite) || !m_pRotationFile->Open(File::FileCreate | File::FileWrite) ||
+		!WriteChunkHeader(*m_pPositionFile, Chunk::Position, 3, 0) || !WriteChunkHeader(*m_pRotationFile, Chunk::Rotation, 4, 0)) {
+		PL_LOG(Error, "Camcorder recorder: Failed to create the chunk files of recording '" + m_sName + '\'')
+		delete m_pPositionFile;
+		delete m_pRotationFile;
+		m_pPositionFile = m_pRotationFile = nullptr;
+	}
+
+	// Write complete blocks while recording, the rest when the recording is stopped
+	bool bStop = false;
+	while (!bStop) {
+		m_cSemaphore.Lock();
+		bStop = m_bStop;
+		MemoryFence();
+		uint32 nNumOfKeys = m_nWriteIndex - m_nReadIndex;
+		if (!bStop)
+			nNumOfKeys -= nNumOfKeys%BlockSize;
+		if (nNumOfKeys) {
+			ProfilerScope cProfilerScope("Camcorder write");
+			WriteKeys(nNumOfKeys);
+		}
+	}
+
+	// Keys dropped at the end of the recording are repeats of the last key as well
+	for (uint32 i=0; i<m_nNumOfTrailingDroppedKeys; i++)
+		AppendKey(m_sLastKey);
+	WriteBlock();
+
+	// Complete the chunk files
+	if (m_pPositionFile && m_pRotationFile) {
+		bool bResult = m_pPositionFile->Seek(0, File::SeekSet) && WriteChunkHeader(*m_pPositionFile, Chunk::Position, 3, m_nNumOfWrittenKeys) &&
+					   m_pRotationFile->Seek(0, File::SeekSet) && WriteChunkHeader(*m_pRotationFile, Chunk::Rotation, 4, m_nNumOfWrittenKeys);
+		m_pPositionFile->Close();
+		m_pRotationFile->Close();
+		delete m_pPositionFile;
+		delete m_pRotationFile;
+		m_pPositionFile = m_pRotationFile = nullptr;
+
+		// Write the camcorder file referencing the chunk files, just like the camcorder does
+		if (bResult) {
+			XmlDocument cDocument;
+			cDocument.LinkEndChild(*new XmlDeclaration("1.0", "", ""));
+			XmlElement &cCamcorderElement = *new XmlElement("Camcorder");
+			cCamcorderElement.SetAttribute("Version",		 "1");
+			cCamcorderElement.SetAttribute("SceneContainer", m_sSceneContainer);
+			cCamcorderElement.SetAttribute("SceneNode",		 m_sSceneNode);
+			XmlElement &cPositionElement = *new XmlElement("PositionKeys");
+			if (m_sCoordinateSystem.GetLength())
+				cPositionElement.SetAttribute("CoordinateSystem", m_sCoordinateSystem);
+			cPositionElement.SetAttribute("FramesPerSecond", String::Format("%u", FramesPerSecond));
+			cPositionElement.LinkEndChild(*new XmlText("Data/Camcorder/" + m_sName + "_Position.chunk"));
+			cCamcorderElement.LinkEndChild(cPositionElement);
+			XmlElement &cRotationElement = *new XmlElement("RotationKeys");
+			cRotationElement.SetAttribute("FramesPerSecond", String::Format("%u", FramesPerSecond));
+			cRotationElement.LinkEndChild(*new XmlText("Data/Camcorder/" + m_sName + "_Rotation.chunk"));
+			cCamcorderElement.LinkEndChild(cRotationElement);
+			cDocument.LinkEndChild(cCamcorderElement);
+			bResult = cDocument.Save(sDirectory + '/' + m_sName + ".cam");
+		}
+		if (!bResult)
+			PL_LOG(Error, "Camcorder recorder: Failed to complete the files of recording '" + m_sName + '\'')
+	}
+
+	// Done, the main thread may now join this thread
+	Profiler::ReleaseThread();
+	MemoryFence();
+	m_bWriting = false;
+}
+
+/**
+*  @brief
+*    Writes keys from the ring buffer into the chunk files, called by the writer thread
+*/
+void CamcorderRecorder::WriteKeys(uint32 nNumOfKeys)
+{
+	uint32 nReadIndex = m_nReadIndex;
+	while (nNumOfKeys) {
+		// Take a block of keys out of the ring buffer, each dropped key is replaced by a repeat of the key before it so
+		// that the timeline of the recording stays intact
+		const uint32 nNumOfRingKeys = (nNumOfKeys < BlockSize) ? nNumOfKeys : BlockSize;
+		for (uint32 i=0; i<nNumOfRingKeys; i++) {
+			const SKey &sKey = m_sKeys[(nReadIndex + i)%BufferSize];
+			for (uint32 nKey=0; nKey<sKey.nNumOfDroppedKeys; nKey++)
+				AppendKey(m_sLastKey);
+			AppendKey(sKey);
+		}
+
+		// Give the ring buffer space back to the main thread, the keys have to be read before
+		MemoryFence();
+		nReadIndex += nNumOfRingKeys;
+		m_nReadIndex = nReadIndex;
+		nNumOfKeys -= nNumOfRingKeys;
+	}
+
+	// Write the rest, the next call starts with a new block
+	WriteBlock();
+}
+
+/**
+*  @brief
+*    Appends a key to the current block, called by the writer thread
+*/
+void CamcorderRecorder::AppendKey(const SKey &sKey)
+{
+	for (uint32 nComponent=0; nComponent<3; nComponent++)
+		m_fPositions[m_nNumOfBlockKeys*3 + nComponent] = sKey.fPosition[nComponent];
+	for (uint32 nComponent=0; nComponent<4; nComponent++)
+		m_fRotations[m_nNumOfBlockKeys*4 + nComponent] = sKey.fRotation[nComponent];
+	if (&sKey != &m_sLastKey)
+		m_sLastKey = sKey;
+	m_nNumOfBlockKeys++;
+	if (m_nNumOfBlockKeys == BlockSize)
+		WriteBlock();
+}
+
+/**
+*  @brief
+*    Writes the current block into the chunk files, called by the writer thread
+*/
+void CamcorderRecorder::WriteBlock()
+{
+	// Append the block to the chunk files
+	if (m_nNumOfBlockKeys && m_pPositionFile && m_pRotationFile) {
+		m_pPositionFile->Write(m_fPositions, sizeof(float)*3, m_nNumOfBlockKeys);
+		m_pRotationFile->Write(m_fRotations, sizeof(float)*4, m_nNumOfBlockKeys);
+		m_nNumOfWrittenKeys += m_nNumOfBlockKeys;
+	}
+	m_nNumOfBlockKeys = 0;
+}
+
+/**
+*  @brief
+*    Writes the header of a chunk file, called by the writer thread
+*/
+bool CamcorderRecorder::WriteChunkHeader(File &cFile, uint32 nSemantic, uint32 nNumOfComponents, uint32 nNumOfKeys) const
+{
+	const uint32 nHeader[7] = {
+		ChunkMagic,
+		ChunkVersion,
+		ChunkBlockOverhead + nNumOfKeys*nNumOfComponents*static_cast<uint32>(sizeof(float)),	// Size of the chunk block
+		nSemantic,
+		Chunk::Float,
+		nNumOfComponents,
+		nNumOfKeys
+	};
+	return (cFile.Write(nHeader, sizeof(nHeader), 1) == 1);
+}
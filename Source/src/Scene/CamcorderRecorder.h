@@ -0,0 +1,301 @@
+/*********************************************************\
+ *  File: CamcorderRecorder.h                            *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_CAMCORDERRECORDER_H__
+#define __DUNGEON_CAMCORDERRECORDER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include <PLCore/System/Semaphore.h>
+#include <PLScene/Scene/SceneNodeHandler.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLCore {
+	class File;
+}
+class CamcorderWriterThread;
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Camcorder recorder streaming the keys to disk while recording
+*
+*  @remarks
+*    Records the position and rotation of a scene node in the format of "PLEngine::Camcorder", so the recording can be
+*    played by the camcorder (e.g. "camcorder:StartPlayback(\"Test\")") or converted into a track (see "CamcorderTrack").
+*    Unlike the camcorder, which keeps all keys in memory and writes them when the recording is stopped, the keys are
+*    streamed:
+*    - Each frame the main thread adds the keys into a fixed size single producer/single consumer ring buffer, without
+*      any lock, allocation or file access
+*    - A writer thread appends blocks of keys to the chunk files as soon as they are complete
+*    - When the recording is stopped, the writer thread writes the rest, completes the chunk headers and writes the
+*      ".cam" file, the main thread doesn't wait for it
+*
+*    The memory used while recording is therefore constant, no matter how long the recording is. If the writer thread
+*    can't keep up (e.g. the disk is stalled for more than "BufferSize" frames), keys are dropped instead of blocking the
+*    main thread - the number of dropped keys is written into the log. The keys are stored without time stamps, so the
+*    writer thread replaces each dropped key by a repeat of the key before it and the timeline stays intact.
+*/
+class CamcorderRecorder {
+
+
+	//[-------------------------------------------------------]
+	//[ Friends                                               ]
+	//[-------------------------------------------------------]
+	friend class CamcorderWriterThread;
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 FramesPerSecond = 24;	/**< Keys per second, like the camcorder */
+		static const PLCore::uint32 BufferSize		= 1024;	/**< Size of the ring buffer in keys (about 42 seconds) */
+		static const PLCore::uint32 BlockSize		= 64;	/**< Number of keys the writer thread writes at once */
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] sBaseDirectory
+		*    Base directory of the application (the directory "Data" is in), ends with a slash
+		*/
+		CamcorderRecorder(const PLCore::String &sBaseDirectory);
+
+		/**
+		*  @brief
+		*    Destructor
+		*
+		*  @note
+		*    - A running recording is stopped, the writer thread is waited for
+		*/
+		~CamcorderRecorder();
+
+		/**
+		*  @brief
+		*    Starts a recording
+		*
+		*  @param[in] sName
+		*    Name of the recording (e.g. "Test" writes "Data/Camcorder/Test.cam")
+		*  @param[in] cSceneNode
+		*    Scene node to record (usually the camera), the recording stops automatically if it's destroyed
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*
+		*  @note
+		*    - A running recording is stopped first
+		*/
+		bool StartRecord(const PLCore::String &sName, PLScene::SceneNode &cSceneNode);
+
+		/**
+		*  @brief
+		*    Stops the recording
+		*
+		*  @note
+		*    - Returns at once, the writer thread completes the files in the background (see "IsWriting()")
+		*/
+		void StopRecord();
+
+		/**
+		*  @brief
+		*    Returns whether or not a recording is running
+		*
+		*  @return
+		*    'true' if a recording is running, else 'false'
+		*/
+		bool IsRecording() const;
+
+		/**
+		*  @brief
+		*    Returns whether or not the writer thread is still writing a recording
+		*
+		*  @return
+		*    'true' if the files of the current or last recording are not complete yet, else 'false'
+		*/
+		bool IsWriting() const;
+
+		/**
+		*  @brief
+		*    Updates the recording, call this once per frame after the scene update
+		*/
+		void Update();
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Key within the ring buffer
+		*/
+		struct SKey {
+			float		   fPosition[3];		/**< Position (x, y, z) */
+			float		   fRotation[4];		/**< Rotation quaternion (w, x, y, z) */
+			PLCore::uint32 nNumOfDroppedKeys;	/**< Number of keys dropped right before this key */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		CamcorderRecorder(const CamcorderRecorder &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		CamcorderRecorder &operator =(const CamcorderRecorder &cSource);
+
+		/**
+		*  @brief
+		*    Waits for the writer thread of the last recording and destroys it
+		*/
+		void JoinWriter();
+
+		/**
+		*  @brief
+		*    Adds the current key of the recorded scene node to the ring buffer, called by the main thread
+		*
+		*  @param[in] cSceneNode
+		*    Recorded scene node
+		*/
+		void AddKey(PLScene::SceneNode &cSceneNode);
+
+		/**
+		*  @brief
+		*    Writes the recording, called by the writer thread
+		*/
+		void Write();
+
+		/**
+		*  @brief
+		*    Writes keys from the ring buffer into the chunk files, called by the writer thread
+		*
+		*  @param[in] nNumOfKeys
+		*    Number of keys to write, must be available within the ring buffer
+		*/
+		void WriteKeys(PLCore::uint32 nNumOfKeys);
+
+		/**
+		*  @brief
+		*    Appends a key to the current block, called by the writer thread
+		*
+		*  @param[in] sKey
+		*    Key to append, the block is written when it's full
+		*/
+		void AppendKey(const SKey &sKey);
+
+		/**
+		*  @brief
+		*    Writes the current block into the chunk files, called by the writer thread
+		*/
+		void WriteBlock();
+
+		/**
+		*  @brief
+		*    Writes the header of a chunk file, called by the writer thread
+		*
+		*  @param[in] cFile
+		*    Chunk file, the file pointer is expected at the beginning
+		*  @param[in] nSemantic
+		*    Chunk semantic ("PLCore::Chunk::ESemantic")
+		*  @param[in] nNumOfComponents
+		*    Number of float components per key
+		*  @param[in] nNumOfKeys
+		*    Number of keys
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool WriteChunkHeader(PLCore::File &cFile, PLCore::uint32 nSemantic, PLCore::uint32 nNumOfComponents, PLCore::uint32 nNumOfKeys) const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		// Main thread
+		PLCore::String			  m_sBaseDirectory;				/**< Base directory of the application, ends with a slash */
+		PLScene::SceneNodeHandler m_cSceneNodeHandler;			/**< Recorded scene node, no element if no recording is running */
+		PLScene::SceneNodeHandler m_cCoordinateSystemHandler;	/**< Scene container the positions are relative to, no element for the scene container of the scene node */
+		float					  m_fTime;						/**< Recorded time in seconds */
+		PLCore::uint32			  m_nNumOfAddedKeys;			/**< Number of keys added by the main thread (counting the dropped ones) */
+		PLCore::uint32			  m_nNumOfDroppedKeys;			/**< Number of keys dropped because the ring buffer was full */
+		PLCore::uint32			  m_nNumOfPendingDroppedKeys;	/**< Number of keys dropped since the last key put into the ring buffer */
+		CamcorderWriterThread	 *m_pWriterThread;				/**< Writer thread of the current or last recording, can be a null pointer */
+		// Shared between the main thread and the writer thread
+		PLCore::String			  m_sName;						/**< Name of the recording, set before the writer thread is started */
+		PLCore::String			  m_sSceneContainer;			/**< Absolute name of the scene container of the recorded scene node */
+		PLCore::String			  m_sSceneNode;					/**< Name of the recorded scene node */
+		PLCore::String			  m_sCoordinateSystem;			/**< Coordinate system of the position keys, relative to the scene container ("Parent" or empty) */
+		SKey					  m_sKeys[BufferSize];			/**< Ring buffer */
+		volatile PLCore::uint32	  m_nWriteIndex;				/**< Number of keys put into the ring buffer, written by the main thread only */
+		volatile PLCore::uint32	  m_nReadIndex;					/**< Number of keys taken from the ring buffer, written by the writer thread only */
+		volatile bool			  m_bStop;						/**< Stop request for the writer thread, written by the main thread only */
+		PLCore::uint32			  m_nNumOfTrailingDroppedKeys;	/**< Number of keys dropped after the last key put into the ring buffer, set before the stop request */
+		volatile bool			  m_bWriting;					/**< Is the writer thread busy? Cleared by the writer thread when the files are complete */
+		PLCore::Semaphore		  m_cSemaphore;					/**< Wakes up the writer thread when a block is complete or a stop was requested */
+		// Writer thread
+		PLCore::File			 *m_pPositionFile;				/**< Position key chunk file, can be a null pointer */
+		PLCore::File			 *m_pRotationFile;				/**< Rotation key chunk file, can be a null pointer */
+		PLCore::uint32			  m_nNumOfWrittenKeys;			/**< Number of keys written into the chunk files */
+		SKey					  m_sLastKey;					/**< Last key appended, repeated for dropped keys */
+		float					  m_fPositions[BlockSize*3];	/**< Position keys of the current block */
+		float					  m_fRotations[BlockSize*4];	/**< Rotation keys of the current block */
+		PLCore::uint32			  m_nNumOfBlockKeys;			/**< Number of keys within the current block */
+
+
+};
+
+
+#endif // __DUNGEON_CAMCORDERRECORDER_H__
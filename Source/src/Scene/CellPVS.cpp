@@ -0,0 +1,224 @@
+/*********************************************************\
+ *  File: CellPVS.cpp                                    *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/Xml/Xml.h>
+#include <PLCore/File/Url.h>
+#include <PLCore/File/File.h>
+#include <PLCore/Tools/LoadableManager.h>
+#include <PLCore/Tools/ChecksumMD5.h>
+#include "Scene/CellPVS.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Returns the filename of the potentially visible set of a scene
+*/
+String CellPVS::GetFilename(const String &sSceneFilename)
+{
+	const Url cUrl(sSceneFilename);
+	return cUrl.CutFilename() + cUrl.GetTitle() + ".pvs";
+}
+
+/**
+*  @brief
+*    Returns the content hash of a scene
+*/
+String CellPVS::GetSceneHash(const String &sSceneFilename)
+{
+	File cSceneFile;
+	return LoadableManager::GetInstance()->OpenFile(cSceneFile, sSceneFilename, false) ? ChecksumMD5().GetChecksumFromFile(cSceneFile.GetUrl().GetUrl()) : "";
+}
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Default constructor, the set has no cells
+*/
+CellPVS::CellPVS()
+{
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+CellPVS::~CellPVS()
+{
+}
+
+/**
+*  @brief
+*    Sets the cells, no cell is visible from any cell afterwards
+*/
+void CellPVS::SetCells(const Array<String> &lstNames)
+{
+	m_lstNames = lstNames;
+	m_lstVisible.Reset();
+	const uint32 nNumOfCells = m_lstNames.GetNumOfElements();
+	for (uint32 i=0; i<nNumOfCells*nNumOfCells; i++)
+		m_lstVisible.Add(false);
+}
+
+/**
+*  @brief
+*    Returns the number of cells
+*/
+uint32 CellPVS::GetNumOfCells() const
+{
+	return m_lstNames.GetNumOfElements();
+}
+
+/**
+*  @brief
+*    Returns the index of a cell
+*/
+int CellPVS::GetCell(const String &sName) const
+{
+	return m_lstNames.GetIndex(sName);
+}
+
+/**
+*  @brief
+*    Returns whether or not a cell is visible from another cell
+*/
+bool CellPVS::IsVisible(uint32 nFromCell, uint32 nToCell) const
+{
+	return m_lstVisible[nFromCell*m_lstNames.GetNumOfElements() + nToCell];
+}
+
+/**
+*  @brief
+*    Marks a cell as visible from another cell
+*/
+void CellPVS::SetVisible(uint32 nFromCell, uint32 nToCell)
+{
+	m_lstVisible[nFromCell*m_lstNames.GetNumOfElements() + nToCell] = true;
+}
+
+/**
+*  @brief
+*    Loads the set
+*/
+bool CellPVS::Load(const String &sFilename, const String &sSceneHash)
+{
+	SetCells(Array<String>());
+
+	// Load the XML document, the loadable manager takes care of the base directories
+	File cFile;
+	XmlDocument cDocument;
+	if (!sSceneHash.GetLength() || !LoadableManager::GetInstance()->OpenFile(cFile, sFilename, false) || !cDocument.Load(cFile))
+		return false; // Error!
+	const XmlElement *pPVSElement = cDocument.GetFirstChildElement("CellPVS");
+	if (!pPVSElement || pPVSElement->GetAttribute("Version").GetUInt32() != Version) {
+		PL_LOG(Warning, "Cell PVS: '" + sFilename + "' has an unknown format, bake it again")
+		return false; // Error!
+	}
+	if (pPVSElement->GetAttribute("SceneHash") != sSceneHash) {
+		PL_LOG(Warning, "Cell PVS: '" + sFilename + "' was baked for another version of the scene, bake it again")
+		return false; // Error!
+	}
+
+	// Get the cells first, the visible cells refer to them
+	Array<String> lstNames;
+	for (const XmlElement *pCellElement=pPVSElement->GetFirstChildElement("Cell"); pCellElement; pCellElement=pCellElement->GetNextSiblingElement("Cell"))
+		lstNames.Add(pCellElement->GetAttribute("Name"));
+	SetCells(lstNames);
+
+	// Get the visible cells
+	uint32 nFromCell = 0;
+	for (const XmlElement *pCellElement=pPVSElement->GetFirstChildElement("Cell"); pCellElement; pCellElement=pCellElement->GetNextSiblingElement("Cell"), nFromCell++) {
+		for (const XmlElement *pVisibleElement=pCellElement->GetFirstChildElement("Visible"); pVisibleElement; pVisibleElement=pVisibleElement->GetNextSiblingElement("Visible")) {
+			const int nToCell = GetCell(pVisibleElement->GetAttribute("Cell"));
+			if (nToCell >= 0)
+				SetVisible(nFromCell, nToCell);
+		}
+	}
+
+	// Done
+	return true;
+}
+
+/**
+*  @brief
+*    Saves the set
+*/
+bool CellPVS::Save(const String &sFilename, const String &sSceneHash) const
+{
+	XmlDocument cDocument;
+	cDocument.LinkEndChild(*new XmlDeclaration("1.0", "ISO-8859-1", ""));
+	XmlElement &cPVSElement = *new XmlElement("CellPVS");
+	cPVSElement.SetAttribute("Version",	  String::Format("%u", Version));
+	cPVSElement.SetAttribute("SceneHash", sSceneHash);
+	for (uint32 nFromCell=0; nFromCell<m_lstNames.GetNumOfElements(); nFromCell++) {
+		XmlElement &cCellElement = *new XmlElement("Cell");
+		cCellElement.SetAttribute("Name", m_lstNames[nFromCell]);
+		for (uint32 nToCell=0; nToCell<m_lstNames.GetNumOfElements(); nToCell++) {
+			if (IsVisible(nFromCell, nToCell)) {
+				XmlElement &cVisibleElement = *new XmlElement("Visible");
+				cVisibleElement.SetAttribute("Cell", m_lstNames[nToCell]);
+				cCellElement.LinkEndChild(cVisibleElement);
+			}
+		}
+		cPVSElement.LinkEndChild(cCellElement);
+	}
+	cDocument.LinkEndChild(cPVSElement);
+	return cDocument.Save(sFilename);
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+CellPVS::CellPVS(const CellPVS &cSource)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+CellPVS &CellPVS::operator =(const CellPVS &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
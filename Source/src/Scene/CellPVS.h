@@ -0,0 +1,233 @@
+/*********************************************************\
+ *  File: CellPVS.h                                      *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_CELLPVS_H__
+#define __DUNGEON_CELLPVS_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include <PLCore/Container/Array.h>
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Potentially visible set between the cells of a scene
+*
+*  @remarks
+*    For each cell, the set lists the cells which can be seen from anywhere within it. It's baked offline by
+*    "DungeonPVSBaker" and stored next to the scene (e.g. "Data/Scenes/Dungeon.pvs" for "Data/Scenes/Dungeon.scene"),
+*    the scene culler rejects the cells outside of the set of the camera cell before any portal is clipped.
+*
+*    The set is keyed by the MD5 content hash of the XML scene, so after exporting the scene again the set is
+*    ignored until it's baked again. XML format:
+*    @verbatim
+*    <CellPVS Version="1" SceneHash="<MD5 of the XML scene>">
+*        <Cell Name="<cell name>">
+*            <Visible Cell="<name of a cell visible from this cell>" />
+*        </Cell>
+*    </CellPVS>
+*    @endverbatim
+*/
+class CellPVS {
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 Version = 1;	/**< Format version, increase on each format change */
+
+
+	//[-------------------------------------------------------]
+	//[ Public static functions                               ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Returns the filename of the potentially visible set of a scene
+		*
+		*  @param[in] sSceneFilename
+		*    Filename of the XML scene (e.g. "Data/Scenes/Dungeon.scene")
+		*
+		*  @return
+		*    Filename of the potentially visible set (e.g. "Data/Scenes/Dungeon.pvs")
+		*/
+		static PLCore::String GetFilename(const PLCore::String &sSceneFilename);
+
+		/**
+		*  @brief
+		*    Returns the content hash of a scene
+		*
+		*  @param[in] sSceneFilename
+		*    Filename of the XML scene, the loadable manager takes care of the base directories
+		*
+		*  @return
+		*    MD5 content hash of the XML scene, empty string on error
+		*/
+		static PLCore::String GetSceneHash(const PLCore::String &sSceneFilename);
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Default constructor, the set has no cells
+		*/
+		CellPVS();
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		~CellPVS();
+
+		/**
+		*  @brief
+		*    Sets the cells, no cell is visible from any cell afterwards
+		*
+		*  @param[in] lstNames
+		*    Cell names, must be unique
+		*/
+		void SetCells(const PLCore::Array<PLCore::String> &lstNames);
+
+		/**
+		*  @brief
+		*    Returns the number of cells
+		*
+		*  @return
+		*    The number of cells, 0 if there's no set
+		*/
+		PLCore::uint32 GetNumOfCells() const;
+
+		/**
+		*  @brief
+		*    Returns the index of a cell
+		*
+		*  @param[in] sName
+		*    Cell name
+		*
+		*  @return
+		*    Index of the cell, <0 if the set doesn't know the cell
+		*/
+		int GetCell(const PLCore::String &sName) const;
+
+		/**
+		*  @brief
+		*    Returns whether or not a cell is visible from another cell
+		*
+		*  @param[in] nFromCell
+		*    Index of the cell the camera is in, must be valid
+		*  @param[in] nToCell
+		*    Index of the cell to check, must be valid
+		*
+		*  @return
+		*    'true' if the cell is potentially visible, else 'false'
+		*/
+		bool IsVisible(PLCore::uint32 nFromCell, PLCore::uint32 nToCell) const;
+
+		/**
+		*  @brief
+		*    Marks a cell as visible from another cell
+		*
+		*  @param[in] nFromCell
+		*    Index of the cell the camera is in, must be valid
+		*  @param[in] nToCell
+		*    Index of the visible cell, must be valid
+		*/
+		void SetVisible(PLCore::uint32 nFromCell, PLCore::uint32 nToCell);
+
+		/**
+		*  @brief
+		*    Loads the set
+		*
+		*  @param[in] sFilename
+		*    Filename of the set, the loadable manager takes care of the base directories
+		*  @param[in] sSceneHash
+		*    Content hash of the XML scene (see "GetSceneHash()")
+		*
+		*  @return
+		*    'true' if all went fine, 'false' if there's no set, it's broken or it was baked for another version of the scene (the set has no cells then)
+		*/
+		bool Load(const PLCore::String &sFilename, const PLCore::String &sSceneHash);
+
+		/**
+		*  @brief
+		*    Saves the set
+		*
+		*  @param[in] sFilename
+		*    Filename of the set
+		*  @param[in] sSceneHash
+		*    Content hash of the XML scene (see "GetSceneHash()")
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool Save(const PLCore::String &sFilename, const PLCore::String &sSceneHash) const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		CellPVS(const CellPVS &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		CellPVS &operator =(const CellPVS &cSource);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::Array<PLCore::String> m_lstNames;	/**< Cell names */
+		PLCore::Array<bool>			  m_lstVisible;	/**< Visibility matrix, "<from cell>*<number of cells> + <to cell>" */
+
+
+};
+
+
+#endif // __DUNGEON_CELLPVS_H__
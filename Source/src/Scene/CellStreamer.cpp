@@ -0,0 +1,693 @@
+/*********************************************************\
+ *  File: CellStreamer.cpp                               *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/Xml/Xml.h>
+#include <PLCore/File/Url.h>
+#include <PLCore/File/File.h>
+#include <PLCore/File/Directory.h>
+#include <PLCore/Tools/LoadableManager.h>
+#include <PLMath/Matrix3x4.h>
+#include <PLMath/AABoundingBox.h>
+#include <PLRenderer/RendererContext.h>
+#include <PLRenderer/Texture/TextureManager.h>
+#include <PLRenderer/Material/MaterialManager.h>
+#include <PLMesh/MeshManager.h>
+#include <PLScene/Scene/SceneContext.h>
+#include <PLScene/Scene/SceneContainer.h>
+#include <PLScene/Scene/SceneNodeHandler.h>
+#include "Scene/AssetPrefetcher.h"
+#include "Scene/CellStreamer.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+using namespace PLRenderer;
+using namespace PLMesh;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+static const uint32 NumOfNodesPerFrame = 32;	/**< Maximum number of scene nodes created per frame while loading a cell in the background */
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor, call this before the scene is loaded
+*/
+CellStreamer::CellStreamer(const String &sSceneFilename, const String &sCacheDirectory, uint32 nPortalHops, uint32 nMemoryBudget, WorkerPool &cWorkerPool) :
+	m_sSceneFilename(sSceneFilename),
+	m_pSceneContainer(nullptr),
+	m_pSceneContext(nullptr),
+	m_nPortalHops(nPortalHops),
+	m_nMemoryBudget(static_cast<uint64>(nMemoryBudget)*1024*1024),
+	m_nCameraCell(-1),
+	m_nUpdateCounter(0),
+	m_pWorkerPool(&cWorkerPool)
+{
+	m_bUnloadUnused[0] = m_bUnloadUnused[1] = m_bUnloadUnused[2] = false;
+
+	// Get the contents of the cells from the XML scene, the loadable manager takes care of the base directories
+	File cSceneFile;
+	XmlDocument cDocument;
+	XmlElement *pSceneElement = nullptr;
+	Array<XmlElement*> lstCellElements;
+	if (LoadableManager::GetInstance()->OpenFile(cSceneFile, sSceneFilename, false) && cDocument.Load(cSceneFile)) {
+		pSceneElement = cDocument.GetFirstChildElement("Scene");
+		if (pSceneElement)
+			CollectCells(*pSceneElement, "", lstCellElements);
+	}
+	cSceneFile.Close();
+
+	// Resolve the portal targets, they are given relative to the cell (e.g. "Parent.WineCellar")
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+		SCell &sCell = *m_lstCells[i];
+		for (uint32 nTarget=0; nTarget<sCell.lstTargetCells.GetNumOfElements(); nTarget++) {
+			const String &sTarget = sCell.lstTargetCells[nTarget];
+			const String  sTargetName = sTarget.GetSubstring(sTarget.LastIndexOf('.') + 1);
+			for (uint32 nCell=0; nCell<m_lstCells.GetNumOfElements(); nCell++) {
+				if (nCell != i && m_lstCells[nCell]->sName == sTargetName) {
+					// Portals are passable in both directions
+					if (!sCell.lstNeighbours.IsElement(nCell))
+						sCell.lstNeighbours.Add(nCell);
+					if (!m_lstCells[nCell]->lstNeighbours.IsElement(i))
+						m_lstCells[nCell]->lstNeighbours.Add(i);
+					break;
+				}
+			}
+		}
+	}
+
+	// Get the file sizes of the assets, each asset is counted just once no matter how many cells reference it
+	uint64 nTotalMemory = 0;
+	m_lstAssetSizes.Resize(m_lstAssets.GetNumOfElements());
+	for (uint32 i=0; i<m_lstAssets.GetNumOfElements(); i++) {
+		File cFile;
+		m_lstAssetSizes[i] = LoadableManager::GetInstance()->OpenFile(cFile, m_lstAssets[i], false) ? cFile.GetSize() : 0;
+		nTotalMemory += m_lstAssetSizes[i];
+	}
+
+	// Just the cells around the start camera are loaded with the scene, the contents of the further cells are removed
+	// from a copy of the XML scene which is loaded instead - without a start camera, all cells are loaded with the scene
+	const int nStartCell = pSceneElement ? GetStartCell(*pSceneElement) : -1;
+	uint32 nNumOfInitialCells = m_lstCells.GetNumOfElements();
+	if (nStartCell >= 0) {
+		Array<int> lstDistance;
+		GetDistances(nStartCell, lstDistance);
+		for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+			if (lstDistance[i] < 0) {
+				SCell &sCell = *m_lstCells[i];
+				sCell.nState = Unloaded;
+				nNumOfInitialCells--;
+
+				// Remove the scene nodes which are streamed
+				XmlElement &cCellElement = *lstCellElements[i];
+				XmlElement *pNode = cCellElement.GetFirstChildElement("Node");
+				while (pNode) {
+					XmlElement *pNextNode = pNode->GetNextSiblingElement("Node");
+					if (IsStreamed(*pNode))
+						cCellElement.RemoveChild(*pNode);
+					pNode = pNextNode;
+				}
+			}
+		}
+
+		// Write the copy of the XML scene, its scene cache is compiled on demand just like the one of the XML scene
+		Directory cCacheDirectory(sCacheDirectory);
+		if (!cCacheDirectory.Exists())
+			cCacheDirectory.CreateRecursive();
+		const String sStreamingFilename = sCacheDirectory + '/' + Url(sSceneFilename).GetTitle() + ".streaming.scene";
+		if (cDocument.Save(sStreamingFilename)) {
+			m_sSceneFilename = sStreamingFilename;
+		} else {
+			// Load all cells with the scene
+			PL_LOG(Warning, "Cell streaming: Failed to write '" + sStreamingFilename + "', all cells are loaded with the scene")
+			for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++)
+				m_lstCells[i]->nState = Resident;
+			nNumOfInitialCells = m_lstCells.GetNumOfElements();
+		}
+	}
+
+	// Done
+	PL_LOG(Info, String::Format("Cell streaming: %u cells with an estimated memory of %.1f MiB, budget is %u MiB within %u portal hops, %u cells are loaded with the scene",
+								m_lstCells.GetNumOfElements(), static_cast<float>(nTotalMemory)/(1024.0f*1024.0f), nMemoryBudget, nPortalHops, nNumOfInitialCells))
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+CellStreamer::~CellStreamer()
+{
+	// Destroy the cells, running prefetches are stopped and the scene nodes stay
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+		SCell *pCell = m_lstCells[i];
+		if (pCell->pPrefetcher)
+			delete pCell->pPrefetcher;
+		for (uint32 nSceneNode=0; nSceneNode<pCell->lstSceneNodes.GetNumOfElements(); nSceneNode++)
+			delete pCell->lstSceneNodes[nSceneNode];
+		delete pCell;
+	}
+	m_lstCells.Clear();
+
+	// Restore the previous unload unused resources settings
+	if (m_pSceneContext) {
+		RendererContext &cRendererContext = m_pSceneContext->GetRendererContext();
+		m_pSceneContext->GetMeshManager().SetUnloadUnused(m_bUnloadUnused[0]);
+		cRendererContext.GetMaterialManager().SetUnloadUnused(m_bUnloadUnused[1]);
+		cRendererContext.GetTextureManager().SetUnloadUnused(m_bUnloadUnused[2]);
+	}
+}
+
+/**
+*  @brief
+*    Returns the filename of the scene to load
+*/
+String CellStreamer::GetSceneFilename() const
+{
+	return m_sSceneFilename;
+}
+
+/**
+*  @brief
+*    Sets the scene container the scene was loaded into
+*/
+void CellStreamer::SetSceneContainer(SceneContainer &cSceneContainer)
+{
+	m_pSceneContainer = &cSceneContainer;
+
+	// Unload the meshes, materials and textures as soon as they are no longer used, else unloading the cells
+	// would just destroy the scene nodes while their resources stay
+	m_pSceneContext = cSceneContainer.GetSceneContext();
+	if (m_pSceneContext) {
+		RendererContext &cRendererContext = m_pSceneContext->GetRendererContext();
+		m_bUnloadUnused[0] = m_pSceneContext->GetMeshManager().GetUnloadUnused();
+		m_bUnloadUnused[1] = cRendererContext.GetMaterialManager().GetUnloadUnused();
+		m_bUnloadUnused[2] = cRendererContext.GetTextureManager().GetUnloadUnused();
+		m_pSceneContext->GetMeshManager().SetUnloadUnused(true);
+		cRendererContext.GetMaterialManager().SetUnloadUnused(true);
+		cRendererContext.GetTextureManager().SetUnloadUnused(true);
+	}
+
+	// Get the cell containers and the scene nodes of the cells loaded with the scene, right after loading they are
+	// still within their cells - from now on they are tracked by scene node handlers
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+		SCell &sCell = *m_lstCells[i];
+		SceneNode *pContainer = cSceneContainer.GetByName(sCell.sPath);
+		if (pContainer && pContainer->IsContainer()) {
+			sCell.pContainer = static_cast<SceneContainer*>(pContainer);
+			if (sCell.nState == Resident) {
+				for (uint32 nRecord=0; nRecord<sCell.lstRecords.GetNumOfElements(); nRecord++) {
+					const SRecord &sRecord = sCell.lstRecords[nRecord];
+					if (!sRecord.bModifier) {
+						SceneNode *pSceneNode = sCell.pContainer->GetByName(sRecord.sName);
+						if (pSceneNode) {
+							SceneNodeHandler *pSceneNodeHandler = new SceneNodeHandler();
+							pSceneNodeHandler->SetElement(pSceneNode);
+							sCell.lstSceneNodes.Add(pSceneNodeHandler);
+						}
+					}
+				}
+			}
+		} else {
+			// There's nothing the contents could be created in, so the cell is never streamed
+			PL_LOG(Warning, "Cell streaming: The cell '" + sCell.sPath + "' is missing")
+			sCell.lstRecords.Clear();
+			sCell.lstAssets.Clear();
+			sCell.nState = Resident;
+		}
+	}
+}
+
+/**
+*  @brief
+*    Returns the number of cells
+*/
+uint32 CellStreamer::GetNumOfCells() const
+{
+	return m_lstCells.GetNumOfElements();
+}
+
+/**
+*  @brief
+*    Returns the number of resident cells
+*/
+uint32 CellStreamer::GetNumOfResidentCells() const
+{
+	uint32 nNumOfResidentCells = 0;
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+		if (m_lstCells[i]->nState != Unloaded)
+			nNumOfResidentCells++;
+	}
+	return nNumOfResidentCells;
+}
+
+/**
+*  @brief
+*    Returns the estimated memory of the resident cells
+*/
+uint64 CellStreamer::GetResidentMemory() const
+{
+	uint64 nMemory = 0;
+	Array<bool> lstCounted;
+	lstCounted.Resize(m_lstAssets.GetNumOfElements());
+	for (uint32 i=0; i<lstCounted.GetNumOfElements(); i++)
+		lstCounted[i] = false;
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+		if (m_lstCells[i]->nState != Unloaded)
+			nMemory += GetUncountedMemory(*m_lstCells[i], lstCounted, true);
+	}
+	return nMemory;
+}
+
+/**
+*  @brief
+*    Updates the streaming, call this once per frame
+*/
+void CellStreamer::Update(SceneNode *pCamera)
+{
+	// Nothing to do if there are no cells or the scene isn't loaded yet
+	if (!m_lstCells.GetNumOfElements() || !m_pSceneContainer)
+		return;
+
+	// The resident cells only change when the camera enters another cell
+	if (pCamera) {
+		const int nCameraCell = GetCameraCell(*pCamera);
+		if (nCameraCell >= 0 && nCameraCell != m_nCameraCell) {
+			m_nCameraCell = nCameraCell;
+			UpdateResidentCells();
+		}
+	}
+
+	// Continue prefetching and loading the cells
+	ContinueLoading();
+}
+
+/**
+*  @brief
+*    Requests a cell ahead of the camera, e.g. by a prefetcher knowing the camera path
+*/
+bool CellStreamer::RequestCell(const SceneContainer &cCell)
+{
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+		SCell &sCell = *m_lstCells[i];
+		if (sCell.pContainer == &cCell) {
+			sCell.nLastUsed = m_nUpdateCounter;
+			if (sCell.nState == Unloaded)
+				LoadCell(sCell);
+			return (sCell.nState == Resident);
+		}
+	}
+
+	// Not a streamed cell, so it's always complete
+	return true;
+}
+
+
+//[-------------------------------------------------------]
+//[ Private static functions                              ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Returns whether or not the scene node of a XML scene node element is streamed
+*/
+bool CellStreamer::IsStreamed(const XmlElement &cElement)
+{
+	// Portals, cameras and helpers always stay, portals define the cell topology - scene nodes without a name
+	// can't be found again after loading the scene
+	const String sClass = cElement.GetAttribute("Class");
+	return (sClass != "PLScene::SNCellPortal" && sClass != "PLScene::SNCamera" && sClass != "PLScene::SNHelper" && cElement.GetAttribute("Name").GetLength());
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+CellStreamer::CellStreamer(const CellStreamer &cSource) :
+	m_pSceneContainer(nullptr),
+	m_pSceneContext(nullptr),
+	m_nPortalHops(0),
+	m_nMemoryBudget(0),
+	m_nCameraCell(-1),
+	m_nUpdateCounter(0),
+	m_pWorkerPool(nullptr)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+CellStreamer &CellStreamer::operator =(const CellStreamer &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Collects the cells of a XML container element and its children
+*/
+void CellStreamer::CollectCells(XmlElement &cElement, const String &sPath, Array<XmlElement*> &lstCellElements)
+{
+	for (XmlElement *pChild=cElement.GetFirstChildElement("Container"); pChild; pChild=pChild->GetNextSiblingElement("Container")) {
+		const String sName = pChild->GetAttribute("Name");
+		const String sChildPath = sPath.GetLength() ? (sPath + '.' + sName) : sName;
+		if (pChild->GetAttribute("Class") == "PLScene::SCCell") {
+			// The cell container itself is always loaded with the scene
+			SCell *pCell = new SCell;
+			pCell->sName		= sName;
+			pCell->sPath		= sChildPath;
+			pCell->pContainer	= nullptr;
+			pCell->nLastUsed	= 0;
+			pCell->nState		= Resident;
+			pCell->nNextRecord	= 0;
+			pCell->pPrefetcher	= nullptr;
+			for (const XmlElement *pNode=pChild->GetFirstChildElement("Node"); pNode; pNode=pNode->GetNextSiblingElement("Node"))
+				AddRecords(*pNode, *pCell);
+			m_lstCells.Add(pCell);
+			lstCellElements.Add(pChild);
+		} else {
+			// Cells may be within other containers, e.g. the physics world
+			CollectCells(*pChild, sChildPath, lstCellElements);
+		}
+	}
+}
+
+/**
+*  @brief
+*    Adds the records of a XML scene node element
+*/
+void CellStreamer::AddRecords(const XmlElement &cElement, SCell &sCell)
+{
+	// Portals define the cell topology
+	if (cElement.GetAttribute("Class") == "PLScene::SNCellPortal") {
+		const String sTargetCell = cElement.GetAttribute("TargetCell");
+		if (sTargetCell.GetLength())
+			sCell.lstTargetCells.Add(sTargetCell);
+	}
+	if (!IsStreamed(cElement))
+		return;
+
+	// The scene node, followed by its modifiers
+	const String sName = cElement.GetAttribute("Name");
+	for (const XmlElement *pElement=&cElement; pElement; pElement=(pElement == &cElement) ? cElement.GetFirstChildElement("Modifier") : pElement->GetNextSiblingElement("Modifier")) {
+		SRecord sRecord;
+		sRecord.bModifier = (pElement != &cElement);
+		sRecord.sClass    = pElement->GetAttribute("Class");
+		sRecord.sName     = sRecord.bModifier ? "" : sName;
+		for (const XmlAttribute *pAttribute=pElement->GetFirstAttribute(); pAttribute; pAttribute=pAttribute->GetNext()) {
+			const String sAttributeName = pAttribute->GetName();
+			if (sAttributeName != "Class" && sAttributeName != "Name") {
+				// Use single quotes if the value contains double quotes
+				const String sValue = pAttribute->GetValue();
+				const char nQuote = (sValue.IndexOf('\"') < 0) ? '\"' : '\'';
+				if (sRecord.sParameters.GetLength())
+					sRecord.sParameters += ' ';
+				sRecord.sParameters += sAttributeName + '=' + nQuote + sValue + nQuote;
+
+				// Assets referenced directly, used for prefetching and the memory estimation
+				if (sValue.Compare("Data/", 0, 5) || sValue.Compare("Data\\", 0, 5)) {
+					int nAsset = m_lstAssets.GetIndex(sValue);
+					if (nAsset < 0) {
+						nAsset = m_lstAssets.GetNumOfElements();
+						m_lstAssets.Add(sValue);
+					}
+					if (!sCell.lstAssets.IsElement(nAsset))
+						sCell.lstAssets.Add(nAsset);
+				}
+			}
+		}
+		sCell.lstRecords.Add(sRecord);
+	}
+}
+
+/**
+*  @brief
+*    Returns the index of the cell the start camera of a XML scene is in
+*/
+int CellStreamer::GetStartCell(const XmlElement &cSceneElement) const
+{
+	// The start camera is given by its name relative to the scene container (e.g. "Container.WineCellar.FreeCamera")
+	for (const XmlElement *pNode=cSceneElement.GetFirstChildElement("Node"); pNode; pNode=pNode->GetNextSiblingElement("Node")) {
+		if (pNode->GetAttribute("Class") == "PLScene::SNKeyValue" && pNode->GetAttribute("Key") == "StartCamera") {
+			const String sCamera = pNode->GetAttribute("Value");
+			for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+				const String &sPath = m_lstCells[i]->sPath;
+				if (sCamera.GetLength() > sPath.GetLength() && sCamera.Compare(sPath, 0, sPath.GetLength()) && sCamera[sPath.GetLength()] == '.')
+					return i;
+			}
+		}
+	}
+
+	// There's no start camera within a cell
+	return -1;
+}
+
+/**
+*  @brief
+*    Returns the number of portal hops from a cell to all cells, up to the number of portal hops within which cells stay resident
+*/
+void CellStreamer::GetDistances(uint32 nCell, Array<int> &lstDistance) const
+{
+	// Breadth-first search through the portals, starting at the given cell
+	lstDistance.Resize(m_lstCells.GetNumOfElements());
+	for (uint32 i=0; i<lstDistance.GetNumOfElements(); i++)
+		lstDistance[i] = -1;
+	Array<uint32> lstQueue;
+	lstDistance[nCell] = 0;
+	lstQueue.Add(nCell);
+	for (uint32 nQueue=0; nQueue<lstQueue.GetNumOfElements(); nQueue++) {
+		const SCell &sCell = *m_lstCells[lstQueue[nQueue]];
+		const int nDistance = lstDistance[lstQueue[nQueue]];
+		if (static_cast<uint32>(nDistance) < m_nPortalHops) {
+			for (uint32 i=0; i<sCell.lstNeighbours.GetNumOfElements(); i++) {
+				const uint32 nNeighbour = sCell.lstNeighbours[i];
+				if (lstDistance[nNeighbour] < 0) {
+					lstDistance[nNeighbour] = nDistance + 1;
+					lstQueue.Add(nNeighbour);
+				}
+			}
+		}
+	}
+}
+
+/**
+*  @brief
+*    Returns the memory of the assets of a cell which are not counted yet
+*/
+uint64 CellStreamer::GetUncountedMemory(const SCell &sCell, Array<bool> &lstCounted, bool bCount) const
+{
+	uint64 nMemory = 0;
+	for (uint32 i=0; i<sCell.lstAssets.GetNumOfElements(); i++) {
+		const uint32 nAsset = sCell.lstAssets[i];
+		if (!lstCounted[nAsset]) {
+			nMemory += m_lstAssetSizes[nAsset];
+			if (bCount)
+				lstCounted[nAsset] = true;
+		}
+	}
+	return nMemory;
+}
+
+/**
+*  @brief
+*    Returns the index of the cell the camera is in
+*/
+int CellStreamer::GetCameraCell(SceneNode &cCamera) const
+{
+	// Is the camera within one of the cells? The cell system moves scene nodes into the cell they are in...
+	for (const SceneContainer *pContainer=cCamera.GetContainer(); pContainer; pContainer=pContainer->GetContainer()) {
+		for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+			if (m_lstCells[i]->pContainer == pContainer)
+				return i;
+		}
+	}
+
+	// ... if not, check the camera position against the bounding boxes of the cells
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+		SceneContainer *pCell = m_lstCells[i]->pContainer;
+		Matrix3x4 mTransform;
+		if (pCell && pCell->GetContainer() && cCamera.GetTransformMatrixTo(*pCell->GetContainer(), mTransform)) {
+			const Vector3 vPosition = mTransform*Vector3::Zero;
+			const AABoundingBox &cBox = pCell->GetContainerAABoundingBox();
+			if (vPosition.x >= cBox.vMin.x && vPosition.y >= cBox.vMin.y && vPosition.z >= cBox.vMin.z &&
+				vPosition.x <= cBox.vMax.x && vPosition.y <= cBox.vMax.y && vPosition.z <= cBox.vMax.z)
+				return i;
+		}
+	}
+
+	// The camera is in none of the cells
+	return -1;
+}
+
+/**
+*  @brief
+*    Decides which cells have to be resident, called when the camera enters another cell
+*/
+void CellStreamer::UpdateResidentCells()
+{
+	m_nUpdateCounter++;
+
+	// Get the cells within the portal hops of the camera cell
+	Array<int> lstDistance;
+	GetDistances(m_nCameraCell, lstDistance);
+
+	// The required cells are always resident, even if they alone exceed the memory budget - the assets shared by
+	// several cells are counted just once
+	uint64 nMemory = 0;
+	Array<bool> lstCounted;
+	lstCounted.Resize(m_lstAssets.GetNumOfElements());
+	for (uint32 i=0; i<lstCounted.GetNumOfElements(); i++)
+		lstCounted[i] = false;
+	Array<uint32> lstOptional;
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+		SCell &sCell = *m_lstCells[i];
+		if (lstDistance[i] >= 0) {
+			sCell.nLastUsed = m_nUpdateCounter;
+			nMemory += GetUncountedMemory(sCell, lstCounted, true);
+
+			// Start loading the cell in the background
+			if (sCell.nState == Unloaded)
+				LoadCell(sCell);
+		} else if (sCell.nState != Unloaded) {
+			// Sort in, most recently used first
+			uint32 nIndex = 0;
+			while (nIndex < lstOptional.GetNumOfElements() && m_lstCells[lstOptional[nIndex]]->nLastUsed >= sCell.nLastUsed)
+				nIndex++;
+			lstOptional.AddAtIndex(i, nIndex);
+		}
+	}
+
+	// Further cells stay as long as their assets which are not resident anyway fit into the memory budget, the least recently used ones are unloaded
+	for (uint32 i=0; i<lstOptional.GetNumOfElements(); i++) {
+		SCell &sCell = *m_lstCells[lstOptional[i]];
+		if (nMemory + GetUncountedMemory(sCell, lstCounted, false) <= m_nMemoryBudget)
+			nMemory += GetUncountedMemory(sCell, lstCounted, true);
+		else
+			UnloadCell(sCell);
+	}
+}
+
+/**
+*  @brief
+*    Continues prefetching and loading the cells
+*/
+void CellStreamer::ContinueLoading()
+{
+	uint32 nNumOfNodes = 0;
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+		SCell &sCell = *m_lstCells[i];
+
+		// The camera cell can't wait, it's loaded at once
+		const bool bCameraCell = (static_cast<int>(i) == m_nCameraCell);
+
+		// Start creating the scene nodes as soon as the assets are prefetched
+		if (sCell.nState == Prefetch && (bCameraCell || sCell.pPrefetcher->IsFinished())) {
+			delete sCell.pPrefetcher;
+			sCell.pPrefetcher = nullptr;
+			sCell.nState	  = Loading;
+		}
+
+		// Create the scene nodes, time sliced
+		if (sCell.nState == Loading) {
+			while (sCell.nNextRecord < sCell.lstRecords.GetNumOfElements() && (bCameraCell || nNumOfNodes < NumOfNodesPerFrame)) {
+				// Scene node, tracked by a scene node handler because the cell system may move it into another cell
+				const SRecord &sRecord = sCell.lstRecords[sCell.nNextRecord++];
+				SceneNode *pSceneNode = sCell.pContainer->Create(sRecord.sClass, sRecord.sName, sRecord.sParameters);
+				if (pSceneNode) {
+					SceneNodeHandler *pSceneNodeHandler = new SceneNodeHandler();
+					pSceneNodeHandler->SetElement(pSceneNode);
+					sCell.lstSceneNodes.Add(pSceneNodeHandler);
+				} else {
+					PL_LOG(Warning, "Cell streaming: Failed to create '" + sCell.sPath + '.' + sRecord.sName + '\'')
+				}
+				nNumOfNodes++;
+
+				// Modifiers of the scene node
+				while (sCell.nNextRecord < sCell.lstRecords.GetNumOfElements() && sCell.lstRecords[sCell.nNextRecord].bModifier) {
+					const SRecord &sModifier = sCell.lstRecords[sCell.nNextRecord++];
+					if (pSceneNode)
+						pSceneNode->AddModifier(sModifier.sClass, sModifier.sParameters);
+				}
+			}
+			if (sCell.nNextRecord >= sCell.lstRecords.GetNumOfElements())
+				sCell.nState = Resident;
+		}
+	}
+}
+
+/**
+*  @brief
+*    Starts loading the contents of a cell in the background
+*/
+void CellStreamer::LoadCell(SCell &sCell)
+{
+	// Prefetch the assets first, the scene nodes are created by "ContinueLoading()"
+	sCell.pPrefetcher = new AssetPrefetcher(*m_pWorkerPool);
+	for (uint32 i=0; i<sCell.lstAssets.GetNumOfElements(); i++)
+		sCell.pPrefetcher->Prefetch(m_lstAssets[sCell.lstAssets[i]]);
+	sCell.nNextRecord = 0;
+	sCell.nState	  = Prefetch;
+}
+
+/**
+*  @brief
+*    Unloads the contents of a cell
+*/
+void CellStreamer::UnloadCell(SCell &sCell)
+{
+	// Stop prefetching
+	if (sCell.pPrefetcher) {
+		delete sCell.pPrefetcher;
+		sCell.pPrefetcher = nullptr;
+	}
+
+	// Destroy the scene nodes wherever they are now, while loading only the already created ones are there - the
+	// resource managers unload the meshes, materials and textures which are no longer used by any scene node
+	for (uint32 i=0; i<sCell.lstSceneNodes.GetNumOfElements(); i++) {
+		SceneNodeHandler *pSceneNodeHandler = sCell.lstSceneNodes[i];
+		SceneNode *pSceneNode = pSceneNodeHandler->GetElement();
+		if (pSceneNode)
+			pSceneNode->Delete(true);
+		delete pSceneNodeHandler;
+	}
+	sCell.lstSceneNodes.Clear();
+	sCell.nNextRecord = 0;
+	sCell.nState	  = Unloaded;
+}
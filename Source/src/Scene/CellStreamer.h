@@ -0,0 +1,410 @@
+/*********************************************************\
+ *  File: CellStreamer.h                                 *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_CELLSTREAMER_H__
+#define __DUNGEON_CELLSTREAMER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include <PLCore/Container/Array.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLCore {
+	class XmlElement;
+}
+namespace PLScene {
+	class SceneNode;
+	class SceneContext;
+	class SceneContainer;
+	class SceneNodeHandler;
+}
+class WorkerPool;
+class AssetPrefetcher;
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Cell-driven streaming of the contents of "PLScene::SCCell" containers
+*
+*  @remarks
+*    Keeps the contents of the cell the camera is in and of all cells reachable within a given number of portal
+*    hops resident. The contents of further cells are unloaded, least recently used first, as soon as the estimated
+*    memory of the resident cells exceeds the memory budget. The cell containers, their portals, cameras and helpers
+*    always stay because they are required for the cell topology, the camcorder and the scripts.
+*
+*    The contents of each cell are taken from the XML scene once. The streamer is created before the scene is loaded
+*    and writes a copy of the XML scene which only has the contents of the cells around the start camera (the
+*    "StartCamera" key of the scene), this copy is loaded instead of the XML scene. So the contents of the further
+*    cells are never loaded at all until they are required. Loading a cell first prefetches its assets on worker
+*    threads (see "AssetPrefetcher"), then the scene nodes are created time sliced over several frames so loading
+*    doesn't cause hitches. The created scene nodes are tracked by scene node handlers, so they are found for
+*    unloading even after the cell system moved them into another cell. While the streamer exists, the mesh, material
+*    and texture managers unload resources as soon as they are no longer used.
+*
+*    The memory of the resident cells is estimated by the size of the unique asset files their scene nodes reference
+*    directly (meshes, materials, sounds...), an asset shared by several resident cells is counted once. Textures
+*    referenced by materials are not taken into account.
+*
+*  @note
+*    - Unloaded scene nodes are recreated with the state described within the XML scene (e.g. moved physics bodies are reset)
+*/
+class CellStreamer {
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor, call this before the scene is loaded
+		*
+		*  @param[in] sSceneFilename
+		*    Filename of the XML scene
+		*  @param[in] sCacheDirectory
+		*    Directory the copy of the XML scene with just the initially resident cells is written into, created on demand
+		*  @param[in] nPortalHops
+		*    Number of portal hops from the camera cell within which cells stay resident
+		*  @param[in] nMemoryBudget
+		*    Memory budget of the resident cells in megabytes
+		*  @param[in] cWorkerPool
+		*    Worker pool prefetching the assets of the cells, must stay valid as long as the streamer exists
+		*
+		*  @note
+		*    - Load the scene returned by "GetSceneFilename()" and call "SetSceneContainer()" afterwards
+		*/
+		CellStreamer(const PLCore::String &sSceneFilename, const PLCore::String &sCacheDirectory, PLCore::uint32 nPortalHops, PLCore::uint32 nMemoryBudget, WorkerPool &cWorkerPool);
+
+		/**
+		*  @brief
+		*    Destructor
+		*
+		*  @note
+		*    - The cells stay as they are
+		*/
+		~CellStreamer();
+
+		/**
+		*  @brief
+		*    Returns the filename of the scene to load
+		*
+		*  @return
+		*    Filename of the copy of the XML scene with just the contents of the cells around the start camera, the
+		*    filename of the XML scene itself if there's no start camera or the copy can't be written
+		*/
+		PLCore::String GetSceneFilename() const;
+
+		/**
+		*  @brief
+		*    Sets the scene container the scene was loaded into
+		*
+		*  @param[in] cSceneContainer
+		*    Scene container the scene returned by "GetSceneFilename()" was loaded into, must stay valid as long as the streamer exists
+		*
+		*  @note
+		*    - Call this once after loading the scene, the streamer does nothing until then
+		*/
+		void SetSceneContainer(PLScene::SceneContainer &cSceneContainer);
+
+		/**
+		*  @brief
+		*    Returns the number of cells
+		*
+		*  @return
+		*    The number of cells, 0 if the scene has no cells (the streamer has nothing to do)
+		*/
+		PLCore::uint32 GetNumOfCells() const;
+
+		/**
+		*  @brief
+		*    Returns the number of resident cells
+		*
+		*  @return
+		*    The number of cells which are resident or are currently loaded
+		*/
+		PLCore::uint32 GetNumOfResidentCells() const;
+
+		/**
+		*  @brief
+		*    Returns the estimated memory of the resident cells
+		*
+		*  @return
+		*    The estimated memory of the unique assets of the cells which are resident or are currently loaded, in bytes
+		*/
+		PLCore::uint64 GetResidentMemory() const;
+
+		/**
+		*  @brief
+		*    Updates the streaming, call this once per frame
+		*
+		*  @param[in] pCamera
+		*    The current camera, can be a null pointer (the resident cells stay as they are)
+		*/
+		void Update(PLScene::SceneNode *pCamera);
+
+		/**
+		*  @brief
+		*    Requests a cell ahead of the camera, e.g. by a prefetcher knowing the camera path
+		*
+		*  @param[in] cCell
+		*    Cell container
+		*
+		*  @return
+		*    'true' if all contents of the cell are there, else 'false' (loading was started or is still running)
+		*
+		*  @note
+		*    - The cell becomes the most recently used one, but it may still be unloaded if it exceeds the memory budget
+		*/
+		bool RequestCell(const PLScene::SceneContainer &cCell);
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Cell state
+		*/
+		enum EState {
+			Resident = 0,	/**< All contents are there */
+			Prefetch = 1,	/**< The contents are unloaded, the assets are prefetched */
+			Loading  = 2,	/**< The contents are created time sliced */
+			Unloaded = 3	/**< The contents are unloaded */
+		};
+
+		/**
+		*  @brief
+		*    Scene node or modifier to create when loading a cell
+		*/
+		struct SRecord {
+			bool		   bModifier;	/**< Modifier of the previous scene node record? */
+			PLCore::String sClass;		/**< Class name */
+			PLCore::String sName;		/**< Name, empty for modifiers */
+			PLCore::String sParameters;	/**< Parameter string */
+
+			bool operator ==(const SRecord &sRecord) const
+			{
+				return (bModifier == sRecord.bModifier && sClass == sRecord.sClass && sName == sRecord.sName);
+			}
+		};
+
+		/**
+		*  @brief
+		*    Cell
+		*/
+		struct SCell {
+			PLCore::String								sName;			/**< Cell name */
+			PLCore::String								sPath;			/**< Cell name relative to the scene container */
+			PLScene::SceneContainer					   *pContainer;		/**< Cell container, a null pointer before "SetSceneContainer()" or if it wasn't loaded */
+			PLCore::Array<SRecord>						lstRecords;		/**< Contents of the cell */
+			PLCore::Array<PLScene::SceneNodeHandler*>	lstSceneNodes;	/**< Created scene nodes of the contents, always valid handlers */
+			PLCore::Array<PLCore::String>				lstTargetCells;	/**< Names of the cells the portals of this cell lead to */
+			PLCore::Array<PLCore::uint32>				lstNeighbours;	/**< Indices of the cells the portals of this cell lead to */
+			PLCore::Array<PLCore::uint32>				lstAssets;		/**< Indices of the assets referenced directly by the contents */
+			PLCore::uint32								nLastUsed;		/**< Update counter value this cell was required the last time */
+			EState										nState;			/**< Current state */
+			PLCore::uint32								nNextRecord;	/**< Index of the next record to create while loading */
+			AssetPrefetcher							   *pPrefetcher;	/**< Asset prefetcher while prefetching, else a null pointer */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private static functions                              ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Returns whether or not the scene node of a XML scene node element is streamed
+		*
+		*  @param[in] cElement
+		*    XML scene node element
+		*
+		*  @return
+		*    'true' if the scene node is streamed, 'false' if it always stays (portals, cameras, helpers and scene nodes without a name)
+		*/
+		static bool IsStreamed(const PLCore::XmlElement &cElement);
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		CellStreamer(const CellStreamer &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		CellStreamer &operator =(const CellStreamer &cSource);
+
+		/**
+		*  @brief
+		*    Collects the cells of a XML container element and its children
+		*
+		*  @param[in] cElement
+		*    XML container element
+		*  @param[in] sPath
+		*    Name of the container relative to the scene container, empty string for the scene root
+		*  @param[out] lstCellElements
+		*    Receives the XML elements of the collected cells, in the order of the cells
+		*/
+		void CollectCells(PLCore::XmlElement &cElement, const PLCore::String &sPath, PLCore::Array<PLCore::XmlElement*> &lstCellElements);
+
+		/**
+		*  @brief
+		*    Adds the records of a XML scene node element
+		*
+		*  @param[in]      cElement
+		*    XML scene node element
+		*  @param[in, out] sCell
+		*    Cell to add the records to
+		*/
+		void AddRecords(const PLCore::XmlElement &cElement, SCell &sCell);
+
+		/**
+		*  @brief
+		*    Returns the index of the cell the start camera of a XML scene is in
+		*
+		*  @param[in] cSceneElement
+		*    XML scene element
+		*
+		*  @return
+		*    The index of the cell the camera named by the "StartCamera" key is in, <0 if there's none
+		*/
+		int GetStartCell(const PLCore::XmlElement &cSceneElement) const;
+
+		/**
+		*  @brief
+		*    Returns the number of portal hops from a cell to all cells, up to the number of portal hops within which cells stay resident
+		*
+		*  @param[in]  nCell
+		*    Index of the cell to start at
+		*  @param[out] lstDistance
+		*    Receives the number of portal hops per cell, <0 for cells which are further away
+		*/
+		void GetDistances(PLCore::uint32 nCell, PLCore::Array<int> &lstDistance) const;
+
+		/**
+		*  @brief
+		*    Returns the memory of the assets of a cell which are not counted yet
+		*
+		*  @param[in]      sCell
+		*    Cell
+		*  @param[in, out] lstCounted
+		*    Per asset: already counted?
+		*  @param[in]      bCount
+		*    Mark the assets of the cell as counted?
+		*
+		*  @return
+		*    The memory of the assets of the cell which were not counted yet, in bytes
+		*/
+		PLCore::uint64 GetUncountedMemory(const SCell &sCell, PLCore::Array<bool> &lstCounted, bool bCount) const;
+
+		/**
+		*  @brief
+		*    Returns the index of the cell the camera is in
+		*
+		*  @param[in] cCamera
+		*    Camera
+		*
+		*  @return
+		*    The index of the cell the camera is in, <0 if the camera is in none of the cells
+		*/
+		int GetCameraCell(PLScene::SceneNode &cCamera) const;
+
+		/**
+		*  @brief
+		*    Decides which cells have to be resident, called when the camera enters another cell
+		*/
+		void UpdateResidentCells();
+
+		/**
+		*  @brief
+		*    Continues prefetching and loading the cells
+		*/
+		void ContinueLoading();
+
+		/**
+		*  @brief
+		*    Starts loading the contents of a cell in the background
+		*
+		*  @param[in] sCell
+		*    Cell to load, must be unloaded
+		*/
+		void LoadCell(SCell &sCell);
+
+		/**
+		*  @brief
+		*    Unloads the contents of a cell
+		*
+		*  @param[in] sCell
+		*    Cell to unload
+		*/
+		void UnloadCell(SCell &sCell);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::String					m_sSceneFilename;	/**< Filename of the scene to load */
+		PLScene::SceneContainer		   *m_pSceneContainer;	/**< Scene container the scene was loaded into, a null pointer before "SetSceneContainer()" */
+		PLScene::SceneContext		   *m_pSceneContext;	/**< Scene context of the scene container, a null pointer before "SetSceneContainer()" */
+		bool							m_bUnloadUnused[3];	/**< Previous unload unused resources setting of the mesh, material and texture manager */
+		PLCore::uint32					m_nPortalHops;		/**< Number of portal hops within which cells stay resident */
+		PLCore::uint64					m_nMemoryBudget;	/**< Memory budget of the resident cells in bytes */
+		PLCore::Array<SCell*>			m_lstCells;			/**< Cells, always valid */
+		PLCore::Array<PLCore::String>	m_lstAssets;		/**< Unique assets referenced directly by the contents of the cells */
+		PLCore::Array<PLCore::uint64>	m_lstAssetSizes;	/**< File size of each asset in bytes */
+		int								m_nCameraCell;		/**< Index of the cell the camera is in, <0 if unknown */
+		PLCore::uint32					m_nUpdateCounter;	/**< Incremented each time the camera enters another cell */
+		WorkerPool					   *m_pWorkerPool;		/**< Worker pool used for prefetching, always valid (shared, not owned) */
+
+
+};
+
+
+#endif // __DUNGEON_CELLSTREAMER_H__
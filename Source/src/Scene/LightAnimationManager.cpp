@@ -0,0 +1,288 @@
+/*********************************************************\
+ *  File: LightAnimationManager.cpp                      *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE__)
+	#define DUNGEON_ANIMATION_SSE
+	#include <xmmintrin.h>
+#endif
+#include <PLCore/Tools/Timing.h>
+#include <PLScene/Scene/SNLight.h>
+#include <PLScene/Scene/SceneContext.h>
+#include "Tools/Profiler.h"
+#include "Tools/AnimationTools.h"
+#include "SNMLightRandomAnimation.h"
+#include "Scene/LightAnimationManager.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLGraphics;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ RTTI interface                                        ]
+//[-------------------------------------------------------]
+pl_class_metadata(LightAnimationManager, "", PLCore::Object, "Batched random light color animation")
+	// Slots
+	pl_slot_0_metadata(OnUpdate,	"Called when the scene context needs to be updated",	"")
+pl_class_metadata_end(LightAnimationManager)
+
+
+//[-------------------------------------------------------]
+//[ Private static data                                   ]
+//[-------------------------------------------------------]
+LightAnimationManager *LightAnimationManager::m_pInstance = nullptr;
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Registers a light animation
+*/
+void LightAnimationManager::AddLight(SNMLightRandomAnimation &cModifier)
+{
+	SceneContext *pSceneContext = cModifier.GetSceneContext();
+	if (pSceneContext) {
+		// Create the instance on demand
+		if (!m_pInstance)
+			m_pInstance = new LightAnimationManager(*pSceneContext);
+
+		// Add the light
+		SNLight &cLight = static_cast<SNLight&>(cModifier.GetSceneNode());
+		m_pInstance->m_lstModifiers.Add(&cModifier);
+		m_pInstance->m_lstLights.Add(&cLight);
+		m_pInstance->m_lstSpeed.Add(cModifier.GetSpeed());
+		m_pInstance->m_lstRadius.Add(cModifier.GetRadius());
+		m_pInstance->m_lstCurrentIntensity.Add(cModifier.m_fCurrentIntensity);
+		m_pInstance->m_lstDestinationIntensity.Add(cModifier.m_fDestinationIntensity);
+		const Color3 &cFixColor = cModifier.GetFixColor();
+		const Color3  cColor    = cLight.Color.Get();
+		m_pInstance->m_lstFixColor[0].Add(cFixColor.r);
+		m_pInstance->m_lstFixColor[1].Add(cFixColor.g);
+		m_pInstance->m_lstFixColor[2].Add(cFixColor.b);
+		m_pInstance->m_lstColor[0].Add(cColor.r);
+		m_pInstance->m_lstColor[1].Add(cColor.g);
+		m_pInstance->m_lstColor[2].Add(cColor.b);
+		m_pInstance->m_lstFlags.Add(cModifier.GetFlags());
+
+		// Seed the random number stream by using the absolute name of the light when the modifier is activated the
+		// first time, a reactivated modifier continues where it stopped
+		if (!cModifier.m_nRandomState)
+			cModifier.m_nRandomState = AnimationTools::GetRandomSeed(cLight.GetAbsoluteName());
+		m_pInstance->m_lstRandomState.Add(cModifier.m_nRandomState);
+	}
+}
+
+/**
+*  @brief
+*    Unregisters a light animation
+*/
+void LightAnimationManager::RemoveLight(SNMLightRandomAnimation &cModifier)
+{
+	if (m_pInstance) {
+		const int nIndex = m_pInstance->m_lstModifiers.GetIndex(&cModifier);
+		if (nIndex >= 0) {
+			// Keep the animation state within the modifier, so the light doesn't jump when the modifier is activated again
+			cModifier.m_fCurrentIntensity	  = m_pInstance->m_lstCurrentIntensity[nIndex];
+			cModifier.m_fDestinationIntensity = m_pInstance->m_lstDestinationIntensity[nIndex];
+			cModifier.m_nRandomState		  = m_pInstance->m_lstRandomState[nIndex];
+
+			// Remove the light, the order of the lights doesn't matter
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstModifiers,            nIndex);
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstLights,               nIndex);
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstSpeed,                nIndex);
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstRadius,               nIndex);
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstCurrentIntensity,     nIndex);
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstDestinationIntensity, nIndex);
+			for (uint32 i=0; i<3; i++) {
+				AnimationTools::RemoveBySwap(m_pInstance->m_lstFixColor[i],      nIndex);
+				AnimationTools::RemoveBySwap(m_pInstance->m_lstColor[i],         nIndex);
+			}
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstFlags,                nIndex);
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstRandomState,          nIndex);
+
+			// Destroy the instance if it's no longer required
+			if (!m_pInstance->m_lstModifiers.GetNumOfElements()) {
+				delete m_pInstance;
+				m_pInstance = nullptr;
+			}
+		}
+	}
+}
+
+/**
+*  @brief
+*    Updates the parameters (speed, radius, fix color and flags) of a registered light animation
+*/
+void LightAnimationManager::UpdateLight(const SNMLightRandomAnimation &cModifier)
+{
+	if (m_pInstance) {
+		const int nIndex = m_pInstance->m_lstModifiers.GetIndex(const_cast<SNMLightRandomAnimation*>(&cModifier));
+		if (nIndex >= 0) {
+			m_pInstance->m_lstSpeed[nIndex]  = cModifier.GetSpeed();
+			m_pInstance->m_lstRadius[nIndex] = cModifier.GetRadius();
+			const Color3 &cFixColor = cModifier.GetFixColor();
+			m_pInstance->m_lstFixColor[0][nIndex] = cFixColor.r;
+			m_pInstance->m_lstFixColor[1][nIndex] = cFixColor.g;
+			m_pInstance->m_lstFixColor[2][nIndex] = cFixColor.b;
+			m_pInstance->m_lstFlags[nIndex] = cModifier.GetFlags();
+		}
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+LightAnimationManager::LightAnimationManager(SceneContext &cSceneContext) :
+	SlotOnUpdate(this),
+	m_pSceneContext(&cSceneContext)
+{
+	// Connect event handler
+	m_pSceneContext->EventUpdate.Connect(SlotOnUpdate);
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+LightAnimationManager::~LightAnimationManager()
+{
+	// Disconnect event handler
+	m_pSceneContext->EventUpdate.Disconnect(SlotOnUpdate);
+}
+
+/**
+*  @brief
+*    Called when the scene context needs to be updated
+*/
+void LightAnimationManager::OnUpdate()
+{
+	ProfilerScope cProfilerScope("Light animation");
+
+	const uint32 nNumOfLights = m_lstModifiers.GetNumOfElements();
+	const float  fTimeDiff    = Timing::GetInstance()->GetTimeDifference();
+
+	// Work directly on the raw arrays, this keeps the passes tight and free of bounds checks
+	const float *pfSpeed                = m_lstSpeed.GetData();
+	const float *pfRadius               = m_lstRadius.GetData();
+	float       *pfCurrentIntensity     = m_lstCurrentIntensity.GetData();
+	float       *pfDestinationIntensity = m_lstDestinationIntensity.GetData();
+	uint32      *pnRandomState          = m_lstRandomState.GetData();
+
+	// First pass: Animate the intensities, four lights at a time - the lights which reached their destination intensity
+	// get a new one, which happens just every few frames per light
+	uint32 nLight = 0;
+	#ifdef DUNGEON_ANIMATION_SSE
+		const __m128 vTimeDiff = _mm_set1_ps(fTimeDiff);
+		const __m128 vSignBit  = _mm_set1_ps(-0.0f);
+		for (; nLight+4<=nNumOfLights; nLight+=4) {
+			// Move towards the destination intensity, the step is negated where the intensity goes down
+			const __m128 vCurrent	  = _mm_loadu_ps(pfCurrentIntensity + nLight);
+			const __m128 vDestination = _mm_loadu_ps(pfDestinationIntensity + nLight);
+			const __m128 vUp		  = _mm_cmple_ps(vCurrent, vDestination);
+			const __m128 vStep		  = _mm_mul_ps(vTimeDiff, _mm_loadu_ps(pfSpeed + nLight));
+			const __m128 vNext		  = _mm_add_ps(vCurrent, _mm_xor_ps(vStep, _mm_andnot_ps(vUp, vSignBit)));
+
+			// Clamp at the destination intensity
+			const __m128 vReached = _mm_or_ps(_mm_and_ps(vUp, _mm_cmpge_ps(vNext, vDestination)), _mm_andnot_ps(vUp, _mm_cmple_ps(vNext, vDestination)));
+			_mm_storeu_ps(pfCurrentIntensity + nLight, _mm_or_ps(_mm_and_ps(vReached, vDestination), _mm_andnot_ps(vReached, vNext)));
+
+			// Choose new destinations
+			const int nReached = _mm_movemask_ps(vReached);
+			if (nReached) {
+				for (uint32 nLane=0; nLane<4; nLane++) {
+					if (nReached & (1 << nLane))
+						pfDestinationIntensity[nLight + nLane] = AnimationTools::GetRandNegFloat(pnRandomState[nLight + nLane])*pfRadius[nLight + nLane];
+				}
+			}
+		}
+	#endif
+	for (; nLight<nNumOfLights; nLight++) {
+		const float fStep = fTimeDiff*pfSpeed[nLight];
+		float fCurrentIntensity = pfCurrentIntensity[nLight];
+		const float fDestinationIntensity = pfDestinationIntensity[nLight];
+		if (fCurrentIntensity <= fDestinationIntensity) {
+			fCurrentIntensity += fStep;
+			if (fCurrentIntensity >= fDestinationIntensity) {
+				// Clamp and choose a new destination
+				fCurrentIntensity = fDestinationIntensity;
+				pfDestinationIntensity[nLight] = AnimationTools::GetRandNegFloat(pnRandomState[nLight])*pfRadius[nLight];
+			}
+		} else {
+			fCurrentIntensity -= fStep;
+			if (fCurrentIntensity <= fDestinationIntensity) {
+				// Clamp and choose a new destination
+				fCurrentIntensity = fDestinationIntensity;
+				pfDestinationIntensity[nLight] = AnimationTools::GetRandNegFloat(pnRandomState[nLight])*pfRadius[nLight];
+			}
+		}
+		pfCurrentIntensity[nLight] = fCurrentIntensity;
+	}
+
+	// Second pass: Calculate the colors (same formula as the former per-light update) and write the changed ones
+	const uint32 *pnFlags  = m_lstFlags.GetData();
+	SNLight     **ppLights = m_lstLights.GetData();
+	for (uint32 i=0; i<nNumOfLights; i++) {
+		const uint32 nFlags = pnFlags[i];
+		bool bChanged = false;
+		float fColor[3];
+		for (uint32 nComponent=0; nComponent<3; nComponent++) {
+			const float fFixColor = m_lstFixColor[nComponent].GetData()[i];
+			float &fLastColor = m_lstColor[nComponent].GetData()[i];
+			if (nFlags & (SNMLightRandomAnimation::NR<<nComponent)) {
+				fColor[nComponent] = fFixColor;
+			} else {
+				const float fColorChanged = fLastColor*pfCurrentIntensity[i];
+				fColor[nComponent] = (nFlags & SNMLightRandomAnimation::Multiply) ? fFixColor*fColorChanged : fFixColor + fColorChanged;
+			}
+
+			// Clamp the color value between 0.0 and 1.0
+			if (fColor[nComponent] < 0.0f)
+				fColor[nComponent] = 0.0f;
+			else if (fColor[nComponent] > 1.0f)
+				fColor[nComponent] = 1.0f;
+
+			// Changed?
+			if (fColor[nComponent] != fLastColor) {
+				fLastColor = fColor[nComponent];
+				bChanged = true;
+			}
+		}
+
+		// Finally, set the new color of the light
+		if (bChanged)
+			ppLights[i]->Color.Set(Color3(fColor[0], fColor[1], fColor[2]));
+	}
+}
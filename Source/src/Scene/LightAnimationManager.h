@@ -0,0 +1,161 @@
+/*********************************************************\
+ *  File: LightAnimationManager.h                        *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_LIGHTANIMATIONMANAGER_H__
+#define __DUNGEON_LIGHTANIMATIONMANAGER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Base/Object.h>
+#include <PLCore/Container/Array.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLScene {
+	class SNLight;
+	class SceneContext;
+}
+class SNMLightRandomAnimation;
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Batched random light color animation
+*
+*  @remarks
+*    Updates all active "SNMLightRandomAnimation" instances within a single pass per frame. The animation
+*    state is stored as structure of arrays, the intensities are animated four lights at a time with SSE.
+*    Every light has its own random number stream seeded by the absolute name of the light (so the
+*    animation is deterministic), and the light color attribute is only written if the color has actually
+*    changed. The animation state is moved into the modifier while it's inactive, so a light continues
+*    where it stopped when the modifier is activated again.
+*
+*    There's at most one instance (the application has a single scene context), it's created by the first
+*    registered light and destroyed when the last light is unregistered.
+*/
+class LightAnimationManager : public PLCore::Object {
+
+
+	//[-------------------------------------------------------]
+	//[ RTTI interface                                        ]
+	//[-------------------------------------------------------]
+	pl_class_def()
+		// Slots
+		pl_slot_0_def(LightAnimationManager, OnUpdate)
+	pl_class_def_end
+
+
+	//[-------------------------------------------------------]
+	//[ Public static functions                               ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Registers a light animation
+		*
+		*  @param[in] cModifier
+		*    Light animation to register, must not be registered yet and must be owned by a light scene node
+		*/
+		static void AddLight(SNMLightRandomAnimation &cModifier);
+
+		/**
+		*  @brief
+		*    Unregisters a light animation
+		*
+		*  @param[in] cModifier
+		*    Light animation to unregister
+		*/
+		static void RemoveLight(SNMLightRandomAnimation &cModifier);
+
+		/**
+		*  @brief
+		*    Updates the parameters (speed, radius, fix color and flags) of a registered light animation
+		*
+		*  @param[in] cModifier
+		*    Light animation to update, if it's not registered nothing happens
+		*/
+		static void UpdateLight(const SNMLightRandomAnimation &cModifier);
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cSceneContext
+		*    Scene context to use
+		*/
+		LightAnimationManager(PLScene::SceneContext &cSceneContext);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		virtual ~LightAnimationManager();
+
+		/**
+		*  @brief
+		*    Called when the scene context needs to be updated
+		*/
+		void OnUpdate();
+
+
+	//[-------------------------------------------------------]
+	//[ Private static data                                   ]
+	//[-------------------------------------------------------]
+	private:
+		static LightAnimationManager *m_pInstance;	/**< The light animation manager instance, can be a null pointer */
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLScene::SceneContext *m_pSceneContext;	/**< Used scene context, always valid */
+		// Per light data, all arrays have the same number of elements
+		PLCore::Array<SNMLightRandomAnimation*> m_lstModifiers;				/**< Registered light animations, always valid */
+		PLCore::Array<PLScene::SNLight*>		m_lstLights;				/**< Animated lights, always valid */
+		PLCore::Array<float>					m_lstSpeed;					/**< Animation speed */
+		PLCore::Array<float>					m_lstRadius;				/**< Animation radius */
+		PLCore::Array<float>					m_lstCurrentIntensity;		/**< Current intensity */
+		PLCore::Array<float>					m_lstDestinationIntensity;	/**< Destination intensity */
+		PLCore::Array<float>					m_lstFixColor[3];			/**< Fix color (red, green, blue) */
+		PLCore::Array<float>					m_lstColor[3];				/**< Last written light color (red, green, blue) */
+		PLCore::Array<PLCore::uint32>			m_lstFlags;					/**< Light animation flags (see "SNMLightRandomAnimation::EFlags") */
+		PLCore::Array<PLCore::uint32>			m_lstRandomState;			/**< Random number stream state */
+
+
+};
+
+
+#endif // __DUNGEON_LIGHTANIMATIONMANAGER_H__
@@ -0,0 +1,236 @@
+/*********************************************************\
+ *  File: MeshBatchCache.cpp                             *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/Xml/Xml.h>
+#include <PLCore/File/Url.h>
+#include <PLCore/File/File.h>
+#include <PLCore/Tools/LoadableManager.h>
+#include <PLCore/Tools/ChecksumMD5.h>
+#include <PLScene/Scene/SceneContainer.h>
+#include "Scene/MeshBatchCache.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Returns the cache directory of a scene
+*/
+String MeshBatchCache::GetDirectory(const String &sSceneFilename)
+{
+	return "_Cache/MeshBatches/" + Url(sSceneFilename).GetTitle() + '/';
+}
+
+/**
+*  @brief
+*    Returns the content hash of a file
+*/
+String MeshBatchCache::GetContentHash(const String &sFilename)
+{
+	File cFile;
+	return LoadableManager::GetInstance()->OpenFile(cFile, sFilename, false) ? ChecksumMD5().GetChecksumFromFile(cFile.GetUrl().GetUrl()) : "";
+}
+
+/**
+*  @brief
+*    Saves the manifest
+*/
+bool MeshBatchCache::Save(const String &sFilename, const String &sSceneHash, const Array<String> &lstMeshes, const Array<SBatch*> &lstBatches)
+{
+	XmlDocument cDocument;
+	cDocument.LinkEndChild(*new XmlDeclaration("1.0", "ISO-8859-1", ""));
+	XmlElement &cCacheElement = *new XmlElement("MeshBatches");
+	cCacheElement.SetAttribute("Version",	String::Format("%u", Version));
+	cCacheElement.SetAttribute("SceneHash", sSceneHash);
+	for (uint32 i=0; i<lstMeshes.GetNumOfElements(); i++) {
+		const String sHash = GetContentHash(lstMeshes[i]);
+		if (!sHash.GetLength())
+			return false; // Error!
+		XmlElement &cMeshElement = *new XmlElement("Mesh");
+		cMeshElement.SetAttribute("Filename", lstMeshes[i]);
+		cMeshElement.SetAttribute("Hash",	  sHash);
+		cCacheElement.LinkEndChild(cMeshElement);
+	}
+	for (uint32 nBatch=0; nBatch<lstBatches.GetNumOfElements(); nBatch++) {
+		const SBatch &sBatch = *lstBatches[nBatch];
+		XmlElement &cBatchElement = *new XmlElement("Batch");
+		cBatchElement.SetAttribute("Container", sBatch.sContainer);
+		cBatchElement.SetAttribute("Name",		sBatch.sName);
+		cBatchElement.SetAttribute("Mesh",		sBatch.sMesh);
+		cBatchElement.SetAttribute("Flags",		String::Format("%u", sBatch.nFlags));
+		for (uint32 i=0; i<sBatch.lstNodes.GetNumOfElements(); i++) {
+			XmlElement &cNodeElement = *new XmlElement("Node");
+			cNodeElement.SetAttribute("Name", sBatch.lstNodes[i]);
+			cBatchElement.LinkEndChild(cNodeElement);
+		}
+		cCacheElement.LinkEndChild(cBatchElement);
+	}
+	cDocument.LinkEndChild(cCacheElement);
+	return cDocument.Save(sFilename);
+}
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor, creates the batch scene nodes if there's an up-to-date cache
+*/
+MeshBatchCache::MeshBatchCache(SceneContainer &cSceneContainer, const String &sSceneFilename)
+{
+	// Load the manifest, the loadable manager takes care of the base directories
+	const String sFilename = GetDirectory(sSceneFilename) + "Batches.xml";
+	File cFile;
+	XmlDocument cDocument;
+	if (!LoadableManager::GetInstance()->OpenFile(cFile, sFilename, false) || !cDocument.Load(cFile))
+		return; // Error!
+	const XmlElement *pCacheElement = cDocument.GetFirstChildElement("MeshBatches");
+	if (!pCacheElement || pCacheElement->GetAttribute("Version").GetUInt32() != Version) {
+		PL_LOG(Warning, "Mesh batch cache: '" + sFilename + "' has an unknown format, bake it again")
+		return; // Error!
+	}
+
+	// The batches must match the scene and the meshes they were baked from
+	if (pCacheElement->GetAttribute("SceneHash") != GetContentHash(sSceneFilename)) {
+		PL_LOG(Warning, "Mesh batch cache: '" + sFilename + "' was baked for another version of the scene, bake it again")
+		return; // Error!
+	}
+	for (const XmlElement *pMeshElement=pCacheElement->GetFirstChildElement("Mesh"); pMeshElement; pMeshElement=pMeshElement->GetNextSiblingElement("Mesh")) {
+		if (pMeshElement->GetAttribute("Hash") != GetContentHash(pMeshElement->GetAttribute("Filename"))) {
+			PL_LOG(Warning, "Mesh batch cache: '" + pMeshElement->GetAttribute("Filename") + "' was changed since '" + sFilename + "' was baked, bake it again")
+			return; // Error!
+		}
+	}
+
+	// Create the batch scene nodes
+	for (const XmlElement *pBatchElement=pCacheElement->GetFirstChildElement("Batch"); pBatchElement; pBatchElement=pBatchElement->GetNextSiblingElement("Batch")) {
+		const String sContainer = pBatchElement->GetAttribute("Container");
+		SceneNode *pContainer = sContainer.GetLength() ? cSceneContainer.GetByName(sContainer) : &cSceneContainer;
+		if (pContainer && pContainer->IsContainer()) {
+			// All merged scene nodes must be there, a node may be merged into several batches (one per material)
+			SceneContainer &cContainer = static_cast<SceneContainer&>(*pContainer);
+			Array<SceneNode*> lstNodes;
+			bool bComplete = true;
+			for (const XmlElement *pNodeElement=pBatchElement->GetFirstChildElement("Node"); pNodeElement && bComplete; pNodeElement=pNodeElement->GetNextSiblingElement("Node")) {
+				SceneNode *pSceneNode = cContainer.GetByName(pNodeElement->GetAttribute("Name"));
+				if (pSceneNode && pSceneNode->IsInstanceOf("PLScene::SNMesh"))
+					lstNodes.Add(pSceneNode);
+				else
+					bComplete = false;
+			}
+
+			// Create the batch scene node and hide the merged scene nodes, they keep their physics bodies
+			SceneNode *pBatch = (bComplete && lstNodes.GetNumOfElements()) ? cContainer.Create("PLScene::SNMesh", pBatchElement->GetAttribute("Name"), "Mesh=\"" + pBatchElement->GetAttribute("Mesh") + '\"') : nullptr;
+			if (pBatch) {
+				pBatch->SetFlags(pBatchElement->GetAttribute("Flags").GetUInt32());
+				SceneNodeHandler *pSceneNodeHandler = new SceneNodeHandler();
+				pSceneNodeHandler->SetElement(pBatch);
+				m_lstBatches.Add(pSceneNodeHandler);
+				for (uint32 i=0; i<lstNodes.GetNumOfElements(); i++) {
+					if (lstNodes[i]->IsVisible()) {
+						lstNodes[i]->SetVisible(false);
+						pSceneNodeHandler = new SceneNodeHandler();
+						pSceneNodeHandler->SetElement(lstNodes[i]);
+						m_lstNodes.Add(pSceneNodeHandler);
+					}
+				}
+			} else {
+				PL_LOG(Warning, "Mesh batch cache: The batch '" + pBatchElement->GetAttribute("Name") + "' of '" + sContainer + "' doesn't match the scene")
+			}
+		}
+	}
+	PL_LOG(Info, String::Format("Mesh batch cache: %u static meshes are drawn by %u batches", m_lstNodes.GetNumOfElements(), m_lstBatches.GetNumOfElements()))
+}
+
+/**
+*  @brief
+*    Destructor, destroys the batch scene nodes and makes the merged scene nodes visible again
+*/
+MeshBatchCache::~MeshBatchCache()
+{
+	for (uint32 i=0; i<m_lstBatches.GetNumOfElements(); i++) {
+		SceneNode *pSceneNode = m_lstBatches[i]->GetElement();
+		if (pSceneNode)
+			pSceneNode->Delete();
+		delete m_lstBatches[i];
+	}
+	for (uint32 i=0; i<m_lstNodes.GetNumOfElements(); i++) {
+		SceneNode *pSceneNode = m_lstNodes[i]->GetElement();
+		if (pSceneNode)
+			pSceneNode->SetVisible(true);
+		delete m_lstNodes[i];
+	}
+}
+
+/**
+*  @brief
+*    Returns the number of batches
+*/
+uint32 MeshBatchCache::GetNumOfBatches() const
+{
+	return m_lstBatches.GetNumOfElements();
+}
+
+/**
+*  @brief
+*    Returns the number of merged scene nodes
+*/
+uint32 MeshBatchCache::GetNumOfMergedNodes() const
+{
+	return m_lstNodes.GetNumOfElements();
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+MeshBatchCache::MeshBatchCache(const MeshBatchCache &cSource)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+MeshBatchCache &MeshBatchCache::operator =(const MeshBatchCache &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
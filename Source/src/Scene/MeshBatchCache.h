@@ -0,0 +1,222 @@
+/*********************************************************\
+ *  File: MeshBatchCache.h                               *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_MESHBATCHCACHE_H__
+#define __DUNGEON_MESHBATCHCACHE_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include <PLCore/Container/Array.h>
+#include <PLScene/Scene/SceneNodeHandler.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLScene {
+	class SceneContainer;
+}
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Cache of the static meshes of a scene merged per container and material
+*
+*  @remarks
+*    "DungeonMeshBaker" merges the unique static meshes (see "SceneCuller::IsStaticMesh()") of each container of a scene
+*    per material into a few big meshes, the batches. Meshes repeated within a container are left to the instancer
+*    (see "MeshInstancer"). The batch meshes and a manifest describing them are written into the cache directory of
+*    the scene (e.g. "_Cache/MeshBatches/Dungeon/" for "Data/Scenes/Dungeon.scene").
+*
+*    When loading the scene, one scene node per batch is created and the merged scene nodes are made invisible. They
+*    keep their physics bodies, so picking and collisions work as before. The draw calls of a container scale with the
+*    number of its materials instead of the number of its meshes.
+*
+*    The cache is keyed by the MD5 content hashes of the XML scene and of all merged mesh files, after exporting the
+*    scene or a mesh again the cache is ignored until it's baked again. Manifest format:
+*    @verbatim
+*    <MeshBatches Version="1" SceneHash="<MD5 of the XML scene>">
+*        <Mesh Filename="<filename of a merged mesh>" Hash="<MD5 of the mesh file>" />
+*        <Batch Container="<container name relative to the scene container>" Name="<scene node name>" Mesh="<batch mesh filename>" Flags="<scene node flags>">
+*            <Node Name="<name of a merged scene node within the container>" />
+*        </Batch>
+*    </MeshBatches>
+*    @endverbatim
+*
+*  @note
+*    - Destroying the cache destroys the batch scene nodes and makes the merged scene nodes visible again
+*    - Don't use the cache together with the cell streamer, unloaded cells would lose their batches
+*/
+class MeshBatchCache {
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 Version = 1;	/**< Format version, increase on each format change */
+
+		/**
+		*  @brief
+		*    Batch description within the manifest
+		*/
+		struct SBatch {
+			PLCore::String				  sContainer;	/**< Name of the container relative to the scene container, empty for the scene container itself */
+			PLCore::String				  sName;		/**< Name of the batch scene node */
+			PLCore::String				  sMesh;		/**< Filename of the batch mesh */
+			PLCore::uint32				  nFlags;		/**< Scene node flags of the batch scene node */
+			PLCore::Array<PLCore::String> lstNodes;		/**< Names of the merged scene nodes within the container */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public static functions                               ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Returns the cache directory of a scene
+		*
+		*  @param[in] sSceneFilename
+		*    Filename of the XML scene (e.g. "Data/Scenes/Dungeon.scene")
+		*
+		*  @return
+		*    Cache directory ending with a slash, relative to the base directory (e.g. "_Cache/MeshBatches/Dungeon/")
+		*/
+		static PLCore::String GetDirectory(const PLCore::String &sSceneFilename);
+
+		/**
+		*  @brief
+		*    Returns the content hash of a file
+		*
+		*  @param[in] sFilename
+		*    Filename, the loadable manager takes care of the base directories
+		*
+		*  @return
+		*    MD5 content hash of the file, empty string on error
+		*/
+		static PLCore::String GetContentHash(const PLCore::String &sFilename);
+
+		/**
+		*  @brief
+		*    Saves the manifest
+		*
+		*  @param[in] sFilename
+		*    Filename of the manifest
+		*  @param[in] sSceneHash
+		*    Content hash of the XML scene (see "GetContentHash()")
+		*  @param[in] lstMeshes
+		*    Filenames of the merged mesh files, their content hashes are written as well
+		*  @param[in] lstBatches
+		*    Batches
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		static bool Save(const PLCore::String &sFilename, const PLCore::String &sSceneHash, const PLCore::Array<PLCore::String> &lstMeshes, const PLCore::Array<SBatch*> &lstBatches);
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor, creates the batch scene nodes if there's an up-to-date cache
+		*
+		*  @param[in] cSceneContainer
+		*    Scene container the scene was loaded into, must stay valid as long as the cache exists
+		*  @param[in] sSceneFilename
+		*    Filename of the XML scene
+		*/
+		MeshBatchCache(PLScene::SceneContainer &cSceneContainer, const PLCore::String &sSceneFilename);
+
+		/**
+		*  @brief
+		*    Destructor, destroys the batch scene nodes and makes the merged scene nodes visible again
+		*/
+		~MeshBatchCache();
+
+		/**
+		*  @brief
+		*    Returns the number of batches
+		*
+		*  @return
+		*    The number of created batch scene nodes, 0 if there's no up-to-date cache (the cache has nothing to do)
+		*/
+		PLCore::uint32 GetNumOfBatches() const;
+
+		/**
+		*  @brief
+		*    Returns the number of merged scene nodes
+		*
+		*  @return
+		*    The number of scene nodes made invisible
+		*/
+		PLCore::uint32 GetNumOfMergedNodes() const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		MeshBatchCache(const MeshBatchCache &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		MeshBatchCache &operator =(const MeshBatchCache &cSource);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::Array<PLScene::SceneNodeHandler*> m_lstBatches;	/**< Batch scene nodes */
+		PLCore::Array<PLScene::SceneNodeHandler*> m_lstNodes;	/**< Merged scene nodes, made invisible */
+
+
+};
+
+
+#endif // __DUNGEON_MESHBATCHCACHE_H__
@@ -0,0 +1,543 @@
+/*********************************************************\
+ *  File: MeshInstancer.cpp                              *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <string.h>
+#include <PLCore/Log/Log.h>
+#include <PLMath/AABoundingBox.h>
+#include <PLRenderer/Renderer/IndexBuffer.h>
+#include <PLRenderer/Renderer/VertexBuffer.h>
+#include <PLRenderer/Material/Material.h>
+#include <PLRenderer/Material/ParameterManager.h>
+#include <PLMesh/Mesh.h>
+#include <PLMesh/Geometry.h>
+#include <PLMesh/MeshHandler.h>
+#include <PLMesh/MeshManager.h>
+#include <PLMesh/MeshLODLevel.h>
+#include <PLMesh/MeshMorphTarget.h>
+#include <PLScene/Scene/SNMesh.h>
+#include <PLScene/Scene/SceneContext.h>
+#include <PLScene/Scene/SceneContainer.h>
+#include "Tools/SpatialTools.h"
+#include "Scene/SceneCuller.h"
+#include "Scene/MeshInstancer.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+using namespace PLRenderer;
+using namespace PLMesh;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ Local functions                                       ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Transforms a direction of a vertex by a 3x3 matrix given by its columns, if the vertex has the direction
+*/
+static void TransformDirection(VertexBuffer &cVertexBuffer, uint32 nVertex, VertexBuffer::ESemantic nSemantic, const Vector3 &vX, const Vector3 &vY, const Vector3 &vZ)
+{
+	float *pfDirection = static_cast<float*>(cVertexBuffer.GetData(nVertex, nSemantic));
+	if (pfDirection) {
+		// The transform may be scaled, so the direction has to be normalized again
+		Vector3 vDirection = vX*pfDirection[0] + vY*pfDirection[1] + vZ*pfDirection[2];
+		const float fLength = vDirection.GetLength();
+		if (fLength > 0.0f)
+			vDirection = vDirection*(1.0f/fLength);
+		pfDirection[0] = vDirection.x;
+		pfDirection[1] = vDirection.y;
+		pfDirection[2] = vDirection.z;
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Transforms a vertex of a locked vertex buffer
+*/
+Vector3 MeshInstancer::TransformVertex(VertexBuffer &cVertexBuffer, uint32 nVertex, const Matrix3x4 &mTransform)
+{
+	// Transform the position
+	float *pfPosition = static_cast<float*>(cVertexBuffer.GetData(nVertex, VertexBuffer::Position));
+	const Vector3 vPosition = mTransform*Vector3(pfPosition[0], pfPosition[1], pfPosition[2]);
+	pfPosition[0] = vPosition.x;
+	pfPosition[1] = vPosition.y;
+	pfPosition[2] = vPosition.z;
+
+	// Tangents and binormals lie within the surface, they are transformed like the positions
+	const Vector3 vX(mTransform.xx, mTransform.yx, mTransform.zx);
+	const Vector3 vY(mTransform.xy, mTransform.yy, mTransform.zy);
+	const Vector3 vZ(mTransform.xz, mTransform.yz, mTransform.zz);
+	TransformDirection(cVertexBuffer, nVertex, VertexBuffer::Tangent,  vX, vY, vZ);
+	TransformDirection(cVertexBuffer, nVertex, VertexBuffer::Binormal, vX, vY, vZ);
+
+	// Normals have to stay perpendicular to the surface under non-uniform scale, so they are transformed by the inverse
+	// transpose - that's the cofactor matrix divided by the determinant, the length doesn't matter but the sign does
+	Vector3 vNormalX = vY.CrossProduct(vZ);
+	Vector3 vNormalY = vZ.CrossProduct(vX);
+	Vector3 vNormalZ = vX.CrossProduct(vY);
+	if (vX.DotProduct(vNormalX) < 0.0f) {
+		vNormalX = -vNormalX;
+		vNormalY = -vNormalY;
+		vNormalZ = -vNormalZ;
+	}
+	TransformDirection(cVertexBuffer, nVertex, VertexBuffer::Normal, vNormalX, vNormalY, vNormalZ);
+
+	// Done
+	return vPosition;
+}
+
+/**
+*  @brief
+*    Returns whether or not a mesh can be replicated into a batch
+*/
+bool MeshInstancer::IsBatchable(Mesh &cMesh)
+{
+	// Morph targets would have to be replicated as well
+	MeshMorphTarget *pMorphTarget  = (cMesh.GetNumOfMorphTargets() == 1) ? cMesh.GetMorphTarget(0) : nullptr;
+	VertexBuffer	*pVertexBuffer = pMorphTarget ? pMorphTarget->GetVertexBuffer() : nullptr;
+	if (!pVertexBuffer || !pVertexBuffer->GetNumOfElements() || !cMesh.GetNumOfLODLevels())
+		return false;
+
+	// The positions and the directions are transformed, so they must be floats
+	bool bPosition = false;
+	for (uint32 i=0; i<pVertexBuffer->GetNumOfVertexAttributes(); i++) {
+		const VertexBuffer::Attribute *pAttribute = pVertexBuffer->GetVertexAttribute(i);
+		if (!pAttribute)
+			return false;
+		if (pAttribute->nSemantic == VertexBuffer::Position || pAttribute->nSemantic == VertexBuffer::Normal ||
+			pAttribute->nSemantic == VertexBuffer::Tangent || pAttribute->nSemantic == VertexBuffer::Binormal) {
+			if (pAttribute->nType != VertexBuffer::Float3 && pAttribute->nType != VertexBuffer::Float4)
+				return false;
+			if (pAttribute->nSemantic == VertexBuffer::Position)
+				bPosition = true;
+		}
+	}
+	if (!bPosition)
+		return false;
+
+	// Triangle lists can be concatenated, strips and fans can't
+	for (uint32 nLODLevel=0; nLODLevel<cMesh.GetNumOfLODLevels(); nLODLevel++) {
+		MeshLODLevel		  *pLODLevel	  = cMesh.GetLODLevel(nLODLevel);
+		IndexBuffer			  *pIndexBuffer	  = pLODLevel ? pLODLevel->GetIndexBuffer() : nullptr;
+		const Array<Geometry> *plstGeometries = pLODLevel ? pLODLevel->GetGeometries() : nullptr;
+		if (!pIndexBuffer || !plstGeometries)
+			return false;
+		for (uint32 i=0; i<plstGeometries->GetNumOfElements(); i++) {
+			const Geometry &cGeometry = (*plstGeometries)[i];
+			if (cGeometry.GetPrimitiveType() != Primitive::TriangleList || cGeometry.GetStartIndex() + cGeometry.GetIndexSize() > pIndexBuffer->GetNumOfElements())
+				return false;
+		}
+	}
+
+	// Done
+	return true;
+}
+
+/**
+*  @brief
+*    Returns the static meshes of a container the instancer will draw by batches
+*/
+void MeshInstancer::WillBatch(SceneContainer &cContainer, Array<SNMesh*> &lstSceneNodes)
+{
+	// Exactly the grouping and splitting the instancer does
+	Array<SGroup*> lstGroups;
+	GroupContainer(cContainer, lstGroups);
+	Array<uint32> lstRanges;
+	for (uint32 nGroup=0; nGroup<lstGroups.GetNumOfElements(); nGroup++) {
+		SGroup *pGroup = lstGroups[nGroup];
+		lstRanges.Reset();
+		SplitGroup(*pGroup, 0, pGroup->lstInstances.GetNumOfElements(), lstRanges);
+		for (uint32 nRange=0; nRange<lstRanges.GetNumOfElements(); nRange+=2) {
+			for (uint32 i=lstRanges[nRange]; i<lstRanges[nRange] + lstRanges[nRange + 1]; i++)
+				lstSceneNodes.Add(pGroup->lstInstances[i].pSceneNode);
+		}
+		delete pGroup;
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor, builds the batches
+*/
+MeshInstancer::MeshInstancer(SceneContainer &cSceneContainer)
+{
+	memset(&m_sStatistics, 0, sizeof(m_sStatistics));
+	AddContainer(cSceneContainer);
+	PL_LOG(Info, String::Format("Instancing: %u of %u static meshes are drawn by %u batches", m_sStatistics.nNumOfInstances, m_sStatistics.nNumOfMeshes, m_sStatistics.nNumOfBatches))
+}
+
+/**
+*  @brief
+*    Destructor, destroys the batches and makes the instances visible again
+*/
+MeshInstancer::~MeshInstancer()
+{
+	for (uint32 nBatch=0; nBatch<m_lstBatches.GetNumOfElements(); nBatch++) {
+		SBatch *pBatch = m_lstBatches[nBatch];
+
+		// Destroy the scene node first, it's using the mesh
+		SceneNode *pSceneNode = pBatch->cSceneNode.GetElement();
+		if (pSceneNode)
+			pSceneNode->Delete();
+		delete pBatch->pMesh;
+
+		// Make the instances visible again
+		for (uint32 i=0; i<pBatch->lstInstances.GetNumOfElements(); i++) {
+			SceneNode *pInstance = pBatch->lstInstances[i]->GetElement();
+			if (pInstance)
+				pInstance->SetVisible(true);
+			delete pBatch->lstInstances[i];
+		}
+		delete pBatch;
+	}
+}
+
+/**
+*  @brief
+*    Returns the number of batches
+*/
+uint32 MeshInstancer::GetNumOfBatches() const
+{
+	return m_lstBatches.GetNumOfElements();
+}
+
+/**
+*  @brief
+*    Returns the instancing statistics
+*/
+const MeshInstancer::SStatistics &MeshInstancer::GetStatistics() const
+{
+	return m_sStatistics;
+}
+
+
+//[-------------------------------------------------------]
+//[ Private static functions                              ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Groups the static meshes of a container by mesh, materials and flags
+*/
+uint32 MeshInstancer::GroupContainer(SceneContainer &cContainer, Array<SGroup*> &lstGroups)
+{
+	uint32 nNumOfMeshes = 0;
+	for (uint32 nElement=0; nElement<cContainer.GetNumOfElements(); nElement++) {
+		SceneNode *pSceneNode = cContainer.GetByIndex(nElement);
+		if (pSceneNode && !pSceneNode->IsContainer() && SceneCuller::IsStaticMesh(*pSceneNode)) {
+			nNumOfMeshes++;
+			SNMesh		&cSNMesh	  = static_cast<SNMesh&>(*pSceneNode);
+			MeshHandler *pMeshHandler = cSNMesh.GetMeshHandler();
+			Mesh		*pMesh		  = pMeshHandler ? pMeshHandler->GetResource() : nullptr;
+			SInstance sInstance;
+			if (pMesh && IsBatchable(*pMesh) && pSceneNode->GetTransformMatrixTo(cContainer, sInstance.mTransform)) {
+				// Transparent materials are drawn back to front per scene node, merged instances would be drawn in the wrong order
+				bool bOpaque = true;
+				for (uint32 i=0; i<pMeshHandler->GetNumOfMaterials() && bOpaque; i++) {
+					Material *pMaterial = pMeshHandler->GetMaterial(i);
+					if (!pMaterial || pMaterial->GetParameterManager().GetParameter("Opacity"))
+						bOpaque = false;
+				}
+				if (bOpaque) {
+					const AABoundingBox &cBox = pSceneNode->GetContainerAABoundingBox();
+					sInstance.pSceneNode = &cSNMesh;
+					sInstance.vCenter	 = (cBox.vMin + cBox.vMax)*0.5f;
+
+					// Find the group of the instance
+					SGroup *pGroup = nullptr;
+					for (uint32 nGroup=0; nGroup<lstGroups.GetNumOfElements() && !pGroup; nGroup++) {
+						SGroup *pCandidate = lstGroups[nGroup];
+						if (pCandidate->pMesh == pMesh && pCandidate->nFlags == pSceneNode->GetFlags() && pCandidate->lstMaterials.GetNumOfElements() == pMeshHandler->GetNumOfMaterials()) {
+							pGroup = pCandidate;
+							for (uint32 i=0; i<pMeshHandler->GetNumOfMaterials() && pGroup; i++) {
+								if (pCandidate->lstMaterials[i] != pMeshHandler->GetMaterial(i))
+									pGroup = nullptr;
+							}
+						}
+					}
+					if (!pGroup) {
+						pGroup = new SGroup;
+						pGroup->pMesh  = pMesh;
+						pGroup->nFlags = pSceneNode->GetFlags();
+						for (uint32 i=0; i<pMeshHandler->GetNumOfMaterials(); i++)
+							pGroup->lstMaterials.Add(pMeshHandler->GetMaterial(i));
+						lstGroups.Add(pGroup);
+					}
+					pGroup->lstInstances.Add(sInstance);
+				}
+			}
+		}
+	}
+	return nNumOfMeshes;
+}
+
+/**
+*  @brief
+*    Splits the instances of a group into the instance ranges of the batches
+*/
+void MeshInstancer::SplitGroup(SGroup &sGroup, uint32 nFirst, uint32 nCount, Array<uint32> &lstRanges)
+{
+	// A batch gets 16 bit indices, so the number of vertices limits the number of instances as well
+	const uint32 nNumOfVertices = sGroup.pMesh->GetMorphTarget(0)->GetVertexBuffer()->GetNumOfElements();
+	uint32 nMaxInstances = MaxVerticesPerBatch/nNumOfVertices;
+	if (nMaxInstances > MaxInstancesPerBatch)
+		nMaxInstances = MaxInstancesPerBatch;
+
+	// Split the instances at the median along the axis they are spread the most, so each batch covers a compact region
+	if (nMaxInstances < MinInstancesPerBatch) {
+		// Not worth a batch
+
+	} else if (nCount > nMaxInstances) {
+		SpatialTools::SortByCenter(&sGroup.lstInstances[nFirst], nCount);
+		const uint32 nHalf = nCount/2;
+		SplitGroup(sGroup, nFirst, nHalf, lstRanges);
+		SplitGroup(sGroup, nFirst + nHalf, nCount - nHalf, lstRanges);
+
+	// Add the range, if it's worth a batch
+	} else if (nCount >= MinInstancesPerBatch) {
+		lstRanges.Add(nFirst);
+		lstRanges.Add(nCount);
+	}
+}
+
+/**
+*  @brief
+*    Bakes the mesh of a batch
+*/
+Mesh *MeshInstancer::BakeMesh(MeshManager &cMeshManager, const String &sName, const SGroup &sGroup, const SBatch &sBatch, Vector3 &vMin, Vector3 &vMax)
+{
+	Mesh		 &cSourceMesh		  = *sGroup.pMesh;
+	VertexBuffer &cSourceVertexBuffer = *cSourceMesh.GetMorphTarget(0)->GetVertexBuffer();
+	const uint32 nNumOfInstances = sBatch.lstTransforms.GetNumOfElements();
+	const uint32 nNumOfVertices	 = cSourceVertexBuffer.GetNumOfElements();
+	Mesh *pMesh = cMeshManager.CreateMesh(sName);
+	if (!pMesh)
+		return nullptr; // Error!
+
+	// The batch uses the materials of the mesh handlers, they may differ from the ones of the mesh
+	for (uint32 i=0; i<sGroup.lstMaterials.GetNumOfElements(); i++)
+		pMesh->AddMaterial(sGroup.lstMaterials[i]);
+
+	// Replicate the vertices, the positions are transformed by the instance transforms and the directions are rotated
+	bool bResult = false;
+	MeshMorphTarget *pMorphTarget  = pMesh->AddMorphTarget();
+	VertexBuffer	*pVertexBuffer = pMorphTarget ? pMorphTarget->GetVertexBuffer() : nullptr;
+	if (pVertexBuffer) {
+		for (uint32 i=0; i<cSourceVertexBuffer.GetNumOfVertexAttributes(); i++) {
+			const VertexBuffer::Attribute *pAttribute = cSourceVertexBuffer.GetVertexAttribute(i);
+			pVertexBuffer->AddVertexAttribute(pAttribute->nSemantic, pAttribute->nChannel, pAttribute->nType);
+		}
+		if (pVertexBuffer->Allocate(nNumOfVertices*nNumOfInstances, Usage::Static) && pVertexBuffer->GetVertexSize() == cSourceVertexBuffer.GetVertexSize()) {
+			const uint8 *pSourceData = static_cast<const uint8*>(cSourceVertexBuffer.Lock(Lock::ReadOnly));
+			if (pSourceData) {
+				uint8 *pData = static_cast<uint8*>(pVertexBuffer->Lock(Lock::WriteOnly));
+				if (pData) {
+					const uint32 nSize = nNumOfVertices*cSourceVertexBuffer.GetVertexSize();
+					for (uint32 nInstance=0; nInstance<nNumOfInstances; nInstance++) {
+						const Matrix3x4 &mTransform = sBatch.lstTransforms[nInstance];
+						memcpy(pData + nInstance*nSize, pSourceData, nSize);
+						for (uint32 nVertex=nInstance*nNumOfVertices; nVertex<(nInstance + 1)*nNumOfVertices; nVertex++) {
+							const Vector3 vPosition = TransformVertex(*pVertexBuffer, nVertex, mTransform);
+							if (!nVertex) {
+								vMin = vMax = vPosition;
+							} else {
+								if (vMin.x > vPosition.x) vMin.x = vPosition.x;
+								if (vMin.y > vPosition.y) vMin.y = vPosition.y;
+								if (vMin.z > vPosition.z) vMin.z = vPosition.z;
+								if (vMax.x < vPosition.x) vMax.x = vPosition.x;
+								if (vMax.y < vPosition.y) vMax.y = vPosition.y;
+								if (vMax.z < vPosition.z) vMax.z = vPosition.z;
+							}
+						}
+					}
+					pVertexBuffer->Unlock();
+					bResult = true;
+				}
+				cSourceVertexBuffer.Unlock();
+			}
+		}
+	}
+
+	// Replicate the indices of each geometry of each level of detail, so each geometry is still drawn at once
+	for (uint32 nLODLevel=0; nLODLevel<cSourceMesh.GetNumOfLODLevels() && bResult; nLODLevel++) {
+		MeshLODLevel		  &cSourceLODLevel		= *cSourceMesh.GetLODLevel(nLODLevel);
+		IndexBuffer			  &cSourceIndexBuffer	= *cSourceLODLevel.GetIndexBuffer();
+		const Array<Geometry> &lstSourceGeometries	= *cSourceLODLevel.GetGeometries();
+		MeshLODLevel		  *pLODLevel			= pMesh->AddLODLevel();
+		bResult = false;
+		if (pLODLevel) {
+			pLODLevel->CreateIndexBuffer();
+			pLODLevel->CreateGeometries();
+			IndexBuffer		*pIndexBuffer	= pLODLevel->GetIndexBuffer();
+			Array<Geometry> *plstGeometries = pLODLevel->GetGeometries();
+			uint32 nNumOfIndices = 0;
+			for (uint32 i=0; i<lstSourceGeometries.GetNumOfElements(); i++)
+				nNumOfIndices += lstSourceGeometries[i].GetIndexSize();
+			if (pIndexBuffer && plstGeometries && nNumOfIndices) {
+				pIndexBuffer->SetElementTypeByMaximumIndex(nNumOfVertices*nNumOfInstances - 1);
+				if (pIndexBuffer->Allocate(nNumOfIndices*nNumOfInstances, Usage::Static) && cSourceIndexBuffer.Lock(Lock::ReadOnly)) {
+					if (pIndexBuffer->Lock(Lock::WriteOnly)) {
+						uint32 nIndex = 0;
+						for (uint32 nGeometry=0; nGeometry<lstSourceGeometries.GetNumOfElements(); nGeometry++) {
+							const Geometry &cSourceGeometry = lstSourceGeometries[nGeometry];
+							Geometry &cGeometry = plstGeometries->Add();
+							cGeometry.SetPrimitiveType(Primitive::TriangleList);
+							cGeometry.SetMaterial(cSourceGeometry.GetMaterial());
+							cGeometry.SetStartIndex(nIndex);
+							cGeometry.SetIndexSize(cSourceGeometry.GetIndexSize()*nNumOfInstances);
+							const uint32 nEndIndex = cSourceGeometry.GetStartIndex() + cSourceGeometry.GetIndexSize();
+							for (uint32 nInstance=0; nInstance<nNumOfInstances; nInstance++) {
+								for (uint32 i=cSourceGeometry.GetStartIndex(); i<nEndIndex; i++)
+									pIndexBuffer->SetData(nIndex++, cSourceIndexBuffer.GetData(i) + nInstance*nNumOfVertices);
+							}
+						}
+						pIndexBuffer->Unlock();
+						bResult = true;
+					}
+					cSourceIndexBuffer.Unlock();
+				}
+			}
+		}
+	}
+
+	// Error?
+	if (!bResult) {
+		delete pMesh;
+		return nullptr; // Error!
+	}
+
+	// Done
+	pMesh->SetBoundingBox(vMin, vMax);
+	return pMesh;
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+MeshInstancer::MeshInstancer(const MeshInstancer &cSource)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+MeshInstancer &MeshInstancer::operator =(const MeshInstancer &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Groups the static meshes of a container and creates the batches, recursive
+*/
+void MeshInstancer::AddContainer(SceneContainer &cContainer)
+{
+	// Child containers are grouped on their own so the batches stay within the cells
+	for (uint32 nElement=0; nElement<cContainer.GetNumOfElements(); nElement++) {
+		SceneNode *pSceneNode = cContainer.GetByIndex(nElement);
+		if (pSceneNode && pSceneNode->IsContainer())
+			AddContainer(static_cast<SceneContainer&>(*pSceneNode));
+	}
+
+	// Group the static meshes by mesh, materials and flags
+	Array<SGroup*> lstGroups;
+	m_sStatistics.nNumOfMeshes += GroupContainer(cContainer, lstGroups);
+
+	// Batch the repeated meshes, the scene nodes are added after the elements of the container were visited
+	Array<uint32> lstRanges;
+	for (uint32 nGroup=0; nGroup<lstGroups.GetNumOfElements(); nGroup++) {
+		SGroup *pGroup = lstGroups[nGroup];
+		lstRanges.Reset();
+		SplitGroup(*pGroup, 0, pGroup->lstInstances.GetNumOfElements(), lstRanges);
+		for (uint32 nRange=0; nRange<lstRanges.GetNumOfElements(); nRange+=2)
+			AddBatch(cContainer, *pGroup, lstRanges[nRange], lstRanges[nRange + 1]);
+		delete pGroup;
+	}
+}
+
+/**
+*  @brief
+*    Creates a batch
+*/
+void MeshInstancer::AddBatch(SceneContainer &cContainer, const SGroup &sGroup, uint32 nFirst, uint32 nCount)
+{
+	if (cContainer.GetSceneContext()) {
+		// Build the instance list
+		SBatch *pBatch = new SBatch;
+		for (uint32 i=0; i<nCount; i++)
+			pBatch->lstTransforms.Add(sGroup.lstInstances[nFirst + i].mTransform);
+
+		// Bake the mesh and create the scene node drawing it, the scene node has no transform so container space is mesh space
+		const String sName = String::Format("InstanceBatch%u", m_lstBatches.GetNumOfElements());
+		Vector3 vMin, vMax;
+		pBatch->pMesh = BakeMesh(cContainer.GetSceneContext()->GetMeshManager(), cContainer.GetAbsoluteName() + '.' + sName, sGroup, *pBatch, vMin, vMax);
+		SceneNode *pSceneNode = pBatch->pMesh ? cContainer.Create("PLScene::SNMesh", sName) : nullptr;
+		MeshHandler *pMeshHandler = pSceneNode ? static_cast<SNMesh*>(pSceneNode)->GetMeshHandler() : nullptr;
+		if (pMeshHandler) {
+			pMeshHandler->SetMesh(pBatch->pMesh);
+			pSceneNode->SetFlags(sGroup.nFlags);
+			pSceneNode->SetAABoundingBox(AABoundingBox(vMin, vMax));
+			pBatch->cSceneNode.SetElement(pSceneNode);
+
+			// The instances are drawn by the batch, they keep their physics bodies
+			for (uint32 i=0; i<nCount; i++) {
+				SNMesh *pInstance = sGroup.lstInstances[nFirst + i].pSceneNode;
+				pInstance->SetVisible(false);
+				SceneNodeHandler *pSceneNodeHandler = new SceneNodeHandler();
+				pSceneNodeHandler->SetElement(pInstance);
+				pBatch->lstInstances.Add(pSceneNodeHandler);
+			}
+			m_lstBatches.Add(pBatch);
+			m_sStatistics.nNumOfInstances += nCount;
+			m_sStatistics.nNumOfBatches++;
+		} else {
+			// Error!
+			if (pSceneNode)
+				pSceneNode->Delete();
+			if (pBatch->pMesh)
+				delete pBatch->pMesh;
+			delete pBatch;
+		}
+	}
+}
@@ -0,0 +1,347 @@
+/*********************************************************\
+ *  File: MeshInstancer.h                                *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_MESHINSTANCER_H__
+#define __DUNGEON_MESHINSTANCER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include <PLCore/Container/Array.h>
+#include <PLMath/Vector3.h>
+#include <PLMath/Matrix3x4.h>
+#include <PLScene/Scene/SceneNodeHandler.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLRenderer {
+	class Material;
+	class VertexBuffer;
+}
+namespace PLMesh {
+	class Mesh;
+	class MeshManager;
+}
+namespace PLScene {
+	class SNMesh;
+	class SceneNode;
+	class SceneContainer;
+}
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Load-time instancing of repeated static meshes
+*
+*  @remarks
+*    The static meshes (see "SceneCuller::IsStaticMesh()") of each container which share the same mesh, the same
+*    materials and the same scene node flags are grouped into instance lists. The instances of a group are sorted along
+*    the axis their centers are spread the most and split into batches of at most "MaxInstancesPerBatch" instances, so
+*    each batch covers a compact region and the culler can still reject it. Each batch keeps the transforms of its
+*    instances within container space.
+*
+*    The renderer has no instanced draw call, so each batch is baked into one mesh on the CPU: the vertices of the
+*    shared mesh are replicated once per instance and transformed by the instance transform, the indices of each
+*    geometry of each level of detail are replicated and offset. One scene node draws the batch, the instance scene
+*    nodes are made invisible and keep their physics bodies. A batch costs one draw call per geometry instead of one per
+*    geometry and instance.
+*
+*  @note
+*    - Groups with less than "MinInstancesPerBatch" instances, meshes with several morph targets, triangle strips or
+*      fans and transparent materials (their draw order matters) are left as they are
+*    - Destroying the instancer destroys the batches and makes the instances visible again
+*    - Don't use the instancer together with the cell streamer, unloaded cells would lose their batches
+*/
+class MeshInstancer {
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 MinInstancesPerBatch = 4;		/**< Minimum number of instances of a batch, fewer instances are not worth a batch */
+		static const PLCore::uint32 MaxInstancesPerBatch = 64;		/**< Maximum number of instances of a batch, bigger groups are split spatially */
+		static const PLCore::uint32 MaxVerticesPerBatch	 = 65536;	/**< Maximum number of vertices of a batch, so a batch gets 16 bit indices */
+
+		/**
+		*  @brief
+		*    Instancing statistics
+		*/
+		struct SStatistics {
+			PLCore::uint32 nNumOfMeshes;	/**< Number of static meshes looked at */
+			PLCore::uint32 nNumOfInstances;	/**< Number of the static meshes which are drawn by batches */
+			PLCore::uint32 nNumOfBatches;	/**< Number of batches */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public static functions                               ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Transforms a vertex of a locked vertex buffer
+		*
+		*  @param[in] cVertexBuffer
+		*    Locked vertex buffer, the position, normal, tangent and binormal must be floats if there are ones
+		*  @param[in] nVertex
+		*    Index of the vertex, must be valid
+		*  @param[in] mTransform
+		*    Transform, may be scaled non-uniformly - the tangent and binormal are transformed by it, the normal by its
+		*    inverse transpose, all of them are normalized again
+		*
+		*  @return
+		*    The transformed position
+		*/
+		static PLMath::Vector3 TransformVertex(PLRenderer::VertexBuffer &cVertexBuffer, PLCore::uint32 nVertex, const PLMath::Matrix3x4 &mTransform);
+
+		/**
+		*  @brief
+		*    Returns whether or not a mesh can be replicated into a batch
+		*
+		*  @param[in] cMesh
+		*    Mesh to check
+		*
+		*  @return
+		*    'true' if the mesh has a single morph target, float positions and directions and just triangle lists, else 'false'
+		*/
+		static bool IsBatchable(PLMesh::Mesh &cMesh);
+
+		/**
+		*  @brief
+		*    Returns the static meshes of a container the instancer will draw by batches
+		*
+		*  @param[in]  cContainer
+		*    Container, its child containers are not looked into (they are grouped on their own)
+		*  @param[out] lstSceneNodes
+		*    Receives the mesh scene nodes the instancer will draw by batches, the list is not cleared before
+		*
+		*  @remarks
+		*    Applies exactly the grouping (mesh, materials and flags), the vertex limit and the minimum number of instances
+		*    per batch of the instancer, so offline tools can leave these meshes to it (see "MeshBaker").
+		*/
+		static void WillBatch(PLScene::SceneContainer &cContainer, PLCore::Array<PLScene::SNMesh*> &lstSceneNodes);
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor, builds the batches
+		*
+		*  @param[in] cSceneContainer
+		*    Scene container the scene was loaded into, must stay valid as long as the instancer exists
+		*/
+		MeshInstancer(PLScene::SceneContainer &cSceneContainer);
+
+		/**
+		*  @brief
+		*    Destructor, destroys the batches and makes the instances visible again
+		*/
+		~MeshInstancer();
+
+		/**
+		*  @brief
+		*    Returns the number of batches
+		*
+		*  @return
+		*    The number of batches, 0 if the scene has no repeated static meshes (the instancer has nothing to do)
+		*/
+		PLCore::uint32 GetNumOfBatches() const;
+
+		/**
+		*  @brief
+		*    Returns the instancing statistics
+		*
+		*  @return
+		*    The instancing statistics
+		*/
+		const SStatistics &GetStatistics() const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Instance, a static mesh scene node which is drawn by a batch
+		*/
+		struct SInstance {
+			PLScene::SNMesh	  *pSceneNode;	/**< Mesh scene node, always valid */
+			PLMath::Matrix3x4  mTransform;	/**< Transform into container space */
+			PLMath::Vector3	   vCenter;		/**< Center of the bounding box within container space */
+		};
+
+		/**
+		*  @brief
+		*    Group of static meshes which can be drawn by the same batch
+		*/
+		struct SGroup {
+			PLMesh::Mesh						*pMesh;			/**< Shared mesh, always valid */
+			PLCore::Array<PLRenderer::Material*> lstMaterials;	/**< Materials of the mesh handlers */
+			PLCore::uint32						 nFlags;		/**< Scene node flags */
+			PLCore::Array<SInstance>			 lstInstances;	/**< Instance list */
+		};
+
+		/**
+		*  @brief
+		*    Batch
+		*/
+		struct SBatch {
+			PLScene::SceneNodeHandler				  cSceneNode;		/**< Scene node drawing the batch, no element if it was destroyed */
+			PLMesh::Mesh							 *pMesh;			/**< Baked mesh of the batch, always valid */
+			PLCore::Array<PLScene::SceneNodeHandler*> lstInstances;		/**< Instance scene nodes, made invisible */
+			PLCore::Array<PLMath::Matrix3x4>		  lstTransforms;	/**< Per instance transforms within container space */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private static functions                              ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Groups the static meshes of a container by mesh, materials and flags
+		*
+		*  @param[in]  cContainer
+		*    Container to group, child containers are not looked into
+		*  @param[out] lstGroups
+		*    Receives the groups, the caller has to delete them
+		*
+		*  @return
+		*    Number of static meshes looked at
+		*/
+		static PLCore::uint32 GroupContainer(PLScene::SceneContainer &cContainer, PLCore::Array<SGroup*> &lstGroups);
+
+		/**
+		*  @brief
+		*    Splits the instances of a group into the instance ranges of the batches, recursive
+		*
+		*  @param[in, out] sGroup
+		*    Group, the instances are sorted
+		*  @param[in]      nFirst
+		*    Index of the first instance to split
+		*  @param[in]      nCount
+		*    Number of instances to split
+		*  @param[out]     lstRanges
+		*    Receives the index of the first instance and the number of instances of each batch, ranges with less than
+		*    "MinInstancesPerBatch" instances are left out
+		*/
+		static void SplitGroup(SGroup &sGroup, PLCore::uint32 nFirst, PLCore::uint32 nCount, PLCore::Array<PLCore::uint32> &lstRanges);
+
+		/**
+		*  @brief
+		*    Bakes the mesh of a batch
+		*
+		*  @param[in] cMeshManager
+		*    Mesh manager creating the mesh
+		*  @param[in] sName
+		*    Name of the mesh
+		*  @param[in] sGroup
+		*    Group the batch is part of
+		*  @param[in] sBatch
+		*    Batch with the per instance transforms
+		*  @param[out] vMin
+		*    Receives the minimum of the bounding box within container space
+		*  @param[out] vMax
+		*    Receives the maximum of the bounding box within container space
+		*
+		*  @return
+		*    The created mesh, null pointer on error
+		*/
+		static PLMesh::Mesh *BakeMesh(PLMesh::MeshManager &cMeshManager, const PLCore::String &sName, const SGroup &sGroup, const SBatch &sBatch,
+									  PLMath::Vector3 &vMin, PLMath::Vector3 &vMax);
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		MeshInstancer(const MeshInstancer &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		MeshInstancer &operator =(const MeshInstancer &cSource);
+
+		/**
+		*  @brief
+		*    Groups the static meshes of a container and creates the batches, recursive
+		*
+		*  @param[in] cContainer
+		*    Container to group, the child containers are grouped on their own
+		*/
+		void AddContainer(PLScene::SceneContainer &cContainer);
+
+		/**
+		*  @brief
+		*    Creates a batch
+		*
+		*  @param[in] cContainer
+		*    Container of the group
+		*  @param[in] sGroup
+		*    Group the batch is part of
+		*  @param[in] nFirst
+		*    Index of the first instance of the batch
+		*  @param[in] nCount
+		*    Number of instances of the batch
+		*/
+		void AddBatch(PLScene::SceneContainer &cContainer, const SGroup &sGroup, PLCore::uint32 nFirst, PLCore::uint32 nCount);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::Array<SBatch*> m_lstBatches;	/**< Batches */
+		SStatistics			   m_sStatistics;	/**< Instancing statistics */
+
+
+};
+
+
+#endif // __DUNGEON_MESHINSTANCER_H__
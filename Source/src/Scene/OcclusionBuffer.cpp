@@ -0,0 +1,332 @@
+/*********************************************************\
+ *  File: OcclusionBuffer.cpp                            *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <string.h>
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE__)
+	#define DUNGEON_CULLING_SSE
+	#include <xmmintrin.h>
+#endif
+#include "Scene/OcclusionBuffer.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+static const float DepthBias	   = 0.001f;	/**< Relative bias moving a tested box towards the eye, so an occluder doesn't hide its own bounding box */
+static const float MinTriangleArea = 0.0001f;	/**< Area (in square pixels) below which a triangle is not rasterized */
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+OcclusionBuffer::OcclusionBuffer() :
+	m_fNearDistance(0.0f),
+	m_pfDepth(new float[Width*Height])
+{
+	memset(m_pfDepth, 0, sizeof(float)*Width*Height);
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+OcclusionBuffer::~OcclusionBuffer()
+{
+	delete [] m_pfDepth;
+}
+
+/**
+*  @brief
+*    Sets the view and removes all occluders
+*/
+void OcclusionBuffer::Clear(const Vector3 &vEye, const Vector3 *pvFarVertices, float fNearDistance)
+{
+	memset(m_pfDepth, 0, sizeof(float)*Width*Height);
+
+	// The far rectangle is at the distance of the far plane, its edges span the view from "-w" to "w"
+	const Vector3 vFar	  = (pvFarVertices[0] + pvFarVertices[1] + pvFarVertices[2] + pvFarVertices[3])*0.25f;
+	const Vector3 vWidth  = pvFarVertices[1] - pvFarVertices[0];
+	const Vector3 vHeight = pvFarVertices[2] - pvFarVertices[1];
+	const float fFarDistance = (vFar - vEye).GetLength();
+	const float fWidth		 = vWidth.GetLength();
+	const float fHeight		 = vHeight.GetLength();
+	if (fFarDistance > 0.0f && fWidth > 0.0f && fHeight > 0.0f && fNearDistance > 0.0f) {
+		m_vEye			= vEye;
+		m_vAxis			= (vFar - vEye)*(1.0f/fFarDistance);
+		m_vRight		= vWidth*(2.0f*fFarDistance/(fWidth*fWidth));
+		m_vUp			= vHeight*(2.0f*fFarDistance/(fHeight*fHeight));
+		m_fNearDistance = fNearDistance;
+	} else {
+		// Invalid view, nothing is drawn and everything is visible
+		m_fNearDistance = 0.0f;
+	}
+}
+
+/**
+*  @brief
+*    Draws occluder triangles
+*/
+void OcclusionBuffer::DrawTriangles(const Vector3 *pvVertices, uint32 nNumOfTriangles)
+{
+	if (m_fNearDistance <= 0.0f)
+		return;
+	for (uint32 nTriangle=0; nTriangle<nNumOfTriangles; nTriangle++) {
+		SVertex sVertices[3];
+		for (uint32 i=0; i<3; i++)
+			Project(pvVertices[nTriangle*3 + i], sVertices[i]);
+
+		// Clip against the near plane, the triangle becomes a quad at most
+		SVertex sPolygon[4];
+		uint32 nNumOfVertices = 0;
+		for (uint32 i=0; i<3; i++) {
+			const SVertex &sA = sVertices[i];
+			const SVertex &sB = sVertices[(i + 1)%3];
+			if (sA.fW >= m_fNearDistance)
+				sPolygon[nNumOfVertices++] = sA;
+			if ((sA.fW >= m_fNearDistance) != (sB.fW >= m_fNearDistance)) {
+				const float fT = (m_fNearDistance - sA.fW)/(sB.fW - sA.fW);
+				SVertex &sVertex = sPolygon[nNumOfVertices++];
+				sVertex.fX = sA.fX + (sB.fX - sA.fX)*fT;
+				sVertex.fY = sA.fY + (sB.fY - sA.fY)*fT;
+				sVertex.fW = m_fNearDistance;
+			}
+		}
+		if (nNumOfVertices >= 3)
+			RasterizeTriangle(sPolygon[0], sPolygon[1], sPolygon[2]);
+		if (nNumOfVertices == 4)
+			RasterizeTriangle(sPolygon[0], sPolygon[2], sPolygon[3]);
+	}
+}
+
+/**
+*  @brief
+*    Returns whether or not a bounding box may be visible
+*/
+bool OcclusionBuffer::IsVisible(const Vector3 &vMin, const Vector3 &vMax) const
+{
+	if (m_fNearDistance <= 0.0f)
+		return true;
+
+	// Get the screen rectangle and the nearest reciprocal depth of the box, a box crossing the near plane is visible
+	float fMinX = 0.0f, fMinY = 0.0f, fMaxX = 0.0f, fMaxY = 0.0f, fMaxZ = 0.0f;
+	for (uint32 nCorner=0; nCorner<8; nCorner++) {
+		SVertex sVertex;
+		Project(Vector3((nCorner & 1) ? vMax.x : vMin.x, (nCorner & 2) ? vMax.y : vMin.y, (nCorner & 4) ? vMax.z : vMin.z), sVertex);
+		if (sVertex.fW < m_fNearDistance)
+			return true;
+		const float fZ = 1.0f/sVertex.fW;
+		const float fX = (sVertex.fX*fZ + 1.0f)*(Width*0.5f);
+		const float fY = (1.0f - sVertex.fY*fZ)*(Height*0.5f);
+		if (!nCorner) {
+			fMinX = fMaxX = fX;
+			fMinY = fMaxY = fY;
+			fMaxZ = fZ;
+		} else {
+			if (fMinX > fX) fMinX = fX;
+			if (fMinY > fY) fMinY = fY;
+			if (fMaxX < fX) fMaxX = fX;
+			if (fMaxY < fY) fMaxY = fY;
+			if (fMaxZ < fZ) fMaxZ = fZ;
+		}
+	}
+	if (fMaxX < 0.0f || fMaxY < 0.0f || fMinX >= Width || fMinY >= Height)
+		return true;
+	const int nMinX = (fMinX > 0.0f) ? static_cast<int>(fMinX) : 0;
+	const int nMinY = (fMinY > 0.0f) ? static_cast<int>(fMinY) : 0;
+	const int nMaxX = (fMaxX < Width)  ? static_cast<int>(fMaxX) : Width  - 1;
+	const int nMaxY = (fMaxY < Height) ? static_cast<int>(fMaxY) : Height - 1;
+	const float fDepth = fMaxZ*(1.0f + DepthBias);
+
+	// The box is visible if any pixel it touches has no occluder in front of it
+	#ifdef DUNGEON_CULLING_SSE
+		const __m128 vLanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+		const __m128 vMinX	= _mm_set1_ps(static_cast<float>(nMinX));
+		const __m128 vMaxX	= _mm_set1_ps(static_cast<float>(nMaxX));
+		const __m128 vDepth = _mm_set1_ps(fDepth);
+		for (int nY=nMinY; nY<=nMaxY; nY++) {
+			const float *pfRow = m_pfDepth + nY*Width;
+			for (int nX=nMinX & ~3; nX<=nMaxX; nX+=4) {
+				const __m128 vX		= _mm_add_ps(_mm_set1_ps(static_cast<float>(nX)), vLanes);
+				const __m128 vValid = _mm_and_ps(_mm_cmpge_ps(vX, vMinX), _mm_cmple_ps(vX, vMaxX));
+				if (_mm_movemask_ps(_mm_and_ps(vValid, _mm_cmple_ps(_mm_loadu_ps(pfRow + nX), vDepth))))
+					return true;
+			}
+		}
+	#else
+		for (int nY=nMinY; nY<=nMaxY; nY++) {
+			const float *pfRow = m_pfDepth + nY*Width;
+			for (int nX=nMinX; nX<=nMaxX; nX++) {
+				if (pfRow[nX] <= fDepth)
+					return true;
+			}
+		}
+	#endif
+
+	// Hidden
+	return false;
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+OcclusionBuffer::OcclusionBuffer(const OcclusionBuffer &cSource) :
+	m_fNearDistance(0.0f),
+	m_pfDepth(nullptr)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+OcclusionBuffer &OcclusionBuffer::operator =(const OcclusionBuffer &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Transforms a position into view space
+*/
+void OcclusionBuffer::Project(const Vector3 &vPosition, SVertex &sVertex) const
+{
+	const Vector3 vOffset = vPosition - m_vEye;
+	sVertex.fX = vOffset.DotProduct(m_vRight);
+	sVertex.fY = vOffset.DotProduct(m_vUp);
+	sVertex.fW = vOffset.DotProduct(m_vAxis);
+}
+
+/**
+*  @brief
+*    Rasterizes a triangle which is completely in front of the near plane
+*/
+void OcclusionBuffer::RasterizeTriangle(const SVertex &sA, const SVertex &sB, const SVertex &sC)
+{
+	// Get the screen positions and the reciprocal depths
+	const SVertex *psVertices[3] = { &sA, &sB, &sC };
+	float fX[3], fY[3], fZ[3];
+	for (uint32 i=0; i<3; i++) {
+		fZ[i] = 1.0f/psVertices[i]->fW;
+		fX[i] = (psVertices[i]->fX*fZ[i] + 1.0f)*(Width*0.5f);
+		fY[i] = (1.0f - psVertices[i]->fY*fZ[i])*(Height*0.5f);
+	}
+
+	// Occluders are seen from both sides, so the winding order is made counterclockwise
+	float fArea = (fX[1] - fX[0])*(fY[2] - fY[0]) - (fY[1] - fY[0])*(fX[2] - fX[0]);
+	if (fArea < 0.0f) {
+		float fTemp;
+		fTemp = fX[1]; fX[1] = fX[2]; fX[2] = fTemp;
+		fTemp = fY[1]; fY[1] = fY[2]; fY[2] = fTemp;
+		fTemp = fZ[1]; fZ[1] = fZ[2]; fZ[2] = fTemp;
+		fArea = -fArea;
+	}
+	if (fArea < MinTriangleArea)
+		return;
+
+	// Get the pixel rectangle
+	const float fMinX = (fX[0] < fX[1]) ? ((fX[0] < fX[2]) ? fX[0] : fX[2]) : ((fX[1] < fX[2]) ? fX[1] : fX[2]);
+	const float fMinY = (fY[0] < fY[1]) ? ((fY[0] < fY[2]) ? fY[0] : fY[2]) : ((fY[1] < fY[2]) ? fY[1] : fY[2]);
+	const float fMaxX = (fX[0] > fX[1]) ? ((fX[0] > fX[2]) ? fX[0] : fX[2]) : ((fX[1] > fX[2]) ? fX[1] : fX[2]);
+	const float fMaxY = (fY[0] > fY[1]) ? ((fY[0] > fY[2]) ? fY[0] : fY[2]) : ((fY[1] > fY[2]) ? fY[1] : fY[2]);
+	if (fMaxX < 0.0f || fMaxY < 0.0f || fMinX >= Width || fMinY >= Height)
+		return;
+	const int nMinX = (fMinX > 0.0f) ? static_cast<int>(fMinX) : 0;
+	const int nMinY = (fMinY > 0.0f) ? static_cast<int>(fMinY) : 0;
+	const int nMaxX = (fMaxX < Width)  ? static_cast<int>(fMaxX) : Width  - 1;
+	const int nMaxY = (fMaxY < Height) ? static_cast<int>(fMaxY) : Height - 1;
+
+	// Edge functions "a*x + b*y + c", positive inside, and the plane of the reciprocal depth
+	float fA[3], fB[3], fC[3];
+	for (uint32 i=0; i<3; i++) {
+		const uint32 nU = (i + 1)%3, nV = (i + 2)%3;
+		fA[i] = fY[nU] - fY[nV];
+		fB[i] = fX[nV] - fX[nU];
+		fC[i] = -(fA[i]*fX[nU] + fB[i]*fY[nU]);
+	}
+	const float fInvArea = 1.0f/fArea;
+	const float fZX = (fZ[0]*fA[0] + fZ[1]*fA[1] + fZ[2]*fA[2])*fInvArea;
+	const float fZY = (fZ[0]*fB[0] + fZ[1]*fB[1] + fZ[2]*fB[2])*fInvArea;
+	const float fZ0 = (fZ[0]*fC[0] + fZ[1]*fC[1] + fZ[2]*fC[2])*fInvArea;
+
+	// Keep the nearest depth of the covered pixels, the pixel centers are sampled
+	#ifdef DUNGEON_CULLING_SSE
+		const __m128 vLanes = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 vZero	= _mm_setzero_ps();
+		const __m128 vA0 = _mm_set1_ps(fA[0]), vA1 = _mm_set1_ps(fA[1]), vA2 = _mm_set1_ps(fA[2]);
+		const __m128 vZX = _mm_set1_ps(fZX);
+		for (int nY=nMinY; nY<=nMaxY; nY++) {
+			const float fPixelY = nY + 0.5f;
+			const __m128 vE0 = _mm_set1_ps(fB[0]*fPixelY + fC[0]);
+			const __m128 vE1 = _mm_set1_ps(fB[1]*fPixelY + fC[1]);
+			const __m128 vE2 = _mm_set1_ps(fB[2]*fPixelY + fC[2]);
+			const __m128 vZY = _mm_set1_ps(fZY*fPixelY + fZ0);
+			float *pfRow = m_pfDepth + nY*Width;
+			for (int nX=nMinX & ~3; nX<=nMaxX; nX+=4) {
+				// The lanes left and right of the rectangle are within the row and outside of the triangle
+				const __m128 vX		 = _mm_add_ps(_mm_set1_ps(static_cast<float>(nX)), vLanes);
+				const __m128 vInside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(vA0, vX), vE0), vZero),
+															 _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(vA1, vX), vE1), vZero)),
+															 _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(vA2, vX), vE2), vZero));
+				if (_mm_movemask_ps(vInside)) {
+					const __m128 vDepth = _mm_loadu_ps(pfRow + nX);
+					const __m128 vZ		= _mm_max_ps(vDepth, _mm_add_ps(_mm_mul_ps(vZX, vX), vZY));
+					_mm_storeu_ps(pfRow + nX, _mm_or_ps(_mm_and_ps(vInside, vZ), _mm_andnot_ps(vInside, vDepth)));
+				}
+			}
+		}
+	#else
+		for (int nY=nMinY; nY<=nMaxY; nY++) {
+			const float fPixelY = nY + 0.5f;
+			float *pfRow = m_pfDepth + nY*Width;
+			for (int nX=nMinX; nX<=nMaxX; nX++) {
+				const float fPixelX = nX + 0.5f;
+				if (fA[0]*fPixelX + fB[0]*fPixelY + fC[0] >= 0.0f && fA[1]*fPixelX + fB[1]*fPixelY + fC[1] >= 0.0f &&
+					fA[2]*fPixelX + fB[2]*fPixelY + fC[2] >= 0.0f) {
+					const float fDepth = fZX*fPixelX + fZY*fPixelY + fZ0;
+					if (pfRow[nX] < fDepth)
+						pfRow[nX] = fDepth;
+				}
+			}
+		}
+	#endif
+}
@@ -0,0 +1,200 @@
+/*********************************************************\
+ *  File: OcclusionBuffer.h                              *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_OCCLUSIONBUFFER_H__
+#define __DUNGEON_OCCLUSIONBUFFER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLMath/Vector3.h>
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Low resolution software depth buffer for occlusion culling
+*
+*  @remarks
+*    Occluder triangles are clipped against the near plane and rasterized with SSE, four pixels of a row at once. Each
+*    pixel keeps the reciprocal view depth ("1/w", it's linear within screen space) of the nearest occluder, so larger
+*    values are nearer. A bounding box is hidden if the nearest point of the box is behind the occluders within all
+*    pixels its projection touches.
+*
+*    Coverage is sampled at the pixel centers, like the renderer does it. A box can therefore be hidden although it's
+*    visible through a gap between occluders which is smaller than a pixel of the low resolution buffer.
+*
+*  @note
+*    - Doesn't touch the scene graph or the renderer, so once the occluders are drawn, "IsVisible()" can be called by
+*      several threads at once
+*/
+class OcclusionBuffer {
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 Width  = 256;	/**< Width of the depth buffer (in pixels), a multiple of four */
+		static const PLCore::uint32 Height = 128;	/**< Height of the depth buffer (in pixels) */
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*/
+		OcclusionBuffer();
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		~OcclusionBuffer();
+
+		/**
+		*  @brief
+		*    Sets the view and removes all occluders
+		*
+		*  @param[in] vEye
+		*    Eye position
+		*  @param[in] pvFarVertices
+		*    The four vertices of the far rectangle of the view frustum, sorted around the view axis
+		*  @param[in] fNearDistance
+		*    Distance of the near plane to the eye along the view axis, must be greater than 0
+		*/
+		void Clear(const PLMath::Vector3 &vEye, const PLMath::Vector3 *pvFarVertices, float fNearDistance);
+
+		/**
+		*  @brief
+		*    Draws occluder triangles
+		*
+		*  @param[in] pvVertices
+		*    Triangle list, three vertices per triangle, within the space of the view
+		*  @param[in] nNumOfTriangles
+		*    Number of triangles
+		*/
+		void DrawTriangles(const PLMath::Vector3 *pvVertices, PLCore::uint32 nNumOfTriangles);
+
+		/**
+		*  @brief
+		*    Returns whether or not a bounding box may be visible
+		*
+		*  @param[in] vMin
+		*    Minimum of the bounding box, within the space of the view
+		*  @param[in] vMax
+		*    Maximum of the bounding box, within the space of the view
+		*
+		*  @return
+		*    'false' if the box is completely hidden by the occluders, else 'true'
+		*/
+		bool IsVisible(const PLMath::Vector3 &vMin, const PLMath::Vector3 &vMax) const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Vertex within view space
+		*/
+		struct SVertex {
+			float fX;	/**< Horizontal position, the view is within "-w" and "w" */
+			float fY;	/**< Vertical position, the view is within "-w" and "w" */
+			float fW;	/**< Distance to the eye along the view axis */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		OcclusionBuffer(const OcclusionBuffer &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		OcclusionBuffer &operator =(const OcclusionBuffer &cSource);
+
+		/**
+		*  @brief
+		*    Transforms a position into view space
+		*
+		*  @param[in]  vPosition
+		*    Position to transform
+		*  @param[out] sVertex
+		*    Receives the vertex within view space
+		*/
+		void Project(const PLMath::Vector3 &vPosition, SVertex &sVertex) const;
+
+		/**
+		*  @brief
+		*    Rasterizes a triangle which is completely in front of the near plane
+		*
+		*  @param[in] sA
+		*    First vertex within view space
+		*  @param[in] sB
+		*    Second vertex within view space
+		*  @param[in] sC
+		*    Third vertex within view space
+		*/
+		void RasterizeTriangle(const SVertex &sA, const SVertex &sB, const SVertex &sC);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLMath::Vector3  m_vEye;			/**< Eye position */
+		PLMath::Vector3  m_vAxis;			/**< Normalized view axis */
+		PLMath::Vector3  m_vRight;			/**< Right vector, scaled so that the view is within "-w" and "w" */
+		PLMath::Vector3  m_vUp;				/**< Up vector, scaled so that the view is within "-w" and "w" */
+		float			 m_fNearDistance;	/**< Distance of the near plane to the eye along the view axis */
+		float			*m_pfDepth;			/**< Reciprocal view depth of the nearest occluder per pixel, row by row, 0 if there's no occluder */
+
+
+};
+
+
+#endif // __DUNGEON_OCCLUSIONBUFFER_H__
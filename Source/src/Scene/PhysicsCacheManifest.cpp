@@ -0,0 +1,352 @@
+/*********************************************************\
+ *  File: PhysicsCacheManifest.cpp                       *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#ifdef WIN32
+	#include <windows.h>
+#else
+	#include <sys/stat.h>
+#endif
+#include <PLCore/Log/Log.h>
+#include <PLCore/Xml/Xml.h>
+#include <PLCore/File/File.h>
+#include <PLCore/File/Directory.h>
+#include <PLCore/File/FileSearch.h>
+#include <PLCore/Tools/ChecksumMD5.h>
+#include "Scene/PhysicsCacheManifest.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+static const char *ManifestFilename = "Manifest.xml";	/**< Name of the manifest file within the cache directory */
+static const char *CacheExtension   = "tc";				/**< Extension of the cache files written by PLPhysicsNewton */
+static const char *MeshSeparator    = "#mesh_";			/**< Separates the mangled source mesh filename from the mangled scale */
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+PhysicsCacheManifest::PhysicsCacheManifest(const String &sCacheDirectory, const String &sBaseDirectory) :
+	m_sCacheDirectory(sCacheDirectory),
+	m_sBaseDirectory(sBaseDirectory),
+	m_bChanged(false)
+{
+	// Load the manifest
+	Load();
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+PhysicsCacheManifest::~PhysicsCacheManifest()
+{
+}
+
+/**
+*  @brief
+*    Deletes the cache files which are no longer valid
+*/
+uint32 PhysicsCacheManifest::Validate()
+{
+	uint32 nNumOfDeleted = 0;
+
+	// Check each cache file
+	Array<String> lstFilenames;
+	GetCacheFiles(lstFilenames);
+	for (uint32 i=0; i<lstFilenames.GetNumOfElements(); i++) {
+		const String &sFilename = lstFilenames[i];
+		if (sFilename.IndexOf(MeshSeparator) < 0)
+			continue;	// Not a mesh collision file, leave it alone
+		const int nIndex = GetEntryIndex(sFilename);
+
+		// Get the current state of the source mesh, without hashing
+		SEntry sCurrent;
+		bool bValid = GetEntry(sFilename, sCurrent, false);
+		if (bValid) {
+			if (nIndex >= 0) {
+				SEntry &sEntry = m_lstEntries[nIndex];
+				if (sEntry.sParameters != sCurrent.sParameters) {
+					// Different cooking parameters
+					bValid = false;
+				} else if (sEntry.nSize != sCurrent.nSize || sEntry.nTime != sCurrent.nTime) {
+					// The source mesh may have been changed, the content hash decides
+					bValid = (GetEntry(sFilename, sCurrent, true) && sEntry.sHash == sCurrent.sHash);
+					if (bValid) {
+						// Same content, just remember the new size and modification time
+						sEntry.nSize = sCurrent.nSize;
+						sEntry.nTime = sCurrent.nTime;
+						m_bChanged   = true;
+					}
+				}
+			} else {
+				// Unknown cache file, take it over if it was written after the source mesh was changed the last time
+				uint64 nSize = 0, nTime = 0;
+				bValid = (GetFileStamp(m_sCacheDirectory + '/' + sFilename, nSize, nTime) && nTime >= sCurrent.nTime && GetEntry(sFilename, sCurrent, true));
+				if (bValid) {
+					m_lstEntries.Add(sCurrent);
+					m_bChanged = true;
+				}
+			}
+		}
+
+		// Delete the invalid cache file, the physics backend cooks it again when loading the scene
+		if (!bValid) {
+			PL_LOG(Info, "Physics cache: '" + sFilename + "' is outdated")
+			File(m_sCacheDirectory + '/' + sFilename).Delete();
+			nNumOfDeleted++;
+			if (nIndex >= 0) {
+				m_lstEntries.RemoveAtIndex(nIndex);
+				m_bChanged = true;
+			}
+		}
+	}
+
+	// Remove the entries of cache files which no longer exist
+	for (uint32 i=0; i<m_lstEntries.GetNumOfElements(); ) {
+		if (lstFilenames.IsElement(m_lstEntries[i].sFilename)) {
+			i++;
+		} else {
+			m_lstEntries.RemoveAtIndex(i);
+			m_bChanged = true;
+		}
+	}
+
+	// Save the manifest, if required
+	if (m_bChanged)
+		Save();
+
+	// Done
+	return nNumOfDeleted;
+}
+
+/**
+*  @brief
+*    Adds the cache files which are not within the manifest yet and saves the manifest
+*/
+uint32 PhysicsCacheManifest::Update()
+{
+	uint32 nNumOfAdded = 0;
+
+	// Add the entries of the newly cooked cache files
+	Array<String> lstFilenames;
+	GetCacheFiles(lstFilenames);
+	for (uint32 i=0; i<lstFilenames.GetNumOfElements(); i++) {
+		if (GetEntryIndex(lstFilenames[i]) < 0) {
+			SEntry sEntry;
+			if (GetEntry(lstFilenames[i], sEntry, true)) {
+				m_lstEntries.Add(sEntry);
+				m_bChanged = true;
+				nNumOfAdded++;
+			}
+		}
+	}
+
+	// Save the manifest, if required
+	if (m_bChanged)
+		Save();
+
+	// Done
+	return nNumOfAdded;
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+PhysicsCacheManifest::PhysicsCacheManifest(const PhysicsCacheManifest &cSource) :
+	m_bChanged(false)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+PhysicsCacheManifest &PhysicsCacheManifest::operator =(const PhysicsCacheManifest &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Loads the manifest
+*/
+void PhysicsCacheManifest::Load()
+{
+	m_lstEntries.Reset();
+	m_bChanged = false;
+
+	// Load the XML document, a missing manifest or one of another version is just an empty manifest
+	XmlDocument cDocument;
+	if (cDocument.Load(m_sCacheDirectory + '/' + ManifestFilename)) {
+		const XmlElement *pManifestElement = cDocument.GetFirstChildElement("PhysicsCacheManifest");
+		if (pManifestElement && pManifestElement->GetAttribute("Version").GetUInt32() == Version) {
+			for (const XmlElement *pElement=pManifestElement->GetFirstChildElement("Entry"); pElement; pElement=pElement->GetNextSiblingElement("Entry")) {
+				SEntry sEntry;
+				sEntry.sFilename   = pElement->GetAttribute("File");
+				sEntry.sSource     = pElement->GetAttribute("Source");
+				sEntry.sParameters = pElement->GetAttribute("Parameters");
+				sEntry.sHash       = pElement->GetAttribute("Hash");
+				sEntry.nSize       = pElement->GetAttribute("Size").GetUInt64();
+				sEntry.nTime       = pElement->GetAttribute("Time").GetUInt64();
+				m_lstEntries.Add(sEntry);
+			}
+		}
+	}
+}
+
+/**
+*  @brief
+*    Saves the manifest
+*/
+void PhysicsCacheManifest::Save() const
+{
+	XmlDocument cDocument;
+	cDocument.LinkEndChild(*new XmlDeclaration("1.0", "ISO-8859-1", ""));
+	XmlElement &cManifestElement = *new XmlElement("PhysicsCacheManifest");
+	cManifestElement.SetAttribute("Version", String::Format("%u", Version));
+	for (uint32 i=0; i<m_lstEntries.GetNumOfElements(); i++) {
+		const SEntry &sEntry = m_lstEntries[i];
+		XmlElement &cElement = *new XmlElement("Entry");
+		cElement.SetAttribute("File",		sEntry.sFilename);
+		cElement.SetAttribute("Source",		sEntry.sSource);
+		cElement.SetAttribute("Parameters",	sEntry.sParameters);
+		cElement.SetAttribute("Hash",		sEntry.sHash);
+		cElement.SetAttribute("Size",		String::Format("%llu", sEntry.nSize));
+		cElement.SetAttribute("Time",		String::Format("%llu", sEntry.nTime));
+		cManifestElement.LinkEndChild(cElement);
+	}
+	cDocument.LinkEndChild(cManifestElement);
+	if (!cDocument.Save(m_sCacheDirectory + '/' + ManifestFilename))
+		PL_LOG(Warning, "Physics cache: Failed to save the manifest")
+}
+
+/**
+*  @brief
+*    Returns the names of the cache files within the cache directory
+*/
+void PhysicsCacheManifest::GetCacheFiles(Array<String> &lstFilenames) const
+{
+	lstFilenames.Reset();
+	Directory cDirectory(m_sCacheDirectory);
+	if (cDirectory.Exists()) {
+		FileSearch cSearch(cDirectory);
+		while (cSearch.HasNextFile()) {
+			const String sFilename = cSearch.GetNextFile();
+			if (Url(sFilename).GetExtension() == CacheExtension)
+				lstFilenames.Add(sFilename);
+		}
+	}
+}
+
+/**
+*  @brief
+*    Returns the index of a manifest entry
+*/
+int PhysicsCacheManifest::GetEntryIndex(const String &sFilename) const
+{
+	for (uint32 i=0; i<m_lstEntries.GetNumOfElements(); i++) {
+		if (m_lstEntries[i].sFilename == sFilename)
+			return i;
+	}
+	return -1;
+}
+
+/**
+*  @brief
+*    Fills a manifest entry by using the current state of the source mesh
+*/
+bool PhysicsCacheManifest::GetEntry(const String &sFilename, SEntry &sEntry, bool bHash) const
+{
+	// The physics backend mangles the source mesh filename and the scale into the cache filename by replacing
+	// the path separators and the dots through '#', e.g. "Data#Meshes#Dungeon#Cave_Cave1#mesh_1_1_1.tc"
+	const String sTitle = Url(sFilename).CutExtension();
+	const int nSeparator = sTitle.LastIndexOf(MeshSeparator);
+	if (nSeparator <= 0)
+		return false;
+	String sSource = sTitle.GetSubstring(0, nSeparator) + ".mesh";
+	sSource.Replace('#', '/');
+	String sScale = sTitle.GetSubstring(nSeparator + String(MeshSeparator).GetLength());
+	sScale.Replace('#', '.');
+	sScale.Replace('_', ' ');
+
+	// Fill the entry
+	sEntry.sFilename   = sFilename;
+	sEntry.sSource     = sSource;
+	sEntry.sParameters = String::Format("Scale=\"%s\" CookingVersion=\"%u\"", sScale.GetASCII(), CookingVersion);
+	if (!GetFileStamp(m_sBaseDirectory + sSource, sEntry.nSize, sEntry.nTime))
+		return false;
+	if (bHash) {
+		sEntry.sHash = ChecksumMD5().GetChecksumFromFile(m_sBaseDirectory + sSource);
+		if (!sEntry.sHash.GetLength())
+			return false;
+	}
+
+	// Done
+	return true;
+}
+
+/**
+*  @brief
+*    Returns the size and modification time of a file
+*/
+bool PhysicsCacheManifest::GetFileStamp(const String &sFilename, uint64 &nSize, uint64 &nTime)
+{
+	#ifdef WIN32
+		WIN32_FILE_ATTRIBUTE_DATA sData;
+		if (::GetFileAttributesExW(Url(sFilename).GetNativePath().GetUnicode(), GetFileExInfoStandard, &sData)) {
+			nSize = (static_cast<uint64>(sData.nFileSizeHigh) << 32) | sData.nFileSizeLow;
+			nTime = (static_cast<uint64>(sData.ftLastWriteTime.dwHighDateTime) << 32) | sData.ftLastWriteTime.dwLowDateTime;
+			return true;
+		}
+	#else
+		struct stat sStat;
+		if (!::stat(Url(sFilename).GetNativePath().GetUTF8(), &sStat)) {
+			nSize = static_cast<uint64>(sStat.st_size);
+			nTime = static_cast<uint64>(sStat.st_mtime);
+			return true;
+		}
+	#endif
+
+	// Error!
+	return false;
+}
@@ -0,0 +1,236 @@
+/*********************************************************\
+ *  File: PhysicsCacheManifest.h                         *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_PHYSICSCACHEMANIFEST_H__
+#define __DUNGEON_PHYSICSCACHEMANIFEST_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include <PLCore/Container/Array.h>
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Self-validating manifest of the physics cache
+*
+*  @remarks
+*    The physics backend (PLPhysicsNewton) writes one collision file per mesh and scale into the cache
+*    directory, e.g. "Data#Meshes#Dungeon#Cave_Cave1#mesh_1_1_1.tc" for "Data/Meshes/Dungeon/Cave_Cave1.mesh"
+*    with the scale (1, 1, 1), but never checks whether or not the source mesh has been changed. The manifest
+*    ("Manifest.xml" within the cache directory) records for each cache file the MD5 content hash of the
+*    source mesh, the cooking parameters and the size and modification time of the source mesh.
+*
+*    Before the scene is loaded, "Validate()" deletes the cache files which are no longer valid, so the
+*    physics backend just cooks the changed meshes again while loading the scene. The size and modification
+*    time of the source meshes are checked first, a source mesh is only hashed if they differ. The cache
+*    files themselves are not opened. After the scene was loaded, "Update()" adds the newly cooked cache files.
+*/
+class PhysicsCacheManifest {
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 Version        = 1;	/**< Manifest format version, increase on each format change */
+		static const PLCore::uint32 CookingVersion = 1;	/**< Increase to invalidate all cache files, e.g. after updating the physics backend */
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] sCacheDirectory
+		*    Physics cache directory
+		*  @param[in] sBaseDirectory
+		*    Directory the source mesh filenames are relative to, must end with a slash
+		*/
+		PhysicsCacheManifest(const PLCore::String &sCacheDirectory, const PLCore::String &sBaseDirectory);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		~PhysicsCacheManifest();
+
+		/**
+		*  @brief
+		*    Deletes the cache files which are no longer valid
+		*
+		*  @return
+		*    Number of deleted cache files
+		*
+		*  @note
+		*    - Cache files which are not within the manifest yet (e.g. written by an older version of the
+		*      application) are taken over if they are newer than their source mesh, else they are deleted
+		*/
+		PLCore::uint32 Validate();
+
+		/**
+		*  @brief
+		*    Adds the cache files which are not within the manifest yet and saves the manifest
+		*
+		*  @return
+		*    Number of added cache files
+		*/
+		PLCore::uint32 Update();
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Manifest entry
+		*/
+		struct SEntry {
+			PLCore::String sFilename;	/**< Name of the cache file (without directory) */
+			PLCore::String sSource;		/**< Filename of the source mesh, relative to the base directory */
+			PLCore::String sParameters;	/**< Cooking parameters */
+			PLCore::String sHash;		/**< MD5 content hash of the source mesh */
+			PLCore::uint64 nSize;		/**< Size of the source mesh */
+			PLCore::uint64 nTime;		/**< Modification time of the source mesh */
+
+			bool operator ==(const SEntry &sEntry) const
+			{
+				return (sFilename == sEntry.sFilename);
+			}
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		PhysicsCacheManifest(const PhysicsCacheManifest &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		PhysicsCacheManifest &operator =(const PhysicsCacheManifest &cSource);
+
+		/**
+		*  @brief
+		*    Loads the manifest
+		*/
+		void Load();
+
+		/**
+		*  @brief
+		*    Saves the manifest
+		*/
+		void Save() const;
+
+		/**
+		*  @brief
+		*    Returns the names of the cache files within the cache directory
+		*
+		*  @param[out] lstFilenames
+		*    Receives the names of the cache files (without directory), the list is cleared before
+		*/
+		void GetCacheFiles(PLCore::Array<PLCore::String> &lstFilenames) const;
+
+		/**
+		*  @brief
+		*    Returns the index of a manifest entry
+		*
+		*  @param[in] sFilename
+		*    Name of the cache file (without directory)
+		*
+		*  @return
+		*    Index of the entry, <0 if there's no entry for the given cache file
+		*/
+		int GetEntryIndex(const PLCore::String &sFilename) const;
+
+		/**
+		*  @brief
+		*    Fills a manifest entry by using the current state of the source mesh
+		*
+		*  @param[in]  sFilename
+		*    Name of the cache file (without directory)
+		*  @param[out] sEntry
+		*    Receives the entry
+		*  @param[in]  bHash
+		*    Hash the source mesh?
+		*
+		*  @return
+		*    'true' if all went fine, else 'false' (the cache file name is unknown or the source mesh is missing)
+		*/
+		bool GetEntry(const PLCore::String &sFilename, SEntry &sEntry, bool bHash) const;
+
+		/**
+		*  @brief
+		*    Returns the size and modification time of a file
+		*
+		*  @param[in]  sFilename
+		*    Filename
+		*  @param[out] nSize
+		*    Receives the size of the file
+		*  @param[out] nTime
+		*    Receives the modification time of the file (platform dependent unit, only useful for comparisons)
+		*
+		*  @return
+		*    'true' if all went fine, else 'false' (the file doesn't exist)
+		*/
+		static bool GetFileStamp(const PLCore::String &sFilename, PLCore::uint64 &nSize, PLCore::uint64 &nTime);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::String		   m_sCacheDirectory;	/**< Physics cache directory */
+		PLCore::String		   m_sBaseDirectory;	/**< Directory the source mesh filenames are relative to */
+		PLCore::Array<SEntry>  m_lstEntries;		/**< Manifest entries */
+		bool				   m_bChanged;			/**< Has the manifest been changed since it was loaded? */
+
+
+};
+
+
+#endif // __DUNGEON_PHYSICSCACHEMANIFEST_H__
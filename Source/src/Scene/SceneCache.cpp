@@ -0,0 +1,392 @@
+/*********************************************************\
+ *  File: SceneCache.cpp                                 *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/Xml/Xml.h>
+#include <PLCore/File/File.h>
+#include <PLCore/File/Directory.h>
+#include <PLCore/String/Tokenizer.h>
+#include <PLCore/Tools/LoadableManager.h>
+#include <PLCore/Tools/ChecksumMD5.h>
+#include <PLMath/Vector3.h>
+#include "Scene/SceneCache.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Legacy scripts with a native scene node modifier replacement
+*/
+static const struct SLegacyScript {
+	const char *pszScript;	/**< Title of the script filename */
+	const char *pszClass;	/**< Class name of the native replacement */
+} LegacyScripts[] = {
+	{ "SNMPositionRandomAnimation", "SNMPositionRandomAnimation" },
+	{ nullptr,                      nullptr                      }
+};
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+SceneCache::SceneCache(const String &sCacheDirectory) :
+	m_sCacheDirectory(sCacheDirectory)
+{
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+SceneCache::~SceneCache()
+{
+}
+
+/**
+*  @brief
+*    Returns the name of the cache file of a scene
+*/
+String SceneCache::GetCacheFilename(const String &sSceneFilename) const
+{
+	return m_sCacheDirectory + '/' + Url(sSceneFilename).GetTitle() + ".scenecache";
+}
+
+/**
+*  @brief
+*    Returns an up-to-date cache file of a scene, compiles the scene if required
+*/
+String SceneCache::Prepare(const String &sSceneFilename)
+{
+	// Open the XML scene, the loadable manager takes care of the base directories
+	File cSceneFile;
+	if (LoadableManager::GetInstance()->OpenFile(cSceneFile, sSceneFilename, false)) {
+		// The content hash of the XML scene is the key of the cache file
+		const String sHash = ChecksumMD5().GetChecksumFromFile(cSceneFile.GetUrl().GetUrl());
+		if (sHash.GetLength() == HashSize) {
+			const String sCacheFilename = GetCacheFilename(sSceneFilename);
+
+			// Is there already an up-to-date cache file?
+			if (IsValid(sCacheFilename, sHash))
+				return sCacheFilename;
+
+			// Compile the XML scene
+			PL_LOG(Info, "Scene cache: Compiling '" + sSceneFilename + "' into '" + sCacheFilename + '\'')
+			if (Compile(cSceneFile, sHash, sCacheFilename))
+				return sCacheFilename;
+		}
+	}
+
+	// Error!
+	PL_LOG(Warning, "Scene cache: Failed to prepare the cache file of '" + sSceneFilename + "', the XML scene is used instead")
+	return "";
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+SceneCache::SceneCache(const SceneCache &cSource)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+SceneCache &SceneCache::operator =(const SceneCache &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Returns whether or not a cache file is valid
+*/
+bool SceneCache::IsValid(const String &sCacheFilename, const String &sHash) const
+{
+	// Open the cache file
+	File cFile(sCacheFilename);
+	if (cFile.Open(File::FileRead)) {
+		// Read and check the header, the content is checked by the loader
+		uint32 nMagic   = 0;
+		uint32 nVersion = 0;
+		char   szHash[HashSize+1];
+		szHash[HashSize] = '\0';
+		const bool bValid = (cFile.Read(&nMagic,   sizeof(uint32), 1) == 1 && nMagic   == Magic &&
+							 cFile.Read(&nVersion, sizeof(uint32), 1) == 1 && nVersion == Version &&
+							 cFile.Read(szHash,    1,        HashSize) == HashSize && sHash == szHash);
+		cFile.Close();
+		return bValid;
+	}
+
+	// Error!
+	return false;
+}
+
+/**
+*  @brief
+*    Compiles a XML scene into a cache file
+*/
+bool SceneCache::Compile(File &cSceneFile, const String &sHash, const String &sCacheFilename) const
+{
+	// Parse the XML scene - this is the last time this content has to be parsed until the XML scene changes
+	XmlDocument cDocument;
+	if (cDocument.Load(cSceneFile)) {
+		const XmlElement *pSceneElement = cDocument.GetFirstChildElement("Scene");
+		if (pSceneElement) {
+			// Ensure that the cache directory exists
+			Directory cDirectory(m_sCacheDirectory);
+			if (!cDirectory.Exists())
+				cDirectory.CreateRecursive();
+
+			// Create the cache file
+			File cFile(sCacheFilename);
+			if (cFile.Open(File::FileCreate | File::FileWrite)) {
+				// Write the header, the magic is written after everything else went fine so an interrupted
+				// compilation never leaves a cache file behind which looks valid
+				const uint32 nInvalidMagic = 0;
+				const uint32 nMagic        = Magic;
+				const uint32 nVersion      = Version;
+				uint32       nNumOfItems   = 0;
+				cFile.Write(&nInvalidMagic, sizeof(uint32), 1);
+				cFile.Write(&nVersion,      sizeof(uint32), 1);
+				cFile.Write(sHash.GetASCII(), 1, HashSize);
+				cFile.Write(&nNumOfItems,   sizeof(uint32), 1);
+
+				// Write the asset table
+				Array<String> lstAssets;
+				CollectAssets(*pSceneElement, lstAssets);
+				const uint32 nNumOfAssets = lstAssets.GetNumOfElements();
+				cFile.Write(&nNumOfAssets, sizeof(uint32), 1);
+				for (uint32 i=0; i<nNumOfAssets; i++)
+					WriteString(cFile, lstAssets[i]);
+
+				// Write the records, starting with the scene root
+				WriteElement(cFile, *pSceneElement, RecordContainer, true, nNumOfItems);
+
+				// Finalize the header
+				cFile.Seek(0);
+				cFile.Write(&nMagic, sizeof(uint32), 1);
+				cFile.Seek(sizeof(uint32)*2 + HashSize);
+				cFile.Write(&nNumOfItems, sizeof(uint32), 1);
+				cFile.Close();
+
+				// Write a log message
+				PL_LOG(Info, String::Format("Scene cache: Compiled %u items referencing %u assets", nNumOfItems, nNumOfAssets))
+
+				// Done
+				return true;
+			}
+		}
+	}
+
+	// Error!
+	return false;
+}
+
+/**
+*  @brief
+*    Collects the assets referenced by an element and its children
+*/
+void SceneCache::CollectAssets(const XmlElement &cElement, Array<String> &lstAssets) const
+{
+	// Attributes of this element
+	for (const XmlAttribute *pAttribute=cElement.GetFirstAttribute(); pAttribute; pAttribute=pAttribute->GetNext()) {
+		const String sValue = pAttribute->GetValue();
+		if ((sValue.Compare("Data/", 0, 5) || sValue.Compare("Data\\", 0, 5)) && !lstAssets.IsElement(sValue))
+			lstAssets.Add(sValue);
+	}
+
+	// Children, in document order which is the order the loader needs the assets
+	for (const XmlElement *pChild=cElement.GetFirstChildElement(); pChild; pChild=pChild->GetNextSiblingElement())
+		CollectAssets(*pChild, lstAssets);
+}
+
+/**
+*  @brief
+*    Writes a container or node record including its children
+*/
+void SceneCache::WriteElement(File &cFile, const XmlElement &cElement, uint8 nRecord, bool bRoot, uint32 &nNumOfItems) const
+{
+	// Record type
+	cFile.Write(&nRecord, sizeof(uint8), 1);
+	nNumOfItems++;
+
+	// Modifiers running a legacy script with a native replacement are migrated
+	String sParameters;
+	if (nRecord == RecordModifier) {
+		String sClass;
+		if (MigrateModifier(cElement, sClass, sParameters)) {
+			WriteString(cFile, sClass);
+			WriteString(cFile, sParameters);
+			return;
+		}
+	}
+
+	// Class, the class of the root is given by the scene container the scene is loaded into
+	WriteString(cFile, bRoot ? String() : cElement.GetAttribute("Class"));
+
+	// Modifiers have no name and no transform
+	if (nRecord != RecordModifier) {
+		// Name
+		WriteString(cFile, cElement.GetAttribute("Name"));
+
+		// Typed transform, so the loader doesn't need to convert strings into floats
+		Vector3 vPosition, vRotation, vScale;
+		uint8 nTransform = 0;
+		if (vPosition.FromString(cElement.GetAttribute("Position")))
+			nTransform |= TransformPosition;
+		if (vRotation.FromString(cElement.GetAttribute("Rotation")))
+			nTransform |= TransformRotation;
+		if (vScale.FromString(cElement.GetAttribute("Scale")))
+			nTransform |= TransformScale;
+		cFile.Write(&nTransform, sizeof(uint8), 1);
+		if (nTransform & TransformPosition)
+			cFile.Write(&vPosition.x, sizeof(float), 3);
+		if (nTransform & TransformRotation)
+			cFile.Write(&vRotation.x, sizeof(float), 3);
+		if (nTransform & TransformScale)
+			cFile.Write(&vScale.x, sizeof(float), 3);
+	}
+
+	// Remaining attributes as one pre-built parameter string
+	for (const XmlAttribute *pAttribute=cElement.GetFirstAttribute(); pAttribute; pAttribute=pAttribute->GetNext()) {
+		const String sName = pAttribute->GetName();
+		if (sName != "Class" && sName != "Name" && sName != "Position" && sName != "Rotation" && sName != "Scale" && (!bRoot || sName != "Version")) {
+			// Use single quotes if the value contains double quotes
+			const String sValue = pAttribute->GetValue();
+			const char nQuote = (sValue.IndexOf('\"') < 0) ? '\"' : '\'';
+			if (sParameters.GetLength())
+				sParameters += ' ';
+			sParameters += sName + '=' + nQuote + sValue + nQuote;
+		}
+	}
+	WriteString(cFile, sParameters);
+
+	// Child records
+	if (nRecord != RecordModifier) {
+		for (const XmlElement *pChild=cElement.GetFirstChildElement(); pChild; pChild=pChild->GetNextSiblingElement()) {
+			const String sType = pChild->GetValue();
+			if (sType == "Container")
+				WriteElement(cFile, *pChild, RecordContainer, false, nNumOfItems);
+			else if (sType == "Node")
+				WriteElement(cFile, *pChild, RecordNode, false, nNumOfItems);
+			else if (sType == "Modifier")
+				WriteElement(cFile, *pChild, RecordModifier, false, nNumOfItems);
+		}
+
+		// End of the child records
+		const uint8 nEnd = RecordEnd;
+		cFile.Write(&nEnd, sizeof(uint8), 1);
+	}
+}
+
+/**
+*  @brief
+*    Migrates a legacy script modifier to its native replacement
+*/
+bool SceneCache::MigrateModifier(const XmlElement &cElement, String &sClass, String &sParameters) const
+{
+	// Only script modifiers running a script with a native replacement can be migrated
+	if (cElement.GetAttribute("Class") != "PLScriptBindings::SNMScript")
+		return false;
+	const String sScript = Url(cElement.GetAttribute("Script")).GetTitle();
+	for (uint32 i=0; LegacyScripts[i].pszScript; i++) {
+		if (sScript == LegacyScripts[i].pszScript) {
+			sClass = LegacyScripts[i].pszClass;
+			break;
+		}
+	}
+	if (!sClass.GetLength())
+		return false;
+
+	// The attributes, except the script related ones, are taken over
+	sParameters = "";
+	for (const XmlAttribute *pAttribute=cElement.GetFirstAttribute(); pAttribute; pAttribute=pAttribute->GetNext()) {
+		const String sName = pAttribute->GetName();
+		if (sName == "Flags") {
+			if (sParameters.GetLength())
+				sParameters += ' ';
+			sParameters += sName + "=\"" + pAttribute->GetValue() + '\"';
+		} else if (sName != "Class" && sName != "Script" && sName != "ScriptExecute") {
+			// Unknown attribute, the native replacement may not behave the same
+			return false;
+		}
+	}
+
+	// The script execute string may only set public variables (e.g. "PublicVariables.Speed=0.6 PublicVariables.Radius=0.18"),
+	// they become the attributes of the native replacement
+	Tokenizer cTokenizer;
+	cTokenizer.SetDelimiters(" \t\r\n;");
+	cTokenizer.Start(cElement.GetAttribute("ScriptExecute"));
+	String sToken = cTokenizer.GetNextToken();
+	while (sToken.GetLength()) {
+		const int nEqual = sToken.IndexOf('=');
+		if (!sToken.Compare("PublicVariables.", 0, 16) || nEqual <= 16 || nEqual == static_cast<int>(sToken.GetLength()) - 1) {
+			// Anything else can't be migrated
+			cTokenizer.Stop();
+			return false;
+		}
+		if (sParameters.GetLength())
+			sParameters += ' ';
+		sParameters += sToken.GetSubstring(16, nEqual - 16) + "=\"" + sToken.GetSubstring(nEqual + 1) + '\"';
+		sToken = cTokenizer.GetNextToken();
+	}
+	cTokenizer.Stop();
+
+	// Done
+	return true;
+}
+
+/**
+*  @brief
+*    Writes a string
+*/
+void SceneCache::WriteString(File &cFile, const String &sString) const
+{
+	const uint32 nLength = sString.GetLength();
+	cFile.Write(&nLength, sizeof(uint32), 1);
+	if (nLength)
+		cFile.Write(sString.GetASCII(), 1, nLength);
+}
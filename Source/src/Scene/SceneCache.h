@@ -0,0 +1,276 @@
+/*********************************************************\
+ *  File: SceneCache.h                                   *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_SCENECACHE_H__
+#define __DUNGEON_SCENECACHE_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include <PLCore/Container/Array.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLCore {
+	class File;
+	class XmlElement;
+}
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Compiled binary scene cache
+*
+*  @remarks
+*    Compiles PixelLight XML scenes into a binary form which is stored within a cache directory, for
+*    example "_Cache/Scenes/Dungeon.scenecache" for "Data/Scenes/Dungeon.scene". The cache file is
+*    keyed by the MD5 content hash of the source scene, so editing or re-exporting the scene automatically
+*    invalidates the cache file. The XML scene stays the authoring format, the cache is loaded by "SceneLoaderCache".
+*
+*    Binary format (native byte order):
+*    @verbatim
+*    Header:    uint32 Magic, uint32 Version, char SourceHash[32], uint32 NumOfItems
+*    Assets:    uint32 NumOfAssets, String[NumOfAssets] (files referenced by the scene, in the order they are needed)
+*    Record:    uint8  Type (see ERecord)
+*      Container/Node: String Class, String Name, uint8 Transform (see ETransform), float[3] per set
+*                      transform bit (position, rotation, scale), String Parameters, child records, End record
+*      Modifier:       String Class, String Parameters
+*    String:    uint32 Length, char[Length] (not terminated)
+*    @endverbatim
+*    The first record is the scene root, a container record with an empty class name describing the
+*    scene container the scene is loaded into. The asset table lists every attribute value starting with
+*    "Data/" or "Data\" and is used to prefetch the assets while the records are loaded. Script modifiers
+*    running a script with a native replacement are migrated during compilation (see "MigrateModifier()").
+*/
+class SceneCache {
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 Magic   = 0x43534E44;	/**< "DNSC" - dungeon scene cache */
+		static const PLCore::uint32 Version = 3;			/**< Format version, increase on each format change */
+		static const PLCore::uint32 HashSize = 32;			/**< Size of the source hash (MD5 as hex string) */
+
+		/**
+		*  @brief
+		*    Record types
+		*/
+		enum ERecord {
+			RecordContainer = 0,	/**< Scene container, followed by child records and an end record */
+			RecordNode      = 1,	/**< Scene node, followed by child records and an end record */
+			RecordModifier  = 2,	/**< Scene node modifier */
+			RecordEnd       = 3		/**< End of the child records of a container or node */
+		};
+
+		/**
+		*  @brief
+		*    Typed transform attributes
+		*/
+		enum ETransform {
+			TransformPosition = 1<<0,	/**< Position as three floats */
+			TransformRotation = 1<<1,	/**< Rotation as three floats (Euler angles in degree) */
+			TransformScale    = 1<<2	/**< Scale as three floats */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] sCacheDirectory
+		*    Directory the compiled scenes are stored in, created on demand
+		*/
+		SceneCache(const PLCore::String &sCacheDirectory);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		~SceneCache();
+
+		/**
+		*  @brief
+		*    Returns the name of the cache file of a scene
+		*
+		*  @param[in] sSceneFilename
+		*    Filename of the XML scene
+		*
+		*  @return
+		*    The name of the cache file of the scene (it's not checked whether or not this file exists)
+		*/
+		PLCore::String GetCacheFilename(const PLCore::String &sSceneFilename) const;
+
+		/**
+		*  @brief
+		*    Returns an up-to-date cache file of a scene, compiles the scene if required
+		*
+		*  @param[in] sSceneFilename
+		*    Filename of the XML scene
+		*
+		*  @return
+		*    The name of the up-to-date cache file, empty string on error (use the XML scene in this case)
+		*/
+		PLCore::String Prepare(const PLCore::String &sSceneFilename);
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		SceneCache(const SceneCache &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		SceneCache &operator =(const SceneCache &cSource);
+
+		/**
+		*  @brief
+		*    Returns whether or not a cache file is valid
+		*
+		*  @param[in] sCacheFilename
+		*    Name of the cache file
+		*  @param[in] sHash
+		*    Content hash of the XML scene
+		*
+		*  @return
+		*    'true' if the cache file exists and was compiled from the given XML scene content, else 'false'
+		*/
+		bool IsValid(const PLCore::String &sCacheFilename, const PLCore::String &sHash) const;
+
+		/**
+		*  @brief
+		*    Compiles a XML scene into a cache file
+		*
+		*  @param[in] cSceneFile
+		*    Opened XML scene file
+		*  @param[in] sHash
+		*    Content hash of the XML scene
+		*  @param[in] sCacheFilename
+		*    Name of the cache file to write
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool Compile(PLCore::File &cSceneFile, const PLCore::String &sHash, const PLCore::String &sCacheFilename) const;
+
+		/**
+		*  @brief
+		*    Collects the assets referenced by an element and its children
+		*
+		*  @param[in]  cElement
+		*    XML element to start with
+		*  @param[out] lstAssets
+		*    Receives the asset filenames (each filename is added just once, the list is not cleared before)
+		*/
+		void CollectAssets(const PLCore::XmlElement &cElement, PLCore::Array<PLCore::String> &lstAssets) const;
+
+		/**
+		*  @brief
+		*    Writes a container or node record including its children
+		*
+		*  @param[in] cFile
+		*    File to write into
+		*  @param[in] cElement
+		*    XML element of the container or node
+		*  @param[in] nRecord
+		*    Record type ('RecordContainer' or 'RecordNode')
+		*  @param[in] bRoot
+		*    'true' if this is the scene root, else 'false'
+		*  @param[out] nNumOfItems
+		*    Receives the number of written containers, nodes and modifiers (incremented)
+		*/
+		void WriteElement(PLCore::File &cFile, const PLCore::XmlElement &cElement, PLCore::uint8 nRecord, bool bRoot, PLCore::uint32 &nNumOfItems) const;
+
+		/**
+		*  @brief
+		*    Migrates a legacy script modifier to its native replacement
+		*
+		*  @param[in]  cElement
+		*    XML element of the modifier
+		*  @param[out] sClass
+		*    Receives the class name of the native replacement, must be empty when calling this method
+		*  @param[out] sParameters
+		*    Receives the parameter string of the native replacement
+		*
+		*  @return
+		*    'true' if the modifier was migrated, else 'false' (use the modifier as it is)
+		*
+		*  @remarks
+		*    A "PLScriptBindings::SNMScript" modifier running a script with a native replacement (e.g.
+		*    "SNMPositionRandomAnimation.lua") becomes the native modifier, the public variables set by
+		*    the "ScriptExecute" attribute become its attributes. Modifiers using anything the native
+		*    replacement doesn't know are not migrated.
+		*/
+		bool MigrateModifier(const PLCore::XmlElement &cElement, PLCore::String &sClass, PLCore::String &sParameters) const;
+
+		/**
+		*  @brief
+		*    Writes a string
+		*
+		*  @param[in] cFile
+		*    File to write into
+		*  @param[in] sString
+		*    String to write
+		*/
+		void WriteString(PLCore::File &cFile, const PLCore::String &sString) const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::String m_sCacheDirectory;	/**< Directory the compiled scenes are stored in */
+
+
+};
+
+
+#endif // __DUNGEON_SCENECACHE_H__
@@ -0,0 +1,1419 @@
+/*********************************************************\
+ *  File: SceneCuller.cpp                                *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE__)
+	#define DUNGEON_CULLING_SSE
+	#include <xmmintrin.h>
+#endif
+#include <PLCore/Log/Log.h>
+#include <PLCore/System/Mutex.h>
+#include <PLCore/System/Semaphore.h>
+#include <PLMath/Polygon.h>
+#include <PLMath/Rectangle.h>
+#include <PLMath/Matrix3x4.h>
+#include <PLMath/AABoundingBox.h>
+#include <PLRenderer/Renderer/IndexBuffer.h>
+#include <PLRenderer/Renderer/VertexBuffer.h>
+#include <PLRenderer/Material/Material.h>
+#include <PLRenderer/Material/ParameterManager.h>
+#include <PLMesh/Mesh.h>
+#include <PLMesh/Geometry.h>
+#include <PLMesh/MeshHandler.h>
+#include <PLMesh/MeshLODLevel.h>
+#include <PLMesh/MeshMorphTarget.h>
+#include <PLScene/Scene/SCCell.h>
+#include <PLScene/Scene/SNMesh.h>
+#include <PLScene/Scene/SNCamera.h>
+#include <PLScene/Scene/SNCellPortal.h>
+#include <PLScene/Scene/SNPointLight.h>
+#include <PLScene/Scene/SceneNodeModifier.h>
+#include "Tools/Profiler.h"
+#include "Tools/WorkerPool.h"
+#include "Tools/SpatialTools.h"
+#include "Scene/OcclusionBuffer.h"
+#include "Scene/SceneCuller.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+using namespace PLRenderer;
+using namespace PLMesh;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+static const uint32 MaxNumOfPortalVertices  = 8;		/**< Maximum number of portal polygon vertices, portals with more vertices are ignored */
+static const float	PortalEpsilon           = 0.01f;	/**< Distance to the portal plane below which a portal can't narrow the frustum */
+static const float	MinOccluderSize         = 2.0f;		/**< Diagonal of the bounding box of a mesh below which it's no occluder */
+static const uint32 MaxTrianglesPerOccluder = 256;		/**< Maximum number of triangles of the coarsest level of detail of an occluder */
+static const uint32 NumOfOccludeesPerJob    = 32;		/**< Number of meshes tested against the occlusion buffer per worker job */
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Ranges of meshes within the view tested against the occlusion buffer, shared by the scene culler and its jobs
+*
+*  @remarks
+*    The main thread and the worker threads take the ranges one after another, so the main thread never waits for a
+*    range no one has started - the worker threads may be blocked by file I/O of other users of the shared worker pool.
+*    Jobs may still be queued when the frame or even the scene culler is long gone, so the ranges are reference
+*    counted and a late job just finds no range to test.
+*/
+class OcclusionTestRanges {
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cSceneCuller
+		*    Owner scene culler, holds the first reference
+		*/
+		OcclusionTestRanges(SceneCuller &cSceneCuller) :
+			m_pSceneCuller(&cSceneCuller),
+			m_cSemaphore(0, 1),
+			m_nNumOfReferences(1),
+			m_nNumOfQueuedJobs(0),
+			m_nNextOccludee(0),
+			m_nNumOfOccludees(0),
+			m_nNumOfUntestedOccludees(0)
+		{
+		}
+
+		/**
+		*  @brief
+		*    Adds the reference of a job which is about to be queued
+		*/
+		void AddJob()
+		{
+			m_cMutex.Lock();
+			m_nNumOfReferences++;
+			m_nNumOfQueuedJobs++;
+			m_cMutex.Unlock();
+		}
+
+		/**
+		*  @brief
+		*    Returns the number of queued jobs which were not started yet
+		*
+		*  @return
+		*    Number of queued jobs which were not started yet
+		*/
+		uint32 GetNumOfQueuedJobs()
+		{
+			m_cMutex.Lock();
+			const uint32 nNumOfQueuedJobs = m_nNumOfQueuedJobs;
+			m_cMutex.Unlock();
+			return nNumOfQueuedJobs;
+		}
+
+		/**
+		*  @brief
+		*    Marks a queued job as started (or discarded)
+		*/
+		void JobStarted()
+		{
+			m_cMutex.Lock();
+			m_nNumOfQueuedJobs--;
+			m_cMutex.Unlock();
+		}
+
+		/**
+		*  @brief
+		*    Releases a reference, the last one destroys the ranges
+		*
+		*  @param[in] bSceneCuller
+		*    'true' if the scene culler releases its reference, the ranges no longer refer to it then
+		*/
+		void Release(bool bSceneCuller = false)
+		{
+			m_cMutex.Lock();
+			if (bSceneCuller)
+				m_pSceneCuller = nullptr;
+			const bool bDestroy = !(--m_nNumOfReferences);
+			m_cMutex.Unlock();
+			if (bDestroy)
+				delete this;
+		}
+
+		/**
+		*  @brief
+		*    Starts testing the meshes within the view of the current frame, called by the main thread
+		*
+		*  @param[in] nNumOfOccludees
+		*    Number of meshes within the view, >0
+		*/
+		void Start(uint32 nNumOfOccludees)
+		{
+			m_cMutex.Lock();
+			m_nNextOccludee			  = 0;
+			m_nNumOfOccludees		  = nNumOfOccludees;
+			m_nNumOfUntestedOccludees = nNumOfOccludees;
+			m_cMutex.Unlock();
+		}
+
+		/**
+		*  @brief
+		*    Tests ranges of meshes until none is left, called by the main thread and the worker threads
+		*/
+		void Test()
+		{
+			for (;;) {
+				// Take the next range, the scene culler is valid as long as not all ranges are tested
+				m_cMutex.Lock();
+				if (m_nNextOccludee >= m_nNumOfOccludees) {
+					m_cMutex.Unlock();
+					return;
+				}
+				const uint32 nFirst			 = m_nNextOccludee;
+				const uint32 nNumOfOccludees = (m_nNumOfOccludees - nFirst < NumOfOccludeesPerJob) ? m_nNumOfOccludees - nFirst : NumOfOccludeesPerJob;
+				m_nNextOccludee += nNumOfOccludees;
+				SceneCuller *pSceneCuller = m_pSceneCuller;
+				m_cMutex.Unlock();
+
+				// Test the range
+				pSceneCuller->TestOccludees(nFirst, nNumOfOccludees);
+
+				// The one testing the last range wakes up the main thread
+				m_cMutex.Lock();
+				m_nNumOfUntestedOccludees -= nNumOfOccludees;
+				const bool bFinished = !m_nNumOfUntestedOccludees;
+				m_cMutex.Unlock();
+				if (bFinished)
+					m_cSemaphore.Unlock();
+			}
+		}
+
+		/**
+		*  @brief
+		*    Waits until all meshes are tested, called by the main thread after "Test()" returned
+		*/
+		void Wait()
+		{
+			// The semaphore is unlocked exactly once per frame, by the one testing the last range
+			m_cSemaphore.Lock();
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		Mutex		 m_cMutex;					/**< Mutex protecting the following data */
+		SceneCuller *m_pSceneCuller;			/**< Owner scene culler, a null pointer as soon as it's destroyed */
+		Semaphore	 m_cSemaphore;				/**< Unlocked when the last range of a frame is tested */
+		uint32		 m_nNumOfReferences;		/**< Number of references (the scene culler and the jobs) */
+		uint32		 m_nNumOfQueuedJobs;		/**< Number of queued jobs which were not started yet */
+		uint32		 m_nNextOccludee;			/**< Index of the first mesh of the next range */
+		uint32		 m_nNumOfOccludees;			/**< Number of meshes within the view of the current frame */
+		uint32		 m_nNumOfUntestedOccludees;	/**< Number of meshes which are not tested yet */
+
+
+};
+
+/**
+*  @brief
+*    Job helping to test the ranges of meshes within the view against the occlusion buffer
+*/
+class OcclusionTestJob : public WorkerPool::Job {
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cRanges
+		*    Ranges to test, the job holds a reference
+		*/
+		OcclusionTestJob(OcclusionTestRanges &cRanges) :
+			m_pRanges(&cRanges),
+			m_bStarted(false)
+		{
+			m_pRanges->AddJob();
+		}
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		virtual ~OcclusionTestJob()
+		{
+			// Discarded jobs were never started
+			if (!m_bStarted)
+				m_pRanges->JobStarted();
+			m_pRanges->Release();
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Public virtual WorkerPool::Job functions              ]
+	//[-------------------------------------------------------]
+	public:
+		virtual void Execute() override
+		{
+			m_bStarted = true;
+			m_pRanges->JobStarted();
+			m_pRanges->Test();
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		OcclusionTestRanges *m_pRanges;		/**< Ranges to test, always valid */
+		bool				 m_bStarted;	/**< Was the job started? */
+
+
+};
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Returns whether or not a scene node is a static mesh
+*/
+bool SceneCuller::IsStaticMesh(SceneNode &cSceneNode)
+{
+	if (!cSceneNode.IsInstanceOf("PLScene::SNMesh") || !cSceneNode.IsVisible())
+		return false;
+
+	// Physics bodies without mass never move, everything else may
+	for (uint32 i=0; i<cSceneNode.GetNumOfModifiers(); i++) {
+		SceneNodeModifier *pSceneNodeModifier = cSceneNode.GetModifier("", i);
+		if (!pSceneNodeModifier || !pSceneNodeModifier->IsInstanceOf("PLPhysics::SNMPhysicsBody"))
+			return false;
+		const DynVar *pMass = pSceneNodeModifier->GetAttribute("Mass");
+		if (!pMass || pMass->GetFloat() != 0.0f)
+			return false;
+	}
+
+	// Done
+	return true;
+}
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+SceneCuller::SceneCuller(SceneContainer &cSceneContainer, const String &sSceneFilename, WorkerPool *pWorkerPool) :
+	m_pSceneContainer(&cSceneContainer),
+	m_nFrame(0),
+	m_nMeshGeneration(0),
+	m_nCameraPVSCell(-1),
+	m_pOcclusionBuffer(pWorkerPool ? new OcclusionBuffer() : nullptr),
+	m_pWorkerPool(pWorkerPool),
+	m_pOcclusionTestRanges(pWorkerPool ? new OcclusionTestRanges(*this) : nullptr)
+{
+	m_sCameraFrustum.nNumOfPlanes = 0;
+	memset(&m_sStatistics, 0, sizeof(m_sStatistics));
+
+	// Collect the cells first, the portals refer to them
+	CollectCells(cSceneContainer);
+	uint32 nNumOfCells = 0;
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+		BuildCell(*m_lstCells[i]);
+		if (m_lstCells[i]->bCell)
+			nNumOfCells++;
+	}
+	PL_LOG(Info, String::Format("Culling: %u static meshes within %u cells and %u other containers", GetNumOfMeshes(), nNumOfCells, m_lstCells.GetNumOfElements() - nNumOfCells))
+	if (m_pOcclusionBuffer) {
+		uint32 nNumOfOccluders = 0, nNumOfTriangles = 0;
+		for (uint32 nCell=0; nCell<m_lstCells.GetNumOfElements(); nCell++) {
+			const SCell &sCell = *m_lstCells[nCell];
+			for (uint32 i=0; i<sCell.lstMeshes.GetNumOfElements(); i++) {
+				if (sCell.lstMeshes[i]->lstOccluderTriangles.GetNumOfElements()) {
+					nNumOfOccluders++;
+					nNumOfTriangles += sCell.lstMeshes[i]->lstOccluderTriangles.GetNumOfElements()/3;
+				}
+			}
+		}
+		PL_LOG(Info, String::Format("Culling: %u occluders with %u triangles", nNumOfOccluders, nNumOfTriangles))
+	}
+
+	// Collect the shadow casters of the lights now, the lights and most meshes never move
+	uint32 nNumOfLights = 0, nNumOfShadowCasters = 0;
+	for (uint32 nCell=0; nCell<m_lstCells.GetNumOfElements(); nCell++) {
+		const SCell &sCell = *m_lstCells[nCell];
+		for (uint32 i=0; i<sCell.lstLights.GetNumOfElements(); i++) {
+			if (UpdateLight(*sCell.lstLights[i])) {
+				nNumOfLights++;
+				nNumOfShadowCasters += sCell.lstLights[i]->lstShadowCasters.GetNumOfElements();
+			}
+		}
+	}
+	PL_LOG(Info, String::Format("Culling: %u shadow casting lights with %u cached shadow casters", nNumOfLights, nNumOfShadowCasters))
+
+	// Use the potentially visible set of the scene, if there's an up-to-date one
+	if (sSceneFilename.GetLength() && m_cCellPVS.Load(CellPVS::GetFilename(sSceneFilename), CellPVS::GetSceneHash(sSceneFilename))) {
+		uint32 nNumOfPVSCells = 0;
+		for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+			SCell &sCell = *m_lstCells[i];
+			if (sCell.bCell) {
+				sCell.nPVSCell = m_cCellPVS.GetCell(sCell.pContainer->GetName());
+				if (sCell.nPVSCell >= 0)
+					nNumOfPVSCells++;
+			}
+		}
+		PL_LOG(Info, String::Format("Culling: The potentially visible set knows %u of %u cells", nNumOfPVSCells, nNumOfCells))
+	}
+}
+
+/**
+*  @brief
+*    Destructor, makes the culled meshes visible again
+*/
+SceneCuller::~SceneCuller()
+{
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+		ClearCell(*m_lstCells[i]);
+		delete m_lstCells[i];
+	}
+	if (m_pOcclusionBuffer)
+		delete m_pOcclusionBuffer;
+
+	// Occlusion test jobs may still be queued, they keep the ranges alive
+	if (m_pOcclusionTestRanges)
+		m_pOcclusionTestRanges->Release(true);
+}
+
+/**
+*  @brief
+*    Returns the number of managed meshes
+*/
+uint32 SceneCuller::GetNumOfMeshes() const
+{
+	uint32 nNumOfMeshes = 0;
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++)
+		nNumOfMeshes += m_lstCells[i]->lstMeshes.GetNumOfElements();
+	return nNumOfMeshes;
+}
+
+/**
+*  @brief
+*    Culls the meshes, call this once per frame right before drawing
+*/
+void SceneCuller::Update(SNCamera *pCamera, const Rectangle &cViewport)
+{
+	m_nFrame++;
+	memset(&m_sStatistics, 0, sizeof(m_sStatistics));
+
+	// Build the bounding volume hierarchies of the containers whose scene nodes have changed
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+		SCell &sCell = *m_lstCells[i];
+		if (sCell.bDirty || sCell.pContainer->GetNumOfElements() != sCell.nNumOfElements)
+			BuildCell(sCell);
+	}
+
+	// Without a camera frustum, everything is visible
+	Vector3 vEye, vFarVertices[4];
+	float fNearDistance = 0.0f;
+	if (!pCamera || !GetCameraFrustum(*pCamera, cViewport, vEye, m_sCameraFrustum, vFarVertices, fNearDistance)) {
+		Apply(false);
+		return;
+	}
+
+	// Containers outside of the cells are culled against the camera frustum without looking at portals, so are all
+	// cells if the camera is in none of them... else the cells are culled through the portals starting at the camera cell
+	const int nCameraCell = GetCameraCell(*pCamera);
+	m_nCameraPVSCell = -1;
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+		if (!m_lstCells[i]->bCell || nCameraCell < 0)
+			CullCell(i, m_sCameraFrustum, vEye, MaxPortalDepth);
+	}
+	if (nCameraCell >= 0) {
+		m_nCameraPVSCell = m_lstCells[nCameraCell]->nPVSCell;
+		CullCell(nCameraCell, m_sCameraFrustum, vEye, 0);
+	}
+
+	// Hide the meshes within the view which are behind the nearest occluders, before the shadow casters are kept
+	if (m_pOcclusionBuffer)
+		CullOccluded(vEye, vFarVertices, fNearDistance);
+
+	// Keep the cached shadow casters of the shadow casting lights which intersect the camera frustum
+	for (uint32 nCell=0; nCell<m_lstCells.GetNumOfElements(); nCell++) {
+		SCell &sCell = *m_lstCells[nCell];
+		for (uint32 nLight=0; nLight<sCell.lstLights.GetNumOfElements(); nLight++) {
+			SLight &sLight = *sCell.lstLights[nLight];
+			if (!sLight.cSceneNode.GetElement()) {
+				// The light was destroyed, build the cell again within the next frame
+				sCell.bDirty = true;
+			} else if (UpdateLight(sLight)) {
+				bool bVisible = true;
+				for (uint32 i=0; i<m_sCameraFrustum.nNumOfPlanes && bVisible; i++) {
+					const float *pfPlane = m_sCameraFrustum.fPlanes[i];
+					bVisible = (pfPlane[0]*sLight.vCenter.x + pfPlane[1]*sLight.vCenter.y + pfPlane[2]*sLight.vCenter.z + pfPlane[3] >= -sLight.fRadius);
+				}
+				if (bVisible) {
+					for (uint32 i=0; i<sLight.lstShadowCasters.GetNumOfElements(); i++) {
+						SMesh &sMesh = *sLight.lstShadowCasters[i];
+						if (sMesh.nVisibleFrame != m_nFrame) {
+							sMesh.nVisibleFrame = m_nFrame;
+							m_sStatistics.nNumOfShadowCasters++;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Make the culled meshes invisible
+	Apply(true);
+}
+
+/**
+*  @brief
+*    Returns the culling statistics of the last frame
+*/
+const SceneCuller::SStatistics &SceneCuller::GetStatistics() const
+{
+	return m_sStatistics;
+}
+
+/**
+*  @brief
+*    Returns the cells visible through the portals from a position into any direction, used to bake the potentially visible set
+*/
+void SceneCuller::GetVisibleCells(const SceneContainer &cCell, const Vector3 &vPosition, Array<SceneContainer*> &lstCells)
+{
+	lstCells.Reset();
+	for (uint32 nCell=0; nCell<m_lstCells.GetNumOfElements(); nCell++) {
+		if (m_lstCells[nCell]->bCell && m_lstCells[nCell]->pContainer == &cCell) {
+			// There's no view direction and no far plane, and of course the potentially visible set itself isn't used
+			m_nFrame++;
+			m_nCameraPVSCell			  = -1;
+			m_sCameraFrustum.nNumOfPlanes = 0;
+			CullCell(nCell, m_sCameraFrustum, vPosition, 0);
+			for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+				if (m_lstCells[i]->bCell && m_lstCells[i]->nVisitedFrame == m_nFrame)
+					lstCells.Add(m_lstCells[i]->pContainer);
+			}
+			return;
+		}
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Private static functions                              ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Adds a plane through the eye and an edge to a frustum
+*/
+void SceneCuller::AddPlane(SFrustum &sFrustum, const Vector3 &vEye, const Vector3 &vA, const Vector3 &vB, const Vector3 &vInside)
+{
+	Vector3 vNormal = (vA - vEye).CrossProduct(vB - vEye);
+	const float fLength = vNormal.GetLength();
+	if (fLength > 0.0f && sFrustum.nNumOfPlanes < MaxNumOfPlanes) {
+		// The order of the edge vertices is unknown, so the plane is turned towards the inside point
+		vNormal = vNormal*(1.0f/fLength);
+		float fDistance = -vNormal.DotProduct(vEye);
+		if (vNormal.DotProduct(vInside) + fDistance < 0.0f) {
+			vNormal	  = -vNormal;
+			fDistance = -fDistance;
+		}
+		float *pfPlane = sFrustum.fPlanes[sFrustum.nNumOfPlanes++];
+		pfPlane[0] = vNormal.x;
+		pfPlane[1] = vNormal.y;
+		pfPlane[2] = vNormal.z;
+		pfPlane[3] = fDistance;
+	}
+}
+
+/**
+*  @brief
+*    Tests the four children of a node against a frustum
+*/
+void SceneCuller::TestFrustum(const SNode &sNode, const SFrustum &sFrustum, uint32 &nOutside, uint32 &nInside)
+{
+	// Per plane, the distance of the box corner farthest along the plane normal is the maximum of "normal*minimum" and
+	// "normal*maximum" per axis: the box is outside if this is negative for any plane, the box is inside if the distance
+	// of the opposite corner is positive for all planes
+	#ifdef DUNGEON_CULLING_SSE
+		const __m128 vMinX = _mm_loadu_ps(sNode.fMinX);
+		const __m128 vMinY = _mm_loadu_ps(sNode.fMinY);
+		const __m128 vMinZ = _mm_loadu_ps(sNode.fMinZ);
+		const __m128 vMaxX = _mm_loadu_ps(sNode.fMaxX);
+		const __m128 vMaxY = _mm_loadu_ps(sNode.fMaxY);
+		const __m128 vMaxZ = _mm_loadu_ps(sNode.fMaxZ);
+		const __m128 vZero = _mm_setzero_ps();
+		__m128 vOutside		= vZero;
+		__m128 vIntersected = vZero;
+		for (uint32 i=0; i<sFrustum.nNumOfPlanes; i++) {
+			const float *pfPlane = sFrustum.fPlanes[i];
+			const __m128 vA = _mm_set1_ps(pfPlane[0]);
+			const __m128 vB = _mm_set1_ps(pfPlane[1]);
+			const __m128 vC = _mm_set1_ps(pfPlane[2]);
+			const __m128 vX0 = _mm_mul_ps(vA, vMinX), vX1 = _mm_mul_ps(vA, vMaxX);
+			const __m128 vY0 = _mm_mul_ps(vB, vMinY), vY1 = _mm_mul_ps(vB, vMaxY);
+			const __m128 vZ0 = _mm_mul_ps(vC, vMinZ), vZ1 = _mm_mul_ps(vC, vMaxZ);
+			const __m128 vD	 = _mm_set1_ps(pfPlane[3]);
+			const __m128 vFar  = _mm_add_ps(_mm_add_ps(_mm_max_ps(vX0, vX1), _mm_max_ps(vY0, vY1)), _mm_add_ps(_mm_max_ps(vZ0, vZ1), vD));
+			const __m128 vNear = _mm_add_ps(_mm_add_ps(_mm_min_ps(vX0, vX1), _mm_min_ps(vY0, vY1)), _mm_add_ps(_mm_min_ps(vZ0, vZ1), vD));
+			vOutside	 = _mm_or_ps(vOutside,	   _mm_cmplt_ps(vFar,  vZero));
+			vIntersected = _mm_or_ps(vIntersected, _mm_cmplt_ps(vNear, vZero));
+		}
+		nOutside = _mm_movemask_ps(vOutside);
+		nInside	 = ~_mm_movemask_ps(vIntersected) & 0xf;
+	#else
+		nOutside = 0;
+		nInside	 = 0xf;
+		for (uint32 i=0; i<sFrustum.nNumOfPlanes; i++) {
+			const float *pfPlane = sFrustum.fPlanes[i];
+			for (uint32 nLane=0; nLane<4; nLane++) {
+				const float fX0 = pfPlane[0]*sNode.fMinX[nLane], fX1 = pfPlane[0]*sNode.fMaxX[nLane];
+				const float fY0 = pfPlane[1]*sNode.fMinY[nLane], fY1 = pfPlane[1]*sNode.fMaxY[nLane];
+				const float fZ0 = pfPlane[2]*sNode.fMinZ[nLane], fZ1 = pfPlane[2]*sNode.fMaxZ[nLane];
+				const float fFar  = ((fX0 > fX1) ? fX0 : fX1) + ((fY0 > fY1) ? fY0 : fY1) + ((fZ0 > fZ1) ? fZ0 : fZ1) + pfPlane[3];
+				const float fNear = ((fX0 < fX1) ? fX0 : fX1) + ((fY0 < fY1) ? fY0 : fY1) + ((fZ0 < fZ1) ? fZ0 : fZ1) + pfPlane[3];
+				if (fFar < 0.0f)
+					nOutside |= 1 << nLane;
+				if (fNear < 0.0f)
+					nInside &= ~(1 << nLane);
+			}
+		}
+	#endif
+}
+
+/**
+*  @brief
+*    Tests the four children of a node against a sphere
+*/
+uint32 SceneCuller::TestSphere(const SNode &sNode, const Vector3 &vCenter, float fRadius)
+{
+	// The distance of the sphere center to a box is the distance to the center clamped into the box
+	#ifdef DUNGEON_CULLING_SSE
+		const __m128 vX	   = _mm_set1_ps(vCenter.x);
+		const __m128 vY	   = _mm_set1_ps(vCenter.y);
+		const __m128 vZ	   = _mm_set1_ps(vCenter.z);
+		const __m128 vZero = _mm_setzero_ps();
+		const __m128 vDX = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(sNode.fMinX), vX), _mm_sub_ps(vX, _mm_loadu_ps(sNode.fMaxX))), vZero);
+		const __m128 vDY = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(sNode.fMinY), vY), _mm_sub_ps(vY, _mm_loadu_ps(sNode.fMaxY))), vZero);
+		const __m128 vDZ = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(sNode.fMinZ), vZ), _mm_sub_ps(vZ, _mm_loadu_ps(sNode.fMaxZ))), vZero);
+		const __m128 vSquaredDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vDX, vDX), _mm_mul_ps(vDY, vDY)), _mm_mul_ps(vDZ, vDZ));
+		return _mm_movemask_ps(_mm_cmple_ps(vSquaredDistance, _mm_set1_ps(fRadius*fRadius)));
+	#else
+		uint32 nIntersected = 0;
+		for (uint32 nLane=0; nLane<4; nLane++) {
+			float fDX = sNode.fMinX[nLane] - vCenter.x, fDY = sNode.fMinY[nLane] - vCenter.y, fDZ = sNode.fMinZ[nLane] - vCenter.z;
+			if (fDX < vCenter.x - sNode.fMaxX[nLane]) fDX = vCenter.x - sNode.fMaxX[nLane];
+			if (fDY < vCenter.y - sNode.fMaxY[nLane]) fDY = vCenter.y - sNode.fMaxY[nLane];
+			if (fDZ < vCenter.z - sNode.fMaxZ[nLane]) fDZ = vCenter.z - sNode.fMaxZ[nLane];
+			if (fDX < 0.0f) fDX = 0.0f;
+			if (fDY < 0.0f) fDY = 0.0f;
+			if (fDZ < 0.0f) fDZ = 0.0f;
+			if (fDX*fDX + fDY*fDY + fDZ*fDZ <= fRadius*fRadius)
+				nIntersected |= 1 << nLane;
+		}
+		return nIntersected;
+	#endif
+}
+
+/**
+*  @brief
+*    Compares two meshes within the view by their distance to the eye, used for sorting
+*/
+int SceneCuller::CompareOccludees(const void *pA, const void *pB)
+{
+	const float fA = static_cast<const SOccludee*>(pA)->fDistance;
+	const float fB = static_cast<const SOccludee*>(pB)->fDistance;
+	return (fA < fB) ? -1 : ((fA > fB) ? 1 : 0);
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+SceneCuller::SceneCuller(const SceneCuller &cSource) :
+	m_pSceneContainer(nullptr),
+	m_nFrame(0),
+	m_nMeshGeneration(0),
+	m_nCameraPVSCell(-1),
+	m_pOcclusionBuffer(nullptr),
+	m_pWorkerPool(nullptr),
+	m_pOcclusionTestRanges(nullptr)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+SceneCuller &SceneCuller::operator =(const SceneCuller &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Collects the cells and the containers outside of the cells
+*/
+void SceneCuller::CollectCells(SceneContainer &cContainer)
+{
+	SCell *pCell = new SCell;
+	pCell->pContainer	  = &cContainer;
+	pCell->bCell		  = cContainer.IsInstanceOf("PLScene::SCCell");
+	pCell->bOnPath		  = false;
+	pCell->bDirty		  = true;
+	pCell->nPVSCell		  = -1;
+	pCell->nVisitedFrame  = 0;
+	pCell->nNumOfElements = 0;
+	m_lstCells.Add(pCell);
+
+	// Containers within cells belong to the cell, else look for further cells
+	if (!pCell->bCell) {
+		for (uint32 i=0; i<cContainer.GetNumOfElements(); i++) {
+			SceneNode *pSceneNode = cContainer.GetByIndex(i);
+			if (pSceneNode && pSceneNode->IsContainer())
+				CollectCells(static_cast<SceneContainer&>(*pSceneNode));
+		}
+	}
+}
+
+/**
+*  @brief
+*    Builds the meshes, the bounding volume hierarchy, the portals and the lights of a cell
+*/
+void SceneCuller::BuildCell(SCell &sCell)
+{
+	ClearCell(sCell);
+	sCell.bDirty		 = false;
+	sCell.nNumOfElements = sCell.pContainer->GetNumOfElements();
+
+	// The cached shadow casters of all lights may refer to the destroyed meshes
+	m_nMeshGeneration++;
+
+	// Get the transform from the container into scene container space
+	Matrix3x4 mTransform;
+	if (sCell.pContainer == m_pSceneContainer)
+		mTransform.SetIdentity();
+	else if (!sCell.pContainer->GetTransformMatrixTo(*m_pSceneContainer, mTransform))
+		return;
+
+	// Collect the static meshes, the portals and the shadow casting lights
+	SItem *pItems = new SItem[sCell.nNumOfElements + 1];
+	uint32 nNumOfItems = 0;
+	for (uint32 i=0; i<sCell.nNumOfElements; i++) {
+		SceneNode *pSceneNode = sCell.pContainer->GetByIndex(i);
+		if (!pSceneNode) {
+			// Nothing to do
+
+		// Static mesh
+		} else if (IsStaticMesh(*pSceneNode)) {
+			// Get the bounding box within scene container space
+			const AABoundingBox &cBox = pSceneNode->GetContainerAABoundingBox();
+			SItem &sItem = pItems[nNumOfItems++];
+			for (uint32 nCorner=0; nCorner<8; nCorner++) {
+				const Vector3 vCorner = mTransform*Vector3((nCorner & 1) ? cBox.vMax.x : cBox.vMin.x,
+														   (nCorner & 2) ? cBox.vMax.y : cBox.vMin.y,
+														   (nCorner & 4) ? cBox.vMax.z : cBox.vMin.z);
+				if (!nCorner) {
+					sItem.vMin = sItem.vMax = vCorner;
+				} else {
+					if (sItem.vMin.x > vCorner.x) sItem.vMin.x = vCorner.x;
+					if (sItem.vMin.y > vCorner.y) sItem.vMin.y = vCorner.y;
+					if (sItem.vMin.z > vCorner.z) sItem.vMin.z = vCorner.z;
+					if (sItem.vMax.x < vCorner.x) sItem.vMax.x = vCorner.x;
+					if (sItem.vMax.y < vCorner.y) sItem.vMax.y = vCorner.y;
+					if (sItem.vMax.z < vCorner.z) sItem.vMax.z = vCorner.z;
+				}
+			}
+			sItem.vCenter = (sItem.vMin + sItem.vMax)*0.5f;
+			sItem.nMesh	  = sCell.lstMeshes.GetNumOfElements();
+
+			// Add the mesh
+			SMesh *pMesh = new SMesh;
+			pMesh->cSceneNode.SetElement(pSceneNode);
+			pMesh->bCastShadow	 = (pSceneNode->GetFlags() & SceneNode::CastShadow) != 0;
+			pMesh->bCulled		 = false;
+			pMesh->nVisibleFrame = 0;
+			pMesh->vMin			 = sItem.vMin;
+			pMesh->vMax			 = sItem.vMax;
+			if (m_pOcclusionBuffer)
+				BuildOccluder(*pSceneNode, *pMesh);
+			sCell.lstMeshes.Add(pMesh);
+
+		// Portal
+		} else if (sCell.bCell && pSceneNode->IsInstanceOf("PLScene::SNCellPortal")) {
+			SNCellPortal &cCellPortal = static_cast<SNCellPortal&>(*pSceneNode);
+			const SCCell *pTargetCell = cCellPortal.GetTargetCellInstance();
+			const Array<Vector3> &lstVertices = cCellPortal.GetPolygon().GetVertexList();
+			Matrix3x4 mPortal;
+			if (pTargetCell && lstVertices.GetNumOfElements() >= 3 && lstVertices.GetNumOfElements() <= MaxNumOfPortalVertices &&
+				cCellPortal.GetTransformMatrixTo(*m_pSceneContainer, mPortal)) {
+				for (uint32 nCell=0; nCell<m_lstCells.GetNumOfElements(); nCell++) {
+					if (m_lstCells[nCell]->pContainer == pTargetCell) {
+						SPortal *pPortal = new SPortal;
+						pPortal->nTargetCell = nCell;
+						for (uint32 nVertex=0; nVertex<lstVertices.GetNumOfElements(); nVertex++)
+							pPortal->lstVertices.Add(mPortal*lstVertices[nVertex]);
+
+						// Get the portal plane, the portal polygon is planar
+						const Vector3 &vV0 = pPortal->lstVertices[0];
+						pPortal->vNormal = (pPortal->lstVertices[1] - vV0).CrossProduct(pPortal->lstVertices[2] - vV0);
+						const float fLength = pPortal->vNormal.GetLength();
+						if (fLength > 0.0f) {
+							pPortal->vNormal   = pPortal->vNormal*(1.0f/fLength);
+							pPortal->fDistance = -pPortal->vNormal.DotProduct(vV0);
+							sCell.lstPortals.Add(pPortal);
+						} else {
+							delete pPortal;
+						}
+						break;
+					}
+				}
+			}
+
+		// Shadow casting point or spot light (spot lights are point lights as well)
+		} else if (pSceneNode->IsInstanceOf("PLScene::SNPointLight") && (pSceneNode->GetFlags() & SceneNode::CastShadow)) {
+			SLight *pLight = new SLight;
+			pLight->cSceneNode.SetElement(pSceneNode);
+			pLight->nMeshGeneration = 0;
+			pLight->fRadius			= 0.0f;
+			sCell.lstLights.Add(pLight);
+		}
+	}
+
+	// Build the bounding volume hierarchy
+	if (nNumOfItems)
+		BuildNode(sCell, pItems, nNumOfItems);
+	delete [] pItems;
+}
+
+/**
+*  @brief
+*    Builds a bounding volume hierarchy node
+*/
+uint32 SceneCuller::BuildNode(SCell &sCell, SItem *pItems, uint32 nNumOfItems)
+{
+	// Up to four meshes get a lane each, more meshes are split into halves of halves along the axis they are spread the most
+	uint32 nFirst[4], nCount[4], nNumOfLanes;
+	if (nNumOfItems <= 4) {
+		for (uint32 i=0; i<nNumOfItems; i++) {
+			nFirst[i] = i;
+			nCount[i] = 1;
+		}
+		nNumOfLanes = nNumOfItems;
+	} else {
+		SpatialTools::SortByCenter(pItems, nNumOfItems);
+		const uint32 nHalf = nNumOfItems/2;
+		SpatialTools::SortByCenter(pItems, nHalf);
+		SpatialTools::SortByCenter(pItems + nHalf, nNumOfItems - nHalf);
+		nFirst[0] = 0;
+		nCount[0] = nHalf/2;
+		nFirst[1] = nCount[0];
+		nCount[1] = nHalf - nCount[0];
+		nFirst[2] = nHalf;
+		nCount[2] = (nNumOfItems - nHalf)/2;
+		nFirst[3] = nHalf + nCount[2];
+		nCount[3] = nNumOfItems - nFirst[3];
+		nNumOfLanes = 4;
+	}
+
+	// Add the node, unused lanes get an empty bounding box
+	SNode sNode;
+	for (uint32 nLane=0; nLane<4; nLane++) {
+		sNode.fMinX[nLane] = sNode.fMinY[nLane] = sNode.fMinZ[nLane] = 0.0f;
+		sNode.fMaxX[nLane] = sNode.fMaxY[nLane] = sNode.fMaxZ[nLane] = 0.0f;
+		sNode.nChild[nLane] = EmptyLane;
+	}
+	const uint32 nNode = sCell.lstNodes.GetNumOfElements();
+	sCell.lstNodes.Add(sNode);
+
+	// Fill the lanes
+	for (uint32 nLane=0; nLane<nNumOfLanes; nLane++) {
+		// Get the bounding box of the meshes of the lane
+		SItem *pLaneItems = pItems + nFirst[nLane];
+		Vector3 vMin = pLaneItems[0].vMin, vMax = pLaneItems[0].vMax;
+		for (uint32 i=1; i<nCount[nLane]; i++) {
+			const SItem &sItem = pLaneItems[i];
+			if (vMin.x > sItem.vMin.x) vMin.x = sItem.vMin.x;
+			if (vMin.y > sItem.vMin.y) vMin.y = sItem.vMin.y;
+			if (vMin.z > sItem.vMin.z) vMin.z = sItem.vMin.z;
+			if (vMax.x < sItem.vMax.x) vMax.x = sItem.vMax.x;
+			if (vMax.y < sItem.vMax.y) vMax.y = sItem.vMax.y;
+			if (vMax.z < sItem.vMax.z) vMax.z = sItem.vMax.z;
+		}
+
+		// A single mesh is a leaf, else build a child node
+		const int nChild = (nCount[nLane] == 1) ? ~static_cast<int>(pLaneItems[0].nMesh) : static_cast<int>(BuildNode(sCell, pLaneItems, nCount[nLane]));
+
+		// Don't keep a reference to the node, the array may have been reallocated by the child nodes
+		SNode &sLaneNode = sCell.lstNodes[nNode];
+		sLaneNode.fMinX[nLane]	= vMin.x;
+		sLaneNode.fMinY[nLane]	= vMin.y;
+		sLaneNode.fMinZ[nLane]	= vMin.z;
+		sLaneNode.fMaxX[nLane]	= vMax.x;
+		sLaneNode.fMaxY[nLane]	= vMax.y;
+		sLaneNode.fMaxZ[nLane]	= vMax.z;
+		sLaneNode.nChild[nLane] = nChild;
+	}
+
+	// Done
+	return nNode;
+}
+
+/**
+*  @brief
+*    Makes the culled meshes of a cell visible again and destroys its meshes, nodes, portals and lights
+*/
+void SceneCuller::ClearCell(SCell &sCell)
+{
+	for (uint32 i=0; i<sCell.lstMeshes.GetNumOfElements(); i++) {
+		SMesh *pMesh = sCell.lstMeshes[i];
+		if (pMesh->bCulled) {
+			SceneNode *pSceneNode = pMesh->cSceneNode.GetElement();
+			if (pSceneNode)
+				pSceneNode->SetVisible(true);
+		}
+		delete pMesh;
+	}
+	sCell.lstMeshes.Clear();
+	sCell.lstNodes.Clear();
+	for (uint32 i=0; i<sCell.lstPortals.GetNumOfElements(); i++)
+		delete sCell.lstPortals[i];
+	sCell.lstPortals.Clear();
+	for (uint32 i=0; i<sCell.lstLights.GetNumOfElements(); i++)
+		delete sCell.lstLights[i];
+	sCell.lstLights.Clear();
+}
+
+/**
+*  @brief
+*    Reads the occluder triangles of a static mesh, if it's a suitable occluder
+*/
+void SceneCuller::BuildOccluder(SceneNode &cSceneNode, SMesh &sMesh) const
+{
+	// Small meshes hide next to nothing, the occluders are walls, pillars, beams...
+	if ((sMesh.vMax - sMesh.vMin).GetLength() < MinOccluderSize || !cSceneNode.IsInstanceOf("PLScene::SNMesh"))
+		return;
+	MeshHandler *pMeshHandler = static_cast<SNMesh&>(cSceneNode).GetMeshHandler();
+	Mesh *pMesh = pMeshHandler ? pMeshHandler->GetResource() : nullptr;
+	Matrix3x4 mTransform;
+	if (!pMesh || !pMesh->GetNumOfLODLevels() || !cSceneNode.GetTransformMatrixTo(*m_pSceneContainer, mTransform))
+		return;
+
+	// Two sided, alpha tested and transparent materials (spider webs, plants, paper...) let the view through
+	for (uint32 i=0; i<pMeshHandler->GetNumOfMaterials(); i++) {
+		Material *pMaterial = pMeshHandler->GetMaterial(i);
+		if (!pMaterial || pMaterial->GetParameterManager().GetParameter("TwoSided") || pMaterial->GetParameterManager().GetParameter("AlphaReference") ||
+			pMaterial->GetParameterManager().GetParameter("Opacity"))
+			return;
+	}
+
+	// The coarsest level of detail is the simplified occluder mesh, just triangle lists are used
+	MeshLODLevel	*pLODLevel	   = pMesh->GetLODLevel(pMesh->GetNumOfLODLevels() - 1);
+	MeshMorphTarget *pMorphTarget  = pMesh->GetMorphTarget(0);
+	IndexBuffer		*pIndexBuffer  = pLODLevel ? pLODLevel->GetIndexBuffer() : nullptr;
+	VertexBuffer	*pVertexBuffer = pMorphTarget ? pMorphTarget->GetVertexBuffer() : nullptr;
+	const Array<Geometry> *plstGeometries = pLODLevel ? pLODLevel->GetGeometries() : nullptr;
+	if (!pIndexBuffer || !pVertexBuffer || !plstGeometries)
+		return;
+	uint32 nNumOfTriangles = 0;
+	for (uint32 i=0; i<plstGeometries->GetNumOfElements(); i++) {
+		const Geometry &cGeometry = (*plstGeometries)[i];
+		if (cGeometry.GetPrimitiveType() == Primitive::TriangleList)
+			nNumOfTriangles += cGeometry.GetIndexSize()/3;
+	}
+	if (!nNumOfTriangles || nNumOfTriangles > MaxTrianglesPerOccluder)
+		return;
+
+	// Read the triangles and transform them into scene container space
+	if (pIndexBuffer->Lock(Lock::ReadOnly)) {
+		if (pVertexBuffer->Lock(Lock::ReadOnly)) {
+			const uint32 nNumOfIndices	= pIndexBuffer->GetNumOfElements();
+			const uint32 nNumOfVertices = pVertexBuffer->GetNumOfElements();
+			for (uint32 nGeometry=0; nGeometry<plstGeometries->GetNumOfElements(); nGeometry++) {
+				const Geometry &cGeometry = (*plstGeometries)[nGeometry];
+				if (cGeometry.GetPrimitiveType() == Primitive::TriangleList) {
+					const uint32 nEndIndex = cGeometry.GetStartIndex() + cGeometry.GetIndexSize();
+					for (uint32 nIndex=cGeometry.GetStartIndex(); nIndex+2<nEndIndex && nIndex+2<nNumOfIndices; nIndex+=3) {
+						const uint32 nVertices[3] = { pIndexBuffer->GetData(nIndex), pIndexBuffer->GetData(nIndex + 1), pIndexBuffer->GetData(nIndex + 2) };
+						if (nVertices[0] < nNumOfVertices && nVertices[1] < nNumOfVertices && nVertices[2] < nNumOfVertices) {
+							for (uint32 i=0; i<3; i++) {
+								const float *pfPosition = static_cast<const float*>(pVertexBuffer->GetData(nVertices[i], VertexBuffer::Position));
+								sMesh.lstOccluderTriangles.Add(mTransform*Vector3(pfPosition[0], pfPosition[1], pfPosition[2]));
+							}
+						}
+					}
+				}
+			}
+			pVertexBuffer->Unlock();
+		}
+		pIndexBuffer->Unlock();
+	}
+}
+
+/**
+*  @brief
+*    Returns the camera frustum within scene container space
+*/
+bool SceneCuller::GetCameraFrustum(SNCamera &cCamera, const Rectangle &cViewport, Vector3 &vEye, SFrustum &sFrustum, Vector3 *pvFarVertices, float &fNearDistance) const
+{
+	// Get the transforms into scene container space, the frustum vertices are within the space of the camera container
+	SceneContainer *pContainer = cCamera.GetContainer();
+	Matrix3x4 mContainer, mCamera;
+	if (!pContainer || !cCamera.GetTransformMatrixTo(*m_pSceneContainer, mCamera))
+		return false; // Error!
+	if (pContainer == m_pSceneContainer)
+		mContainer.SetIdentity();
+	else if (!pContainer->GetTransformMatrixTo(*m_pSceneContainer, mContainer))
+		return false; // Error!
+	vEye = mCamera*Vector3::Zero;
+
+	// Get the frustum vertices sorted by their distance to the eye, so the first four are the near ones
+	const Array<Vector3> &lstVertices = cCamera.GetFrustumVertices(cViewport);
+	if (lstVertices.GetNumOfElements() != 8)
+		return false; // Error!
+	Vector3 vVertices[8];
+	float	fDistances[8];
+	for (uint32 i=0; i<8; i++) {
+		const Vector3 vVertex   = mContainer*lstVertices[i];
+		const float	  fDistance = (vVertex - vEye).GetSquaredLength();
+		uint32 j = i;
+		for (; j>0 && fDistances[j - 1] > fDistance; j--) {
+			vVertices[j]  = vVertices[j - 1];
+			fDistances[j] = fDistances[j - 1];
+		}
+		vVertices[j]  = vVertex;
+		fDistances[j] = fDistance;
+	}
+	const Vector3 vNear = (vVertices[0] + vVertices[1] + vVertices[2] + vVertices[3])*0.25f;
+	const Vector3 vFar  = (vVertices[4] + vVertices[5] + vVertices[6] + vVertices[7])*0.25f;
+	Vector3 vAxis = vFar - vNear;
+	const float fLength = vAxis.GetLength();
+	if (fLength <= 0.0f)
+		return false; // Error!
+	vAxis = vAxis*(1.0f/fLength);
+	fNearDistance = vAxis.DotProduct(vNear - vEye);
+
+	// Near plane, the second plane is always the far plane (the portal frusta use it as well)
+	sFrustum.nNumOfPlanes = 2;
+	sFrustum.fPlanes[0][0] = vAxis.x;
+	sFrustum.fPlanes[0][1] = vAxis.y;
+	sFrustum.fPlanes[0][2] = vAxis.z;
+	sFrustum.fPlanes[0][3] = -vAxis.DotProduct(vNear);
+	sFrustum.fPlanes[1][0] = -vAxis.x;
+	sFrustum.fPlanes[1][1] = -vAxis.y;
+	sFrustum.fPlanes[1][2] = -vAxis.z;
+	sFrustum.fPlanes[1][3] = vAxis.DotProduct(vFar);
+
+	// Side planes through the eye and the edges of the far rectangle, the far vertices are sorted by their angle around the axis
+	const Vector3 vU = vVertices[4] - vFar;
+	const Vector3 vV = vAxis.CrossProduct(vU);
+	float fAngles[4];
+	for (uint32 i=0; i<4; i++) {
+		const Vector3 vVertex = vVertices[4 + i];
+		const Vector3 vOffset = vVertex - vFar;
+		const float	  fAngle  = atan2f(vOffset.DotProduct(vV), vOffset.DotProduct(vU));
+		uint32 j = i;
+		for (; j>0 && fAngles[j - 1] > fAngle; j--) {
+			vVertices[4 + j] = vVertices[4 + j - 1];
+			fAngles[j]		 = fAngles[j - 1];
+		}
+		vVertices[4 + j] = vVertex;
+		fAngles[j]		 = fAngle;
+	}
+	const Vector3 vInside = (vNear + vFar)*0.5f;
+	for (uint32 i=0; i<4; i++) {
+		AddPlane(sFrustum, vEye, vVertices[4 + i], vVertices[4 + (i + 1)%4], vInside);
+		pvFarVertices[i] = vVertices[4 + i];
+	}
+
+	// Done
+	return true;
+}
+
+/**
+*  @brief
+*    Returns the index of the cell the camera is in
+*/
+int SceneCuller::GetCameraCell(SceneNode &cCamera) const
+{
+	// Is the camera within one of the cells? The cell system moves scene nodes into the cell they are in...
+	for (const SceneContainer *pContainer=cCamera.GetContainer(); pContainer; pContainer=pContainer->GetContainer()) {
+		for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+			if (m_lstCells[i]->bCell && m_lstCells[i]->pContainer == pContainer)
+				return i;
+		}
+	}
+
+	// ... if not, check the camera position against the bounding boxes of the cells
+	for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+		const SCell &sCell = *m_lstCells[i];
+		SceneContainer *pCellParent = sCell.pContainer->GetContainer();
+		Matrix3x4 mTransform;
+		if (sCell.bCell && pCellParent && cCamera.GetTransformMatrixTo(*pCellParent, mTransform)) {
+			const Vector3 vPosition = mTransform*Vector3::Zero;
+			const AABoundingBox &cBox = sCell.pContainer->GetContainerAABoundingBox();
+			if (vPosition.x >= cBox.vMin.x && vPosition.y >= cBox.vMin.y && vPosition.z >= cBox.vMin.z &&
+				vPosition.x <= cBox.vMax.x && vPosition.y <= cBox.vMax.y && vPosition.z <= cBox.vMax.z)
+				return i;
+		}
+	}
+
+	// The camera is in none of the cells
+	return -1;
+}
+
+/**
+*  @brief
+*    Narrows a frustum through a portal
+*/
+bool SceneCuller::NarrowFrustum(const SFrustum &sFrustum, const Vector3 &vEye, const SPortal &sPortal, SFrustum &sNarrowed) const
+{
+	// If the eye is (almost) within the portal plane, the portal can't narrow the frustum
+	const float fEyeDistance = sPortal.vNormal.DotProduct(vEye) + sPortal.fDistance;
+	if (fEyeDistance > -PortalEpsilon && fEyeDistance < PortalEpsilon) {
+		sNarrowed = sFrustum;
+		return true;
+	}
+
+	// Clip the portal polygon against the frustum (Sutherland-Hodgman), each plane adds one vertex at most
+	Vector3 vPolygons[2][MaxNumOfPortalVertices + MaxNumOfPlanes];
+	uint32 nNumOfVertices = sPortal.lstVertices.GetNumOfElements();
+	for (uint32 i=0; i<nNumOfVertices; i++)
+		vPolygons[0][i] = sPortal.lstVertices[i];
+	uint32 nPolygon = 0;
+	for (uint32 nPlane=0; nPlane<sFrustum.nNumOfPlanes; nPlane++) {
+		const float *pfPlane = sFrustum.fPlanes[nPlane];
+		const Vector3 *pvIn  = vPolygons[nPolygon];
+		Vector3		  *pvOut = vPolygons[1 - nPolygon];
+		uint32 nNumOfOutVertices = 0;
+		for (uint32 i=0; i<nNumOfVertices; i++) {
+			const Vector3 &vA = pvIn[i];
+			const Vector3 &vB = pvIn[(i + 1)%nNumOfVertices];
+			const float fA = pfPlane[0]*vA.x + pfPlane[1]*vA.y + pfPlane[2]*vA.z + pfPlane[3];
+			const float fB = pfPlane[0]*vB.x + pfPlane[1]*vB.y + pfPlane[2]*vB.z + pfPlane[3];
+			if (fA >= 0.0f)
+				pvOut[nNumOfOutVertices++] = vA;
+			if ((fA >= 0.0f) != (fB >= 0.0f))
+				pvOut[nNumOfOutVertices++] = vA + (vB - vA)*(fA/(fA - fB));
+		}
+		nNumOfVertices = nNumOfOutVertices;
+		nPolygon	   = 1 - nPolygon;
+
+		// Is the portal completely outside of the frustum?
+		if (nNumOfVertices < 3)
+			return false;
+	}
+	const Vector3 *pvPolygon = vPolygons[nPolygon];
+
+	// Too many planes? Then just use the frustum the portal is seen through.
+	if (nNumOfVertices + 2 > MaxNumOfPlanes) {
+		sNarrowed = sFrustum;
+		return true;
+	}
+
+	// The portal plane, everything on the side of the eye is culled
+	const float fSign = (fEyeDistance > 0.0f) ? -1.0f : 1.0f;
+	sNarrowed.nNumOfPlanes = 1;
+	sNarrowed.fPlanes[0][0] = sPortal.vNormal.x*fSign;
+	sNarrowed.fPlanes[0][1] = sPortal.vNormal.y*fSign;
+	sNarrowed.fPlanes[0][2] = sPortal.vNormal.z*fSign;
+	sNarrowed.fPlanes[0][3] = sPortal.fDistance*fSign;
+
+	// The far plane of the camera, if there's one
+	if (m_sCameraFrustum.nNumOfPlanes > 1) {
+		for (uint32 i=0; i<4; i++)
+			sNarrowed.fPlanes[1][i] = m_sCameraFrustum.fPlanes[1][i];
+		sNarrowed.nNumOfPlanes = 2;
+	}
+
+	// Planes through the eye and the edges of the clipped portal polygon
+	Vector3 vCenter = pvPolygon[0];
+	for (uint32 i=1; i<nNumOfVertices; i++)
+		vCenter += pvPolygon[i];
+	vCenter = vCenter*(1.0f/nNumOfVertices);
+	for (uint32 i=0; i<nNumOfVertices; i++)
+		AddPlane(sNarrowed, vEye, pvPolygon[i], pvPolygon[(i + 1)%nNumOfVertices], vCenter);
+
+	// Done
+	return true;
+}
+
+/**
+*  @brief
+*    Culls a cell and the cells behind its portals
+*/
+void SceneCuller::CullCell(uint32 nCell, const SFrustum &sFrustum, const Vector3 &vEye, uint32 nDepth)
+{
+	SCell &sCell = *m_lstCells[nCell];
+	sCell.nVisitedFrame = m_nFrame;
+	m_sStatistics.nNumOfVisitedCells++;
+	if (sCell.lstNodes.GetNumOfElements())
+		CullNode(sCell, 0, sFrustum);
+
+	// Cull the cells behind the portals, but don't go back into a cell on the current path
+	if (nDepth < MaxPortalDepth) {
+		sCell.bOnPath = true;
+		for (uint32 i=0; i<sCell.lstPortals.GetNumOfElements(); i++) {
+			const SPortal &sPortal = *sCell.lstPortals[i];
+			const SCell &sTargetCell = *m_lstCells[sPortal.nTargetCell];
+			if (!sTargetCell.bOnPath) {
+				// Cells outside of the potentially visible set of the camera cell are rejected without clipping the portal
+				SFrustum sNarrowed;
+				if (m_nCameraPVSCell >= 0 && sTargetCell.nPVSCell >= 0 && !m_cCellPVS.IsVisible(m_nCameraPVSCell, sTargetCell.nPVSCell))
+					m_sStatistics.nNumOfRejectedCells++;
+				else if (NarrowFrustum(sFrustum, vEye, sPortal, sNarrowed))
+					CullCell(sPortal.nTargetCell, sNarrowed, vEye, nDepth + 1);
+			}
+		}
+		sCell.bOnPath = false;
+	}
+}
+
+/**
+*  @brief
+*    Culls the children of a node
+*/
+void SceneCuller::CullNode(SCell &sCell, uint32 nNode, const SFrustum &sFrustum)
+{
+	m_sStatistics.nNumOfVisitedNodes++;
+	const SNode &sNode = sCell.lstNodes[nNode];
+	uint32 nOutside, nInside;
+	TestFrustum(sNode, sFrustum, nOutside, nInside);
+	for (uint32 nLane=0; nLane<4; nLane++) {
+		const int nChild = sNode.nChild[nLane];
+		if (nChild != EmptyLane && !(nOutside & (1 << nLane))) {
+			if (nChild < 0)
+				sCell.lstMeshes[~nChild]->nVisibleFrame = m_nFrame;
+			else if (nInside & (1 << nLane))
+				MarkNode(sCell, nChild);
+			else
+				CullNode(sCell, nChild, sFrustum);
+		}
+	}
+}
+
+/**
+*  @brief
+*    Marks all meshes below a node as visible
+*/
+void SceneCuller::MarkNode(SCell &sCell, uint32 nNode)
+{
+	m_sStatistics.nNumOfVisitedNodes++;
+	const SNode &sNode = sCell.lstNodes[nNode];
+	for (uint32 nLane=0; nLane<4; nLane++) {
+		const int nChild = sNode.nChild[nLane];
+		if (nChild != EmptyLane) {
+			if (nChild < 0)
+				sCell.lstMeshes[~nChild]->nVisibleFrame = m_nFrame;
+			else
+				MarkNode(sCell, nChild);
+		}
+	}
+}
+
+/**
+*  @brief
+*    Collects the shadow casting meshes below a node which intersect a sphere
+*/
+void SceneCuller::CollectShadowCasters(SCell &sCell, uint32 nNode, const Vector3 &vCenter, float fRadius, Array<SMesh*> &lstShadowCasters) const
+{
+	const SNode &sNode = sCell.lstNodes[nNode];
+	const uint32 nIntersected = TestSphere(sNode, vCenter, fRadius);
+	for (uint32 nLane=0; nLane<4; nLane++) {
+		const int nChild = sNode.nChild[nLane];
+		if (nChild != EmptyLane && (nIntersected & (1 << nLane))) {
+			if (nChild < 0) {
+				SMesh *pMesh = sCell.lstMeshes[~nChild];
+				if (pMesh->bCastShadow)
+					lstShadowCasters.Add(pMesh);
+			} else {
+				CollectShadowCasters(sCell, nChild, vCenter, fRadius, lstShadowCasters);
+			}
+		}
+	}
+}
+
+/**
+*  @brief
+*    Updates the position and the range of a light and collects its shadow casters again, if required
+*/
+bool SceneCuller::UpdateLight(SLight &sLight)
+{
+	SNPointLight *pLight = static_cast<SNPointLight*>(sLight.cSceneNode.GetElement());
+	Matrix3x4 mTransform;
+	if (!pLight || !pLight->GetTransformMatrixTo(*m_pSceneContainer, mTransform))
+		return false; // Error!
+
+	// Static lights keep their shadow casters until a cell is built again, moving lights collect them again each frame
+	const Vector3 vCenter = mTransform*Vector3::Zero;
+	const float	  fRadius = pLight->GetRange();
+	if (sLight.nMeshGeneration != m_nMeshGeneration || sLight.vCenter != vCenter || sLight.fRadius != fRadius) {
+		sLight.nMeshGeneration = m_nMeshGeneration;
+		sLight.vCenter		   = vCenter;
+		sLight.fRadius		   = fRadius;
+		sLight.lstShadowCasters.Reset();
+		for (uint32 i=0; i<m_lstCells.GetNumOfElements(); i++) {
+			if (m_lstCells[i]->lstNodes.GetNumOfElements())
+				CollectShadowCasters(*m_lstCells[i], 0, vCenter, fRadius, sLight.lstShadowCasters);
+		}
+	}
+
+	// Done
+	return true;
+}
+
+/**
+*  @brief
+*    Applies the visibility of the current frame to the meshes
+*/
+void SceneCuller::Apply(bool bCull)
+{
+	for (uint32 nCell=0; nCell<m_lstCells.GetNumOfElements(); nCell++) {
+		SCell &sCell = *m_lstCells[nCell];
+		for (uint32 i=0; i<sCell.lstMeshes.GetNumOfElements(); i++) {
+			SMesh &sMesh = *sCell.lstMeshes[i];
+			SceneNode *pSceneNode = sMesh.cSceneNode.GetElement();
+			if (pSceneNode) {
+				// Only touch the scene node if its visibility changes
+				const bool bVisible = !bCull || sMesh.nVisibleFrame == m_nFrame;
+				if (bVisible == sMesh.bCulled) {
+					pSceneNode->SetVisible(bVisible);
+					sMesh.bCulled = !bVisible;
+				}
+				if (bVisible)
+					m_sStatistics.nNumOfDrawnMeshes++;
+				else
+					m_sStatistics.nNumOfCulledMeshes++;
+			} else {
+				// The mesh was destroyed, build the cell again within the next frame
+				sCell.bDirty = true;
+			}
+		}
+	}
+}
+
+/**
+*  @brief
+*    Hides the meshes within the view which are behind the nearest occluders
+*/
+void SceneCuller::CullOccluded(const Vector3 &vEye, const Vector3 *pvFarVertices, float fNearDistance)
+{
+	ProfilerScope cProfilerScope("Occlusion culling");
+
+	// Gather the meshes within the view, sorted by the distance of their bounding boxes to the eye
+	m_lstOccludees.Reset();
+	for (uint32 nCell=0; nCell<m_lstCells.GetNumOfElements(); nCell++) {
+		SCell &sCell = *m_lstCells[nCell];
+		for (uint32 i=0; i<sCell.lstMeshes.GetNumOfElements(); i++) {
+			SMesh &sMesh = *sCell.lstMeshes[i];
+			if (sMesh.nVisibleFrame == m_nFrame) {
+				const float fDX = (vEye.x < sMesh.vMin.x) ? sMesh.vMin.x - vEye.x : ((vEye.x > sMesh.vMax.x) ? vEye.x - sMesh.vMax.x : 0.0f);
+				const float fDY = (vEye.y < sMesh.vMin.y) ? sMesh.vMin.y - vEye.y : ((vEye.y > sMesh.vMax.y) ? vEye.y - sMesh.vMax.y : 0.0f);
+				const float fDZ = (vEye.z < sMesh.vMin.z) ? sMesh.vMin.z - vEye.z : ((vEye.z > sMesh.vMax.z) ? vEye.z - sMesh.vMax.z : 0.0f);
+				SOccludee sOccludee;
+				sOccludee.pMesh		= &sMesh;
+				sOccludee.fDistance = fDX*fDX + fDY*fDY + fDZ*fDZ;
+				sOccludee.bVisible	= true;
+				m_lstOccludees.Add(sOccludee);
+			}
+		}
+	}
+	const uint32 nNumOfOccludees = m_lstOccludees.GetNumOfElements();
+	if (!nNumOfOccludees)
+		return;
+	qsort(m_lstOccludees.GetData(), nNumOfOccludees, sizeof(SOccludee), CompareOccludees);
+
+	// Draw the nearest occluders until the triangle budget is used up
+	m_pOcclusionBuffer->Clear(vEye, pvFarVertices, fNearDistance);
+	for (uint32 i=0; i<nNumOfOccludees; i++) {
+		const Array<Vector3> &lstTriangles = m_lstOccludees[i].pMesh->lstOccluderTriangles;
+		const uint32 nNumOfTriangles = lstTriangles.GetNumOfElements()/3;
+		if (nNumOfTriangles && m_sStatistics.nNumOfOccluderTriangles + nNumOfTriangles <= MaxNumOfOccluderTriangles) {
+			m_pOcclusionBuffer->DrawTriangles(lstTriangles.GetData(), nNumOfTriangles);
+			m_sStatistics.nNumOfOccluderTriangles += nNumOfTriangles;
+		}
+	}
+
+	// The main thread and the worker threads test the bounding boxes range by range - the jobs are urgent because the
+	// frame waits for them, but other users of the worker pool may block the worker threads with file I/O, so the main
+	// thread tests all ranges no worker thread has taken. Jobs still queued from previous frames help as well.
+	m_pOcclusionTestRanges->Start(nNumOfOccludees);
+	uint32 nNumOfJobs = (nNumOfOccludees - 1)/NumOfOccludeesPerJob;
+	if (nNumOfJobs > m_pWorkerPool->GetNumOfThreads())
+		nNumOfJobs = m_pWorkerPool->GetNumOfThreads();
+	for (uint32 nNumOfQueuedJobs=m_pOcclusionTestRanges->GetNumOfQueuedJobs(); nNumOfQueuedJobs<nNumOfJobs; nNumOfQueuedJobs++)
+		m_pWorkerPool->AddJob(*new OcclusionTestJob(*m_pOcclusionTestRanges), true);
+	m_pOcclusionTestRanges->Test();
+
+	// Wait for the ranges the worker threads are testing right now
+	m_pOcclusionTestRanges->Wait();
+
+	// Hidden meshes are no longer marked as visible within the current frame
+	for (uint32 i=0; i<nNumOfOccludees; i++) {
+		const SOccludee &sOccludee = m_lstOccludees[i];
+		if (!sOccludee.bVisible) {
+			sOccludee.pMesh->nVisibleFrame = m_nFrame - 1;
+			m_sStatistics.nNumOfOccludedMeshes++;
+		}
+	}
+}
+
+/**
+*  @brief
+*    Tests the bounding boxes of meshes within the view against the occlusion buffer, called by worker threads as well
+*/
+void SceneCuller::TestOccludees(uint32 nFirst, uint32 nNumOfOccludees)
+{
+	for (uint32 i=nFirst; i<nFirst+nNumOfOccludees; i++) {
+		SOccludee &sOccludee = m_lstOccludees[i];
+		sOccludee.bVisible = m_pOcclusionBuffer->IsVisible(sOccludee.pMesh->vMin, sOccludee.pMesh->vMax);
+	}
+}
@@ -0,0 +1,645 @@
+/*********************************************************\
+ *  File: SceneCuller.h                                  *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_SCENECULLER_H__
+#define __DUNGEON_SCENECULLER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Container/Array.h>
+#include <PLMath/Vector3.h>
+#include <PLScene/Scene/SceneNodeHandler.h>
+#include "Scene/CellPVS.h"
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+class WorkerPool;
+class OcclusionBuffer;
+class OcclusionTestRanges;
+namespace PLMath {
+	class Rectangle;
+	class AABoundingBox;
+}
+namespace PLScene {
+	class SNCamera;
+	class SceneNode;
+	class SceneContainer;
+}
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Hierarchical frustum and portal culling of the static meshes of a scene
+*
+*  @remarks
+*    The static meshes (no modifiers except physics bodies without mass) of each "PLScene::SCCell" container and of
+*    each container outside of the cells are put into a bounding volume hierarchy with four children per node. The
+*    bounding boxes of the children are stored as structure of arrays, so one node is tested against a frustum plane
+*    with a single SSE operation. Subtrees completely within the frustum are accepted without further tests.
+*
+*    The cell the camera is in is culled against the camera frustum. Each portal ("PLScene::SNCellPortal") of the cell
+*    is clipped against the frustum, the frustum through the remaining portal polygon is used for the target cell and
+*    so on. If the camera is within none of the cells, all cells are culled against the camera frustum. Containers
+*    outside of the cells are always culled against the camera frustum. If there's an up-to-date potentially visible
+*    set of the scene (see "CellPVS"), cells outside of the set of the camera cell are rejected before their portal
+*    is clipped.
+*
+*    Optionally, the meshes left within the view are tested against a low resolution depth buffer (see
+*    "OcclusionBuffer"). The occluders are the big static meshes with opaque one sided materials, the coarsest level of
+*    detail of each is the simplified occluder mesh. The nearest occluders within the view are drawn by the main
+*    thread until "MaxNumOfOccluderTriangles" is reached, then the bounding boxes are tested by worker threads.
+*
+*    Culled meshes are made invisible, so the renderer doesn't have to look at them at all. As the shadow maps are
+*    rendered from the light positions, shadow casting meshes within the range of a shadow casting light which
+*    intersects the camera frustum stay visible. The shadow casters within the range of each light are collected once
+*    and cached, the list is only collected again when the light moves, its range changes or a cell is built again.
+*    Meshes with modifiers (moved by physics, animated...) and everything else are left to the renderer.
+*
+*    Scene nodes created or destroyed within a container (cell streaming, the cell system moving nodes between cells)
+*    cause the bounding volume hierarchy of the container to be built again.
+*
+*  @note
+*    - The visibility of the managed meshes belongs to the culler, when it's destroyed they are made visible again
+*/
+class SceneCuller {
+
+
+	//[-------------------------------------------------------]
+	//[ Friends                                               ]
+	//[-------------------------------------------------------]
+	friend class OcclusionTestRanges;
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 MaxNumOfPlanes			  = 16;		/**< Maximum number of frustum planes, a portal frustum with more planes isn't narrowed */
+		static const PLCore::uint32 MaxPortalDepth			  = 8;		/**< Maximum number of portals passed through from the camera cell */
+		static const PLCore::uint32 MaxNumOfOccluderTriangles = 4096;	/**< Maximum number of occluder triangles drawn per frame */
+
+		/**
+		*  @brief
+		*    Culling statistics of a frame
+		*/
+		struct SStatistics {
+			PLCore::uint32 nNumOfVisitedCells;		/**< Number of culled cells and containers, a cell seen through several portals is counted several times */
+			PLCore::uint32 nNumOfVisitedNodes;		/**< Number of visited bounding volume hierarchy nodes */
+			PLCore::uint32 nNumOfRejectedCells;		/**< Number of cells behind portals rejected by the potentially visible set */
+			PLCore::uint32 nNumOfCulledMeshes;		/**< Number of meshes made invisible */
+			PLCore::uint32 nNumOfDrawnMeshes;		/**< Number of meshes left visible for the renderer */
+			PLCore::uint32 nNumOfShadowCasters;		/**< Number of the drawn meshes which are outside of the view but may cast shadows into it */
+			PLCore::uint32 nNumOfOccludedMeshes;	/**< Number of meshes within the view hidden by occluders, hidden shadow casters are drawn nevertheless */
+			PLCore::uint32 nNumOfOccluderTriangles;	/**< Number of drawn occluder triangles */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public static functions                               ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Returns whether or not a scene node is a static mesh
+		*
+		*  @param[in] cSceneNode
+		*    Scene node to check
+		*
+		*  @return
+		*    'true' if the scene node is a visible mesh without modifiers except physics bodies without mass, else 'false'
+		*/
+		static bool IsStaticMesh(PLScene::SceneNode &cSceneNode);
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cSceneContainer
+		*    Scene container the scene was loaded into, must stay valid as long as the culler exists
+		*  @param[in] sSceneFilename
+		*    Filename of the XML scene, if not empty its potentially visible set is used when it's up-to-date
+		*  @param[in] pWorkerPool
+		*    Worker pool testing the meshes against the occlusion buffer, a null pointer to disable occlusion culling, must
+		*    stay valid as long as the culler exists. Occlusion culling hides the meshes behind occluders as well and reads
+		*    the geometry of the occluder meshes.
+		*/
+		SceneCuller(PLScene::SceneContainer &cSceneContainer, const PLCore::String &sSceneFilename = "", WorkerPool *pWorkerPool = nullptr);
+
+		/**
+		*  @brief
+		*    Destructor, makes the culled meshes visible again
+		*/
+		~SceneCuller();
+
+		/**
+		*  @brief
+		*    Returns the number of managed meshes
+		*
+		*  @return
+		*    The number of managed meshes, 0 if the scene has no static meshes (the culler has nothing to do)
+		*/
+		PLCore::uint32 GetNumOfMeshes() const;
+
+		/**
+		*  @brief
+		*    Culls the meshes, call this once per frame right before drawing
+		*
+		*  @param[in] pCamera
+		*    The current camera, can be a null pointer (all meshes are made visible)
+		*  @param[in] cViewport
+		*    Viewport the camera is rendered into
+		*/
+		void Update(PLScene::SNCamera *pCamera, const PLMath::Rectangle &cViewport);
+
+		/**
+		*  @brief
+		*    Returns the culling statistics of the last frame
+		*
+		*  @return
+		*    The culling statistics of the last frame
+		*/
+		const SStatistics &GetStatistics() const;
+
+		/**
+		*  @brief
+		*    Returns the cells visible through the portals from a position into any direction, used to bake the potentially visible set
+		*
+		*  @param[in]  cCell
+		*    Cell the position is in
+		*  @param[in]  vPosition
+		*    Position within scene container space
+		*  @param[out] lstCells
+		*    Receives the visible cells including the given cell, empty if the given container is no cell of the scene
+		*
+		*  @note
+		*    - The visibility of the meshes is not touched
+		*/
+		void GetVisibleCells(const PLScene::SceneContainer &cCell, const PLMath::Vector3 &vPosition, PLCore::Array<PLScene::SceneContainer*> &lstCells);
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		static const int EmptyLane = 0x7fffffff;	/**< Child of an unused lane of a node */
+
+		/**
+		*  @brief
+		*    Frustum, a point is inside if "a*x + b*y + c*z + d >= 0" for all planes
+		*/
+		struct SFrustum {
+			PLCore::uint32 nNumOfPlanes;				/**< Number of planes */
+			float		   fPlanes[MaxNumOfPlanes][4];	/**< Planes (a, b, c, d), the normals point inside */
+		};
+
+		/**
+		*  @brief
+		*    Bounding volume hierarchy node with four children, the bounding boxes are stored as structure of arrays
+		*/
+		struct SNode {
+			float fMinX[4];		/**< Per lane: minimum x of the bounding box of the child */
+			float fMinY[4];		/**< Per lane: minimum y of the bounding box of the child */
+			float fMinZ[4];		/**< Per lane: minimum z of the bounding box of the child */
+			float fMaxX[4];		/**< Per lane: maximum x of the bounding box of the child */
+			float fMaxY[4];		/**< Per lane: maximum y of the bounding box of the child */
+			float fMaxZ[4];		/**< Per lane: maximum z of the bounding box of the child */
+			int	  nChild[4];	/**< Per lane: index of a node if >= 0, "~<mesh index>" if < 0, "EmptyLane" if unused */
+
+			bool operator ==(const SNode &sNode) const
+			{
+				// Nodes are identified by their children
+				return (nChild[0] == sNode.nChild[0] && nChild[1] == sNode.nChild[1] && nChild[2] == sNode.nChild[2] && nChild[3] == sNode.nChild[3]);
+			}
+		};
+
+		/**
+		*  @brief
+		*    Managed mesh
+		*/
+		struct SMesh {
+			PLScene::SceneNodeHandler	   cSceneNode;				/**< Mesh scene node, no element if it was destroyed */
+			bool						   bCastShadow;				/**< Does the mesh cast shadows? */
+			bool						   bCulled;					/**< Is the mesh currently made invisible? */
+			PLCore::uint32				   nVisibleFrame;			/**< Frame the mesh was found to be visible the last time */
+			PLMath::Vector3				   vMin;					/**< Minimum of the bounding box within scene container space */
+			PLMath::Vector3				   vMax;					/**< Maximum of the bounding box within scene container space */
+			PLCore::Array<PLMath::Vector3> lstOccluderTriangles;	/**< Occluder triangle list within scene container space, empty if the mesh is no occluder */
+		};
+
+		/**
+		*  @brief
+		*    Cell portal
+		*/
+		struct SPortal {
+			PLCore::uint32					 nTargetCell;	/**< Index of the cell the portal leads to */
+			PLCore::Array<PLMath::Vector3>	 lstVertices;	/**< Portal polygon within scene container space */
+			PLMath::Vector3					 vNormal;		/**< Normal of the portal plane */
+			float							 fDistance;		/**< Distance of the portal plane ("normal*point + distance = 0") */
+		};
+
+		/**
+		*  @brief
+		*    Shadow casting point or spot light
+		*/
+		struct SLight {
+			PLScene::SceneNodeHandler cSceneNode;			/**< Light scene node, no element if it was destroyed */
+			PLCore::uint32			  nMeshGeneration;		/**< Mesh generation the shadow casters were collected for, 0 if they were never collected */
+			PLMath::Vector3			  vCenter;				/**< Light position within scene container space the shadow casters were collected for */
+			float					  fRadius;				/**< Light range the shadow casters were collected for */
+			PLCore::Array<SMesh*>	  lstShadowCasters;		/**< Shadow casting meshes of all cells within the light range */
+		};
+
+		/**
+		*  @brief
+		*    Cell or container outside of the cells
+		*/
+		struct SCell {
+			PLScene::SceneContainer						*pContainer;		/**< Container, always valid */
+			bool										 bCell;				/**< Is the container a "PLScene::SCCell"? */
+			bool										 bOnPath;			/**< Is the cell on the current portal path? */
+			bool										 bDirty;			/**< Has the bounding volume hierarchy to be built again? */
+			int											 nPVSCell;			/**< Index of the cell within the potentially visible set, <0 if the set doesn't know the cell */
+			PLCore::uint32								 nVisitedFrame;		/**< Frame the cell was visited the last time */
+			PLCore::uint32								 nNumOfElements;	/**< Number of scene nodes within the container when the bounding volume hierarchy was built */
+			PLCore::Array<SMesh*>						 lstMeshes;			/**< Managed meshes */
+			PLCore::Array<SNode>						 lstNodes;			/**< Bounding volume hierarchy within scene container space, the first node is the root, empty if there are no meshes */
+			PLCore::Array<SPortal*>						 lstPortals;		/**< Portals leading to other cells */
+			PLCore::Array<SLight*>						 lstLights;			/**< Shadow casting point and spot lights */
+		};
+
+		/**
+		*  @brief
+		*    Mesh while building a bounding volume hierarchy
+		*/
+		struct SItem {
+			PLCore::uint32	nMesh;		/**< Index of the mesh within the cell */
+			PLMath::Vector3	vMin;		/**< Minimum of the bounding box within scene container space */
+			PLMath::Vector3	vMax;		/**< Maximum of the bounding box within scene container space */
+			PLMath::Vector3	vCenter;	/**< Center of the bounding box */
+		};
+
+		/**
+		*  @brief
+		*    Mesh within the view while occlusion culling
+		*/
+		struct SOccludee {
+			SMesh *pMesh;		/**< Mesh, always valid */
+			float  fDistance;	/**< Squared distance of the bounding box to the eye */
+			bool   bVisible;	/**< Is the bounding box visible? Written by the occlusion test. */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private static functions                              ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Adds a plane through the eye and an edge to a frustum
+		*
+		*  @param[in, out] sFrustum
+		*    Frustum to add the plane to, must have less than "MaxNumOfPlanes" planes
+		*  @param[in]      vEye
+		*    Eye position
+		*  @param[in]      vA
+		*    First edge vertex
+		*  @param[in]      vB
+		*    Second edge vertex
+		*  @param[in]      vInside
+		*    A point which has to be inside of the plane
+		*/
+		static void AddPlane(SFrustum &sFrustum, const PLMath::Vector3 &vEye, const PLMath::Vector3 &vA, const PLMath::Vector3 &vB, const PLMath::Vector3 &vInside);
+
+		/**
+		*  @brief
+		*    Tests the four children of a node against a frustum
+		*
+		*  @param[in]  sNode
+		*    Node to test
+		*  @param[in]  sFrustum
+		*    Frustum to test against
+		*  @param[out] nOutside
+		*    Receives a bit per lane which is set if the child is completely outside of the frustum
+		*  @param[out] nInside
+		*    Receives a bit per lane which is set if the child is completely inside of the frustum
+		*/
+		static void TestFrustum(const SNode &sNode, const SFrustum &sFrustum, PLCore::uint32 &nOutside, PLCore::uint32 &nInside);
+
+		/**
+		*  @brief
+		*    Tests the four children of a node against a sphere
+		*
+		*  @param[in] sNode
+		*    Node to test
+		*  @param[in] vCenter
+		*    Sphere center
+		*  @param[in] fRadius
+		*    Sphere radius
+		*
+		*  @return
+		*    A bit per lane which is set if the child intersects the sphere
+		*/
+		static PLCore::uint32 TestSphere(const SNode &sNode, const PLMath::Vector3 &vCenter, float fRadius);
+
+		/**
+		*  @brief
+		*    Compares two meshes within the view by their distance to the eye, used for sorting
+		*
+		*  @param[in] pA
+		*    First mesh, "SOccludee"
+		*  @param[in] pB
+		*    Second mesh, "SOccludee"
+		*
+		*  @return
+		*    <0 if the first mesh is nearer, >0 if the second mesh is nearer, else 0
+		*/
+		static int CompareOccludees(const void *pA, const void *pB);
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		SceneCuller(const SceneCuller &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		SceneCuller &operator =(const SceneCuller &cSource);
+
+		/**
+		*  @brief
+		*    Collects the cells and the containers outside of the cells
+		*
+		*  @param[in] cContainer
+		*    Container to collect, its children are collected as well unless it's a cell
+		*/
+		void CollectCells(PLScene::SceneContainer &cContainer);
+
+		/**
+		*  @brief
+		*    Builds the meshes, the bounding volume hierarchy, the portals and the lights of a cell
+		*
+		*  @param[in, out] sCell
+		*    Cell to build
+		*/
+		void BuildCell(SCell &sCell);
+
+		/**
+		*  @brief
+		*    Builds a bounding volume hierarchy node
+		*
+		*  @param[in, out] sCell
+		*    Cell to add the node to
+		*  @param[in, out] pItems
+		*    Meshes to put below the node, reordered
+		*  @param[in]      nNumOfItems
+		*    Number of meshes, must be at least 1
+		*
+		*  @return
+		*    Index of the node
+		*/
+		PLCore::uint32 BuildNode(SCell &sCell, SItem *pItems, PLCore::uint32 nNumOfItems);
+
+		/**
+		*  @brief
+		*    Makes the culled meshes of a cell visible again and destroys its meshes, nodes, portals and lights
+		*
+		*  @param[in, out] sCell
+		*    Cell to clear
+		*/
+		void ClearCell(SCell &sCell);
+
+		/**
+		*  @brief
+		*    Reads the occluder triangles of a static mesh, if it's a suitable occluder
+		*
+		*  @param[in]  cSceneNode
+		*    Static mesh scene node
+		*  @param[out] sMesh
+		*    Managed mesh receiving the occluder triangles, its bounding box must be set
+		*/
+		void BuildOccluder(PLScene::SceneNode &cSceneNode, SMesh &sMesh) const;
+
+		/**
+		*  @brief
+		*    Returns the camera frustum within scene container space
+		*
+		*  @param[in]  cCamera
+		*    Camera
+		*  @param[in]  cViewport
+		*    Viewport the camera is rendered into
+		*  @param[out] vEye
+		*    Receives the camera position within scene container space
+		*  @param[out] sFrustum
+		*    Receives the camera frustum within scene container space
+		*  @param[out] pvFarVertices
+		*    Receives the four vertices of the far rectangle within scene container space, sorted around the view axis
+		*  @param[out] fNearDistance
+		*    Receives the distance of the near plane to the eye along the view axis
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*/
+		bool GetCameraFrustum(PLScene::SNCamera &cCamera, const PLMath::Rectangle &cViewport, PLMath::Vector3 &vEye, SFrustum &sFrustum, PLMath::Vector3 *pvFarVertices, float &fNearDistance) const;
+
+		/**
+		*  @brief
+		*    Returns the index of the cell the camera is in
+		*
+		*  @param[in] cCamera
+		*    Camera
+		*
+		*  @return
+		*    The index of the cell the camera is in, <0 if the camera is in none of the cells
+		*/
+		int GetCameraCell(PLScene::SceneNode &cCamera) const;
+
+		/**
+		*  @brief
+		*    Narrows a frustum through a portal
+		*
+		*  @param[in]  sFrustum
+		*    Frustum the portal is seen through
+		*  @param[in]  vEye
+		*    Eye position
+		*  @param[in]  sPortal
+		*    Portal
+		*  @param[out] sNarrowed
+		*    Receives the frustum through the portal
+		*
+		*  @return
+		*    'true' if the portal is visible, else 'false'
+		*/
+		bool NarrowFrustum(const SFrustum &sFrustum, const PLMath::Vector3 &vEye, const SPortal &sPortal, SFrustum &sNarrowed) const;
+
+		/**
+		*  @brief
+		*    Culls a cell and the cells behind its portals
+		*
+		*  @param[in] nCell
+		*    Index of the cell
+		*  @param[in] sFrustum
+		*    Frustum the cell is seen through
+		*  @param[in] vEye
+		*    Eye position
+		*  @param[in] nDepth
+		*    Number of portals passed through so far
+		*/
+		void CullCell(PLCore::uint32 nCell, const SFrustum &sFrustum, const PLMath::Vector3 &vEye, PLCore::uint32 nDepth);
+
+		/**
+		*  @brief
+		*    Culls the children of a node
+		*
+		*  @param[in] sCell
+		*    Cell of the node
+		*  @param[in] nNode
+		*    Index of the node
+		*  @param[in] sFrustum
+		*    Frustum to cull against
+		*/
+		void CullNode(SCell &sCell, PLCore::uint32 nNode, const SFrustum &sFrustum);
+
+		/**
+		*  @brief
+		*    Marks all meshes below a node as visible
+		*
+		*  @param[in] sCell
+		*    Cell of the node
+		*  @param[in] nNode
+		*    Index of the node
+		*/
+		void MarkNode(SCell &sCell, PLCore::uint32 nNode);
+
+		/**
+		*  @brief
+		*    Collects the shadow casting meshes below a node which intersect a sphere
+		*
+		*  @param[in]      sCell
+		*    Cell of the node
+		*  @param[in]      nNode
+		*    Index of the node
+		*  @param[in]      vCenter
+		*    Sphere center
+		*  @param[in]      fRadius
+		*    Sphere radius
+		*  @param[in, out] lstShadowCasters
+		*    Receives the shadow casting meshes
+		*/
+		void CollectShadowCasters(SCell &sCell, PLCore::uint32 nNode, const PLMath::Vector3 &vCenter, float fRadius, PLCore::Array<SMesh*> &lstShadowCasters) const;
+
+		/**
+		*  @brief
+		*    Updates the position and the range of a light and collects its shadow casters again, if required
+		*
+		*  @param[in, out] sLight
+		*    Light to update
+		*
+		*  @return
+		*    'true' if all went fine, 'false' if the light was destroyed or has no transform into scene container space
+		*/
+		bool UpdateLight(SLight &sLight);
+
+		/**
+		*  @brief
+		*    Applies the visibility of the current frame to the meshes
+		*
+		*  @param[in] bCull
+		*    Make the meshes which are not marked as visible invisible? If 'false', all meshes are made visible.
+		*/
+		void Apply(bool bCull);
+
+		/**
+		*  @brief
+		*    Hides the meshes within the view which are behind the nearest occluders
+		*
+		*  @param[in] vEye
+		*    Eye position
+		*  @param[in] pvFarVertices
+		*    The four vertices of the far rectangle, sorted around the view axis
+		*  @param[in] fNearDistance
+		*    Distance of the near plane to the eye along the view axis
+		*/
+		void CullOccluded(const PLMath::Vector3 &vEye, const PLMath::Vector3 *pvFarVertices, float fNearDistance);
+
+		/**
+		*  @brief
+		*    Tests the bounding boxes of meshes within the view against the occlusion buffer, called by worker threads as well
+		*
+		*  @param[in] nFirst
+		*    Index of the first mesh within the view
+		*  @param[in] nNumOfOccludees
+		*    Number of meshes to test
+		*/
+		void TestOccludees(PLCore::uint32 nFirst, PLCore::uint32 nNumOfOccludees);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLScene::SceneContainer *m_pSceneContainer;			/**< Scene container, always valid */
+		PLCore::Array<SCell*>	 m_lstCells;				/**< Cells and containers outside of the cells */
+		PLCore::uint32			 m_nFrame;					/**< Current frame */
+		PLCore::uint32			 m_nMeshGeneration;			/**< Increased each time the meshes of a cell are built, the cached shadow casters are outdated then */
+		SFrustum				 m_sCameraFrustum;			/**< Camera frustum of the current frame, no planes while baking the potentially visible set */
+		SStatistics				 m_sStatistics;				/**< Culling statistics of the last frame */
+		CellPVS					 m_cCellPVS;				/**< Potentially visible set, no cells if there's none */
+		int						 m_nCameraPVSCell;			/**< Index of the camera cell within the potentially visible set, <0 if the set isn't used within the current frame */
+		OcclusionBuffer			*m_pOcclusionBuffer;		/**< Occlusion buffer, a null pointer if occlusion culling is disabled */
+		WorkerPool				*m_pWorkerPool;				/**< Worker threads testing the meshes against the occlusion buffer, a null pointer if occlusion culling is disabled */
+		PLCore::Array<SOccludee> m_lstOccludees;			/**< Meshes within the view of the current frame, nearest first */
+		OcclusionTestRanges		*m_pOcclusionTestRanges;	/**< Ranges of meshes tested against the occlusion buffer, a null pointer if occlusion culling is disabled */
+
+
+};
+
+
+#endif // __DUNGEON_SCENECULLER_H__
@@ -0,0 +1,384 @@
+/*********************************************************\
+ *  File: SceneLoadReport.cpp                            *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/System/Mutex.h>
+#include <PLCore/System/System.h>
+#include <PLCore/Container/Array.h>
+#include "Tools/Profiler.h"
+#include "Scene/SceneLoadReport.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Report entry (a phase, a class or an asset)
+*/
+struct SEntry {
+	String sName;		/**< Phase name, class name or asset filename */
+	uint32 nDepth;		/**< Depth of a phase, 0 for a top level phase */
+	uint32 nCount;		/**< Number of phase calls, scene nodes or modifiers */
+	uint64 nTime;		/**< Time (in microseconds) spent within the phase, to create the instances or to load the asset */
+	uint64 nReadTime;	/**< Time (in microseconds) a worker thread needed to read the asset */
+	uint64 nReadBytes;	/**< Number of read bytes of the asset */
+};
+
+
+//[-------------------------------------------------------]
+//[ Global variables                                      ]
+//[-------------------------------------------------------]
+static Mutex		 g_cMutex;				/**< Mutex protecting the following data */
+static bool			 g_bCollecting = false;	/**< Is the report collected? */
+static String		 g_sFilename;			/**< Filename of the loaded scene */
+static uint64		 g_nStartTime = 0;		/**< Start time of the loading (in microseconds) */
+static uint64		 g_nTotalTime = 0;		/**< Total load time (in microseconds), 0 while loading */
+static uint32		 g_nDepth = 0;			/**< Depth of the current phase */
+static Array<SEntry> g_lstPhases;			/**< Phases, in the order they were entered the first time */
+static Array<SEntry> g_lstSceneNodes;		/**< Scene node classes */
+static Array<SEntry> g_lstModifiers;		/**< Scene node modifier classes */
+static Array<SEntry> g_lstAssets;			/**< Assets */
+
+
+//[-------------------------------------------------------]
+//[ Local functions                                       ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Returns an entry, the entry is added if it doesn't exist yet
+*/
+static SEntry &GetEntry(Array<SEntry> &lstEntries, const String &sName, uint32 nDepth = 0)
+{
+	for (uint32 i=0; i<lstEntries.GetNumOfElements(); i++) {
+		if (lstEntries[i].nDepth == nDepth && lstEntries[i].sName == sName)
+			return lstEntries[i];
+	}
+	SEntry sEntry;
+	sEntry.sName	  = sName;
+	sEntry.nDepth	  = nDepth;
+	sEntry.nCount	  = 0;
+	sEntry.nTime	  = 0;
+	sEntry.nReadTime  = 0;
+	sEntry.nReadBytes = 0;
+	lstEntries.Add(sEntry);
+	return lstEntries[lstEntries.GetNumOfElements() - 1];
+}
+
+/**
+*  @brief
+*    Returns the entry indices sorted by the time spent on the entries, the slowest entry first
+*/
+static void GetSortedIndices(const Array<SEntry> &lstEntries, Array<uint32> &lstIndices)
+{
+	// Insertion sort, there are some hundred entries at most
+	lstIndices.Resize(lstEntries.GetNumOfElements());
+	for (uint32 i=0; i<lstEntries.GetNumOfElements(); i++) {
+		const uint64 nTime = lstEntries[i].nTime + lstEntries[i].nReadTime;
+		uint32 nIndex = i;
+		for (; nIndex>0 && lstEntries[lstIndices[nIndex - 1]].nTime + lstEntries[lstIndices[nIndex - 1]].nReadTime < nTime; nIndex--)
+			lstIndices[nIndex] = lstIndices[nIndex - 1];
+		lstIndices[nIndex] = i;
+	}
+}
+
+/**
+*  @brief
+*    Writes the scene node or modifier classes into the log
+*/
+static void LogClasses(const Array<SEntry> &lstClasses)
+{
+	Array<uint32> lstIndices;
+	GetSortedIndices(lstClasses, lstIndices);
+	for (uint32 i=0; i<lstIndices.GetNumOfElements(); i++) {
+		const SEntry &sEntry = lstClasses[lstIndices[i]];
+		PL_LOG(Info, String::Format("  %-44s %10.1f ms %6u x %8.3f ms", sEntry.sName.GetASCII(), sEntry.nTime/1000.0, sEntry.nCount,
+									sEntry.nTime/1000.0/sEntry.nCount))
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Starts collecting the report of a scene, the previous report is removed
+*/
+void SceneLoadReport::Begin(const String &sFilename)
+{
+	g_cMutex.Lock();
+	g_bCollecting = true;
+	g_sFilename	  = sFilename;
+	g_nStartTime  = System::GetInstance()->GetMicroseconds();
+	g_nTotalTime  = 0;
+	g_nDepth	  = 0;
+	g_lstPhases.Clear();
+	g_lstSceneNodes.Clear();
+	g_lstModifiers.Clear();
+	g_lstAssets.Clear();
+	g_cMutex.Unlock();
+}
+
+/**
+*  @brief
+*    Stops collecting
+*/
+void SceneLoadReport::End()
+{
+	g_cMutex.Lock();
+	if (g_bCollecting) {
+		g_bCollecting = false;
+		g_nTotalTime  = System::GetInstance()->GetMicroseconds() - g_nStartTime;
+	}
+	g_cMutex.Unlock();
+}
+
+/**
+*  @brief
+*    Returns whether or not the report is collected
+*/
+bool SceneLoadReport::IsCollecting()
+{
+	g_cMutex.Lock();
+	const bool bCollecting = g_bCollecting;
+	g_cMutex.Unlock();
+	return bCollecting;
+}
+
+/**
+*  @brief
+*    Begins a load phase
+*/
+void SceneLoadReport::BeginPhase(const char *pszName)
+{
+	g_cMutex.Lock();
+	if (g_bCollecting) {
+		GetEntry(g_lstPhases, pszName, g_nDepth);
+		g_nDepth++;
+	}
+	g_cMutex.Unlock();
+}
+
+/**
+*  @brief
+*    Ends the current load phase
+*/
+void SceneLoadReport::EndPhase(const char *pszName, uint64 nTime)
+{
+	g_cMutex.Lock();
+	if (g_bCollecting && g_nDepth) {
+		g_nDepth--;
+		SEntry &sEntry = GetEntry(g_lstPhases, pszName, g_nDepth);
+		sEntry.nCount++;
+		sEntry.nTime += nTime;
+	}
+	g_cMutex.Unlock();
+}
+
+/**
+*  @brief
+*    Adds time to a load phase which is a child phase of the current phase
+*/
+void SceneLoadReport::AddPhase(const char *pszName, uint64 nTime)
+{
+	g_cMutex.Lock();
+	if (g_bCollecting) {
+		SEntry &sEntry = GetEntry(g_lstPhases, pszName, g_nDepth);
+		sEntry.nCount++;
+		sEntry.nTime += nTime;
+	}
+	g_cMutex.Unlock();
+}
+
+/**
+*  @brief
+*    Adds a created scene node
+*/
+void SceneLoadReport::AddSceneNode(const String &sClass, uint64 nTime, const String &sAsset)
+{
+	g_cMutex.Lock();
+	if (g_bCollecting) {
+		SEntry &sEntry = GetEntry(g_lstSceneNodes, sClass);
+		sEntry.nCount++;
+		sEntry.nTime += nTime;
+
+		// The asset prefetcher uses slashes only
+		if (sAsset.GetLength()) {
+			String sFilename = sAsset;
+			sFilename.Replace('\\', '/');
+			SEntry &sAssetEntry = GetEntry(g_lstAssets, sFilename);
+			sAssetEntry.nCount++;
+			sAssetEntry.nTime += nTime;
+		}
+	}
+	g_cMutex.Unlock();
+}
+
+/**
+*  @brief
+*    Adds a created scene node modifier
+*/
+void SceneLoadReport::AddModifier(const String &sClass, uint64 nTime)
+{
+	g_cMutex.Lock();
+	if (g_bCollecting) {
+		SEntry &sEntry = GetEntry(g_lstModifiers, sClass);
+		sEntry.nCount++;
+		sEntry.nTime += nTime;
+	}
+	g_cMutex.Unlock();
+}
+
+/**
+*  @brief
+*    Adds a read asset
+*/
+void SceneLoadReport::AddAssetRead(const String &sFilename, uint64 nTime, uint64 nBytes)
+{
+	g_cMutex.Lock();
+	if (g_bCollecting) {
+		SEntry &sEntry = GetEntry(g_lstAssets, sFilename);
+		sEntry.nReadTime  += nTime;
+		sEntry.nReadBytes += nBytes;
+	}
+	g_cMutex.Unlock();
+}
+
+/**
+*  @brief
+*    Writes the report of the last loaded scene into the log
+*/
+void SceneLoadReport::Log()
+{
+	g_cMutex.Lock();
+	if (g_bCollecting) {
+		PL_LOG(Info, "Scene load report: '" + g_sFilename + "' is still loaded")
+	} else if (!g_sFilename.GetLength()) {
+		PL_LOG(Info, "Scene load report: No scene was loaded yet")
+	} else {
+		PL_LOG(Info, "Scene load report: '" + g_sFilename + String::Format("' was loaded within %.1f ms", g_nTotalTime/1000.0))
+
+		// Phases, child phases are indented
+		PL_LOG(Info, "Phases (time, share of the total load time):")
+		for (uint32 i=0; i<g_lstPhases.GetNumOfElements(); i++) {
+			const SEntry &sEntry = g_lstPhases[i];
+			String sName;
+			for (uint32 nDepth=0; nDepth<sEntry.nDepth; nDepth++)
+				sName += "  ";
+			sName += sEntry.sName;
+			PL_LOG(Info, String::Format("  %-44s %10.1f ms %5.1f%%", sName.GetASCII(), sEntry.nTime/1000.0, g_nTotalTime ? sEntry.nTime*100.0/g_nTotalTime : 0.0))
+		}
+
+		// Scene node and modifier classes
+		PL_LOG(Info, "Scene node classes (time, instances, time per instance), asset decoding and uploading included:")
+		LogClasses(g_lstSceneNodes);
+		PL_LOG(Info, "Scene node modifier classes (time, instances, time per instance):")
+		LogClasses(g_lstModifiers);
+
+		// The slowest assets, the read times are summed up over all assets to show the total work of the worker threads
+		uint64 nReadTime = 0, nReadBytes = 0;
+		uint32 nNumOfReadAssets = 0;
+		for (uint32 i=0; i<g_lstAssets.GetNumOfElements(); i++) {
+			if (g_lstAssets[i].nReadBytes) {
+				nReadTime  += g_lstAssets[i].nReadTime;
+				nReadBytes += g_lstAssets[i].nReadBytes;
+				nNumOfReadAssets++;
+			}
+		}
+		PL_LOG(Info, String::Format("Assets (load time and scene nodes on the main thread, read time and size on the worker threads), %u read within %.1f ms, %.1f MiB:",
+									nNumOfReadAssets, nReadTime/1000.0, nReadBytes/(1024.0*1024.0)))
+		Array<uint32> lstIndices;
+		GetSortedIndices(g_lstAssets, lstIndices);
+		const uint32 nNumOfAssets = (lstIndices.GetNumOfElements() < MaxNumOfAssets) ? lstIndices.GetNumOfElements() : MaxNumOfAssets;
+		for (uint32 i=0; i<nNumOfAssets; i++) {
+			const SEntry &sEntry = g_lstAssets[lstIndices[i]];
+			PL_LOG(Info, String::Format("  %-60s %10.1f ms %6u x %8.1f ms %8.1f KiB", sEntry.sName.GetASCII(), sEntry.nTime/1000.0, sEntry.nCount,
+										sEntry.nReadTime/1000.0, sEntry.nReadBytes/1024.0))
+		}
+		if (lstIndices.GetNumOfElements() > nNumOfAssets)
+			PL_LOG(Info, String::Format("  ... and %u further assets", lstIndices.GetNumOfElements() - nNumOfAssets))
+	}
+	g_cMutex.Unlock();
+}
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+SceneLoadPhase::SceneLoadPhase(const char *pszName) :
+	m_pszName(pszName),
+	m_nStartTime(System::GetInstance()->GetMicroseconds()),
+	m_bRecorded(Profiler::Begin(pszName))
+{
+	SceneLoadReport::BeginPhase(pszName);
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+SceneLoadPhase::~SceneLoadPhase()
+{
+	SceneLoadReport::EndPhase(m_pszName, System::GetInstance()->GetMicroseconds() - m_nStartTime);
+	if (m_bRecorded)
+		Profiler::End();
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+SceneLoadPhase::SceneLoadPhase(const SceneLoadPhase &cSource) :
+	m_pszName(cSource.m_pszName),
+	m_nStartTime(0),
+	m_bRecorded(false)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+SceneLoadPhase &SceneLoadPhase::operator =(const SceneLoadPhase &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
@@ -0,0 +1,247 @@
+/*********************************************************\
+ *  File: SceneLoadReport.h                              *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_SCENELOADREPORT_H__
+#define __DUNGEON_SCENELOADREPORT_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Scene load report, lists where the load time of a scene went
+*
+*  @remarks
+*    While a scene is loaded, the load phases (see "SceneLoadPhase"), the creation time of each scene node and modifier
+*    (summed up per class) and the load time of each asset are collected. After loading, the report is written into
+*    the log, the "loadreport" console command writes the report of the last loaded scene into the log again.
+*
+*    The PixelLight resource managers decode the assets and upload them to the renderer right within the creation of
+*    the scene node using them, so decoding and uploading can't be timed separately. The creation time of a mesh scene
+*    node is added to its mesh, this includes the materials and textures of the mesh - as the resources are shared,
+*    usually the first scene node using a mesh pays for it. The read time of an asset is the time a worker thread of
+*    the asset prefetcher needed to read it (see "AssetPrefetcher"). The scene cache loader times each scene node and
+*    modifier, for the XML scene loader the times are split evenly over the instances created between two load progress
+*    signals (see "SceneLoadTracer").
+*
+*  @note
+*    - Data is only collected between "Begin()" and "End()", so runtime users of the asset prefetcher don't show up
+*    - "Begin()", "End()" and "Log()" must be called by the main thread only, the other functions can be called by any thread
+*/
+class SceneLoadReport {
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 MaxNumOfAssets = 30;	/**< Maximum number of assets listed within the report, the slowest ones are listed */
+
+
+	//[-------------------------------------------------------]
+	//[ Public static functions                               ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Starts collecting the report of a scene, the previous report is removed
+		*
+		*  @param[in] sFilename
+		*    Filename of the loaded scene
+		*/
+		static void Begin(const PLCore::String &sFilename);
+
+		/**
+		*  @brief
+		*    Stops collecting
+		*/
+		static void End();
+
+		/**
+		*  @brief
+		*    Returns whether or not the report is collected
+		*
+		*  @return
+		*    'true' if the report is collected, else 'false'
+		*/
+		static bool IsCollecting();
+
+		/**
+		*  @brief
+		*    Begins a load phase, following phases are child phases of it until "EndPhase()" is called
+		*
+		*  @param[in] pszName
+		*    Phase name, must be a string literal
+		*/
+		static void BeginPhase(const char *pszName);
+
+		/**
+		*  @brief
+		*    Ends the current load phase
+		*
+		*  @param[in] pszName
+		*    Phase name, must be the one given to "BeginPhase()"
+		*  @param[in] nTime
+		*    Time spent within the phase (in microseconds)
+		*/
+		static void EndPhase(const char *pszName, PLCore::uint64 nTime);
+
+		/**
+		*  @brief
+		*    Adds time to a load phase which is a child phase of the current phase (e.g. time summed up over many records)
+		*
+		*  @param[in] pszName
+		*    Phase name, must be a string literal
+		*  @param[in] nTime
+		*    Time (in microseconds) to add
+		*/
+		static void AddPhase(const char *pszName, PLCore::uint64 nTime);
+
+		/**
+		*  @brief
+		*    Adds a created scene node
+		*
+		*  @param[in] sClass
+		*    Class name of the scene node (e.g. "PLScene::SNMesh")
+		*  @param[in] nTime
+		*    Creation time (in microseconds), including the loading of the assets used by the scene node
+		*  @param[in] sAsset
+		*    Asset the creation time is added to (e.g. the mesh of a mesh scene node), empty string if none
+		*/
+		static void AddSceneNode(const PLCore::String &sClass, PLCore::uint64 nTime, const PLCore::String &sAsset);
+
+		/**
+		*  @brief
+		*    Adds a created scene node modifier
+		*
+		*  @param[in] sClass
+		*    Class name of the scene node modifier (e.g. "PLPhysics::SNMPhysicsBodyMesh")
+		*  @param[in] nTime
+		*    Creation time (in microseconds)
+		*/
+		static void AddModifier(const PLCore::String &sClass, PLCore::uint64 nTime);
+
+		/**
+		*  @brief
+		*    Adds a read asset
+		*
+		*  @param[in] sFilename
+		*    Filename of the asset
+		*  @param[in] nTime
+		*    Read time (in microseconds)
+		*  @param[in] nBytes
+		*    Number of read bytes
+		*/
+		static void AddAssetRead(const PLCore::String &sFilename, PLCore::uint64 nTime, PLCore::uint64 nBytes);
+
+		/**
+		*  @brief
+		*    Writes the report of the last loaded scene into the log
+		*/
+		static void Log();
+
+
+};
+
+/**
+*  @brief
+*    Scene load phase, begins a load phase and a profiler scope when being constructed and ends them when being destroyed
+*
+*  @remarks
+*    Usage example:
+*    @code
+*    {
+*        SceneLoadPhase cPhase("Physics cache validation");
+*        cPhysicsCacheManifest.Validate();
+*    }
+*    @endcode
+*/
+class SceneLoadPhase {
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] pszName
+		*    Phase name, must be a string literal
+		*/
+		SceneLoadPhase(const char *pszName);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		~SceneLoadPhase();
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		SceneLoadPhase(const SceneLoadPhase &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		SceneLoadPhase &operator =(const SceneLoadPhase &cSource);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		const char	   *m_pszName;		/**< Phase name, always valid */
+		PLCore::uint64	m_nStartTime;	/**< Start time of the phase (in microseconds) */
+		bool			m_bRecorded;	/**< Was the profiler scope of the phase recorded? */
+
+
+};
+
+
+#endif // __DUNGEON_SCENELOADREPORT_H__
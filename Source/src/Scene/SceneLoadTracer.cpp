@@ -0,0 +1,192 @@
+/*********************************************************\
+ *  File: SceneLoadTracer.cpp                            *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Base/Class.h>
+#include <PLCore/System/System.h>
+#include <PLScene/Scene/SceneContainer.h>
+#include <PLScene/Scene/SceneNodeModifier.h>
+#include "Scene/SceneLoadReport.h"
+#include "Scene/SceneLoadTracer.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+SceneLoadTracer::SceneLoadTracer(SceneContainer &cContainer) :
+	EventHandlerLoadProgress(&SceneLoadTracer::OnLoadProgress, this),
+	m_pContainer(SceneLoadReport::IsCollecting() ? &cContainer : nullptr),
+	m_nLastTime(System::GetInstance()->GetMicroseconds()),
+	m_nNumOfRootModifiers(0)
+{
+	if (m_pContainer)
+		m_pContainer->SignalLoadProgress.Connect(EventHandlerLoadProgress);
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+SceneLoadTracer::~SceneLoadTracer()
+{
+	if (m_pContainer) {
+		m_pContainer->SignalLoadProgress.Disconnect(EventHandlerLoadProgress);
+
+		// The scene nodes and modifiers created after the last load progress signal
+		Trace();
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+SceneLoadTracer::SceneLoadTracer(const SceneLoadTracer &cSource) :
+	EventHandlerLoadProgress(&SceneLoadTracer::OnLoadProgress, this),
+	m_pContainer(nullptr),
+	m_nLastTime(0),
+	m_nNumOfRootModifiers(0)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+SceneLoadTracer &SceneLoadTracer::operator =(const SceneLoadTracer &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Called when the load progress of the scene container changed
+*/
+void SceneLoadTracer::OnLoadProgress(float fProgress)
+{
+	Trace();
+}
+
+/**
+*  @brief
+*    Adds the scene nodes and modifiers created since the last call to the scene load report
+*/
+void SceneLoadTracer::Trace()
+{
+	// Look for the created scene nodes and modifiers
+	m_nNumOfRootModifiers = CollectModifiers(*m_pContainer, m_nNumOfRootModifiers);
+	CollectInstances(*m_pContainer, 0);
+
+	// Split the time since the previous trace evenly over them - if there are none yet (e.g. while the XML document is
+	// parsed), the time is added to the following ones
+	if (m_lstInstances.GetNumOfElements()) {
+		const uint64 nTime = System::GetInstance()->GetMicroseconds();
+		const uint64 nInstanceTime = (nTime - m_nLastTime)/m_lstInstances.GetNumOfElements();
+		for (uint32 i=0; i<m_lstInstances.GetNumOfElements(); i++) {
+			const SInstance &sInstance = m_lstInstances[i];
+			if (sInstance.bModifier)
+				SceneLoadReport::AddModifier(sInstance.sClass, nInstanceTime);
+			else
+				SceneLoadReport::AddSceneNode(sInstance.sClass, nInstanceTime, sInstance.sAsset);
+		}
+		m_lstInstances.Reset();
+		m_nLastTime = nTime;
+	}
+}
+
+/**
+*  @brief
+*    Looks for the scene nodes and modifiers created since the last call within a scene container, recursive
+*/
+void SceneLoadTracer::CollectInstances(SceneContainer &cContainer, uint32 nLevel)
+{
+	// A scene container not seen at this level before starts a new path, the levels of the previous path are done
+	if (nLevel >= m_lstLevels.GetNumOfElements() || m_lstLevels[nLevel].pContainer != &cContainer) {
+		m_lstLevels.Resize(nLevel + 1, true, true);
+		SLevel &sLevel = m_lstLevels[nLevel];
+		sLevel.pContainer	   = &cContainer;
+		sLevel.nNumOfNodes	   = 0;
+		sLevel.nNumOfModifiers = 0;
+	}
+
+	// Start with the last seen scene node, it may have got further modifiers or children since the last call
+	for (uint32 i=m_lstLevels[nLevel].nNumOfNodes ? m_lstLevels[nLevel].nNumOfNodes - 1 : 0; i<cContainer.GetNumOfElements(); i++) {
+		SceneNode *pSceneNode = cContainer.GetByIndex(i);
+		if (pSceneNode) {
+			// Add the scene node, the mesh is already set because the load progress signal is emitted after creating it - the
+			// level array may be resized within the recursion, so the level is fetched again for each scene node
+			SLevel *pLevel = &m_lstLevels[nLevel];
+			if (i >= pLevel->nNumOfNodes) {
+				const bool bMesh = (pSceneNode->IsInstanceOf("PLScene::SNMesh") && pSceneNode->GetAttribute("Mesh"));
+				SInstance &sInstance = m_lstInstances.Add();
+				sInstance.sClass	= pSceneNode->GetClass()->GetClassName();
+				sInstance.sAsset	= bMesh ? pSceneNode->GetAttribute("Mesh")->GetString() : String();
+				sInstance.bModifier = false;
+				pLevel->nNumOfNodes		= i + 1;
+				pLevel->nNumOfModifiers = 0;
+			}
+
+			// Add its new modifiers and children
+			pLevel->nNumOfModifiers = CollectModifiers(*pSceneNode, pLevel->nNumOfModifiers);
+			if (pSceneNode->IsContainer())
+				CollectInstances(static_cast<SceneContainer&>(*pSceneNode), nLevel + 1);
+		}
+	}
+}
+
+/**
+*  @brief
+*    Adds the modifiers of a scene node starting at a given index to the created instances
+*/
+uint32 SceneLoadTracer::CollectModifiers(SceneNode &cSceneNode, uint32 nFirstModifier)
+{
+	const uint32 nNumOfModifiers = cSceneNode.GetNumOfModifiers();
+	for (uint32 i=nFirstModifier; i<nNumOfModifiers; i++) {
+		SceneNodeModifier *pSceneNodeModifier = cSceneNode.GetModifier("", i);
+		if (pSceneNodeModifier) {
+			SInstance &sInstance = m_lstInstances.Add();
+			sInstance.sClass	= pSceneNodeModifier->GetClass()->GetClassName();
+			sInstance.sAsset	= String();
+			sInstance.bModifier = true;
+		}
+	}
+	return nNumOfModifiers;
+}
@@ -0,0 +1,216 @@
+/*********************************************************\
+ *  File: SceneLoadTracer.h                              *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+#ifndef __DUNGEON_SCENELOADTRACER_H__
+#define __DUNGEON_SCENELOADTRACER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include <PLCore/Container/Array.h>
+#include <PLCore/Base/Event/EventHandler.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLScene {
+	class SceneNode;
+	class SceneContainer;
+}
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Scene load tracer, adds the scene nodes and modifiers created by the XML scene loader of PixelLight to the scene load report
+*
+*  @remarks
+*    The scene cache loader adds each record it creates to the scene load report (see "SceneLoaderCache"), the XML scene
+*    loader of PixelLight offers no such hook. So while the tracer exists, it listens to the load progress signal of the
+*    scene container, on each signal it looks for the scene nodes and modifiers created since the previous signal and
+*    adds them to the scene load report. The XML scene loader emits the signal once per percent of the loaded items, so
+*    the classes and the number of instances are exact, while the time between two signals (including the XML parsing)
+*    is split evenly over the instances created within it. The creation time of a mesh scene node is added to its mesh.
+*
+*    Usage example:
+*    @code
+*    {
+*        SceneLoadTracer cTracer(*GetScene());
+*        ScriptApplication::LoadScene(sFilename);
+*    }
+*    @endcode
+*
+*  @note
+*    - The XML scene loader creates the scene depth first and appends the scene nodes and modifiers, so only the last
+*      scene node of each level of the last loaded path is checked for new children and modifiers again
+*    - Does nothing if the scene load report isn't collected
+*/
+class SceneLoadTracer {
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cContainer
+		*    Scene container the scene is loaded into, must stay valid as long as the tracer exists
+		*/
+		SceneLoadTracer(PLScene::SceneContainer &cContainer);
+
+		/**
+		*  @brief
+		*    Destructor, adds the scene nodes and modifiers created since the last load progress signal
+		*/
+		~SceneLoadTracer();
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Already seen part of a scene container of the last loaded path
+		*/
+		struct SLevel {
+			PLScene::SceneContainer *pContainer;		/**< Scene container, always valid */
+			PLCore::uint32			 nNumOfNodes;		/**< Number of seen scene nodes within the scene container */
+			PLCore::uint32			 nNumOfModifiers;	/**< Number of seen modifiers of the last seen scene node */
+
+			bool operator ==(const SLevel &sLevel) const
+			{
+				return (pContainer == sLevel.pContainer && nNumOfNodes == sLevel.nNumOfNodes && nNumOfModifiers == sLevel.nNumOfModifiers);
+			}
+		};
+
+		/**
+		*  @brief
+		*    Scene node or modifier created since the previous load progress signal
+		*/
+		struct SInstance {
+			PLCore::String sClass;		/**< Class name */
+			PLCore::String sAsset;		/**< Asset the creation time is added to, empty string if none */
+			bool		   bModifier;	/**< Is it a modifier? */
+
+			bool operator ==(const SInstance &sInstance) const
+			{
+				return (sClass == sInstance.sClass && sAsset == sInstance.sAsset && bModifier == sInstance.bModifier);
+			}
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		SceneLoadTracer(const SceneLoadTracer &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		SceneLoadTracer &operator =(const SceneLoadTracer &cSource);
+
+		/**
+		*  @brief
+		*    Called when the load progress of the scene container changed
+		*
+		*  @param[in] fProgress
+		*    Current load progress [0, 1]
+		*/
+		void OnLoadProgress(float fProgress);
+
+		/**
+		*  @brief
+		*    Adds the scene nodes and modifiers created since the last call to the scene load report
+		*/
+		void Trace();
+
+		/**
+		*  @brief
+		*    Looks for the scene nodes and modifiers created since the last call within a scene container, recursive
+		*
+		*  @param[in] cContainer
+		*    Scene container to look into
+		*  @param[in] nLevel
+		*    Level of the scene container within the last loaded path, 0 for the scene container the scene is loaded into
+		*/
+		void CollectInstances(PLScene::SceneContainer &cContainer, PLCore::uint32 nLevel);
+
+		/**
+		*  @brief
+		*    Adds the modifiers of a scene node starting at a given index to the created instances
+		*
+		*  @param[in] cSceneNode
+		*    Scene node the modifiers belong to
+		*  @param[in] nFirstModifier
+		*    Index of the first modifier to add
+		*
+		*  @return
+		*    Number of modifiers of the scene node
+		*/
+		PLCore::uint32 CollectModifiers(PLScene::SceneNode &cSceneNode, PLCore::uint32 nFirstModifier);
+
+
+	//[-------------------------------------------------------]
+	//[ Private event handlers                                ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::EventHandler<float> EventHandlerLoadProgress;
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLScene::SceneContainer	 *m_pContainer;				/**< Scene container the scene is loaded into, null pointer if the scene load report isn't collected */
+		PLCore::uint64			  m_nLastTime;				/**< Time (in microseconds) of the previous trace */
+		PLCore::uint32			  m_nNumOfRootModifiers;	/**< Number of seen modifiers of the scene container the scene is loaded into */
+		PLCore::Array<SLevel>	  m_lstLevels;				/**< Seen part of the scene containers of the last loaded path, the scene container the scene is loaded into first */
+		PLCore::Array<SInstance>  m_lstInstances;			/**< Scene nodes and modifiers created since the previous trace */
+
+
+};
+
+
+#endif // __DUNGEON_SCENELOADTRACER_H__
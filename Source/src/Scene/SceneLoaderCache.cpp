@@ -0,0 +1,376 @@
+/*********************************************************\
+ *  File: SceneLoaderCache.cpp                           *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/File/File.h>
+#include <PLCore/System/System.h>
+#include <PLCore/Core/MemoryManager.h>
+#include <PLMath/Vector3.h>
+#include <PLScene/Scene/SceneContainer.h>
+#include "Tools/WorkerPool.h"
+#include "Tools/MemoryMappedFile.h"
+#include "Scene/SceneCache.h"
+#include "Scene/AssetPrefetcher.h"
+#include "Scene/SceneLoadReport.h"
+#include "Scene/SceneLoaderCache.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ Global variables                                      ]
+//[-------------------------------------------------------]
+static WorkerPool *g_pWorkerPool = nullptr;	/**< Worker pool prefetching the assets (shared, not owned), can be a null pointer */
+
+
+//[-------------------------------------------------------]
+//[ RTTI interface                                        ]
+//[-------------------------------------------------------]
+pl_class_metadata(SceneLoaderCache, "", PLScene::SceneLoader, "Scene loader implementation for compiled binary scene caches")
+	// Properties
+	pl_properties
+		pl_property("Formats",	"scenecache,SCENECACHE")
+		pl_property("Load",		"1")
+		pl_property("Save",		"0")
+	pl_properties_end
+	// Constructors
+	pl_constructor_0_metadata(DefaultConstructor,	"Default constructor",	"")
+	// Methods
+	pl_method_2_metadata(Load,	pl_ret_type(bool),	PLScene::SceneContainer&,	PLCore::File&,	"Load method",	"")
+pl_class_metadata_end(SceneLoaderCache)
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Sets the worker pool prefetching the assets
+*/
+void SceneLoaderCache::SetWorkerPool(WorkerPool *pWorkerPool)
+{
+	g_pWorkerPool = pWorkerPool;
+}
+
+
+//[-------------------------------------------------------]
+//[ Public RTTI methods                                   ]
+//[-------------------------------------------------------]
+bool SceneLoaderCache::Load(SceneContainer &cContainer, File &cFile)
+{
+	// Map the cache file into memory, if this fails (e.g. the file is within a packed archive) read it into memory
+	const uint64 nStartTime = System::GetInstance()->GetMicroseconds();
+	MemoryMappedFile cMemoryMappedFile;
+	uint8 *pBuffer = nullptr;
+	const uint8 *pData = nullptr;
+	uint32 nSize = 0;
+	if (cMemoryMappedFile.Open(cFile.GetUrl().GetNativePath())) {
+		pData = cMemoryMappedFile.GetData();
+		nSize = cMemoryMappedFile.GetSize();
+	} else {
+		nSize = cFile.GetSize();
+		if (nSize) {
+			pBuffer = new uint8[nSize];
+			if (cFile.Read(pBuffer, 1, nSize) == nSize)
+				pData = pBuffer;
+		}
+	}
+	SceneLoadReport::AddPhase("Cache file I/O", System::GetInstance()->GetMicroseconds() - nStartTime);
+
+	// Check the header
+	bool bResult = false;
+	const uint32 nHeaderSize = sizeof(uint32)*3 + SceneCache::HashSize;
+	if (pData && nSize >= nHeaderSize) {
+		uint32 nMagic, nVersion;
+		MemoryManager::Copy(&nMagic,        pData,                                          sizeof(uint32));
+		MemoryManager::Copy(&nVersion,      pData + sizeof(uint32),                         sizeof(uint32));
+		MemoryManager::Copy(&m_nNumOfItems, pData + sizeof(uint32)*2 + SceneCache::HashSize, sizeof(uint32));
+		if (nMagic == SceneCache::Magic && nVersion == SceneCache::Version) {
+			const uint8 *pCurrent = pData + nHeaderSize;
+			const uint8 *pEnd     = pData + nSize;
+			m_nNumOfLoadedItems = 0;
+			m_nLastProgress     = 0;
+			m_nParseTime        = 0;
+			m_nSceneNodeTime    = 0;
+			m_nModifierTime     = 0;
+
+			// Start prefetching the assets of the scene on the shared worker threads, they are read in the order the records need them
+			m_pAssetPrefetcher = g_pWorkerPool ? new AssetPrefetcher(*g_pWorkerPool) : nullptr;
+			uint32 nNumOfAssets = 0;
+			bool bValidAssets = (pEnd - pCurrent >= static_cast<int>(sizeof(uint32)));
+			if (bValidAssets) {
+				MemoryManager::Copy(&nNumOfAssets, pCurrent, sizeof(uint32));
+				pCurrent += sizeof(uint32);
+				String sAsset;
+				for (uint32 i=0; i<nNumOfAssets && bValidAssets; i++) {
+					bValidAssets = ReadString(pCurrent, pEnd, sAsset);
+					if (bValidAssets && m_pAssetPrefetcher)
+						m_pAssetPrefetcher->Prefetch(sAsset);
+				}
+			}
+
+			// The first record describes the scene container the scene is loaded into
+			if (bValidAssets && pCurrent < pEnd && *pCurrent++ == SceneCache::RecordContainer) {
+				String sClass, sName, sParameters;
+				uint8 nTransform = 0;
+				Vector3 vPosition, vRotation, vScale;
+				if (ReadNode(pCurrent, pEnd, sClass, sName, nTransform, vPosition, vRotation, vScale, sParameters)) {
+					UpdateProgress(cContainer);
+					if (sName.GetLength())
+						cContainer.SetName(sName);
+					cContainer.SetValues(sParameters);
+					ApplyTransform(cContainer, nTransform, vPosition, vRotation, vScale);
+
+					// Load the content of the scene
+					bResult = LoadRecords(cContainer, &cContainer, &cContainer, pCurrent, pEnd);
+				}
+			}
+
+			// Add the summed up times of the records to the scene load report
+			SceneLoadReport::AddPhase("Record parsing", m_nParseTime);
+			SceneLoadReport::AddPhase("Scene node creation (asset decoding and uploading)", m_nSceneNodeTime);
+			SceneLoadReport::AddPhase("Scene node modifier creation", m_nModifierTime);
+
+			// Write a log message - everything the scene needs is loaded now, so remaining prefetch jobs are skipped
+			if (m_pAssetPrefetcher) {
+				PL_LOG(Info, String::Format("Scene cache: Prefetched %.1f MiB of %u scene assets (including dependencies) on %u worker threads",
+											static_cast<float>(m_pAssetPrefetcher->GetNumOfReadBytes())/(1024.0f*1024.0f), nNumOfAssets, g_pWorkerPool->GetNumOfThreads()))
+				delete m_pAssetPrefetcher;
+				m_pAssetPrefetcher = nullptr;
+			}
+			if (!bResult)
+				PL_LOG(Error, "Scene cache: '" + cFile.GetUrl().GetNativePath() + "' is corrupt")
+		} else {
+			PL_LOG(Error, "Scene cache: '" + cFile.GetUrl().GetNativePath() + "' has an invalid format")
+		}
+	}
+
+	// Cleanup
+	if (pBuffer)
+		delete [] pBuffer;
+
+	// Done
+	return bResult;
+}
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Default constructor
+*/
+SceneLoaderCache::SceneLoaderCache() :
+	m_nNumOfItems(0),
+	m_nNumOfLoadedItems(0),
+	m_nLastProgress(0),
+	m_nParseTime(0),
+	m_nSceneNodeTime(0),
+	m_nModifierTime(0),
+	m_pAssetPrefetcher(nullptr)
+{
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+SceneLoaderCache::~SceneLoaderCache()
+{
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Loads the records
+*/
+bool SceneLoaderCache::LoadRecords(SceneContainer &cContainer, SceneContainer *pContainer, SceneNode *pOwner, const uint8 *&pData, const uint8 *pEnd)
+{
+	while (pData < pEnd) {
+		const uint8 nRecord = *pData++;
+		switch (nRecord) {
+			case SceneCache::RecordEnd:
+				// Done
+				return true;
+
+			case SceneCache::RecordContainer:
+			case SceneCache::RecordNode:
+			{
+				String sClass, sName, sParameters;
+				uint8 nTransform = 0;
+				Vector3 vPosition, vRotation, vScale;
+				uint64 nStartTime = System::GetInstance()->GetMicroseconds();
+				if (!ReadNode(pData, pEnd, sClass, sName, nTransform, vPosition, vRotation, vScale, sParameters))
+					return false; // Error!
+				UpdateProgress(cContainer);
+
+				// Create the scene node - the assets are decoded and uploaded right within the creation, so add its time to the mesh
+				uint64 nTime = System::GetInstance()->GetMicroseconds();
+				m_nParseTime += nTime - nStartTime;
+				nStartTime = nTime;
+				SceneNode *pSceneNode = pContainer ? pContainer->Create(sClass, sName, sParameters) : nullptr;
+				if (pSceneNode) {
+					ApplyTransform(*pSceneNode, nTransform, vPosition, vRotation, vScale);
+				} else {
+					PL_LOG(Error, "Scene cache: Can't create the scene node '" + sName + "' of the class '" + sClass + '\'')
+				}
+				nTime = System::GetInstance()->GetMicroseconds() - nStartTime;
+				m_nSceneNodeTime += nTime;
+				const bool bMesh = (pSceneNode && pSceneNode->IsInstanceOf("PLScene::SNMesh") && pSceneNode->GetAttribute("Mesh"));
+				SceneLoadReport::AddSceneNode(sClass, nTime, bMesh ? pSceneNode->GetAttribute("Mesh")->GetString() : String());
+
+				// Load the children - if the scene node couldn't be created, they are skipped
+				SceneContainer *pChildContainer = (pSceneNode && nRecord == SceneCache::RecordContainer && pSceneNode->IsContainer()) ? static_cast<SceneContainer*>(pSceneNode) : nullptr;
+				if (!LoadRecords(cContainer, pChildContainer, pSceneNode, pData, pEnd))
+					return false; // Error!
+				break;
+			}
+
+			case SceneCache::RecordModifier:
+			{
+				String sClass, sParameters;
+				uint64 nStartTime = System::GetInstance()->GetMicroseconds();
+				if (!ReadString(pData, pEnd, sClass) || !ReadString(pData, pEnd, sParameters))
+					return false; // Error!
+				UpdateProgress(cContainer);
+
+				// Add the scene node modifier
+				uint64 nTime = System::GetInstance()->GetMicroseconds();
+				m_nParseTime += nTime - nStartTime;
+				nStartTime = nTime;
+				if (pOwner && !pOwner->AddModifier(sClass, sParameters))
+					PL_LOG(Error, "Scene cache: Can't add the scene node modifier of the class '" + sClass + "' to '" + pOwner->GetAbsoluteName() + '\'')
+				nTime = System::GetInstance()->GetMicroseconds() - nStartTime;
+				m_nModifierTime += nTime;
+				if (pOwner)
+					SceneLoadReport::AddModifier(sClass, nTime);
+				break;
+			}
+
+			default:
+				// Error!
+				return false;
+		}
+	}
+
+	// Error! (missing end record)
+	return false;
+}
+
+/**
+*  @brief
+*    Reads the common data of a container or node record
+*/
+bool SceneLoaderCache::ReadNode(const uint8 *&pData, const uint8 *pEnd, String &sClass, String &sName, uint8 &nTransform,
+								Vector3 &vPosition, Vector3 &vRotation, Vector3 &vScale, String &sParameters) const
+{
+	// Class and name
+	if (!ReadString(pData, pEnd, sClass) || !ReadString(pData, pEnd, sName) || pData >= pEnd)
+		return false; // Error!
+
+	// Typed transform, the data is not aligned so copy it
+	nTransform = *pData++;
+	Vector3 *pvTransform[3] = { &vPosition, &vRotation, &vScale };
+	for (uint32 i=0; i<3; i++) {
+		if (nTransform & (1<<i)) {
+			if (pEnd - pData < static_cast<int>(sizeof(float)*3))
+				return false; // Error!
+			MemoryManager::Copy(&pvTransform[i]->x, pData, sizeof(float)*3);
+			pData += sizeof(float)*3;
+		}
+	}
+
+	// Parameters
+	return ReadString(pData, pEnd, sParameters);
+}
+
+/**
+*  @brief
+*    Reads a string
+*/
+bool SceneLoaderCache::ReadString(const uint8 *&pData, const uint8 *pEnd, String &sString) const
+{
+	// Length
+	if (pEnd - pData < static_cast<int>(sizeof(uint32)))
+		return false; // Error!
+	uint32 nLength;
+	MemoryManager::Copy(&nLength, pData, sizeof(uint32));
+	pData += sizeof(uint32);
+
+	// Characters
+	if (static_cast<uint32>(pEnd - pData) < nLength)
+		return false; // Error!
+	sString = nLength ? String(reinterpret_cast<const char*>(pData), true, nLength) : String();
+	pData += nLength;
+
+	// Done
+	return true;
+}
+
+/**
+*  @brief
+*    Applies the typed transform to a scene node
+*/
+void SceneLoaderCache::ApplyTransform(SceneNode &cSceneNode, uint8 nTransform, const Vector3 &vPosition, const Vector3 &vRotation, const Vector3 &vScale) const
+{
+	if (nTransform & SceneCache::TransformPosition)
+		cSceneNode.SetPosition(vPosition);
+	if (nTransform & SceneCache::TransformRotation)
+		cSceneNode.SetRotation(vRotation);
+	if (nTransform & SceneCache::TransformScale)
+		cSceneNode.SetScale(vScale);
+}
+
+/**
+*  @brief
+*    Counts a loaded item and emits the load progress signal if required
+*/
+void SceneLoaderCache::UpdateProgress(SceneContainer &cContainer)
+{
+	m_nNumOfLoadedItems++;
+	if (m_nNumOfItems) {
+		// The progress is the average of the record progress and the prefetch progress
+		float fProgress = static_cast<float>(m_nNumOfLoadedItems)/m_nNumOfItems;
+		if (m_pAssetPrefetcher)
+			fProgress = (fProgress + m_pAssetPrefetcher->GetProgress())*0.5f;
+
+		// We don't want to emit the signal for each single tiny item *performance*
+		const uint32 nProgress = static_cast<uint32>(fProgress*100.0f);
+		if (nProgress > m_nLastProgress) {
+			m_nLastProgress = nProgress;
+			cContainer.SignalLoadProgress(fProgress);
+		}
+	}
+}
@@ -0,0 +1,223 @@
+/*********************************************************\
+ *  File: SceneLoaderCache.h                             *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_SCENELOADERCACHE_H__
+#define __DUNGEON_SCENELOADERCACHE_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLScene/Scene/SceneLoader/SceneLoader.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLMath {
+	class Vector3;
+}
+namespace PLScene {
+	class SceneNode;
+}
+class WorkerPool;
+class AssetPrefetcher;
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Scene loader implementation for compiled binary scene caches (see "SceneCache")
+*
+*  @remarks
+*    The cache file is memory mapped and applied straight from the mapped memory. Transforms are applied
+*    as typed data, all other attributes are applied by using a parameter string per scene node and modifier
+*    which was built during compilation. While the records are loaded, the assets listed within the
+*    cache file are prefetched on the worker threads set by "SetWorkerPool()" (see "AssetPrefetcher").
+*/
+class SceneLoaderCache : public PLScene::SceneLoader {
+
+
+	//[-------------------------------------------------------]
+	//[ RTTI interface                                        ]
+	//[-------------------------------------------------------]
+	pl_class_def()
+	pl_class_def_end
+
+
+	//[-------------------------------------------------------]
+	//[ Public static functions                               ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Sets the worker pool prefetching the assets
+		*
+		*  @param[in] pWorkerPool
+		*    Worker pool prefetching the assets, must stay valid as long as it's set, can be a null pointer (no prefetching)
+		*
+		*  @remarks
+		*    The loader is created by the loadable system, so the application sets its shared worker pool here.
+		*/
+		static void SetWorkerPool(WorkerPool *pWorkerPool);
+
+
+	//[-------------------------------------------------------]
+	//[ Public RTTI methods                                   ]
+	//[-------------------------------------------------------]
+	public:
+		bool Load(PLScene::SceneContainer &cContainer, PLCore::File &cFile);
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Default constructor
+		*/
+		SceneLoaderCache();
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		virtual ~SceneLoaderCache();
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Loads the records
+		*
+		*  @param[in] cContainer
+		*    Scene container the scene is loaded into (for the progress signal)
+		*  @param[in] pContainer
+		*    Scene container to create the scene nodes in, can be a null pointer (scene nodes are skipped)
+		*  @param[in] pOwner
+		*    Scene node to add the modifiers to, can be a null pointer (modifiers are skipped)
+		*  @param[in, out] pData
+		*    Current read position, is moved behind the read records
+		*  @param[in] pEnd
+		*    End of the data
+		*
+		*  @return
+		*    'true' if all went fine, else 'false' (corrupt data)
+		*/
+		bool LoadRecords(PLScene::SceneContainer &cContainer, PLScene::SceneContainer *pContainer, PLScene::SceneNode *pOwner, const PLCore::uint8 *&pData, const PLCore::uint8 *pEnd);
+
+		/**
+		*  @brief
+		*    Reads the common data of a container or node record
+		*
+		*  @param[in, out] pData
+		*    Current read position, is moved behind the read data
+		*  @param[in] pEnd
+		*    End of the data
+		*  @param[out] sClass
+		*    Receives the class name
+		*  @param[out] sName
+		*    Receives the name
+		*  @param[out] nTransform
+		*    Receives the set transform bits
+		*  @param[out] vPosition
+		*    Receives the position, if set
+		*  @param[out] vRotation
+		*    Receives the rotation, if set
+		*  @param[out] vScale
+		*    Receives the scale, if set
+		*  @param[out] sParameters
+		*    Receives the parameter string
+		*
+		*  @return
+		*    'true' if all went fine, else 'false' (corrupt data)
+		*/
+		bool ReadNode(const PLCore::uint8 *&pData, const PLCore::uint8 *pEnd, PLCore::String &sClass, PLCore::String &sName, PLCore::uint8 &nTransform,
+					  PLMath::Vector3 &vPosition, PLMath::Vector3 &vRotation, PLMath::Vector3 &vScale, PLCore::String &sParameters) const;
+
+		/**
+		*  @brief
+		*    Reads a string
+		*
+		*  @param[in, out] pData
+		*    Current read position, is moved behind the read data
+		*  @param[in] pEnd
+		*    End of the data
+		*  @param[out] sString
+		*    Receives the string
+		*
+		*  @return
+		*    'true' if all went fine, else 'false' (corrupt data)
+		*/
+		bool ReadString(const PLCore::uint8 *&pData, const PLCore::uint8 *pEnd, PLCore::String &sString) const;
+
+		/**
+		*  @brief
+		*    Applies the typed transform to a scene node
+		*
+		*  @param[in] cSceneNode
+		*    Scene node to apply the transform to
+		*  @param[in] nTransform
+		*    Set transform bits
+		*  @param[in] vPosition
+		*    Position, used if set
+		*  @param[in] vRotation
+		*    Rotation, used if set
+		*  @param[in] vScale
+		*    Scale, used if set
+		*/
+		void ApplyTransform(PLScene::SceneNode &cSceneNode, PLCore::uint8 nTransform, const PLMath::Vector3 &vPosition, const PLMath::Vector3 &vRotation, const PLMath::Vector3 &vScale) const;
+
+		/**
+		*  @brief
+		*    Counts a loaded item and emits the load progress signal if required
+		*
+		*  @param[in] cContainer
+		*    Scene container the scene is loaded into
+		*/
+		void UpdateProgress(PLScene::SceneContainer &cContainer);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::uint32	 m_nNumOfItems;			/**< Total number of items within the currently loaded cache file */
+		PLCore::uint32	 m_nNumOfLoadedItems;	/**< Number of already loaded items */
+		PLCore::uint32	 m_nLastProgress;		/**< Last emitted progress in percent */
+		PLCore::uint64	 m_nParseTime;			/**< Time (in microseconds) spent to parse the records */
+		PLCore::uint64	 m_nSceneNodeTime;		/**< Time (in microseconds) spent to create the scene nodes */
+		PLCore::uint64	 m_nModifierTime;		/**< Time (in microseconds) spent to create the scene node modifiers */
+		AssetPrefetcher *m_pAssetPrefetcher;	/**< Asset prefetcher of the currently loaded cache file, can be a null pointer */
+
+
+};
+
+
+#endif // __DUNGEON_SCENELOADERCACHE_H__
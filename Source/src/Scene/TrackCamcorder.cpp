@@ -0,0 +1,342 @@
+/*********************************************************\
+ *  File: TrackCamcorder.cpp                             *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/Xml/Xml.h>
+#include <PLCore/File/File.h>
+#include <PLCore/Tools/LoadableManager.h>
+#include <PLScene/Scene/SceneContext.h>
+#include <PLScene/Scene/SceneContainer.h>
+#include <PLEngine/Tools/Camcorder.h>
+#include "Application.h"
+#include "SNMCamcorderTrack.h"
+#include "Scene/TrackCamcorder.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLScene;
+using namespace PLEngine;
+
+
+//[-------------------------------------------------------]
+//[ RTTI interface                                        ]
+//[-------------------------------------------------------]
+pl_class_metadata(TrackCamcorder, "", PLCore::Object, "Camcorder interaction component playing the compact camcorder tracks")
+	// Constructors
+	pl_constructor_1_metadata(ParameterConstructor,	Application&,	"Parameter constructor. Owner application as first parameter.",	"")
+	// Methods
+	pl_method_1_metadata(StartRecord,			pl_ret_type(void),	const PLCore::String&,	"Starts the record, record name as first parameter (if empty string, no recording will be started)",	"")
+	pl_method_0_metadata(IsRecording,			pl_ret_type(bool),							"Returns whether or not recording is currently active. Returns 'true' if recording is currently active, else 'false'.",	"")
+	pl_method_0_metadata(StopRecord,				pl_ret_type(void),							"Stops the record",	"")
+	pl_method_1_metadata(StartPlayback,			pl_ret_type(void),	const PLCore::String&,	"Starts the playback, record name as first parameter (the track \"Data/Camcorder/<Name>.track\" is played if it exists)",	"")
+	pl_method_0_metadata(IsPlaying,				pl_ret_type(bool),							"Returns whether or not playback is currently active. Returns 'true' if playback is currently active, else 'false'.",	"")
+	pl_method_0_metadata(StopPlayback,			pl_ret_type(void),							"Stops the playback",	"")
+	pl_method_0_metadata(GetPlaybackTime,		pl_ret_type(float),							"Returns the current playback time in seconds, 0 if no track is played",	"")
+	pl_method_1_metadata(SetPlaybackTime,		pl_ret_type(void),	float,					"Sets the current playback time, new playback time in seconds as first parameter (only tracks can be seeked)",	"")
+	pl_method_0_metadata(GetPlaybackDuration,	pl_ret_type(float),							"Returns the duration of the played track in seconds, 0 if no track is played",	"")
+	pl_method_0_metadata(Update,					pl_ret_type(void),							"Updates the camcorder component, call this once per frame",	"")
+	// Signals
+	pl_signal_0_metadata(SignalPlaybackFinished,	"Playback has been finished",	"")
+	// Slots
+	pl_slot_0_metadata(OnPlaybackFinished,	"Called when the playback of \"PLEngine::Camcorder\" has been finished",	"")
+	pl_slot_0_metadata(OnTrackFinished,		"Called when the end of the played track has been reached",				"")
+pl_class_metadata_end(TrackCamcorder)
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+TrackCamcorder::TrackCamcorder(Application &cApplication) :
+	SlotOnPlaybackFinished(this),
+	SlotOnTrackFinished(this),
+	m_pApplication(&cApplication),
+	m_pCamcorder(new Camcorder(cApplication)),
+	m_bTrackFinished(false)
+{
+	// Forward the end of the playbacks of the camcorder
+	m_pCamcorder->SignalPlaybackFinished.Connect(SlotOnPlaybackFinished);
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+TrackCamcorder::~TrackCamcorder()
+{
+	// Stop the playback, this gives the camera back its controllers
+	StopPlayback();
+	delete m_pCamcorder;
+}
+
+/**
+*  @brief
+*    Starts the record
+*/
+void TrackCamcorder::StartRecord(const String &sName)
+{
+	m_pCamcorder->StartRecord(sName);
+}
+
+/**
+*  @brief
+*    Returns whether or not recording is currently active
+*/
+bool TrackCamcorder::IsRecording() const
+{
+	return m_pCamcorder->IsRecording();
+}
+
+/**
+*  @brief
+*    Stops the record
+*/
+void TrackCamcorder::StopRecord()
+{
+	m_pCamcorder->StopRecord();
+}
+
+/**
+*  @brief
+*    Starts the playback
+*/
+void TrackCamcorder::StartPlayback(const String &sName)
+{
+	// Stop the previous playback
+	StopPlayback();
+
+	// Play the track, if there's none, let the camcorder play the keys of the record
+	if (!StartTrackPlayback(sName))
+		m_pCamcorder->StartPlayback(sName);
+}
+
+/**
+*  @brief
+*    Returns whether or not playback is currently active
+*/
+bool TrackCamcorder::IsPlaying() const
+{
+	return (m_cCameraHandler.GetElement() || m_pCamcorder->IsPlaying());
+}
+
+/**
+*  @brief
+*    Stops the playback
+*/
+void TrackCamcorder::StopPlayback()
+{
+	// Stop playing the track
+	SceneNode *pCamera = m_cCameraHandler.GetElement();
+	if (pCamera) {
+		pCamera->RemoveModifier("SNMCamcorderTrack");
+
+		// Give the camera back its controllers and move it back into its previous scene container
+		for (uint32 i=0; i<m_lstControllers.GetNumOfElements(); i++) {
+			SceneNodeModifier *pController = pCamera->GetModifier(m_lstControllers[i]);
+			if (pController)
+				pController->SetActive(true);
+		}
+		SceneNode *pContainer = m_cContainerHandler.GetElement();
+		if (pContainer && pContainer != pCamera->GetContainer())
+			pCamera->SetContainer(static_cast<SceneContainer&>(*pContainer));
+	}
+	m_cCameraHandler.SetElement();
+	m_cContainerHandler.SetElement();
+	m_lstControllers.Clear();
+	m_bTrackFinished = false;
+
+	// Stop the playback of the camcorder
+	m_pCamcorder->StopPlayback();
+}
+
+/**
+*  @brief
+*    Returns the current playback time
+*/
+float TrackCamcorder::GetPlaybackTime() const
+{
+	SceneNode *pCamera = m_cCameraHandler.GetElement();
+	SceneNodeModifier *pModifier = pCamera ? pCamera->GetModifier("SNMCamcorderTrack") : nullptr;
+	return pModifier ? static_cast<SNMCamcorderTrack*>(pModifier)->GetTime() : 0.0f;
+}
+
+/**
+*  @brief
+*    Sets the current playback time
+*/
+void TrackCamcorder::SetPlaybackTime(float fTime)
+{
+	// Seeking is just a binary search within the keys of the track
+	SceneNode *pCamera = m_cCameraHandler.GetElement();
+	SceneNodeModifier *pModifier = pCamera ? pCamera->GetModifier("SNMCamcorderTrack") : nullptr;
+	if (pModifier) {
+		static_cast<SNMCamcorderTrack*>(pModifier)->SetTime(fTime);
+		m_bTrackFinished = false;
+	}
+}
+
+/**
+*  @brief
+*    Returns the duration of the played track
+*/
+float TrackCamcorder::GetPlaybackDuration() const
+{
+	SceneNode *pCamera = m_cCameraHandler.GetElement();
+	SceneNodeModifier *pModifier = pCamera ? pCamera->GetModifier("SNMCamcorderTrack") : nullptr;
+	return pModifier ? static_cast<SNMCamcorderTrack*>(pModifier)->GetDuration() : 0.0f;
+}
+
+/**
+*  @brief
+*    Updates the camcorder component, call this once per frame
+*/
+void TrackCamcorder::Update()
+{
+	// Update the camcorder, it emits its own end of the playback
+	m_pCamcorder->Update();
+
+	// The end of the track is handled here and not within the slot, the modifier can't be removed while it's updated
+	if (m_bTrackFinished) {
+		StopPlayback();
+		SignalPlaybackFinished();
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+TrackCamcorder::TrackCamcorder(const TrackCamcorder &cSource) :
+	SlotOnPlaybackFinished(this),
+	SlotOnTrackFinished(this),
+	m_pApplication(nullptr),
+	m_pCamcorder(nullptr),
+	m_bTrackFinished(false)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+TrackCamcorder &TrackCamcorder::operator =(const TrackCamcorder &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Starts the playback of a track
+*/
+bool TrackCamcorder::StartTrackPlayback(const String &sName)
+{
+	// Is there a track?
+	const String sTrackFilename = "Data/Camcorder/" + sName + ".track";
+	File cFile;
+	if (!sName.GetLength() || !LoadableManager::GetInstance()->OpenFile(cFile, sTrackFilename, false))
+		return false;
+	cFile.Close();
+
+	// The track only holds the keys, the scene container and the coordinate system are still within the record
+	XmlDocument cDocument;
+	if (!LoadableManager::GetInstance()->OpenFile(cFile, "Data/Camcorder/" + sName + ".cam", false) || !cDocument.Load(cFile)) {
+		PL_LOG(Warning, "Camcorder: The track '" + sTrackFilename + "' has no record, the keys are played instead")
+		return false;
+	}
+	const XmlElement *pCamcorderElement = cDocument.GetFirstChildElement("Camcorder");
+	const XmlElement *pPositionElement  = pCamcorderElement ? pCamcorderElement->GetFirstChildElement("PositionKeys") : nullptr;
+	if (!pCamcorderElement || !pPositionElement)
+		return false;
+
+	// Get the camera and the scene container of the record, its absolute name starts with the root scene container
+	SceneNode *pCamera = reinterpret_cast<SceneNode*>(m_pApplication->GetCamera());
+	SceneContext *pSceneContext = m_pApplication->GetSceneContext();
+	if (!pCamera || !pSceneContext || !pSceneContext->GetRoot())
+		return false;
+	String sContainer = pCamcorderElement->GetAttribute("SceneContainer");
+	if (sContainer.IndexOf("Root.") == 0)
+		sContainer.Delete(0, 5);
+	SceneNode *pContainer = pSceneContext->GetRoot()->GetByName(sContainer);
+	if (!pContainer || !pContainer->IsContainer()) {
+		PL_LOG(Warning, "Camcorder: Unknown scene container '" + sContainer + "' of the track '" + sTrackFilename + '\'')
+		return false;
+	}
+
+	// Move the camera into the scene container of the record, just like the camcorder does
+	m_cCameraHandler.SetElement(pCamera);
+	m_cContainerHandler.SetElement(pCamera->GetContainer());
+	if (pContainer != pCamera->GetContainer())
+		pCamera->SetContainer(static_cast<SceneContainer&>(*pContainer));
+
+	// Deactivate the camera controllers while the track is played
+	for (uint32 i=0; i<pCamera->GetNumOfModifiers(); i++) {
+		SceneNodeModifier *pController = pCamera->GetModifier("", i);
+		if (pController && pController->IsActive() && pController->IsInstanceOf("PLScene::SNMTransform")) {
+			pController->SetActive(false);
+			m_lstControllers.Add(pController->GetClass()->GetClassName());
+		}
+	}
+
+	// Play the track - the coordinate system has to be set before the track is opened and applied
+	SceneNodeModifier *pModifier = pCamera->AddModifier("SNMCamcorderTrack", "CoordinateSystem=\"" + pPositionElement->GetAttribute("CoordinateSystem") + "\" Track=\"" + sTrackFilename + '\"');
+	if (!pModifier) {
+		StopPlayback();
+		return false;
+	}
+	static_cast<SNMCamcorderTrack*>(pModifier)->SignalFinished.Connect(SlotOnTrackFinished);
+
+	// Done
+	return true;
+}
+
+/**
+*  @brief
+*    Called when the playback of "PLEngine::Camcorder" has been finished
+*/
+void TrackCamcorder::OnPlaybackFinished()
+{
+	SignalPlaybackFinished();
+}
+
+/**
+*  @brief
+*    Called when the end of the played track has been reached
+*/
+void TrackCamcorder::OnTrackFinished()
+{
+	m_bTrackFinished = true;
+}
@@ -0,0 +1,243 @@
+/*********************************************************\
+ *  File: TrackCamcorder.h                               *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_TRACKCAMCORDER_H__
+#define __DUNGEON_TRACKCAMCORDER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Base/Object.h>
+#include <PLCore/Container/Array.h>
+#include <PLScene/Scene/SceneNodeHandler.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLEngine {
+	class Camcorder;
+}
+class Application;
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Camcorder interaction component playing the compact camcorder tracks
+*
+*  @remarks
+*    Offers the same interface as "PLEngine::Camcorder", so scripts can use it the very same way. When a track
+*    "Data/Camcorder/<Name>.track" (see "CamcorderTrack") exists, the playback evaluates it by using the
+*    "SNMCamcorderTrack" modifier instead of loading all keys of "Data/Camcorder/<Name>.cam" into keyframe animations.
+*    Everything else, the recording as well as the playback of recordings without a track, is forwarded to
+*    "PLEngine::Camcorder".
+*/
+class TrackCamcorder : public PLCore::Object {
+
+
+	//[-------------------------------------------------------]
+	//[ RTTI interface                                        ]
+	//[-------------------------------------------------------]
+	pl_class_def()
+		// Signals
+		pl_signal_0_def(SignalPlaybackFinished)
+		// Slots
+		pl_slot_0_def(TrackCamcorder, OnPlaybackFinished)
+		pl_slot_0_def(TrackCamcorder, OnTrackFinished)
+	pl_class_def_end
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cApplication
+		*    Owner application
+		*/
+		TrackCamcorder(Application &cApplication);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		virtual ~TrackCamcorder();
+
+		/**
+		*  @brief
+		*    Starts the record
+		*
+		*  @param[in] sName
+		*    Name of the record
+		*/
+		void StartRecord(const PLCore::String &sName);
+
+		/**
+		*  @brief
+		*    Returns whether or not recording is currently active
+		*
+		*  @return
+		*    'true' if recording is currently active, else 'false'
+		*/
+		bool IsRecording() const;
+
+		/**
+		*  @brief
+		*    Stops the record
+		*/
+		void StopRecord();
+
+		/**
+		*  @brief
+		*    Starts the playback
+		*
+		*  @param[in] sName
+		*    Name of the record to play, the track "Data/Camcorder/<Name>.track" is played if it exists
+		*/
+		void StartPlayback(const PLCore::String &sName);
+
+		/**
+		*  @brief
+		*    Returns whether or not playback is currently active
+		*
+		*  @return
+		*    'true' if playback is currently active, else 'false'
+		*/
+		bool IsPlaying() const;
+
+		/**
+		*  @brief
+		*    Stops the playback
+		*/
+		void StopPlayback();
+
+		/**
+		*  @brief
+		*    Returns the current playback time
+		*
+		*  @return
+		*    The current playback time in seconds, 0 if no track is played
+		*/
+		float GetPlaybackTime() const;
+
+		/**
+		*  @brief
+		*    Sets the current playback time
+		*
+		*  @param[in] fTime
+		*    The new playback time in seconds
+		*
+		*  @note
+		*    - Only tracks can be seeked, the keyframe animations of "PLEngine::Camcorder" can't
+		*/
+		void SetPlaybackTime(float fTime);
+
+		/**
+		*  @brief
+		*    Returns the duration of the played track
+		*
+		*  @return
+		*    The duration of the played track in seconds, 0 if no track is played
+		*/
+		float GetPlaybackDuration() const;
+
+		/**
+		*  @brief
+		*    Updates the camcorder component, call this once per frame
+		*/
+		void Update();
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		TrackCamcorder(const TrackCamcorder &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		TrackCamcorder &operator =(const TrackCamcorder &cSource);
+
+		/**
+		*  @brief
+		*    Starts the playback of a track
+		*
+		*  @param[in] sName
+		*    Name of the record to play
+		*
+		*  @return
+		*    'true' if all went fine, else 'false' (there's no track or the camera can't be moved into the scene container of the recording)
+		*/
+		bool StartTrackPlayback(const PLCore::String &sName);
+
+		/**
+		*  @brief
+		*    Called when the playback of "PLEngine::Camcorder" has been finished
+		*/
+		void OnPlaybackFinished();
+
+		/**
+		*  @brief
+		*    Called when the end of the played track has been reached
+		*/
+		void OnTrackFinished();
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		Application					  *m_pApplication;			/**< Owner application, always valid */
+		PLEngine::Camcorder			  *m_pCamcorder;			/**< Camcorder recording and playing the records without a track, always valid */
+		PLScene::SceneNodeHandler	   m_cCameraHandler;		/**< Camera playing the track, no element if no track is played */
+		PLScene::SceneNodeHandler	   m_cContainerHandler;		/**< Scene container the camera was in before the track was played */
+		PLCore::Array<PLCore::String>  m_lstControllers;		/**< Class names of the camera controllers deactivated while the track is played */
+		bool						   m_bTrackFinished;		/**< Has the end of the played track been reached? */
+
+
+};
+
+
+#endif // __DUNGEON_TRACKCAMCORDER_H__
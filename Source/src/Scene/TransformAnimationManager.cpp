@@ -0,0 +1,257 @@
+/*********************************************************\
+ *  File: TransformAnimationManager.cpp                  *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Tools/Timing.h>
+#include <PLMath/Vector3.h>
+#include <PLScene/Scene/SceneNode.h>
+#include <PLScene/Scene/SceneContext.h>
+#include "Tools/Profiler.h"
+#include "Tools/AnimationTools.h"
+#include "SNMTransformRandomAnimation.h"
+#include "Scene/TransformAnimationManager.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+using namespace PLScene;
+
+
+//[-------------------------------------------------------]
+//[ RTTI interface                                        ]
+//[-------------------------------------------------------]
+pl_class_metadata(TransformAnimationManager, "", PLCore::Object, "Batched random transform animation")
+	// Slots
+	pl_slot_0_metadata(OnUpdate,	"Called when the scene context needs to be updated",	"")
+pl_class_metadata_end(TransformAnimationManager)
+
+
+//[-------------------------------------------------------]
+//[ Private static data                                   ]
+//[-------------------------------------------------------]
+TransformAnimationManager *TransformAnimationManager::m_pInstance = nullptr;
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Registers a transform animation
+*/
+void TransformAnimationManager::AddModifier(SNMTransformRandomAnimation &cModifier)
+{
+	SceneContext *pSceneContext = cModifier.GetSceneContext();
+	if (pSceneContext) {
+		// Create the instance on demand
+		if (!m_pInstance)
+			m_pInstance = new TransformAnimationManager(*pSceneContext);
+
+		// Get the animation center
+		SceneNode &cSceneNode = cModifier.GetSceneNode();
+		const uint8 nComponent = static_cast<uint8>(cModifier.GetComponent());
+		Vector3 vCenter;
+		switch (nComponent) {
+			case SNMTransformRandomAnimation::Position:
+				vCenter = cSceneNode.GetPosition();
+				break;
+
+			case SNMTransformRandomAnimation::Rotation:
+				vCenter = cSceneNode.GetRotation();
+				break;
+
+			case SNMTransformRandomAnimation::Scale:
+				vCenter = cSceneNode.GetScale();
+				break;
+		}
+
+		// Add the modifier
+		m_pInstance->m_lstModifiers.Add(&cModifier);
+		m_pInstance->m_lstSceneNodes.Add(&cSceneNode);
+		m_pInstance->m_lstComponents.Add(nComponent);
+		m_pInstance->m_lstSpeed.Add(cModifier.GetSpeed());
+		m_pInstance->m_lstRadius.Add(cModifier.GetRadius());
+		for (uint32 i=0; i<3; i++) {
+			m_pInstance->m_lstCenter.Add(vCenter[i]);
+			m_pInstance->m_lstCurrentOffset.Add(0.0f);
+			m_pInstance->m_lstDestinationOffset.Add(0.0f);
+		}
+
+		// Seed the random number stream by using the absolute name of the scene node and the component
+		m_pInstance->m_lstRandomState.Add(AnimationTools::GetRandomSeed(cSceneNode.GetAbsoluteName(), nComponent));
+	}
+}
+
+/**
+*  @brief
+*    Unregisters a transform animation
+*/
+void TransformAnimationManager::RemoveModifier(SNMTransformRandomAnimation &cModifier)
+{
+	if (m_pInstance) {
+		const int nIndex = m_pInstance->m_lstModifiers.GetIndex(&cModifier);
+		if (nIndex >= 0) {
+			// Restore the animation center
+			SetComponent(*m_pInstance->m_lstSceneNodes[nIndex], m_pInstance->m_lstComponents[nIndex], &m_pInstance->m_lstCenter.GetData()[nIndex*3]);
+
+			// Remove the modifier, the order of the modifiers doesn't matter
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstModifiers,         nIndex);
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstSceneNodes,        nIndex);
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstComponents,        nIndex);
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstSpeed,             nIndex);
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstRadius,            nIndex);
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstRandomState,       nIndex);
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstCenter,            nIndex, 3);
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstCurrentOffset,     nIndex, 3);
+			AnimationTools::RemoveBySwap(m_pInstance->m_lstDestinationOffset, nIndex, 3);
+
+			// Destroy the instance if it's no longer required
+			if (!m_pInstance->m_lstModifiers.GetNumOfElements()) {
+				delete m_pInstance;
+				m_pInstance = nullptr;
+			}
+		}
+	}
+}
+
+/**
+*  @brief
+*    Updates the parameters (speed and radius) of a registered transform animation
+*/
+void TransformAnimationManager::UpdateModifier(const SNMTransformRandomAnimation &cModifier)
+{
+	if (m_pInstance) {
+		const int nIndex = m_pInstance->m_lstModifiers.GetIndex(const_cast<SNMTransformRandomAnimation*>(&cModifier));
+		if (nIndex >= 0) {
+			m_pInstance->m_lstSpeed[nIndex]  = cModifier.GetSpeed();
+			m_pInstance->m_lstRadius[nIndex] = cModifier.GetRadius();
+		}
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+TransformAnimationManager::TransformAnimationManager(SceneContext &cSceneContext) :
+	SlotOnUpdate(this),
+	m_pSceneContext(&cSceneContext)
+{
+	// Connect event handler
+	m_pSceneContext->EventUpdate.Connect(SlotOnUpdate);
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+TransformAnimationManager::~TransformAnimationManager()
+{
+	// Disconnect event handler
+	m_pSceneContext->EventUpdate.Disconnect(SlotOnUpdate);
+}
+
+/**
+*  @brief
+*    Called when the scene context needs to be updated
+*/
+void TransformAnimationManager::OnUpdate()
+{
+	ProfilerScope cProfilerScope("Transform animation");
+
+	const uint32 nNumOfModifiers = m_lstModifiers.GetNumOfElements();
+	const float  fTimeDiff       = Timing::GetInstance()->GetTimeDifference();
+
+	const float *pfSpeed             = m_lstSpeed.GetData();
+	const float *pfRadius            = m_lstRadius.GetData();
+	const float *pfCenter            = m_lstCenter.GetData();
+	float       *pfCurrentOffset     = m_lstCurrentOffset.GetData();
+	float       *pfDestinationOffset = m_lstDestinationOffset.GetData();
+	uint32      *pnRandomState       = m_lstRandomState.GetData();
+
+	// First pass: Animate the offsets, three per modifier (same movement as the former "SNMPositionRandomAnimation.lua" script)
+	for (uint32 i=0; i<nNumOfModifiers*3; i++) {
+		const uint32 nModifier = i/3;
+		const float fStep = fTimeDiff*pfSpeed[nModifier];
+		float fCurrentOffset = pfCurrentOffset[i];
+		const float fDestinationOffset = pfDestinationOffset[i];
+		if (fCurrentOffset <= fDestinationOffset) {
+			fCurrentOffset += fStep;
+			if (fCurrentOffset >= fDestinationOffset) {
+				// Clamp and choose a new destination
+				fCurrentOffset = fDestinationOffset;
+				pfDestinationOffset[i] = AnimationTools::GetRandNegFloat(pnRandomState[nModifier])*pfRadius[nModifier];
+			}
+		} else {
+			fCurrentOffset -= fStep;
+			if (fCurrentOffset <= fDestinationOffset) {
+				// Clamp and choose a new destination
+				fCurrentOffset = fDestinationOffset;
+				pfDestinationOffset[i] = AnimationTools::GetRandNegFloat(pnRandomState[nModifier])*pfRadius[nModifier];
+			}
+		}
+		pfCurrentOffset[i] = fCurrentOffset;
+	}
+
+	// Second pass: Write the transform components as typed vectors
+	const uint8 *pnComponents  = m_lstComponents.GetData();
+	SceneNode  **ppSceneNodes  = m_lstSceneNodes.GetData();
+	for (uint32 i=0; i<nNumOfModifiers; i++) {
+		const float fValue[3] = {
+			pfCenter[i*3]     + pfCurrentOffset[i*3],
+			pfCenter[i*3 + 1] + pfCurrentOffset[i*3 + 1],
+			pfCenter[i*3 + 2] + pfCurrentOffset[i*3 + 2]
+		};
+		SetComponent(*ppSceneNodes[i], pnComponents[i], fValue);
+	}
+}
+
+/**
+*  @brief
+*    Writes a transform component into a scene node
+*/
+void TransformAnimationManager::SetComponent(SceneNode &cSceneNode, uint8 nComponent, const float *pfValue)
+{
+	const Vector3 vValue(pfValue[0], pfValue[1], pfValue[2]);
+	switch (nComponent) {
+		case SNMTransformRandomAnimation::Position:
+			cSceneNode.SetPosition(vValue);
+			break;
+
+		case SNMTransformRandomAnimation::Rotation:
+			cSceneNode.SetRotation(vValue);
+			break;
+
+		case SNMTransformRandomAnimation::Scale:
+			cSceneNode.SetScale(vValue);
+			break;
+	}
+}
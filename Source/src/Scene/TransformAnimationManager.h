@@ -0,0 +1,177 @@
+/*********************************************************\
+ *  File: TransformAnimationManager.h                    *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_TRANSFORMANIMATIONMANAGER_H__
+#define __DUNGEON_TRANSFORMANIMATIONMANAGER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Base/Object.h>
+#include <PLCore/Container/Array.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLScene {
+	class SceneNode;
+	class SceneContext;
+}
+class SNMTransformRandomAnimation;
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Batched random transform animation
+*
+*  @remarks
+*    Updates all active "SNMTransformRandomAnimation" instances within a single pass per frame and writes
+*    the results as typed vectors into the scene nodes. The animation state is stored as structure of arrays
+*    with three offsets per modifier, every modifier has its own random number stream seeded by the absolute
+*    name of the owner scene node and the animated component (so the animation is deterministic).
+*
+*    There's at most one instance (the application has a single scene context), it's created by the first
+*    registered modifier and destroyed when the last modifier is unregistered.
+*/
+class TransformAnimationManager : public PLCore::Object {
+
+
+	//[-------------------------------------------------------]
+	//[ RTTI interface                                        ]
+	//[-------------------------------------------------------]
+	pl_class_def()
+		// Slots
+		pl_slot_0_def(TransformAnimationManager, OnUpdate)
+	pl_class_def_end
+
+
+	//[-------------------------------------------------------]
+	//[ Public static functions                               ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Registers a transform animation
+		*
+		*  @param[in] cModifier
+		*    Transform animation to register, must not be registered yet
+		*
+		*  @note
+		*    - The current value of the animated transform component of the owner scene node is the animation center
+		*/
+		static void AddModifier(SNMTransformRandomAnimation &cModifier);
+
+		/**
+		*  @brief
+		*    Unregisters a transform animation
+		*
+		*  @param[in] cModifier
+		*    Transform animation to unregister
+		*
+		*  @note
+		*    - The animated transform component of the owner scene node is set back to the animation center
+		*/
+		static void RemoveModifier(SNMTransformRandomAnimation &cModifier);
+
+		/**
+		*  @brief
+		*    Updates the parameters (speed and radius) of a registered transform animation
+		*
+		*  @param[in] cModifier
+		*    Transform animation to update, if it's not registered nothing happens
+		*/
+		static void UpdateModifier(const SNMTransformRandomAnimation &cModifier);
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cSceneContext
+		*    Scene context to use
+		*/
+		TransformAnimationManager(PLScene::SceneContext &cSceneContext);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		virtual ~TransformAnimationManager();
+
+		/**
+		*  @brief
+		*    Called when the scene context needs to be updated
+		*/
+		void OnUpdate();
+
+		/**
+		*  @brief
+		*    Writes a transform component into a scene node
+		*
+		*  @param[in] cSceneNode
+		*    Scene node to write into
+		*  @param[in] nComponent
+		*    Transform component to write (see "SNMTransformRandomAnimation::EComponent")
+		*  @param[in] pfValue
+		*    The three values to write
+		*/
+		static void SetComponent(PLScene::SceneNode &cSceneNode, PLCore::uint8 nComponent, const float *pfValue);
+
+
+	//[-------------------------------------------------------]
+	//[ Private static data                                   ]
+	//[-------------------------------------------------------]
+	private:
+		static TransformAnimationManager *m_pInstance;	/**< The transform animation manager instance, can be a null pointer */
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLScene::SceneContext *m_pSceneContext;	/**< Used scene context, always valid */
+		// Per modifier data, all arrays have the same number of elements (times three for the per axis data)
+		PLCore::Array<SNMTransformRandomAnimation*> m_lstModifiers;				/**< Registered transform animations, always valid */
+		PLCore::Array<PLScene::SceneNode*>			m_lstSceneNodes;			/**< Animated scene nodes, always valid */
+		PLCore::Array<PLCore::uint8>				m_lstComponents;			/**< Animated transform components (see "SNMTransformRandomAnimation::EComponent") */
+		PLCore::Array<float>						m_lstSpeed;					/**< Animation speed */
+		PLCore::Array<float>						m_lstRadius;				/**< Animation radius */
+		PLCore::Array<PLCore::uint32>				m_lstRandomState;			/**< Random number stream state */
+		PLCore::Array<float>						m_lstCenter;				/**< Animation center, x, y, z per modifier */
+		PLCore::Array<float>						m_lstCurrentOffset;			/**< Current offset from the center, x, y, z per modifier */
+		PLCore::Array<float>						m_lstDestinationOffset;		/**< Destination offset from the center, x, y, z per modifier */
+
+
+};
+
+
+#endif // __DUNGEON_TRANSFORMANIMATIONMANAGER_H__
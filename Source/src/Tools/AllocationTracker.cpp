@@ -0,0 +1,191 @@
+/*********************************************************\
+ *  File: AllocationTracker.cpp                          *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#ifdef DUNGEON_ALLOCATION_TRACKING
+	#include <stdlib.h>
+	#ifdef WIN32
+		#include <new>
+	#endif
+#endif
+#include "Tools/AllocationTracker.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+#ifdef DUNGEON_ALLOCATION_TRACKING
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+#ifdef WIN32
+	#define ALLOCATION_TRACKER_THREAD_LOCAL __declspec(thread)
+#else
+	#define ALLOCATION_TRACKER_THREAD_LOCAL __thread
+#endif
+
+// The thread local counters of the executable don't allocate, so they can be used within the allocation functions
+static ALLOCATION_TRACKER_THREAD_LOCAL uint32 g_nNumOfAllocations = 0;	/**< Number of allocations of the current thread */
+static ALLOCATION_TRACKER_THREAD_LOCAL uint32 g_nAllocatedBytes	  = 0;	/**< Number of allocated bytes of the current thread */
+
+
+//[-------------------------------------------------------]
+//[ Local functions                                       ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Counts an allocation of the current thread
+*/
+static inline void CountAllocation(size_t nSize)
+{
+	g_nNumOfAllocations++;
+	g_nAllocatedBytes += static_cast<uint32>(nSize);
+}
+
+
+//[-------------------------------------------------------]
+//[ Allocation functions                                  ]
+//[-------------------------------------------------------]
+#ifdef WIN32
+	// The global operators of the executable, the PixelLight libraries have their own
+	void *operator new(size_t nSize)
+	{
+		CountAllocation(nSize);
+		void *pMemory = malloc(nSize ? nSize : 1);
+		if (!pMemory)
+			throw std::bad_alloc();
+		return pMemory;
+	}
+
+	void *operator new[](size_t nSize)
+	{
+		return operator new(nSize);
+	}
+
+	void *operator new(size_t nSize, const std::nothrow_t &)
+	{
+		CountAllocation(nSize);
+		return malloc(nSize ? nSize : 1);
+	}
+
+	void *operator new[](size_t nSize, const std::nothrow_t &cNoThrow)
+	{
+		return operator new(nSize, cNoThrow);
+	}
+
+	void operator delete(void *pMemory)
+	{
+		free(pMemory);
+	}
+
+	void operator delete[](void *pMemory)
+	{
+		free(pMemory);
+	}
+
+	void operator delete(void *pMemory, const std::nothrow_t &)
+	{
+		free(pMemory);
+	}
+
+	void operator delete[](void *pMemory, const std::nothrow_t &)
+	{
+		free(pMemory);
+	}
+#elif defined(LINUX)
+	// Replace the C allocation functions of the whole process, "new" ends within them as well - they have to be visible
+	// to the shared libraries
+	extern "C" {
+		void *__libc_malloc(size_t nSize);
+		void *__libc_calloc(size_t nNumOfElements, size_t nSize);
+		void *__libc_realloc(void *pMemory, size_t nSize);
+
+		__attribute__((visibility("default"))) void *malloc(size_t nSize)
+		{
+			CountAllocation(nSize);
+			return __libc_malloc(nSize);
+		}
+
+		__attribute__((visibility("default"))) void *calloc(size_t nNumOfElements, size_t nSize)
+		{
+			CountAllocation(nNumOfElements*nSize);
+			return __libc_calloc(nNumOfElements, nSize);
+		}
+
+		__attribute__((visibility("default"))) void *realloc(void *pMemory, size_t nSize)
+		{
+			// Shrinking or growing a block is an allocation as well
+			if (nSize)
+				CountAllocation(nSize);
+			return __libc_realloc(pMemory, nSize);
+		}
+	}
+#endif
+#endif
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Returns whether or not the allocation tracker is compiled in
+*/
+bool AllocationTracker::IsEnabled()
+{
+	#ifdef DUNGEON_ALLOCATION_TRACKING
+		return true;
+	#else
+		return false;
+	#endif
+}
+
+/**
+*  @brief
+*    Returns the number of allocations of the current thread
+*/
+uint32 AllocationTracker::GetNumOfAllocations()
+{
+	#ifdef DUNGEON_ALLOCATION_TRACKING
+		return g_nNumOfAllocations;
+	#else
+		return 0;
+	#endif
+}
+
+/**
+*  @brief
+*    Returns the number of allocated bytes of the current thread
+*/
+uint32 AllocationTracker::GetAllocatedBytes()
+{
+	#ifdef DUNGEON_ALLOCATION_TRACKING
+		return g_nAllocatedBytes;
+	#else
+		return 0;
+	#endif
+}
@@ -0,0 +1,91 @@
+/*********************************************************\
+ *  File: AllocationTracker.h                            *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_ALLOCATIONTRACKER_H__
+#define __DUNGEON_ALLOCATIONTRACKER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/PLCore.h>
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Allocation tracker, counts the heap allocations of each thread
+*
+*  @remarks
+*    The tracker is only compiled in if "DUNGEON_ALLOCATION_TRACKING" is defined (CMake option of the same name). Then
+*    each thread counts its allocations and allocated bytes, the profiler stores the counters within its events so the
+*    allocations are attributed to the profiler scopes and frames (see "Profiler") and shown within the profiler window.
+*    A steady state frame should show zero allocations.
+*
+*    On Linux, "malloc()", "calloc()" and "realloc()" are replaced and forward to the glibc implementation, this covers
+*    "new" as well as the allocations of the PixelLight libraries. On Windows, the global "new" and "delete" operators of
+*    the executable are replaced, the PixelLight libraries use their own C runtime heap so their allocations are not seen.
+*
+*    The counters wrap around, use the difference of two counter values of the same thread.
+*/
+class AllocationTracker {
+
+
+	//[-------------------------------------------------------]
+	//[ Public static functions                               ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Returns whether or not the allocation tracker is compiled in
+		*
+		*  @return
+		*    'true' if the allocations are tracked, else 'false' (the counters are always 0)
+		*/
+		static bool IsEnabled();
+
+		/**
+		*  @brief
+		*    Returns the number of allocations of the current thread
+		*
+		*  @return
+		*    The number of allocations of the current thread (wraps around)
+		*/
+		static PLCore::uint32 GetNumOfAllocations();
+
+		/**
+		*  @brief
+		*    Returns the number of allocated bytes of the current thread
+		*
+		*  @return
+		*    The number of allocated bytes of the current thread (wraps around)
+		*/
+		static PLCore::uint32 GetAllocatedBytes();
+
+
+};
+
+
+#endif // __DUNGEON_ALLOCATIONTRACKER_H__
@@ -0,0 +1,53 @@
+/*********************************************************\
+ *  File: AnimationTools.cpp                             *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include "Tools/AnimationTools.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Returns a random number stream seed
+*/
+uint32 AnimationTools::GetRandomSeed(const String &sName, uint32 nValue)
+{
+	// FNV-1a over the name and the additional value
+	uint32 nSeed = 2166136261u;
+	for (uint32 i=0; i<sName.GetLength(); i++)
+		nSeed = (nSeed ^ static_cast<uint8>(sName[i]))*16777619u;
+	nSeed = (nSeed ^ nValue)*16777619u;
+
+	// Zero is no valid xorshift state
+	return nSeed ? nSeed : 1;
+}
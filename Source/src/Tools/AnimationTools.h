@@ -0,0 +1,113 @@
+/*********************************************************\
+ *  File: AnimationTools.h                               *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_ANIMATIONTOOLS_H__
+#define __DUNGEON_ANIMATIONTOOLS_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Container/Array.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLCore {
+	class String;
+}
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Static helpers shared by the batched animation managers
+*
+*  @remarks
+*    The animation managers keep their data within parallel arrays and give each animation an own xorshift random
+*    number stream, so the animation doesn't depend on the order in which the animations were registered.
+*/
+class AnimationTools {
+
+
+	//[-------------------------------------------------------]
+	//[ Public static functions                               ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Returns a random number stream seed
+		*
+		*  @param[in] sName
+		*    Name the seed is derived from, usually the absolute name of the animated scene node
+		*  @param[in] nValue
+		*    Additional value which is mixed into the seed, used to give several streams of the same node different seeds
+		*
+		*  @return
+		*    The seed (FNV-1a hash), never 0 because that's no valid xorshift state
+		*/
+		static PLCore::uint32 GetRandomSeed(const PLCore::String &sName, PLCore::uint32 nValue = 0);
+
+		/**
+		*  @brief
+		*    Returns the next random number within [-1, 1] of a random number stream
+		*
+		*  @param[in, out] nState
+		*    Random number stream state, must not be 0
+		*
+		*  @return
+		*    The next random number within [-1, 1]
+		*/
+		static inline float GetRandNegFloat(PLCore::uint32 &nState);
+
+		/**
+		*  @brief
+		*    Removes a group of elements by moving the last group into its place
+		*
+		*  @param[in, out] lstArray
+		*    Array to remove the elements from
+		*  @param[in] nIndex
+		*    Index of the group to remove
+		*  @param[in] nGroupSize
+		*    Number of elements per group
+		*
+		*  @note
+		*    - The order of the elements isn't kept
+		*/
+		template <typename T>
+		static inline void RemoveBySwap(PLCore::Array<T> &lstArray, PLCore::uint32 nIndex, PLCore::uint32 nGroupSize = 1);
+
+
+};
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "Tools/AnimationTools.inl"
+
+
+#endif // __DUNGEON_ANIMATIONTOOLS_H__
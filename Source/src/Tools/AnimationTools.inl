@@ -0,0 +1,54 @@
+/*********************************************************\
+ *  File: AnimationTools.inl                             *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Returns the next random number within [-1, 1] of a random number stream
+*/
+inline float AnimationTools::GetRandNegFloat(PLCore::uint32 &nState)
+{
+	// xorshift32
+	nState ^= nState << 13;
+	nState ^= nState >> 17;
+	nState ^= nState << 5;
+	return static_cast<float>(nState)*(2.0f/4294967295.0f) - 1.0f;
+}
+
+/**
+*  @brief
+*    Removes a group of elements by moving the last group into its place
+*/
+template <typename T>
+inline void AnimationTools::RemoveBySwap(PLCore::Array<T> &lstArray, PLCore::uint32 nIndex, PLCore::uint32 nGroupSize)
+{
+	const PLCore::uint32 nFirst = nIndex*nGroupSize;
+	const PLCore::uint32 nLast  = lstArray.GetNumOfElements() - nGroupSize;
+	if (nFirst != nLast) {
+		for (PLCore::uint32 i=0; i<nGroupSize; i++)
+			lstArray[nFirst + i] = lstArray[nLast + i];
+	}
+	for (PLCore::uint32 i=0; i<nGroupSize; i++)
+		lstArray.RemoveAtIndex(lstArray.GetNumOfElements() - 1);
+}
@@ -0,0 +1,511 @@
+/*********************************************************\
+ *  File: CamcorderTrack.cpp                             *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/File/File.h>
+#include <PLCore/Tools/LoadableManager.h>
+#include <PLMath/Math.h>
+#include <PLMath/Vector3.h>
+#include <PLMath/Quaternion.h>
+#include "Tools/CamcorderTrack.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+static const uint32 MaxKeyDistance = 1024;			/**< Maximum number of frames between two stored keys, limits the key reduction costs */
+static const float  Sqrt2          = 1.41421356f;	/**< Square root of 2, the three smallest quaternion components are within [-1/sqrt(2), 1/sqrt(2)] */
+
+
+//[-------------------------------------------------------]
+//[ Local functions                                       ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Returns the given size rounded up to a multiple of 4
+*/
+static uint32 Align4(uint32 nSize)
+{
+	return (nSize + 3) & ~3;
+}
+
+/**
+*  @brief
+*    Interpolates linearly between two positions
+*/
+static void Interpolate(const Vector3 &vPosition1, const Vector3 &vPosition2, float fFactor, Vector3 &vPosition)
+{
+	vPosition = vPosition1 + (vPosition2 - vPosition1)*fFactor;
+}
+
+/**
+*  @brief
+*    Interpolates between two rotations (normalized linear interpolation, taking the shortest path)
+*/
+static void Interpolate(const Quaternion &qRotation1, const Quaternion &qRotation2, float fFactor, Quaternion &qRotation)
+{
+	const float fSign = (qRotation1.w*qRotation2.w + qRotation1.x*qRotation2.x + qRotation1.y*qRotation2.y + qRotation1.z*qRotation2.z < 0.0f) ? -1.0f : 1.0f;
+	qRotation.w = qRotation1.w + (qRotation2.w*fSign - qRotation1.w)*fFactor;
+	qRotation.x = qRotation1.x + (qRotation2.x*fSign - qRotation1.x)*fFactor;
+	qRotation.y = qRotation1.y + (qRotation2.y*fSign - qRotation1.y)*fFactor;
+	qRotation.z = qRotation1.z + (qRotation2.z*fSign - qRotation1.z)*fFactor;
+	const float fLength = Math::Sqrt(qRotation.w*qRotation.w + qRotation.x*qRotation.x + qRotation.y*qRotation.y + qRotation.z*qRotation.z);
+	if (fLength > 0.0f) {
+		qRotation.w /= fLength;
+		qRotation.x /= fLength;
+		qRotation.y /= fLength;
+		qRotation.z /= fLength;
+	}
+}
+
+/**
+*  @brief
+*    Returns the error between two positions (distance)
+*/
+static float GetError(const Vector3 &vPosition1, const Vector3 &vPosition2)
+{
+	return (vPosition1 - vPosition2).GetLength();
+}
+
+/**
+*  @brief
+*    Returns the error between two rotations (1 - cos(angle/2), see "Save()")
+*/
+static float GetError(const Quaternion &qRotation1, const Quaternion &qRotation2)
+{
+	return 1.0f - Math::Abs(qRotation1.w*qRotation2.w + qRotation1.x*qRotation2.x + qRotation1.y*qRotation2.y + qRotation1.z*qRotation2.z);
+}
+
+/**
+*  @brief
+*    Error bounded key reduction, keeps a key only if it can't be interpolated from the previous kept key and a later one
+*/
+template <typename T>
+static void ReduceKeys(const Array<T> &lstValues, float fMaxError, Array<uint32> &lstKeys)
+{
+	const uint32 nNumOfValues = lstValues.GetNumOfElements();
+	lstKeys.Add(0);
+	uint32 nStart = 0;
+	while (nStart + 1 < nNumOfValues) {
+		// Extend the interpolated span as far as all values in between are within the error
+		uint32 nEnd = nStart + 1;
+		while (nEnd + 1 < nNumOfValues && nEnd + 1 - nStart <= MaxKeyDistance) {
+			const uint32 nCandidate = nEnd + 1;
+			bool bValid = true;
+			for (uint32 i=nStart+1; i<nCandidate && bValid; i++) {
+				T cValue;
+				Interpolate(lstValues[nStart], lstValues[nCandidate], static_cast<float>(i - nStart)/static_cast<float>(nCandidate - nStart), cValue);
+				bValid = (GetError(cValue, lstValues[i]) <= fMaxError);
+			}
+			if (!bValid)
+				break;
+			nEnd = nCandidate;
+		}
+		lstKeys.Add(nEnd);
+		nStart = nEnd;
+	}
+}
+
+/**
+*  @brief
+*    Encodes a rotation as the three smallest components, the index of the largest component is within the highest bits
+*/
+static void EncodeRotation(const Quaternion &qRotation, uint16 *pnRotation)
+{
+	const float fComponents[4] = { qRotation.w, qRotation.x, qRotation.y, qRotation.z };
+
+	// Find the largest component, the quaternion is negated if it's negative so it can be restored from the others
+	uint32 nLargest = 0;
+	for (uint32 i=1; i<4; i++) {
+		if (Math::Abs(fComponents[i]) > Math::Abs(fComponents[nLargest]))
+			nLargest = i;
+	}
+	const float fSign = (fComponents[nLargest] < 0.0f) ? -1.0f : 1.0f;
+
+	// Quantize the three smallest components to 15 bit
+	for (uint32 i=0, nComponent=0; i<4; i++) {
+		if (i != nLargest) {
+			const float fValue = (fComponents[i]*fSign*Sqrt2*0.5f + 0.5f)*32767.0f + 0.5f;
+			pnRotation[nComponent++] = static_cast<uint16>((fValue < 0.0f) ? 0 : ((fValue > 32767.0f) ? 32767 : fValue));
+		}
+	}
+	pnRotation[0] |= static_cast<uint16>((nLargest & 1) << 15);
+	pnRotation[1] |= static_cast<uint16>((nLargest & 2) << 14);
+}
+
+/**
+*  @brief
+*    Decodes a rotation encoded by "EncodeRotation()"
+*/
+static void DecodeRotation(const uint16 *pnRotation, Quaternion &qRotation)
+{
+	const uint32 nLargest = (pnRotation[0] >> 15) | ((pnRotation[1] >> 15) << 1);
+	float fComponents[4];
+	float fSum = 0.0f;
+	for (uint32 i=0, nComponent=0; i<4; i++) {
+		if (i != nLargest) {
+			const float fValue = ((static_cast<float>(pnRotation[nComponent++] & 0x7FFF)/32767.0f)*2.0f - 1.0f)/Sqrt2;
+			fComponents[i] = fValue;
+			fSum += fValue*fValue;
+		}
+	}
+	fComponents[nLargest] = (fSum < 1.0f) ? Math::Sqrt(1.0f - fSum) : 0.0f;
+	qRotation.w = fComponents[0];
+	qRotation.x = fComponents[1];
+	qRotation.y = fComponents[2];
+	qRotation.z = fComponents[3];
+}
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Writes a track
+*/
+bool CamcorderTrack::Save(const String &sFilename, float fFramesPerSecond, const Array<Vector3> &lstPositions, const Array<Quaternion> &lstRotations, float fMaxPositionError, float fMaxRotationError)
+{
+	// Check the keys
+	const uint32 nNumOfFrames = lstPositions.GetNumOfElements();
+	if (!nNumOfFrames || lstRotations.GetNumOfElements() != nNumOfFrames || fFramesPerSecond <= 0.0f)
+		return false; // Error!
+
+	// Reduce the keys, the rotation error is compared as "1 - cos(angle/2)" so no inverse cosine is required
+	Array<uint32> lstPositionKeys, lstRotationKeys;
+	ReduceKeys(lstPositions, fMaxPositionError, lstPositionKeys);
+	ReduceKeys(lstRotations, 1.0f - Math::Cos(fMaxRotationError*static_cast<float>(Math::Pi)/360.0f), lstRotationKeys);
+
+	// Get the position quantization within the bounding box of the stored position keys
+	SHeader sHeader;
+	sHeader.nMagic			   = 0;	// Written after everything else went fine
+	sHeader.nVersion		   = Version;
+	sHeader.fFramesPerSecond   = fFramesPerSecond;
+	sHeader.nNumOfFrames	   = nNumOfFrames;
+	sHeader.nNumOfPositionKeys = lstPositionKeys.GetNumOfElements();
+	sHeader.nNumOfRotationKeys = lstRotationKeys.GetNumOfElements();
+	Vector3 vMin = lstPositions[0];
+	Vector3 vMax = lstPositions[0];
+	for (uint32 i=1; i<lstPositionKeys.GetNumOfElements(); i++) {
+		const Vector3 &vPosition = lstPositions[lstPositionKeys[i]];
+		for (uint32 nComponent=0; nComponent<3; nComponent++) {
+			if (vMin[nComponent] > vPosition[nComponent])
+				vMin[nComponent] = vPosition[nComponent];
+			if (vMax[nComponent] < vPosition[nComponent])
+				vMax[nComponent] = vPosition[nComponent];
+		}
+	}
+	for (uint32 nComponent=0; nComponent<3; nComponent++) {
+		sHeader.fPositionMin[nComponent]   = vMin[nComponent];
+		sHeader.fPositionScale[nComponent] = (vMax[nComponent] - vMin[nComponent])/65535.0f;
+	}
+
+	// Create the track file
+	File cFile(sFilename);
+	if (!cFile.Open(File::FileCreate | File::FileWrite))
+		return false; // Error!
+	cFile.Write(&sHeader, sizeof(SHeader), 1);
+	const uint16 nPadding = 0;
+
+	// Write the position keys
+	for (uint32 i=0; i<lstPositionKeys.GetNumOfElements(); i++)
+		cFile.Write(&lstPositionKeys[i], sizeof(uint32), 1);
+	for (uint32 i=0; i<lstPositionKeys.GetNumOfElements(); i++) {
+		const Vector3 &vPosition = lstPositions[lstPositionKeys[i]];
+		uint16 nPosition[3];
+		for (uint32 nComponent=0; nComponent<3; nComponent++) {
+			const float fScale = sHeader.fPositionScale[nComponent];
+			const float fValue = (fScale > 0.0f) ? ((vPosition[nComponent] - sHeader.fPositionMin[nComponent])/fScale + 0.5f) : 0.0f;
+			nPosition[nComponent] = static_cast<uint16>((fValue > 65535.0f) ? 65535 : fValue);
+		}
+		cFile.Write(nPosition, sizeof(uint16), 3);
+	}
+	if (lstPositionKeys.GetNumOfElements() & 1)
+		cFile.Write(&nPadding, sizeof(uint16), 1);
+
+	// Write the rotation keys
+	for (uint32 i=0; i<lstRotationKeys.GetNumOfElements(); i++)
+		cFile.Write(&lstRotationKeys[i], sizeof(uint32), 1);
+	for (uint32 i=0; i<lstRotationKeys.GetNumOfElements(); i++) {
+		uint16 nRotation[3];
+		EncodeRotation(lstRotations[lstRotationKeys[i]], nRotation);
+		cFile.Write(nRotation, sizeof(uint16), 3);
+	}
+	if (lstRotationKeys.GetNumOfElements() & 1)
+		cFile.Write(&nPadding, sizeof(uint16), 1);
+
+	// Finalize the header
+	const uint32 nMagic = Magic;
+	cFile.Seek(0);
+	cFile.Write(&nMagic, sizeof(uint32), 1);
+	cFile.Close();
+
+	// Done
+	return true;
+}
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Default constructor
+*/
+CamcorderTrack::CamcorderTrack() :
+	m_pHeader(nullptr),
+	m_pnPositionFrames(nullptr),
+	m_pnPositions(nullptr),
+	m_pnRotationFrames(nullptr),
+	m_pnRotations(nullptr)
+{
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+CamcorderTrack::~CamcorderTrack()
+{
+}
+
+/**
+*  @brief
+*    Opens a track
+*/
+bool CamcorderTrack::Open(const String &sFilename)
+{
+	// Close the previously opened track
+	Close();
+
+	// Map the track file, the loadable manager takes care of the base directories
+	File cFile;
+	if (LoadableManager::GetInstance()->OpenFile(cFile, sFilename, false)) {
+		const String sNativePath = cFile.GetUrl().GetNativePath();
+		cFile.Close();
+		if (m_cFile.Open(sNativePath) && m_cFile.GetSize() >= sizeof(SHeader)) {
+			// Check the header
+			const uint8   *pData   = m_cFile.GetData();
+			const SHeader *pHeader = reinterpret_cast<const SHeader*>(pData);
+			if (pHeader->nMagic == Magic && pHeader->nVersion == Version && pHeader->fFramesPerSecond > 0.0f &&
+				pHeader->nNumOfFrames && pHeader->nNumOfPositionKeys && pHeader->nNumOfRotationKeys) {
+				// Check the size and get the sections
+				const uint32 nPositionFramesOffset = sizeof(SHeader);
+				const uint32 nPositionsOffset	   = nPositionFramesOffset + pHeader->nNumOfPositionKeys*sizeof(uint32);
+				const uint32 nRotationFramesOffset = nPositionsOffset + Align4(pHeader->nNumOfPositionKeys*sizeof(uint16)*3);
+				const uint32 nRotationsOffset	   = nRotationFramesOffset + pHeader->nNumOfRotationKeys*sizeof(uint32);
+				const uint32 nSize				   = nRotationsOffset + Align4(pHeader->nNumOfRotationKeys*sizeof(uint16)*3);
+				if (nSize <= m_cFile.GetSize()) {
+					m_pHeader		   = pHeader;
+					m_pnPositionFrames = reinterpret_cast<const uint32*>(pData + nPositionFramesOffset);
+					m_pnPositions	   = reinterpret_cast<const uint16*>(pData + nPositionsOffset);
+					m_pnRotationFrames = reinterpret_cast<const uint32*>(pData + nRotationFramesOffset);
+					m_pnRotations	   = reinterpret_cast<const uint16*>(pData + nRotationsOffset);
+
+					// Done
+					return true;
+				}
+			}
+		}
+	}
+
+	// Error!
+	Close();
+	return false;
+}
+
+/**
+*  @brief
+*    Closes the track
+*/
+void CamcorderTrack::Close()
+{
+	m_cFile.Close();
+	m_pHeader		   = nullptr;
+	m_pnPositionFrames = nullptr;
+	m_pnPositions	   = nullptr;
+	m_pnRotationFrames = nullptr;
+	m_pnRotations	   = nullptr;
+}
+
+/**
+*  @brief
+*    Returns whether or not a track is opened
+*/
+bool CamcorderTrack::IsOpen() const
+{
+	return (m_pHeader != nullptr);
+}
+
+/**
+*  @brief
+*    Returns the duration of the track
+*/
+float CamcorderTrack::GetDuration() const
+{
+	return m_pHeader ? static_cast<float>(m_pHeader->nNumOfFrames - 1)/m_pHeader->fFramesPerSecond : 0.0f;
+}
+
+/**
+*  @brief
+*    Returns the frames per second of the original keys
+*/
+float CamcorderTrack::GetFramesPerSecond() const
+{
+	return m_pHeader ? m_pHeader->fFramesPerSecond : 0.0f;
+}
+
+/**
+*  @brief
+*    Returns the number of stored position keys
+*/
+uint32 CamcorderTrack::GetNumOfPositionKeys() const
+{
+	return m_pHeader ? m_pHeader->nNumOfPositionKeys : 0;
+}
+
+/**
+*  @brief
+*    Returns the number of stored rotation keys
+*/
+uint32 CamcorderTrack::GetNumOfRotationKeys() const
+{
+	return m_pHeader ? m_pHeader->nNumOfRotationKeys : 0;
+}
+
+/**
+*  @brief
+*    Evaluates the position at a given time
+*/
+void CamcorderTrack::GetPosition(float fTime, Vector3 &vPosition) const
+{
+	if (m_pHeader) {
+		uint32 nKey;
+		float fFactor;
+		FindKeys(m_pnPositionFrames, m_pHeader->nNumOfPositionKeys, fTime, nKey, fFactor);
+
+		// Dequantize and interpolate
+		const uint16 *pnPosition = &m_pnPositions[nKey*3];
+		const Vector3 vPosition1(m_pHeader->fPositionMin[0] + pnPosition[0]*m_pHeader->fPositionScale[0],
+								 m_pHeader->fPositionMin[1] + pnPosition[1]*m_pHeader->fPositionScale[1],
+								 m_pHeader->fPositionMin[2] + pnPosition[2]*m_pHeader->fPositionScale[2]);
+		if (fFactor > 0.0f) {
+			pnPosition += 3;
+			const Vector3 vPosition2(m_pHeader->fPositionMin[0] + pnPosition[0]*m_pHeader->fPositionScale[0],
+									 m_pHeader->fPositionMin[1] + pnPosition[1]*m_pHeader->fPositionScale[1],
+									 m_pHeader->fPositionMin[2] + pnPosition[2]*m_pHeader->fPositionScale[2]);
+			Interpolate(vPosition1, vPosition2, fFactor, vPosition);
+		} else {
+			vPosition = vPosition1;
+		}
+	}
+}
+
+/**
+*  @brief
+*    Evaluates the rotation at a given time
+*/
+void CamcorderTrack::GetRotation(float fTime, Quaternion &qRotation) const
+{
+	if (m_pHeader) {
+		uint32 nKey;
+		float fFactor;
+		FindKeys(m_pnRotationFrames, m_pHeader->nNumOfRotationKeys, fTime, nKey, fFactor);
+
+		// Decode and interpolate
+		Quaternion qRotation1;
+		DecodeRotation(&m_pnRotations[nKey*3], qRotation1);
+		if (fFactor > 0.0f) {
+			Quaternion qRotation2;
+			DecodeRotation(&m_pnRotations[(nKey + 1)*3], qRotation2);
+			Interpolate(qRotation1, qRotation2, fFactor, qRotation);
+		} else {
+			qRotation = qRotation1;
+		}
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+CamcorderTrack::CamcorderTrack(const CamcorderTrack &cSource) :
+	m_pHeader(nullptr),
+	m_pnPositionFrames(nullptr),
+	m_pnPositions(nullptr),
+	m_pnRotationFrames(nullptr),
+	m_pnRotations(nullptr)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+CamcorderTrack &CamcorderTrack::operator =(const CamcorderTrack &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Finds the keys to interpolate between
+*/
+void CamcorderTrack::FindKeys(const uint32 *pnFrames, uint32 nNumOfKeys, float fTime, uint32 &nKey, float &fFactor) const
+{
+	// Get the frame, clamped to the track
+	float fFrame = fTime*m_pHeader->fFramesPerSecond;
+	if (fFrame < 0.0f)
+		fFrame = 0.0f;
+	else if (fFrame > static_cast<float>(m_pHeader->nNumOfFrames - 1))
+		fFrame = static_cast<float>(m_pHeader->nNumOfFrames - 1);
+
+	// Binary search for the last key at or before the frame
+	uint32 nLow  = 0;
+	uint32 nHigh = nNumOfKeys - 1;
+	while (nLow < nHigh) {
+		const uint32 nMiddle = (nLow + nHigh + 1)/2;
+		if (static_cast<float>(pnFrames[nMiddle]) <= fFrame)
+			nLow = nMiddle;
+		else
+			nHigh = nMiddle - 1;
+	}
+	nKey = nLow;
+
+	// Interpolation factor towards the next key
+	fFactor = (nKey + 1 < nNumOfKeys) ? (fFrame - static_cast<float>(pnFrames[nKey]))/static_cast<float>(pnFrames[nKey + 1] - pnFrames[nKey]) : 0.0f;
+}
@@ -0,0 +1,294 @@
+/*********************************************************\
+ *  File: CamcorderTrack.h                               *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_CAMCORDERTRACK_H__
+#define __DUNGEON_CAMCORDERTRACK_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Container/Array.h>
+#include "Tools/MemoryMappedFile.h"
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace PLMath {
+	class Vector3;
+	class Quaternion;
+}
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Compact, memory mapped camcorder track (".track")
+*
+*  @remarks
+*    A track holds the position and rotation keys of a camcorder recording within one file. Compared to the raw float
+*    chunks written by the camcorder (12 bytes per position key and 16 bytes per rotation key, one key per frame) the
+*    keys are reduced and quantized:
+*    - Keys which can be interpolated from their neighbours within a given error are dropped
+*    - Positions are quantized to 16 bit per component within the bounding box of the track
+*    - Rotations are stored as the three smallest quaternion components with 15 bit each, the index of the largest
+*      component is within the remaining two bits
+*
+*    The file is mapped into memory and evaluated in place, opening even hour-long tracks is nearly free. Each key
+*    stores its frame, evaluating the track at any time is a binary search followed by an interpolation, so seeking
+*    and scrubbing cost the same as playing.
+*
+*    File layout (little endian, each section is 4 byte aligned):
+*    - Header (see "SHeader")
+*    - Position key frames (uint32 each), followed by the quantized positions (3 uint16 each)
+*    - Rotation key frames (uint32 each), followed by the encoded rotations (3 uint16 each)
+*/
+class CamcorderTrack {
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 Magic   = 0x4B525444;	/**< "DTRK" */
+		static const PLCore::uint32 Version = 1;			/**< Format version, increase on each format change */
+
+
+	//[-------------------------------------------------------]
+	//[ Public static functions                               ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Writes a track
+		*
+		*  @param[in] sFilename
+		*    Filename of the track to write
+		*  @param[in] fFramesPerSecond
+		*    Frames per second of the given keys
+		*  @param[in] lstPositions
+		*    Position keys, one per frame
+		*  @param[in] lstRotations
+		*    Rotation keys, one per frame
+		*  @param[in] fMaxPositionError
+		*    Maximum position error of the key reduction
+		*  @param[in] fMaxRotationError
+		*    Maximum rotation error of the key reduction in degree
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*
+		*  @note
+		*    - The quantization error comes on top of the key reduction error, it's below 1/65535 of the track extent
+		*/
+		static bool Save(const PLCore::String &sFilename, float fFramesPerSecond, const PLCore::Array<PLMath::Vector3> &lstPositions,
+						 const PLCore::Array<PLMath::Quaternion> &lstRotations, float fMaxPositionError = 0.005f, float fMaxRotationError = 0.1f);
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Default constructor
+		*/
+		CamcorderTrack();
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		~CamcorderTrack();
+
+		/**
+		*  @brief
+		*    Opens a track
+		*
+		*  @param[in] sFilename
+		*    Filename of the track, the base directories of the loadable manager are taken into account
+		*
+		*  @return
+		*    'true' if all went fine, else 'false'
+		*
+		*  @note
+		*    - A previously opened track is closed automatically
+		*/
+		bool Open(const PLCore::String &sFilename);
+
+		/**
+		*  @brief
+		*    Closes the track
+		*/
+		void Close();
+
+		/**
+		*  @brief
+		*    Returns whether or not a track is opened
+		*
+		*  @return
+		*    'true' if a track is opened, else 'false'
+		*/
+		bool IsOpen() const;
+
+		/**
+		*  @brief
+		*    Returns the duration of the track
+		*
+		*  @return
+		*    The duration of the track in seconds, 0 if no track is opened
+		*/
+		float GetDuration() const;
+
+		/**
+		*  @brief
+		*    Returns the frames per second of the original keys
+		*
+		*  @return
+		*    The frames per second of the original keys, 0 if no track is opened
+		*/
+		float GetFramesPerSecond() const;
+
+		/**
+		*  @brief
+		*    Returns the number of stored position keys
+		*
+		*  @return
+		*    The number of stored position keys
+		*/
+		PLCore::uint32 GetNumOfPositionKeys() const;
+
+		/**
+		*  @brief
+		*    Returns the number of stored rotation keys
+		*
+		*  @return
+		*    The number of stored rotation keys
+		*/
+		PLCore::uint32 GetNumOfRotationKeys() const;
+
+		/**
+		*  @brief
+		*    Evaluates the position at a given time
+		*
+		*  @param[in]  fTime
+		*    Time in seconds, clamped to the duration of the track
+		*  @param[out] vPosition
+		*    Receives the position, not touched if no track is opened
+		*/
+		void GetPosition(float fTime, PLMath::Vector3 &vPosition) const;
+
+		/**
+		*  @brief
+		*    Evaluates the rotation at a given time
+		*
+		*  @param[in]  fTime
+		*    Time in seconds, clamped to the duration of the track
+		*  @param[out] qRotation
+		*    Receives the rotation, not touched if no track is opened
+		*/
+		void GetRotation(float fTime, PLMath::Quaternion &qRotation) const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    File header
+		*/
+		struct SHeader {
+			PLCore::uint32 nMagic;				/**< Magic number, "Magic" */
+			PLCore::uint32 nVersion;			/**< Format version, "Version" */
+			float		   fFramesPerSecond;	/**< Frames per second of the original keys */
+			PLCore::uint32 nNumOfFrames;		/**< Number of frames of the original keys, >0 */
+			float		   fPositionMin[3];		/**< Minimum of the positions */
+			float		   fPositionScale[3];	/**< Dequantization scale of the positions */
+			PLCore::uint32 nNumOfPositionKeys;	/**< Number of stored position keys, >0 */
+			PLCore::uint32 nNumOfRotationKeys;	/**< Number of stored rotation keys, >0 */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		CamcorderTrack(const CamcorderTrack &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		CamcorderTrack &operator =(const CamcorderTrack &cSource);
+
+		/**
+		*  @brief
+		*    Finds the keys to interpolate between
+		*
+		*  @param[in]  pnFrames
+		*    Key frames, ascending, the first one is 0
+		*  @param[in]  nNumOfKeys
+		*    Number of keys, >0
+		*  @param[in]  fTime
+		*    Time in seconds
+		*  @param[out] nKey
+		*    Receives the index of the key before or at the given time
+		*  @param[out] fFactor
+		*    Receives the interpolation factor (0.0-1.0) between the key and the next one
+		*/
+		void FindKeys(const PLCore::uint32 *pnFrames, PLCore::uint32 nNumOfKeys, float fTime, PLCore::uint32 &nKey, float &fFactor) const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		MemoryMappedFile	  m_cFile;				/**< Mapped track file */
+		const SHeader		 *m_pHeader;			/**< Header within the mapped file, null pointer if no track is opened */
+		const PLCore::uint32 *m_pnPositionFrames;	/**< Position key frames within the mapped file */
+		const PLCore::uint16 *m_pnPositions;		/**< Quantized positions within the mapped file */
+		const PLCore::uint32 *m_pnRotationFrames;	/**< Rotation key frames within the mapped file */
+		const PLCore::uint16 *m_pnRotations;		/**< Encoded rotations within the mapped file */
+
+
+};
+
+
+#endif // __DUNGEON_CAMCORDERTRACK_H__
@@ -0,0 +1,160 @@
+/*********************************************************\
+ *  File: Histogram.cpp                                  *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "Tools/Histogram.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Default constructor
+*/
+Histogram::Histogram()
+{
+	Reset();
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+Histogram::~Histogram()
+{
+}
+
+/**
+*  @brief
+*    Removes all values
+*/
+void Histogram::Reset()
+{
+	for (uint32 i=0; i<NumOfBuckets; i++)
+		m_nCounts[i] = 0;
+	m_nNumOfValues = 0;
+	m_nMax		   = 0;
+}
+
+/**
+*  @brief
+*    Adds a value
+*/
+void Histogram::Add(uint32 nValue)
+{
+	m_nCounts[GetBucket(nValue)]++;
+	m_nNumOfValues++;
+	if (m_nMax < nValue)
+		m_nMax = nValue;
+}
+
+/**
+*  @brief
+*    Returns the number of added values
+*/
+uint32 Histogram::GetNumOfValues() const
+{
+	return m_nNumOfValues;
+}
+
+/**
+*  @brief
+*    Returns the maximum value
+*/
+uint32 Histogram::GetMax() const
+{
+	return m_nMax;
+}
+
+/**
+*  @brief
+*    Returns a percentile
+*/
+uint32 Histogram::GetPercentile(float fPercentile) const
+{
+	if (m_nNumOfValues) {
+		// Number of values below or at the percentile, at least one
+		uint32 nRank = static_cast<uint32>(static_cast<double>(m_nNumOfValues)*fPercentile/100.0 + 0.5);
+		if (nRank < 1)
+			nRank = 1;
+
+		// Find the bucket of the value, the maximum is exact so there's no need to go beyond it
+		uint32 nNumOfValues = 0;
+		for (uint32 nBucket=0; nBucket<NumOfBuckets; nBucket++) {
+			nNumOfValues += m_nCounts[nBucket];
+			if (nNumOfValues >= nRank) {
+				const uint32 nValue = GetBucketValue(nBucket);
+				return (nValue < m_nMax) ? nValue : m_nMax;
+			}
+		}
+		return m_nMax;
+	}
+
+	// Error!
+	return 0;
+}
+
+
+//[-------------------------------------------------------]
+//[ Private static functions                              ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Returns the bucket of a value
+*/
+uint32 Histogram::GetBucket(uint32 nValue)
+{
+	// Small values are exact
+	if (nValue < SubBuckets)
+		return nValue;
+
+	// Find the highest set bit, the value is shifted so that "SubBucketBits" significant bits are left
+	uint32 nShift = 0;
+	while ((nValue >> nShift) >= SubBuckets)
+		nShift++;
+	return SubBuckets + (nShift - 1)*(SubBuckets/2) + (nValue >> nShift) - SubBuckets/2;
+}
+
+/**
+*  @brief
+*    Returns the value represented by a bucket
+*/
+uint32 Histogram::GetBucketValue(uint32 nBucket)
+{
+	// Small values are exact
+	if (nBucket < SubBuckets)
+		return nBucket;
+
+	// Return the middle of the value range of the bucket
+	const uint32 nShift		= (nBucket - SubBuckets)/(SubBuckets/2) + 1;
+	const uint32 nSubBucket = (nBucket - SubBuckets)%(SubBuckets/2) + SubBuckets/2;
+	return (nSubBucket << nShift) + ((1 << nShift) >> 1);
+}
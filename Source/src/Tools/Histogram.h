@@ -0,0 +1,162 @@
+/*********************************************************\
+ *  File: Histogram.h                                    *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_HISTOGRAM_H__
+#define __DUNGEON_HISTOGRAM_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/PLCore.h>
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Histogram with a constant relative precision over the whole 32 bit value range (HDR histogram style)
+*
+*  @remarks
+*    Values below "SubBuckets" get a bucket each, above that each power of two is split into "SubBuckets/2" linear
+*    buckets. So the relative error of a percentile is below 1/SubBuckets (about 3%) no matter whether the value is a
+*    few microseconds or several seconds, and the histogram has a fixed size of some kilobytes. Adding a value costs a
+*    few instructions, so a histogram can record every single frame of a session lasting for days.
+*/
+class Histogram {
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 SubBucketBits = 5;												/**< Number of significant bits of a value which select its bucket */
+		static const PLCore::uint32 SubBuckets	  = 1 << SubBucketBits;								/**< Number of buckets below the first power of two which is split */
+		static const PLCore::uint32 NumOfBuckets  = SubBuckets + (32 - SubBucketBits)*SubBuckets/2;	/**< Total number of buckets */
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Default constructor
+		*/
+		Histogram();
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		~Histogram();
+
+		/**
+		*  @brief
+		*    Removes all values
+		*/
+		void Reset();
+
+		/**
+		*  @brief
+		*    Adds a value
+		*
+		*  @param[in] nValue
+		*    Value to add (e.g. a frame time in microseconds)
+		*/
+		void Add(PLCore::uint32 nValue);
+
+		/**
+		*  @brief
+		*    Returns the number of added values
+		*
+		*  @return
+		*    The number of added values
+		*/
+		PLCore::uint32 GetNumOfValues() const;
+
+		/**
+		*  @brief
+		*    Returns the maximum value
+		*
+		*  @return
+		*    The exact maximum of the added values, 0 if there are no values
+		*/
+		PLCore::uint32 GetMax() const;
+
+		/**
+		*  @brief
+		*    Returns a percentile
+		*
+		*  @param[in] fPercentile
+		*    Percentile to return (0.0-100.0, e.g. 99.0 for p99)
+		*
+		*  @return
+		*    The value below or at which the given percentage of the added values is, 0 if there are no values
+		*/
+		PLCore::uint32 GetPercentile(float fPercentile) const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private static functions                              ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Returns the bucket of a value
+		*
+		*  @param[in] nValue
+		*    Value
+		*
+		*  @return
+		*    Bucket index, always below "NumOfBuckets"
+		*/
+		static PLCore::uint32 GetBucket(PLCore::uint32 nValue);
+
+		/**
+		*  @brief
+		*    Returns the value represented by a bucket
+		*
+		*  @param[in] nBucket
+		*    Bucket index, must be below "NumOfBuckets"
+		*
+		*  @return
+		*    The middle of the value range of the bucket
+		*/
+		static PLCore::uint32 GetBucketValue(PLCore::uint32 nBucket);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::uint32 m_nCounts[NumOfBuckets];	/**< Number of values per bucket */
+		PLCore::uint32 m_nNumOfValues;			/**< Number of added values */
+		PLCore::uint32 m_nMax;					/**< Maximum of the added values */
+
+
+};
+
+
+#endif // __DUNGEON_HISTOGRAM_H__
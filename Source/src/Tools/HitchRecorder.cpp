@@ -0,0 +1,165 @@
+/*********************************************************\
+ *  File: HitchRecorder.cpp                              *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <time.h>
+#include <PLCore/Log/Log.h>
+#include <PLCore/File/Directory.h>
+#include <PLCore/System/System.h>
+#include "Tools/Profiler.h"
+#include "Tools/TraceCapture.h"
+#include "Tools/HitchRecorder.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor, enables the profiler
+*/
+HitchRecorder::HitchRecorder(const String &sDirectory, float fThreshold, float fTimeBeforeHitch) :
+	m_sDirectory(sDirectory),
+	m_nThreshold(static_cast<uint64>(fThreshold*1000.0f)),
+	m_nTimeBeforeHitch(static_cast<uint64>(fTimeBeforeHitch*1000000.0f)),
+	m_nNumOfFrames(0),
+	m_nHitchFrame(0),
+	m_nFramesToWait(0),
+	m_nLastTraceTime(0)
+{
+	// The profiler has to record all the time, the events of a hitch are gone when it's detected too late
+	Profiler::Enable();
+}
+
+/**
+*  @brief
+*    Destructor, disables the profiler and waits until all traces are written
+*/
+HitchRecorder::~HitchRecorder()
+{
+	Profiler::Disable();
+	for (uint32 i=0; i<m_lstTraces.GetNumOfElements(); i++)
+		delete m_lstTraces[i];
+}
+
+/**
+*  @brief
+*    Checks the frame which was just finished
+*/
+void HitchRecorder::Update()
+{
+	// Get rid of the traces which are written
+	for (uint32 i=0; i<m_lstTraces.GetNumOfElements();) {
+		if (m_lstTraces[i]->IsFinished()) {
+			delete m_lstTraces[i];
+			m_lstTraces.RemoveAtIndex(i);
+		} else {
+			i++;
+		}
+	}
+
+	// The finished frame ends and the next frame starts right now
+	const uint64 nTime = System::GetInstance()->GetMicroseconds();
+	const uint64 nFrameTime = m_nNumOfFrames ? nTime - m_nFrameTimes[(m_nNumOfFrames - 1)%NumOfFrameTimes] : 0;
+	m_nFrameTimes[m_nNumOfFrames%NumOfFrameTimes] = nTime;
+	m_nNumOfFrames++;
+
+	// Write the trace when the frames after the hitch are recorded as well, further hitches until then are within the same trace
+	if (m_nFramesToWait) {
+		m_nFramesToWait--;
+		if (!m_nFramesToWait)
+			WriteTrace();
+
+	// Hitch?
+	} else if (nFrameTime > m_nThreshold && (!m_nLastTraceTime || nTime - m_nLastTraceTime > TimeBetweenTraces*1000000ULL)) {
+		m_nHitchFrame	= m_nNumOfFrames - 2;
+		m_nFramesToWait = FramesAfterHitch;
+
+		// The filename contains the local date and time of the hitch
+		char szTime[32] = "";
+		const time_t nSystemTime = time(nullptr);
+		const struct tm *pLocalTime = localtime(&nSystemTime);
+		if (pLocalTime)
+			strftime(szTime, sizeof(szTime), "%Y-%m-%d_%H-%M-%S", pLocalTime);
+		m_sFilename = m_sDirectory + "/Hitch_" + szTime + String::Format("_%ums.json", static_cast<uint32>(nFrameTime/1000));
+		PL_LOG(Warning, String::Format("Hitch: a frame took %.1f ms, writing the trace '", static_cast<float>(nFrameTime)/1000.0f) + m_sFilename + '\'')
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+HitchRecorder::HitchRecorder(const HitchRecorder &cSource)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+HitchRecorder &HitchRecorder::operator =(const HitchRecorder &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Starts writing the trace of the current hitch
+*/
+void HitchRecorder::WriteTrace()
+{
+	// Create the directory, if required
+	Directory cDirectory(m_sDirectory);
+	if (!cDirectory.Exists())
+		cDirectory.CreateRecursive();
+
+	// Get the start time of the trace
+	const uint64 nHitchStartTime = m_nFrameTimes[m_nHitchFrame%NumOfFrameTimes];
+	const uint64 nStartTime		 = (nHitchStartTime > m_nTimeBeforeHitch) ? nHitchStartTime - m_nTimeBeforeHitch : 0;
+
+	// Mark the frames within the trace, as far as their start times are still known
+	Array<uint64> lstFrameTimes;
+	for (uint32 nFrame=(m_nNumOfFrames > NumOfFrameTimes) ? m_nNumOfFrames - NumOfFrameTimes : 0; nFrame<m_nNumOfFrames; nFrame++) {
+		const uint64 nFrameTime = m_nFrameTimes[nFrame%NumOfFrameTimes];
+		if (nFrameTime >= nStartTime)
+			lstFrameTimes.Add(nFrameTime);
+	}
+
+	// The trace reads the ring buffers of the profiler at once and writes them within the background
+	m_lstTraces.Add(new TraceCapture(m_sFilename, nStartTime, lstFrameTimes));
+	m_nLastTraceTime = System::GetInstance()->GetMicroseconds();
+}
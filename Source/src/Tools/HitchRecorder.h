@@ -0,0 +1,148 @@
+/*********************************************************\
+ *  File: HitchRecorder.h                                *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_HITCHRECORDER_H__
+#define __DUNGEON_HITCHRECORDER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include <PLCore/Container/Array.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+class TraceCapture;
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Flight recorder writing a trace of the frames around each hitch
+*
+*  @remarks
+*    The hitch recorder keeps the profiler enabled all the time, so the ring buffers of the profiler always hold the last
+*    seconds of events of all threads. When a frame takes longer than the threshold, the recorder waits a few frames
+*    and writes the events around the slow frame as Chrome trace (see "TraceCapture") within the background, the
+*    filename contains the date and time of the hitch. While there's no hitch, the cost is the recording of the
+*    profiler scopes plus one time query per frame.
+*/
+class HitchRecorder {
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 NumOfFrameTimes	  = 1024;	/**< Number of frame start times kept to mark the frames within the traces */
+		static const PLCore::uint32 FramesAfterHitch  = 30;		/**< Number of frames recorded after a hitch before the trace is written */
+		static const PLCore::uint32 TimeBetweenTraces = 10;		/**< Minimum time (in seconds) between two traces, so a slow machine doesn't flood the disk */
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor, enables the profiler
+		*
+		*  @param[in] sDirectory
+		*    Directory the traces are written into, created if required
+		*  @param[in] fThreshold
+		*    Frame time (in milliseconds) above which a frame is a hitch
+		*  @param[in] fTimeBeforeHitch
+		*    Time (in seconds) before the hitch which is written into the trace, limited by the size of the profiler ring buffers
+		*/
+		HitchRecorder(const PLCore::String &sDirectory, float fThreshold, float fTimeBeforeHitch);
+
+		/**
+		*  @brief
+		*    Destructor, disables the profiler and waits until all traces are written
+		*/
+		~HitchRecorder();
+
+		/**
+		*  @brief
+		*    Checks the frame which was just finished, call this once per frame within the main thread after "Profiler::NextFrame()"
+		*/
+		void Update();
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		HitchRecorder(const HitchRecorder &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		HitchRecorder &operator =(const HitchRecorder &cSource);
+
+		/**
+		*  @brief
+		*    Starts writing the trace of the current hitch
+		*/
+		void WriteTrace();
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::String				 m_sDirectory;						/**< Directory the traces are written into */
+		PLCore::uint64				 m_nThreshold;						/**< Frame time (in microseconds) above which a frame is a hitch */
+		PLCore::uint64				 m_nTimeBeforeHitch;				/**< Time (in microseconds) before the hitch which is written into the trace */
+		PLCore::uint64				 m_nFrameTimes[NumOfFrameTimes];	/**< Ring buffer of the last frame start times (in microseconds) */
+		PLCore::uint32				 m_nNumOfFrames;					/**< Number of frames started since the construction */
+		PLCore::uint32				 m_nHitchFrame;						/**< Number of the current hitch frame */
+		PLCore::uint32				 m_nFramesToWait;					/**< Number of frames to wait until the trace of the current hitch is written, 0 if there's no hitch */
+		PLCore::String				 m_sFilename;						/**< Filename of the trace of the current hitch */
+		PLCore::uint64				 m_nLastTraceTime;					/**< Time (in microseconds) the last trace was written, 0 if there was none */
+		PLCore::Array<TraceCapture*> m_lstTraces;						/**< Traces which are written right now */
+
+
+};
+
+
+#endif // __DUNGEON_HITCHRECORDER_H__
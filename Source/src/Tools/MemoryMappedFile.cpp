@@ -0,0 +1,204 @@
+/*********************************************************\
+ *  File: MemoryMappedFile.cpp                           *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#ifdef WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+#include "Tools/MemoryMappedFile.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Default constructor
+*/
+MemoryMappedFile::MemoryMappedFile() :
+	m_pData(nullptr),
+	m_nSize(0)
+	#ifdef WIN32
+		, m_hFile(nullptr),
+		m_hMapping(nullptr)
+	#endif
+{
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+MemoryMappedFile::~MemoryMappedFile()
+{
+	Close();
+}
+
+/**
+*  @brief
+*    Maps a file into memory
+*/
+bool MemoryMappedFile::Open(const String &sFilename)
+{
+	// Unmap the previously mapped file
+	Close();
+
+	#ifdef WIN32
+		// Open the file
+		HANDLE hFile = ::CreateFileW(sFilename.GetUnicode(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (hFile != INVALID_HANDLE_VALUE) {
+			const DWORD nSize = ::GetFileSize(hFile, nullptr);
+			if (nSize != INVALID_FILE_SIZE && nSize) {
+				// Create the file mapping
+				HANDLE hMapping = ::CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (hMapping) {
+					// Map the whole file
+					const void *pData = ::MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+					if (pData) {
+						m_hFile    = hFile;
+						m_hMapping = hMapping;
+						m_pData    = static_cast<const uint8*>(pData);
+						m_nSize    = nSize;
+
+						// Done
+						return true;
+					}
+					::CloseHandle(hMapping);
+				}
+			}
+			::CloseHandle(hFile);
+		}
+	#else
+		// Open the file
+		const int nFile = ::open(sFilename.GetUTF8(), O_RDONLY);
+		if (nFile != -1) {
+			struct stat sStat;
+			if (!::fstat(nFile, &sStat) && sStat.st_size > 0) {
+				// Map the whole file, the file descriptor is no longer required after this
+				void *pData = ::mmap(nullptr, static_cast<size_t>(sStat.st_size), PROT_READ, MAP_PRIVATE, nFile, 0);
+				if (pData != MAP_FAILED) {
+					::close(nFile);
+					m_pData = static_cast<const uint8*>(pData);
+					m_nSize = static_cast<uint32>(sStat.st_size);
+
+					// Done
+					return true;
+				}
+			}
+			::close(nFile);
+		}
+	#endif
+
+	// Error!
+	return false;
+}
+
+/**
+*  @brief
+*    Unmaps the currently mapped file
+*/
+void MemoryMappedFile::Close()
+{
+	if (m_pData) {
+		#ifdef WIN32
+			::UnmapViewOfFile(m_pData);
+			::CloseHandle(m_hMapping);
+			::CloseHandle(m_hFile);
+			m_hMapping = nullptr;
+			m_hFile    = nullptr;
+		#else
+			::munmap(const_cast<uint8*>(m_pData), m_nSize);
+		#endif
+		m_pData = nullptr;
+		m_nSize = 0;
+	}
+}
+
+/**
+*  @brief
+*    Returns whether or not a file is currently mapped
+*/
+bool MemoryMappedFile::IsOpen() const
+{
+	return (m_pData != nullptr);
+}
+
+/**
+*  @brief
+*    Returns the mapped file content
+*/
+const uint8 *MemoryMappedFile::GetData() const
+{
+	return m_pData;
+}
+
+/**
+*  @brief
+*    Returns the size of the mapped file content
+*/
+uint32 MemoryMappedFile::GetSize() const
+{
+	return m_nSize;
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+MemoryMappedFile::MemoryMappedFile(const MemoryMappedFile &cSource) :
+	m_pData(nullptr),
+	m_nSize(0)
+	#ifdef WIN32
+		, m_hFile(nullptr),
+		m_hMapping(nullptr)
+	#endif
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+MemoryMappedFile &MemoryMappedFile::operator =(const MemoryMappedFile &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
@@ -0,0 +1,154 @@
+/*********************************************************\
+ *  File: MemoryMappedFile.h                             *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_MEMORYMAPPEDFILE_H__
+#define __DUNGEON_MEMORYMAPPEDFILE_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Read only memory mapped file
+*
+*  @remarks
+*    PLCore has no memory mapping functionality, so this is a small platform dependent wrapper. The
+*    operation system pages the file content in on demand, which makes opening large files nearly free.
+*/
+class MemoryMappedFile {
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Default constructor
+		*/
+		MemoryMappedFile();
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		~MemoryMappedFile();
+
+		/**
+		*  @brief
+		*    Maps a file into memory
+		*
+		*  @param[in] sFilename
+		*    Native path of the file to map
+		*
+		*  @return
+		*    'true' if all went fine, else 'false' (e.g. the file doesn't exist or is empty)
+		*
+		*  @note
+		*    - A previously mapped file is unmapped automatically
+		*/
+		bool Open(const PLCore::String &sFilename);
+
+		/**
+		*  @brief
+		*    Unmaps the currently mapped file
+		*/
+		void Close();
+
+		/**
+		*  @brief
+		*    Returns whether or not a file is currently mapped
+		*
+		*  @return
+		*    'true' if a file is currently mapped, else 'false'
+		*/
+		bool IsOpen() const;
+
+		/**
+		*  @brief
+		*    Returns the mapped file content
+		*
+		*  @return
+		*    The mapped file content, a null pointer if no file is mapped, do not destroy the returned memory
+		*/
+		const PLCore::uint8 *GetData() const;
+
+		/**
+		*  @brief
+		*    Returns the size of the mapped file content
+		*
+		*  @return
+		*    The size of the mapped file content in bytes
+		*/
+		PLCore::uint32 GetSize() const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		MemoryMappedFile(const MemoryMappedFile &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		MemoryMappedFile &operator =(const MemoryMappedFile &cSource);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		const PLCore::uint8	*m_pData;		/**< Mapped file content, can be a null pointer */
+		PLCore::uint32		 m_nSize;		/**< Size of the mapped file content in bytes */
+		#ifdef WIN32
+			void			*m_hFile;		/**< File handle, can be a null pointer */
+			void			*m_hMapping;	/**< File mapping handle, can be a null pointer */
+		#endif
+
+
+};
+
+
+#endif // __DUNGEON_MEMORYMAPPEDFILE_H__
@@ -0,0 +1,467 @@
+/*********************************************************\
+ *  File: Profiler.cpp                                   *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#ifdef WIN32
+	#include <PLCore/PLCoreWindowsIncludes.h>
+#endif
+#include <PLCore/System/Mutex.h>
+#include <PLCore/System/System.h>
+#include <PLMath/Math.h>
+#include "Tools/AllocationTracker.h"
+#include "Tools/Profiler.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLMath;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+#ifdef WIN32
+	#define PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+	#define PROFILER_THREAD_LOCAL __thread
+#endif
+
+static const uint32 MaxDepth	  = 32;			/**< Maximum scope depth summed up by "NextFrame()", deeper scopes are ignored */
+static const uint32 InvalidScope  = 0xFFFFFFFF;	/**< Scope which is not summed up */
+static const uint32 MaxThreadName = 32;			/**< Maximum length of a thread name, including the terminating zero */
+
+/**
+*  @brief
+*    Event ring buffer of a thread
+*/
+struct SThreadBuffer {
+	uint32			 nThread;								/**< Index of the thread, in the order of the first recorded scope */
+	String			 sName;									/**< Thread name, can be empty */
+	bool			 bReleased;								/**< Was the thread buffer released by its thread? */
+	volatile uint32	 nWriteIndex;							/**< Number of events written into the ring buffer */
+	Profiler::SEvent sEvents[Profiler::ThreadBufferSize];	/**< Ring buffer */
+};
+
+static volatile uint32						g_nNumOfUsers = 0;					/**< Number of profiler users, the profiler is recording if there's at least one */
+static Mutex								g_cMutex;							/**< Mutex protecting the list of thread buffers */
+static Array<SThreadBuffer*>				g_lstThreadBuffers;					/**< Thread buffers, they live as long as the process and are reused by new threads */
+static PROFILER_THREAD_LOCAL SThreadBuffer *g_pThreadBuffer = nullptr;			/**< Thread buffer of the current thread, null pointer if the thread didn't record a scope yet */
+static PROFILER_THREAD_LOCAL char			g_szThreadName[MaxThreadName];		/**< Name of the current thread, kept until the thread buffer is created */
+static uint32								g_nReadIndex = 0;					/**< Events of the main thread up to this index were summed up */
+static Profiler::SFrame						g_sFrames[Profiler::NumOfFrames];	/**< Ring buffer of the finished frames */
+static uint32								g_nNumOfFrames = 0;					/**< Number of finished frames within "g_sFrames" */
+static uint32								g_nNextFrame = 0;					/**< Index of the next frame within "g_sFrames" */
+static uint32								g_nFrameNumber = 0;					/**< Current frame number */
+static uint64								g_nFrameStartTime = 0;				/**< Start time of the current frame (in microseconds) */
+static uint32								g_nFrameStartAllocations = 0;		/**< Allocation counter of the main thread at the start of the current frame */
+static uint32								g_nFrameStartBytes = 0;				/**< Allocated bytes counter of the main thread at the start of the current frame */
+static uint32								g_nFrameDrawCalls = 0;				/**< Number of draw calls of the current frame */
+
+
+//[-------------------------------------------------------]
+//[ Local functions                                       ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Full memory barrier, the event has to be written before the write index is increased
+*/
+static inline void MemoryFence()
+{
+	#ifdef WIN32
+		MemoryBarrier();
+	#else
+		__sync_synchronize();
+	#endif
+}
+
+/**
+*  @brief
+*    Returns the thread buffer of the current thread, created on the first call within the thread
+*/
+static SThreadBuffer &GetThreadBuffer()
+{
+	SThreadBuffer *pThreadBuffer = g_pThreadBuffer;
+	if (!pThreadBuffer) {
+		g_cMutex.Lock();
+
+		// Reuse a thread buffer released by an exited thread, the worker pools are created again on each scene load
+		for (uint32 i=0; i<g_lstThreadBuffers.GetNumOfElements() && !pThreadBuffer; i++) {
+			if (g_lstThreadBuffers[i]->bReleased)
+				pThreadBuffer = g_lstThreadBuffers[i];
+		}
+
+		// Create a new thread buffer
+		if (!pThreadBuffer) {
+			pThreadBuffer = new SThreadBuffer;
+			pThreadBuffer->nThread	   = g_lstThreadBuffers.GetNumOfElements();
+			pThreadBuffer->nWriteIndex = 0;
+			g_lstThreadBuffers.Add(pThreadBuffer);
+		}
+		pThreadBuffer->sName	 = g_szThreadName;
+		pThreadBuffer->bReleased = false;
+		g_cMutex.Unlock();
+		g_pThreadBuffer = pThreadBuffer;
+	}
+	return *pThreadBuffer;
+}
+
+/**
+*  @brief
+*    Returns a thread buffer by index
+*/
+static SThreadBuffer &GetThreadBuffer(uint32 nThread)
+{
+	// The list may be reallocated by another thread adding its buffer, the buffers itself never move
+	g_cMutex.Lock();
+	SThreadBuffer *pThreadBuffer = g_lstThreadBuffers[nThread];
+	g_cMutex.Unlock();
+	return *pThreadBuffer;
+}
+
+/**
+*  @brief
+*    Adds an event to the ring buffer of the current thread
+*/
+static void AddEvent(const char *pszName)
+{
+	// Write the event, the oldest event is overwritten if the ring buffer is full
+	SThreadBuffer *pThreadBuffer = &GetThreadBuffer();
+	const uint32 nWriteIndex = pThreadBuffer->nWriteIndex;
+	Profiler::SEvent &sEvent = pThreadBuffer->sEvents[nWriteIndex%Profiler::ThreadBufferSize];
+	sEvent.pszName			 = pszName;
+	sEvent.nTime			 = System::GetInstance()->GetMicroseconds();
+	sEvent.nNumOfAllocations = AllocationTracker::GetNumOfAllocations();
+	sEvent.nAllocatedBytes	 = AllocationTracker::GetAllocatedBytes();
+	MemoryFence();
+	pThreadBuffer->nWriteIndex = nWriteIndex + 1;
+}
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Enables the profiler
+*/
+void Profiler::Enable()
+{
+	// Start with an empty frame history
+	if (!g_nNumOfUsers) {
+		g_nReadIndex   = g_pThreadBuffer ? g_pThreadBuffer->nWriteIndex : 0;
+		g_nNumOfFrames = 0;
+	}
+	g_nNumOfUsers++;
+}
+
+/**
+*  @brief
+*    Disables the profiler
+*/
+void Profiler::Disable()
+{
+	if (g_nNumOfUsers)
+		g_nNumOfUsers--;
+}
+
+/**
+*  @brief
+*    Returns whether or not the profiler is recording
+*/
+bool Profiler::IsEnabled()
+{
+	return (g_nNumOfUsers != 0);
+}
+
+/**
+*  @brief
+*    Begins a scope within the current thread
+*/
+bool Profiler::Begin(const char *pszName)
+{
+	if (g_nNumOfUsers) {
+		AddEvent(pszName);
+		return true;
+	} else {
+		return false;
+	}
+}
+
+/**
+*  @brief
+*    Ends the current scope of the current thread
+*/
+void Profiler::End()
+{
+	// The scope was recorded, so it has to be ended even if the profiler was disabled in the meantime
+	AddEvent(nullptr);
+}
+
+/**
+*  @brief
+*    Sets the name of the current thread, used by traces
+*/
+void Profiler::SetThreadName(const String &sName)
+{
+	// Keep the name until the thread records its first scope, threads which never record a scope don't get a ring buffer
+	const uint32 nLength = (sName.GetLength() < MaxThreadName) ? sName.GetLength() : MaxThreadName - 1;
+	for (uint32 i=0; i<nLength; i++)
+		g_szThreadName[i] = sName.GetASCII()[i];
+	g_szThreadName[nLength] = '\0';
+
+	// Update the name of an existing thread buffer
+	if (g_pThreadBuffer) {
+		g_cMutex.Lock();
+		g_pThreadBuffer->sName = g_szThreadName;
+		g_cMutex.Unlock();
+	}
+}
+
+/**
+*  @brief
+*    Releases the ring buffer of the current thread
+*/
+void Profiler::ReleaseThread()
+{
+	if (g_pThreadBuffer) {
+		g_cMutex.Lock();
+		g_pThreadBuffer->bReleased = true;
+		g_cMutex.Unlock();
+		g_pThreadBuffer = nullptr;
+	}
+	g_szThreadName[0] = '\0';
+}
+
+/**
+*  @brief
+*    Returns the number of threads which have recorded events
+*/
+uint32 Profiler::GetNumOfThreads()
+{
+	g_cMutex.Lock();
+	const uint32 nNumOfThreads = g_lstThreadBuffers.GetNumOfElements();
+	g_cMutex.Unlock();
+	return nNumOfThreads;
+}
+
+/**
+*  @brief
+*    Returns the name of a thread
+*/
+String Profiler::GetThreadName(uint32 nThread)
+{
+	g_cMutex.Lock();
+	const String sName = g_lstThreadBuffers[nThread]->sName;
+	g_cMutex.Unlock();
+	return sName;
+}
+
+/**
+*  @brief
+*    Returns the index of the next event of a thread
+*/
+uint32 Profiler::GetEventIndex(uint32 nThread)
+{
+	return GetThreadBuffer(nThread).nWriteIndex;
+}
+
+/**
+*  @brief
+*    Reads the events of a thread, can be called by any thread
+*/
+uint32 Profiler::ReadEvents(uint32 nThread, uint32 &nReadIndex, Array<SEvent> &lstEvents)
+{
+	const SThreadBuffer &sThreadBuffer = GetThreadBuffer(nThread);
+	uint32 nNumOfLostEvents = 0;
+
+	// Skip the events which are already overwritten
+	const uint32 nWriteIndex = sThreadBuffer.nWriteIndex;
+	MemoryFence();
+	if (nWriteIndex - nReadIndex > ThreadBufferSize) {
+		nNumOfLostEvents = nWriteIndex - ThreadBufferSize - nReadIndex;
+		nReadIndex = nWriteIndex - ThreadBufferSize;
+	}
+
+	// Copy the events
+	const uint32 nFirstEvent = lstEvents.GetNumOfElements();
+	for (uint32 i=nReadIndex; i!=nWriteIndex; i++)
+		lstEvents.Add(sThreadBuffer.sEvents[i%ThreadBufferSize]);
+
+	// The thread may have overwritten the oldest copied events in the meantime, drop them
+	MemoryFence();
+	const uint32 nNewWriteIndex = sThreadBuffer.nWriteIndex;
+	if (nNewWriteIndex - nReadIndex > ThreadBufferSize) {
+		const uint32 nNumOfCopied	   = nWriteIndex - nReadIndex;
+		const uint32 nNumOfOverwritten = Math::Min(nNewWriteIndex - ThreadBufferSize - nReadIndex, nNumOfCopied);
+		for (uint32 i=nNumOfOverwritten; i<nNumOfCopied; i++)
+			lstEvents[nFirstEvent + i - nNumOfOverwritten] = lstEvents[nFirstEvent + i];
+		lstEvents.Resize(nFirstEvent + nNumOfCopied - nNumOfOverwritten);
+		nNumOfLostEvents += nNumOfOverwritten;
+	}
+
+	// Done
+	nReadIndex = nWriteIndex;
+	return nNumOfLostEvents;
+}
+
+/**
+*  @brief
+*    Sets the number of draw calls of the current frame, call this within the main thread after drawing
+*/
+void Profiler::SetNumOfDrawCalls(uint32 nNumOfDrawCalls)
+{
+	g_nFrameDrawCalls = nNumOfDrawCalls;
+}
+
+/**
+*  @brief
+*    Finishes the current frame, call this once per frame within the main thread
+*/
+void Profiler::NextFrame()
+{
+	const uint64 nTime			   = System::GetInstance()->GetMicroseconds();
+	const uint32 nNumOfAllocations = AllocationTracker::GetNumOfAllocations();
+	const uint32 nAllocatedBytes   = AllocationTracker::GetAllocatedBytes();
+
+	// Sum up the scopes of the main thread
+	if (g_nNumOfUsers) {
+		SFrame &sFrame = g_sFrames[g_nNextFrame];
+		sFrame.nFrame			 = g_nFrameNumber;
+		sFrame.fTime			 = static_cast<float>(nTime - g_nFrameStartTime)/1000.0f;
+		sFrame.nNumOfAllocations = nNumOfAllocations - g_nFrameStartAllocations;
+		sFrame.nAllocatedBytes	 = nAllocatedBytes - g_nFrameStartBytes;
+		sFrame.nNumOfDrawCalls	 = g_nFrameDrawCalls;
+		sFrame.nNumOfScopes		 = 0;
+		if (g_pThreadBuffer) {
+			// Skip the events which were overwritten in the meantime
+			const uint32 nWriteIndex = g_pThreadBuffer->nWriteIndex;
+			if (nWriteIndex - g_nReadIndex > ThreadBufferSize)
+				g_nReadIndex = nWriteIndex - ThreadBufferSize;
+
+			// Walk through the events, scopes which are still open from the previous frame are ignored
+			uint32 nStack[MaxDepth];
+			uint64 nBeginTimes[MaxDepth];
+			uint32 nBeginAllocations[MaxDepth];
+			uint32 nBeginBytes[MaxDepth];
+			uint32 nDepth = 0;
+			for (; g_nReadIndex!=nWriteIndex; g_nReadIndex++) {
+				const SEvent &sEvent = g_pThreadBuffer->sEvents[g_nReadIndex%ThreadBufferSize];
+				if (sEvent.pszName) {
+					// Begin of a scope, find the scope with the same name within the same parent scope
+					if (nDepth < MaxDepth) {
+						const uint32 nParent = nDepth ? nStack[nDepth - 1] : NoParent;
+						uint32 nScope = InvalidScope;
+						if (nParent != InvalidScope) {
+							for (uint32 i=0; i<sFrame.nNumOfScopes && nScope==InvalidScope; i++) {
+								if (sFrame.sScopes[i].pszName == sEvent.pszName && sFrame.sScopes[i].nParent == nParent)
+									nScope = i;
+							}
+							if (nScope == InvalidScope && sFrame.nNumOfScopes < MaxScopesPerFrame) {
+								nScope = sFrame.nNumOfScopes++;
+								SScope &sScope = sFrame.sScopes[nScope];
+								sScope.pszName           = sEvent.pszName;
+								sScope.nParent           = nParent;
+								sScope.nDepth            = nDepth;
+								sScope.nCalls            = 0;
+								sScope.fTime             = 0.0f;
+								sScope.nNumOfAllocations = 0;
+								sScope.nAllocatedBytes   = 0;
+							}
+						}
+						nStack[nDepth]			  = nScope;
+						nBeginTimes[nDepth]		  = sEvent.nTime;
+						nBeginAllocations[nDepth] = sEvent.nNumOfAllocations;
+						nBeginBytes[nDepth]		  = sEvent.nAllocatedBytes;
+					}
+					nDepth++;
+				} else if (nDepth) {
+					// End of a scope
+					nDepth--;
+					if (nDepth < MaxDepth && nStack[nDepth] != InvalidScope) {
+						SScope &sScope = sFrame.sScopes[nStack[nDepth]];
+						sScope.nCalls++;
+						sScope.fTime += static_cast<float>(sEvent.nTime - nBeginTimes[nDepth])/1000.0f;
+						sScope.nNumOfAllocations += sEvent.nNumOfAllocations - nBeginAllocations[nDepth];
+						sScope.nAllocatedBytes	 += sEvent.nAllocatedBytes - nBeginBytes[nDepth];
+					}
+				}
+			}
+		}
+
+		// Next frame
+		g_nNextFrame = (g_nNextFrame + 1)%NumOfFrames;
+		if (g_nNumOfFrames < NumOfFrames)
+			g_nNumOfFrames++;
+	}
+
+	// The next frame starts right now
+	g_nFrameNumber++;
+	g_nFrameStartTime		 = nTime;
+	g_nFrameStartAllocations = nNumOfAllocations;
+	g_nFrameStartBytes		 = nAllocatedBytes;
+	g_nFrameDrawCalls		 = 0;
+}
+
+/**
+*  @brief
+*    Returns the number of available frames
+*/
+uint32 Profiler::GetNumOfFrames()
+{
+	return g_nNumOfFrames;
+}
+
+/**
+*  @brief
+*    Returns a frame
+*/
+const Profiler::SFrame &Profiler::GetFrame(uint32 nIndex)
+{
+	return g_sFrames[(g_nNextFrame + NumOfFrames - 1 - nIndex)%NumOfFrames];
+}
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+ProfilerScope::ProfilerScope(const char *pszName) :
+	m_bRecorded(Profiler::Begin(pszName))
+{
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+ProfilerScope::~ProfilerScope()
+{
+	if (m_bRecorded)
+		Profiler::End();
+}
@@ -0,0 +1,334 @@
+/*********************************************************\
+ *  File: Profiler.h                                     *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_PROFILER_H__
+#define __DUNGEON_PROFILER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include <PLCore/Container/Array.h>
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Hierarchical frame profiler
+*
+*  @remarks
+*    Code is instrumented by using "ProfilerScope" instances. Each thread writes the begin and end events of its scopes into
+*    its own fixed size ring buffer, so there's no lock and no allocation while profiling. "NextFrame()" is called by the main
+*    thread once per frame, it sums up the scopes of the main thread of the finished frame, merged by name and parent scope,
+*    and keeps the result of the last "NumOfFrames" frames (e.g. for the profiler window of the ingame GUI).
+*
+*    The events of all threads can be read while they are recorded (e.g. to write a trace, see "TraceCapture").
+*
+*    The profiler is only recording while it's enabled, a disabled scope costs a function call and the check of a flag.
+*
+*  @note
+*    - Scope names must be string literals, they are compared by pointer and referenced after the scope is left
+*    - "Enable()", "Disable()", "NextFrame()" and "GetFrame()" must be called by the main thread only
+*/
+class Profiler {
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 ThreadBufferSize  = 32768;	/**< Number of events within the ring buffer of each thread, a few seconds of a busy thread */
+		static const PLCore::uint32 NumOfFrames		  = 128;	/**< Number of frames kept by the profiler */
+		static const PLCore::uint32 MaxScopesPerFrame = 32;		/**< Maximum number of different scopes per frame, further scopes are ignored */
+
+		/**
+		*  @brief
+		*    Event recorded by a thread
+		*/
+		struct SEvent {
+			const char	   *pszName;			/**< Scope name for a begin event, null pointer for an end event */
+			PLCore::uint64  nTime;				/**< Time of the event (in microseconds, "PLCore::System::GetMicroseconds()") */
+			PLCore::uint32  nNumOfAllocations;	/**< Allocation counter of the thread at the time of the event (see "AllocationTracker") */
+			PLCore::uint32  nAllocatedBytes;	/**< Allocated bytes counter of the thread at the time of the event (see "AllocationTracker") */
+		};
+
+		/**
+		*  @brief
+		*    Scope of a frame, all calls of the same scope within the same parent scope are merged
+		*/
+		struct SScope {
+			const char	   *pszName;			/**< Scope name */
+			PLCore::uint32  nParent;			/**< Index of the parent scope within the frame, "NoParent" for a top level scope */
+			PLCore::uint32  nDepth;				/**< Depth of the scope, 0 for a top level scope */
+			PLCore::uint32  nCalls;				/**< Number of calls within the frame */
+			float			fTime;				/**< Time spent within the scope (in milliseconds), including the child scopes */
+			PLCore::uint32  nNumOfAllocations;	/**< Number of allocations within the scope, including the child scopes (see "AllocationTracker") */
+			PLCore::uint32  nAllocatedBytes;	/**< Number of allocated bytes within the scope, including the child scopes */
+		};
+		static const PLCore::uint32 NoParent = 0xFFFFFFFF;	/**< "SScope::nParent" of a top level scope */
+
+		/**
+		*  @brief
+		*    Frame
+		*/
+		struct SFrame {
+			PLCore::uint32 nFrame;						/**< Frame number */
+			float		   fTime;						/**< Frame time (in milliseconds) */
+			PLCore::uint32 nNumOfAllocations;			/**< Number of allocations of the main thread within the frame (see "AllocationTracker") */
+			PLCore::uint32 nAllocatedBytes;				/**< Number of allocated bytes of the main thread within the frame */
+			PLCore::uint32 nNumOfDrawCalls;				/**< Number of draw calls within the frame, 0 if unknown (see "SetNumOfDrawCalls()") */
+			PLCore::uint32 nNumOfScopes;				/**< Number of used scopes */
+			SScope		   sScopes[MaxScopesPerFrame];	/**< Scopes in the order they were entered the first time */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public static functions                               ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Enables the profiler
+		*
+		*  @remarks
+		*    Each "Enable()" call has to be paired with a "Disable()" call, the profiler is recording as long as there's at least
+		*    one user (e.g. the profiler window).
+		*/
+		static void Enable();
+
+		/**
+		*  @brief
+		*    Disables the profiler
+		*/
+		static void Disable();
+
+		/**
+		*  @brief
+		*    Returns whether or not the profiler is recording
+		*
+		*  @return
+		*    'true' if the profiler is recording, else 'false'
+		*/
+		static bool IsEnabled();
+
+		/**
+		*  @brief
+		*    Begins a scope within the current thread
+		*
+		*  @param[in] pszName
+		*    Scope name, must be a string literal
+		*
+		*  @return
+		*    'true' if the scope was recorded and "End()" has to be called, else 'false'
+		*/
+		static bool Begin(const char *pszName);
+
+		/**
+		*  @brief
+		*    Ends the current scope of the current thread
+		*/
+		static void End();
+
+		/**
+		*  @brief
+		*    Sets the name of the current thread, used by traces
+		*
+		*  @param[in] sName
+		*    Thread name (e.g. "Worker 1")
+		*/
+		static void SetThreadName(const PLCore::String &sName);
+
+		/**
+		*  @brief
+		*    Releases the ring buffer of the current thread, call this before a thread which might have recorded scopes exits
+		*
+		*  @note
+		*    - The ring buffer is reused by the next new thread, its recorded events are kept
+		*/
+		static void ReleaseThread();
+
+		/**
+		*  @brief
+		*    Returns the number of threads which have recorded events
+		*
+		*  @return
+		*    The number of threads, thread buffers are never removed
+		*/
+		static PLCore::uint32 GetNumOfThreads();
+
+		/**
+		*  @brief
+		*    Returns the name of a thread
+		*
+		*  @param[in] nThread
+		*    Thread index, must be below "GetNumOfThreads()"
+		*
+		*  @return
+		*    The name of the thread, empty string if no name was set
+		*/
+		static PLCore::String GetThreadName(PLCore::uint32 nThread);
+
+		/**
+		*  @brief
+		*    Returns the index of the next event of a thread
+		*
+		*  @param[in] nThread
+		*    Thread index, must be below "GetNumOfThreads()"
+		*
+		*  @return
+		*    The index the next recorded event of the thread will get, use it as read index to read just the following events
+		*/
+		static PLCore::uint32 GetEventIndex(PLCore::uint32 nThread);
+
+		/**
+		*  @brief
+		*    Reads the events of a thread, can be called by any thread
+		*
+		*  @param[in]     nThread
+		*    Thread index, must be below "GetNumOfThreads()"
+		*  @param[in, out] nReadIndex
+		*    Index of the first event to read, receives the index of the next event to read
+		*  @param[out]    lstEvents
+		*    Receives the read events (added at the end)
+		*
+		*  @return
+		*    Number of events which were overwritten before they could be read
+		*/
+		static PLCore::uint32 ReadEvents(PLCore::uint32 nThread, PLCore::uint32 &nReadIndex, PLCore::Array<SEvent> &lstEvents);
+
+		/**
+		*  @brief
+		*    Sets the number of draw calls of the current frame, call this within the main thread after drawing
+		*
+		*  @param[in] nNumOfDrawCalls
+		*    Number of draw calls issued by the renderer within the current frame
+		*/
+		static void SetNumOfDrawCalls(PLCore::uint32 nNumOfDrawCalls);
+
+		/**
+		*  @brief
+		*    Finishes the current frame, call this once per frame within the main thread
+		*/
+		static void NextFrame();
+
+		/**
+		*  @brief
+		*    Returns the number of available frames
+		*
+		*  @return
+		*    The number of available frames, "NumOfFrames" at most
+		*/
+		static PLCore::uint32 GetNumOfFrames();
+
+		/**
+		*  @brief
+		*    Returns a frame
+		*
+		*  @param[in] nIndex
+		*    Frame index, 0 for the last finished frame, must be below "GetNumOfFrames()"
+		*
+		*  @return
+		*    The requested frame
+		*/
+		static const SFrame &GetFrame(PLCore::uint32 nIndex);
+
+
+};
+
+/**
+*  @brief
+*    Profiler scope, begins a profiler scope when being constructed and ends it when being destroyed
+*
+*  @remarks
+*    Usage example:
+*    @code
+*    void Application::UpdateMousePickingPullAnimation()
+*    {
+*        ProfilerScope cProfilerScope("Mouse picking pull animation");
+*        ...
+*    }
+*    @endcode
+*/
+class ProfilerScope {
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] pszName
+		*    Scope name, must be a string literal
+		*/
+		ProfilerScope(const char *pszName);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		~ProfilerScope();
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		ProfilerScope(const ProfilerScope &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		ProfilerScope &operator =(const ProfilerScope &cSource);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		bool m_bRecorded;	/**< Was the scope recorded? (the profiler may be enabled while the scope is running) */
+
+
+};
+
+
+#endif // __DUNGEON_PROFILER_H__
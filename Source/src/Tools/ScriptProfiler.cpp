@@ -0,0 +1,198 @@
+/*********************************************************\
+ *  File: ScriptProfiler.cpp                             *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/System/System.h>
+#include <PLCore/Container/Array.h>
+#include "Tools/Profiler.h"
+#include "Tools/ScriptProfiler.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Script function
+*/
+struct SFunction {
+	String sName;			/**< Function name, its characters are used as profiler scope name */
+	uint32 nCalls;			/**< Number of calls */
+	uint64 nTime;			/**< Time spent within the function (in microseconds), including nested script calls */
+	uint64 nMaxTime;		/**< Maximum time of a single call (in microseconds) */
+	double fHeapGrowth;		/**< Lua heap growth (in KiB) */
+};
+
+/**
+*  @brief
+*    Running script function call
+*/
+struct SCall {
+	SFunction *pFunction;	/**< Called function, always valid */
+	uint64	   nStartTime;	/**< Start time of the call (in microseconds) */
+	bool	   bRecorded;	/**< Was the profiler scope of the call recorded? */
+};
+
+// The functions live as long as the process, the profiler may still reference their names as scope names
+static bool					g_bEnabled = false;					/**< Is the script profiler enabled? */
+static uint64				g_nStartTime = 0;					/**< Time the script profiler was enabled (in microseconds) */
+static Array<SFunction*>	g_lstFunctions;						/**< Known script functions */
+static SCall				g_sCalls[ScriptProfiler::MaxDepth];	/**< Stack of the running calls */
+static uint32				g_nDepth = 0;						/**< Depth of the current call, can be above "MaxDepth" */
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Enables the script profiler, the collected data is reset
+*/
+void ScriptProfiler::Enable()
+{
+	for (uint32 i=0; i<g_lstFunctions.GetNumOfElements(); i++) {
+		SFunction &sFunction = *g_lstFunctions[i];
+		sFunction.nCalls	  = 0;
+		sFunction.nTime		  = 0;
+		sFunction.nMaxTime	  = 0;
+		sFunction.fHeapGrowth = 0.0;
+	}
+	g_bEnabled	 = true;
+	g_nStartTime = System::GetInstance()->GetMicroseconds();
+}
+
+/**
+*  @brief
+*    Disables the script profiler
+*/
+void ScriptProfiler::Disable()
+{
+	g_bEnabled = false;
+}
+
+/**
+*  @brief
+*    Returns whether or not the script profiler is enabled
+*/
+bool ScriptProfiler::IsEnabled()
+{
+	return g_bEnabled;
+}
+
+/**
+*  @brief
+*    Begins a script function call
+*/
+void ScriptProfiler::Begin(const String &sName)
+{
+	// Calls which began while the profiler was enabled are ended even if it was disabled in the meantime
+	if (g_bEnabled && g_nDepth < MaxDepth) {
+		// Find the function, there are just some dozen functions
+		SFunction *pFunction = nullptr;
+		for (uint32 i=0; i<g_lstFunctions.GetNumOfElements() && !pFunction; i++) {
+			if (g_lstFunctions[i]->sName == sName)
+				pFunction = g_lstFunctions[i];
+		}
+		if (!pFunction) {
+			pFunction = new SFunction;
+			pFunction->sName	   = sName;
+			pFunction->nCalls	   = 0;
+			pFunction->nTime	   = 0;
+			pFunction->nMaxTime	   = 0;
+			pFunction->fHeapGrowth = 0.0;
+			g_lstFunctions.Add(pFunction);
+		}
+
+		// Begin the call, the name of a function never changes so its characters are a valid profiler scope name
+		SCall &sCall = g_sCalls[g_nDepth];
+		sCall.pFunction	 = pFunction;
+		sCall.bRecorded	 = Profiler::Begin(pFunction->sName.GetASCII());
+		sCall.nStartTime = System::GetInstance()->GetMicroseconds();
+	}
+	g_nDepth++;
+}
+
+/**
+*  @brief
+*    Ends the current script function call
+*/
+void ScriptProfiler::End(float fHeapGrowth)
+{
+	if (g_nDepth) {
+		g_nDepth--;
+		if (g_nDepth < MaxDepth && g_sCalls[g_nDepth].pFunction) {
+			SCall &sCall = g_sCalls[g_nDepth];
+			const uint64 nTime = System::GetInstance()->GetMicroseconds() - sCall.nStartTime;
+			if (sCall.bRecorded)
+				Profiler::End();
+
+			// Update the function
+			SFunction &sFunction = *sCall.pFunction;
+			sFunction.nCalls++;
+			sFunction.nTime += nTime;
+			if (sFunction.nMaxTime < nTime)
+				sFunction.nMaxTime = nTime;
+			sFunction.fHeapGrowth += fHeapGrowth;
+			sCall.pFunction = nullptr;
+		}
+	}
+}
+
+/**
+*  @brief
+*    Writes the collected data into the log, the most expensive function first
+*/
+void ScriptProfiler::Log()
+{
+	const float fSeconds = static_cast<float>(System::GetInstance()->GetMicroseconds() - g_nStartTime)/1000000.0f;
+	PL_LOG(Info, String::Format("Script profiler: %.1f seconds (calls, total time, time per call, maximum time, Lua heap growth per call):", fSeconds))
+
+	// Sort the functions by their total time, there are just some dozen functions
+	Array<SFunction*> lstFunctions;
+	for (uint32 i=0; i<g_lstFunctions.GetNumOfElements(); i++) {
+		SFunction *pFunction = g_lstFunctions[i];
+		if (pFunction->nCalls) {
+			uint32 nIndex = 0;
+			while (nIndex < lstFunctions.GetNumOfElements() && lstFunctions[nIndex]->nTime >= pFunction->nTime)
+				nIndex++;
+			lstFunctions.AddAtIndex(pFunction, nIndex);
+		}
+	}
+
+	// Write the functions
+	for (uint32 i=0; i<lstFunctions.GetNumOfElements(); i++) {
+		const SFunction &sFunction = *lstFunctions[i];
+		PL_LOG(Info, String::Format("  %-48s %8u %10.1f ms %8.3f ms %8.3f ms %8.2f KiB", sFunction.sName.GetASCII(), sFunction.nCalls, sFunction.nTime/1000.0,
+									sFunction.nTime/1000.0/sFunction.nCalls, sFunction.nMaxTime/1000.0, sFunction.fHeapGrowth/sFunction.nCalls))
+	}
+	if (!lstFunctions.GetNumOfElements())
+		PL_LOG(Info, "  No script function was called")
+}
@@ -0,0 +1,118 @@
+/*********************************************************\
+ *  File: ScriptProfiler.h                               *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_SCRIPTPROFILER_H__
+#define __DUNGEON_SCRIPTPROFILER_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Script profiler, collects the cost of the script functions called by C++
+*
+*  @remarks
+*    The script entry points (the "OnUpdate()" functions, the signal handlers...) are wrapped by the Lua module
+*    "ScriptProfiler.lua" which calls "Begin()" and "End()" through the RTTI methods of the application while the
+*    script profiler is enabled. Per function, the calls, the total and the maximum time and the Lua heap growth are
+*    summed up, each call is a profiler scope as well so the functions show up within the profiler window and traces.
+*
+*    While the script profiler is enabled, the Lua module disables the automatic garbage collector and runs the
+*    collector explicitly after each outermost script call, with the same amount of work the automatic collector
+*    would have done for the allocated memory. So the garbage collection pauses are measured as function "Lua GC"
+*    instead of being hidden within the script function that happened to allocate when a collector step was due.
+*
+*  @note
+*    - Must be used by the main thread only
+*/
+class ScriptProfiler {
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 MaxDepth = 32;	/**< Maximum depth of nested script calls, deeper calls are ignored */
+
+
+	//[-------------------------------------------------------]
+	//[ Public static functions                               ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Enables the script profiler, the collected data is reset
+		*/
+		static void Enable();
+
+		/**
+		*  @brief
+		*    Disables the script profiler
+		*/
+		static void Disable();
+
+		/**
+		*  @brief
+		*    Returns whether or not the script profiler is enabled
+		*
+		*  @return
+		*    'true' if the script profiler is enabled, else 'false'
+		*/
+		static bool IsEnabled();
+
+		/**
+		*  @brief
+		*    Begins a script function call
+		*
+		*  @param[in] sName
+		*    Function name (e.g. "Interaction.OnControl")
+		*/
+		static void Begin(const PLCore::String &sName);
+
+		/**
+		*  @brief
+		*    Ends the current script function call
+		*
+		*  @param[in] fHeapGrowth
+		*    Lua heap growth (in KiB) during the call, negative if memory was collected
+		*/
+		static void End(float fHeapGrowth);
+
+		/**
+		*  @brief
+		*    Writes the collected data into the log, the most expensive function first
+		*/
+		static void Log();
+
+
+};
+
+
+#endif // __DUNGEON_SCRIPTPROFILER_H__
@@ -0,0 +1,72 @@
+/*********************************************************\
+ *  File: SpatialTools.h                                 *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+#ifndef __DUNGEON_SPATIALTOOLS_H__
+#define __DUNGEON_SPATIALTOOLS_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLMath/Vector3.h>
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Static helpers shared by the spatial subdivisions of the culler, the instancer and the mesh baker
+*/
+class SpatialTools {
+
+
+	//[-------------------------------------------------------]
+	//[ Public static functions                               ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Sorts elements along the axis their centers are spread the most
+		*
+		*  @param[in, out] pElements
+		*    Elements to sort, each one has a "PLMath::Vector3 vCenter" member
+		*  @param[in]      nNumOfElements
+		*    Number of elements
+		*
+		*  @remarks
+		*    Splitting the sorted elements at the median gives two compact regions, that's how the bounding volume
+		*    hierarchy of the culler, the instance batches and the mesh batches are built.
+		*/
+		template <typename T>
+		static inline void SortByCenter(T *pElements, PLCore::uint32 nNumOfElements);
+
+
+};
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "Tools/SpatialTools.inl"
+
+
+#endif // __DUNGEON_SPATIALTOOLS_H__
@@ -0,0 +1,57 @@
+/*********************************************************\
+ *  File: SpatialTools.inl                               *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Public static functions                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Sorts elements along the axis their centers are spread the most
+*/
+template <typename T>
+inline void SpatialTools::SortByCenter(T *pElements, PLCore::uint32 nNumOfElements)
+{
+	if (nNumOfElements > 1) {
+		// Get the axis the centers are spread the most
+		PLMath::Vector3 vMin = pElements[0].vCenter, vMax = pElements[0].vCenter;
+		for (PLCore::uint32 i=1; i<nNumOfElements; i++) {
+			const PLMath::Vector3 &vCenter = pElements[i].vCenter;
+			if (vMin.x > vCenter.x) vMin.x = vCenter.x;
+			if (vMin.y > vCenter.y) vMin.y = vCenter.y;
+			if (vMin.z > vCenter.z) vMin.z = vCenter.z;
+			if (vMax.x < vCenter.x) vMax.x = vCenter.x;
+			if (vMax.y < vCenter.y) vMax.y = vCenter.y;
+			if (vMax.z < vCenter.z) vMax.z = vCenter.z;
+		}
+		const PLMath::Vector3 vSize = vMax - vMin;
+		const PLCore::uint32 nAxis = (vSize.x >= vSize.y && vSize.x >= vSize.z) ? 0 : ((vSize.y >= vSize.z) ? 1 : 2);
+
+		// Insertion sort, the elements of a cell are sorted once at load time or offline
+		for (PLCore::uint32 i=1; i<nNumOfElements; i++) {
+			const T cElement = pElements[i];
+			PLCore::uint32 j = i;
+			for (; j>0 && pElements[j - 1].vCenter[nAxis] > cElement.vCenter[nAxis]; j--)
+				pElements[j] = pElements[j - 1];
+			pElements[j] = cElement;
+		}
+	}
+}
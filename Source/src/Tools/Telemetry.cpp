@@ -0,0 +1,246 @@
+/*********************************************************\
+ *  File: Telemetry.cpp                                  *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <time.h>
+#include <string.h>
+#ifdef WIN32
+	#include <PLCore/PLCoreWindowsIncludes.h>
+	#include <psapi.h>
+	#pragma comment(lib, "psapi.lib")
+#elif defined(LINUX)
+	#include <stdio.h>
+	#include <unistd.h>
+#endif
+#include <PLCore/Log/Log.h>
+#include <PLCore/File/File.h>
+#include <PLCore/System/System.h>
+#include "Tools/Profiler.h"
+#include "Tools/Telemetry.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+//[-------------------------------------------------------]
+//[ Local functions                                       ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Returns the resident memory of the process in bytes, 0 if unknown
+*/
+static uint64 GetResidentMemory()
+{
+	#ifdef WIN32
+		PROCESS_MEMORY_COUNTERS sCounters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &sCounters, sizeof(sCounters)))
+			return sCounters.WorkingSetSize;
+	#elif defined(LINUX)
+		// The second value of "statm" is the number of resident pages
+		FILE *pFile = fopen("/proc/self/statm", "r");
+		if (pFile) {
+			unsigned long nSize = 0, nResident = 0;
+			const int nNumOfValues = fscanf(pFile, "%lu %lu", &nSize, &nResident);
+			fclose(pFile);
+			if (nNumOfValues == 2)
+				return static_cast<uint64>(nResident)*sysconf(_SC_PAGESIZE);
+		}
+	#endif
+
+	// Unknown
+	return 0;
+}
+
+/**
+*  @brief
+*    Returns the percentiles of a histogram with microsecond values as text
+*/
+static String GetPercentiles(const Histogram &cHistogram)
+{
+	return String::Format("p50=%.2fms p95=%.2fms p99=%.2fms max=%.2fms", cHistogram.GetPercentile(50.0f)/1000.0f, cHistogram.GetPercentile(95.0f)/1000.0f,
+						  cHistogram.GetPercentile(99.0f)/1000.0f, cHistogram.GetMax()/1000.0f);
+}
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor, enables the profiler
+*/
+Telemetry::Telemetry(const String &sFilename, float fInterval) :
+	m_sFilename(sFilename),
+	m_nInterval(static_cast<uint64>(fInterval*60.0f*1000000.0f)),
+	m_nIntervalStartTime(System::GetInstance()->GetMicroseconds()),
+	m_nFrameStartTime(0)
+{
+	// The subsystem times are taken from the profiler
+	Profiler::Enable();
+}
+
+/**
+*  @brief
+*    Destructor, appends the current interval and disables the profiler
+*/
+Telemetry::~Telemetry()
+{
+	// Append the current interval, the last minutes before a shutdown are of interest as well
+	if (m_cFrameTimes.GetNumOfValues())
+		Write();
+
+	// Destroy the subsystems
+	for (uint32 i=0; i<m_lstSubsystems.GetNumOfElements(); i++)
+		delete m_lstSubsystems[i];
+
+	// Disable the profiler
+	Profiler::Disable();
+}
+
+/**
+*  @brief
+*    Adds the frame which was just finished
+*/
+void Telemetry::Update()
+{
+	// The finished frame ends and the next frame starts right now
+	const uint64 nTime = System::GetInstance()->GetMicroseconds();
+	if (m_nFrameStartTime) {
+		m_cFrameTimes.Add(static_cast<uint32>(nTime - m_nFrameStartTime));
+
+		// Add the times of the top level scopes of the finished frame
+		if (Profiler::GetNumOfFrames()) {
+			const Profiler::SFrame &sFrame = Profiler::GetFrame(0);
+			for (uint32 nScope=0; nScope<sFrame.nNumOfScopes; nScope++) {
+				const Profiler::SScope &sScope = sFrame.sScopes[nScope];
+				if (sScope.nParent == Profiler::NoParent) {
+					// Find the subsystem, the same scope name can be different string literals within different source files
+					SSubsystem *pSubsystem = nullptr;
+					for (uint32 i=0; i<m_lstSubsystems.GetNumOfElements() && !pSubsystem; i++) {
+						if (m_lstSubsystems[i]->pszName == sScope.pszName || !strcmp(m_lstSubsystems[i]->pszName, sScope.pszName))
+							pSubsystem = m_lstSubsystems[i];
+					}
+					if (!pSubsystem) {
+						pSubsystem = new SSubsystem;
+						pSubsystem->pszName = sScope.pszName;
+						m_lstSubsystems.Add(pSubsystem);
+					}
+					pSubsystem->cTimes.Add(static_cast<uint32>(sScope.fTime*1000.0f));
+				}
+			}
+		}
+	}
+	m_nFrameStartTime = nTime;
+
+	// Append the interval to the log file
+	if (nTime - m_nIntervalStartTime >= m_nInterval)
+		Write();
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+Telemetry::Telemetry(const Telemetry &cSource)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+Telemetry &Telemetry::operator =(const Telemetry &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Appends the current interval to the log file and starts a new interval
+*/
+void Telemetry::Write()
+{
+	const uint64 nTime = System::GetInstance()->GetMicroseconds();
+
+	// Local date and time
+	char szTime[32] = "";
+	const time_t nSystemTime = time(nullptr);
+	const struct tm *pLocalTime = localtime(&nSystemTime);
+	if (pLocalTime)
+		strftime(szTime, sizeof(szTime), "%Y-%m-%d %H:%M:%S", pLocalTime);
+
+	// Compose the line, one line per interval so the log can be processed with the usual line based tools
+	String sLine = String(szTime) + String::Format(" interval=%.1fmin frames=%u frame ", static_cast<float>(nTime - m_nIntervalStartTime)/60000000.0f, m_cFrameTimes.GetNumOfValues()) +
+				   GetPercentiles(m_cFrameTimes);
+	for (uint32 i=0; i<m_lstSubsystems.GetNumOfElements(); i++) {
+		const SSubsystem &sSubsystem = *m_lstSubsystems[i];
+		if (sSubsystem.cTimes.GetNumOfValues())
+			sLine += " | " + String(sSubsystem.pszName) + String::Format(" frames=%u ", sSubsystem.cTimes.GetNumOfValues()) + GetPercentiles(sSubsystem.cTimes);
+	}
+	sLine += String::Format(" | memory=%.1fMiB\n", static_cast<double>(GetResidentMemory())/(1024.0*1024.0));
+
+	// Append the line
+	Rotate();
+	File cFile(m_sFilename);
+	if (!cFile.Open(File::FileWrite | File::FileAppend) || cFile.PutS(sLine) < 0)
+		PL_LOG(Error, "Failed to append to the telemetry log '" + m_sFilename + '\'')
+
+	// Start a new interval
+	m_nIntervalStartTime = nTime;
+	m_cFrameTimes.Reset();
+	for (uint32 i=0; i<m_lstSubsystems.GetNumOfElements(); i++)
+		m_lstSubsystems[i]->cTimes.Reset();
+}
+
+/**
+*  @brief
+*    Rotates the log files, if the current one is too large
+*/
+void Telemetry::Rotate()
+{
+	File cFile(m_sFilename);
+	if (cFile.Open(File::FileRead)) {
+		const uint32 nSize = cFile.GetSize();
+		cFile.Close();
+		if (nSize > MaxLogSize) {
+			// Remove the oldest log file, move the other ones
+			File(m_sFilename + String::Format(".%u", NumOfLogFiles - 1)).Delete();
+			for (uint32 i=NumOfLogFiles-1; i>1; i--) {
+				File cOldFile(m_sFilename + String::Format(".%u", i - 1));
+				if (cOldFile.Exists())
+					cOldFile.Move(m_sFilename + String::Format(".%u", i));
+			}
+			cFile.Move(m_sFilename + ".1");
+		}
+	}
+}
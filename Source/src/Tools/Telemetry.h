@@ -0,0 +1,158 @@
+/*********************************************************\
+ *  File: Telemetry.h                                    *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_TELEMETRY_H__
+#define __DUNGEON_TELEMETRY_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/String/String.h>
+#include <PLCore/Container/Array.h>
+#include "Tools/Histogram.h"
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Telemetry sink appending frame time percentiles and the resident memory to a rotating log file
+*
+*  @remarks
+*    Every frame, the frame time and the time of each top level profiler scope (scene update, script update, render...)
+*    is added to a histogram (see "Histogram"). At the end of each interval one line with the p50/p95/p99/max of each
+*    histogram and the resident memory of the process is appended to the log file and the histograms are reset. Unlike
+*    averages, the percentiles show growing frame time tails, the memory shows memory creep over multi-day sessions.
+*
+*    When the log file exceeds "MaxLogSize", it's renamed to "<filename>.1" ("<filename>.1" to "<filename>.2" and so
+*    on), the oldest one is removed, so the telemetry never takes more than "NumOfLogFiles*MaxLogSize" on disk.
+*/
+class Telemetry {
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const PLCore::uint32 MaxLogSize	  = 1024*1024;	/**< Size (in bytes) above which the log file is rotated */
+		static const PLCore::uint32 NumOfLogFiles = 5;			/**< Number of log files including the current one */
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor, enables the profiler
+		*
+		*  @param[in] sFilename
+		*    Name of the log file
+		*  @param[in] fInterval
+		*    Interval (in minutes) a line is appended to the log file
+		*/
+		Telemetry(const PLCore::String &sFilename, float fInterval);
+
+		/**
+		*  @brief
+		*    Destructor, appends the current interval and disables the profiler
+		*/
+		~Telemetry();
+
+		/**
+		*  @brief
+		*    Adds the frame which was just finished, call this once per frame within the main thread after "Profiler::NextFrame()"
+		*/
+		void Update();
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Subsystem, a top level profiler scope
+		*/
+		struct SSubsystem {
+			const char *pszName;	/**< Scope name, a string literal */
+			Histogram	cTimes;		/**< Times per frame (in microseconds), 0 if the scope wasn't used within a frame */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		Telemetry(const Telemetry &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		Telemetry &operator =(const Telemetry &cSource);
+
+		/**
+		*  @brief
+		*    Appends the current interval to the log file and starts a new interval
+		*/
+		void Write();
+
+		/**
+		*  @brief
+		*    Rotates the log files, if the current one is too large
+		*/
+		void Rotate();
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::String				m_sFilename;			/**< Name of the log file */
+		PLCore::uint64				m_nInterval;			/**< Interval (in microseconds) a line is appended to the log file */
+		PLCore::uint64				m_nIntervalStartTime;	/**< Start time of the current interval (in microseconds) */
+		PLCore::uint64				m_nFrameStartTime;		/**< Start time of the current frame (in microseconds), 0 before the first frame */
+		Histogram					m_cFrameTimes;			/**< Frame times (in microseconds) of the current interval */
+		PLCore::Array<SSubsystem*>	m_lstSubsystems;		/**< Subsystems, in the order of their first appearance */
+
+
+};
+
+
+#endif // __DUNGEON_TELEMETRY_H__
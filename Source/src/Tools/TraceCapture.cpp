@@ -0,0 +1,354 @@
+/*********************************************************\
+ *  File: TraceCapture.cpp                               *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Log/Log.h>
+#include <PLCore/File/File.h>
+#include <PLCore/System/System.h>
+#include <PLCore/System/Thread.h>
+#include "Tools/TraceCapture.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+//[-------------------------------------------------------]
+//[ Local definitions                                     ]
+//[-------------------------------------------------------]
+static const uint32 EventsPerWrite = 256;	/**< Number of events formatted before they are written into the file */
+
+
+//[-------------------------------------------------------]
+//[ Local functions                                       ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Returns the given text as JSON string
+*/
+static String ToJsonString(const String &sText)
+{
+	String sJson = sText;
+	sJson.Replace("\\", "\\\\");
+	sJson.Replace("\"", "\\\"");
+	return "\"" + sJson + '"';
+}
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Writer thread of a trace capture
+*/
+class TraceWriterThread : public Thread {
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cCapture
+		*    Owner trace capture
+		*/
+		TraceWriterThread(TraceCapture &cCapture) :
+			m_pCapture(&cCapture)
+		{
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Public virtual PLCore::ThreadFunction functions       ]
+	//[-------------------------------------------------------]
+	public:
+		virtual int Run() override
+		{
+			m_pCapture->Write();
+
+			// Done
+			return 0;
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		TraceCapture *m_pCapture;	/**< Owner trace capture, always valid */
+
+
+};
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor, starts the capture
+*/
+TraceCapture::TraceCapture(const String &sFilename, uint32 nNumOfFrames) :
+	m_sFilename(sFilename),
+	m_nNumOfFrames(nNumOfFrames ? nNumOfFrames : 1),
+	m_nStartTime(System::GetInstance()->GetMicroseconds()),
+	m_pWriterThread(nullptr),
+	m_bFinished(false)
+{
+	// Only the events following the start are captured
+	const uint32 nNumOfThreads = Profiler::GetNumOfThreads();
+	for (uint32 i=0; i<nNumOfThreads; i++) {
+		SThread *pThread = new SThread;
+		pThread->nReadIndex		  = Profiler::GetEventIndex(i);
+		pThread->nNumOfLostEvents = 0;
+		m_lstThreads.Add(pThread);
+	}
+
+	// Start recording
+	Profiler::Enable();
+	PL_LOG(Info, String::Format("Capturing %u frames into the trace '", m_nNumOfFrames) + m_sFilename + '\'')
+}
+
+/**
+*  @brief
+*    Constructor, writes the events which are still within the ring buffers of the profiler
+*/
+TraceCapture::TraceCapture(const String &sFilename, uint64 nStartTime, const Array<uint64> &lstFrameTimes) :
+	m_sFilename(sFilename),
+	m_nNumOfFrames(lstFrameTimes.GetNumOfElements()),
+	m_nStartTime(nStartTime),
+	m_lstFrameTimes(lstFrameTimes),
+	m_pWriterThread(nullptr),
+	m_bFinished(false)
+{
+	// Read the whole ring buffers, the writer ignores the events recorded before the start time
+	const uint32 nNumOfThreads = Profiler::GetNumOfThreads();
+	for (uint32 i=0; i<nNumOfThreads; i++) {
+		const uint32 nEventIndex = Profiler::GetEventIndex(i);
+		SThread *pThread = new SThread;
+		pThread->nReadIndex		  = (nEventIndex > Profiler::ThreadBufferSize) ? nEventIndex - Profiler::ThreadBufferSize : 0;
+		pThread->nNumOfLostEvents = 0;
+		m_lstThreads.Add(pThread);
+	}
+	Collect();
+
+	// Write the events
+	StartWriter();
+}
+
+/**
+*  @brief
+*    Destructor, waits until the file is written
+*/
+TraceCapture::~TraceCapture()
+{
+	// Write the events captured so far, if the capture is still running
+	if (!m_pWriterThread) {
+		Profiler::Disable();
+		StartWriter();
+	}
+
+	// Wait for the writer thread and destroy it
+	m_pWriterThread->Join();
+	delete m_pWriterThread;
+
+	// Destroy the captured threads
+	for (uint32 i=0; i<m_lstThreads.GetNumOfElements(); i++)
+		delete m_lstThreads[i];
+}
+
+/**
+*  @brief
+*    Returns the name of the JSON file
+*/
+String TraceCapture::GetFilename() const
+{
+	return m_sFilename;
+}
+
+/**
+*  @brief
+*    Captures the events of the frame which was just finished
+*/
+void TraceCapture::Update()
+{
+	if (!m_pWriterThread) {
+		// Drain the ring buffers of the profiler
+		Collect();
+
+		// Start the next frame, or stop if enough frames were captured
+		if (m_lstFrameTimes.GetNumOfElements() < m_nNumOfFrames) {
+			m_lstFrameTimes.Add(System::GetInstance()->GetMicroseconds());
+		} else {
+			Profiler::Disable();
+			StartWriter();
+		}
+	}
+}
+
+/**
+*  @brief
+*    Returns whether or not the capture is finished and the file is written
+*/
+bool TraceCapture::IsFinished() const
+{
+	return m_bFinished;
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+TraceCapture::TraceCapture(const TraceCapture &cSource)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+TraceCapture &TraceCapture::operator =(const TraceCapture &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Reads the new events of all threads from the profiler
+*/
+void TraceCapture::Collect()
+{
+	// Threads which recorded their first event during the capture are read from their first event on
+	const uint32 nNumOfThreads = Profiler::GetNumOfThreads();
+	while (m_lstThreads.GetNumOfElements() < nNumOfThreads) {
+		SThread *pThread = new SThread;
+		pThread->nReadIndex		  = 0;
+		pThread->nNumOfLostEvents = 0;
+		m_lstThreads.Add(pThread);
+	}
+
+	// Read the new events
+	for (uint32 i=0; i<nNumOfThreads; i++) {
+		SThread &sThread = *m_lstThreads[i];
+		sThread.nNumOfLostEvents += Profiler::ReadEvents(i, sThread.nReadIndex, sThread.lstEvents);
+	}
+}
+
+/**
+*  @brief
+*    Starts the writer thread
+*/
+void TraceCapture::StartWriter()
+{
+	// The thread names are known by now
+	for (uint32 i=0; i<m_lstThreads.GetNumOfElements(); i++)
+		m_lstThreads[i]->sName = Profiler::GetThreadName(i);
+
+	// Write the file within the writer thread, writing some megabytes must not stall the main thread
+	m_pWriterThread = new TraceWriterThread(*this);
+	m_pWriterThread->Start();
+}
+
+/**
+*  @brief
+*    Writes the captured events, called by the writer thread
+*/
+void TraceCapture::Write()
+{
+	File cFile(m_sFilename);
+	if (cFile.Open(File::FileCreate | File::FileWrite)) {
+		bool bResult = cFile.PutS("{\"traceEvents\":[\n") >= 0;
+		uint32 nNumOfEvents = 0;
+		uint32 nNumOfLostEvents = 0;
+
+		// Thread names, one track per thread
+		String sText;
+		for (uint32 nThread=0; nThread<m_lstThreads.GetNumOfElements(); nThread++) {
+			const SThread &sThread = *m_lstThreads[nThread];
+			const String sName = sThread.sName.GetLength() ? sThread.sName : String::Format("Thread %u", nThread);
+			sText += String::Format("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", nThread) + ToJsonString(sName) + "}},\n";
+			sText += String::Format("{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"sort_index\":%u}},\n", nThread, nThread);
+			nNumOfLostEvents += sThread.nNumOfLostEvents;
+		}
+
+		// Frame starts, global instant events
+		for (uint32 i=0; i<m_lstFrameTimes.GetNumOfElements(); i++)
+			sText += String::Format("{\"name\":\"Frame %u\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%u},\n", i, static_cast<uint32>(m_lstFrameTimes[i] - m_nStartTime));
+		bResult = bResult && cFile.PutS(sText) >= 0;
+		sText = "";
+
+		// Begin and end events, events recorded before the start of the capture are ignored
+		for (uint32 nThread=0; nThread<m_lstThreads.GetNumOfElements() && bResult; nThread++) {
+			const Array<Profiler::SEvent> &lstEvents = m_lstThreads[nThread]->lstEvents;
+			for (uint32 i=0; i<lstEvents.GetNumOfElements() && bResult; i++) {
+				const Profiler::SEvent &sEvent = lstEvents[i];
+				if (sEvent.nTime >= m_nStartTime) {
+					const uint32 nTime = static_cast<uint32>(sEvent.nTime - m_nStartTime);
+					if (sEvent.pszName)
+						sText += "{\"name\":" + ToJsonString(sEvent.pszName) + String::Format(",\"ph\":\"B\",\"pid\":1,\"tid\":%u,\"ts\":%u},\n", nThread, nTime);
+					else
+						sText += String::Format("{\"ph\":\"E\",\"pid\":1,\"tid\":%u,\"ts\":%u},\n", nThread, nTime);
+					nNumOfEvents++;
+
+					// Write the formatted events
+					if (!(nNumOfEvents%EventsPerWrite)) {
+						bResult = cFile.PutS(sText) >= 0;
+						sText = "";
+					}
+				}
+			}
+		}
+
+		// The last event must not be followed by a comma, so close the list with a metadata event
+		sText += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Dungeon\"}}\n],\"displayTimeUnit\":\"ms\"}\n";
+		bResult = bResult && cFile.PutS(sText) >= 0;
+		cFile.Close();
+
+		// Log the result
+		if (bResult) {
+			PL_LOG(Info, String::Format("Wrote %u events of %u frames into the trace '", nNumOfEvents, m_lstFrameTimes.GetNumOfElements()) + m_sFilename + '\'')
+			if (nNumOfLostEvents)
+				PL_LOG(Warning, String::Format("%u events were lost because the profiler ring buffers overflowed", nNumOfLostEvents))
+		} else {
+			PL_LOG(Error, "Failed to write the trace '" + m_sFilename + '\'')
+		}
+	} else {
+		PL_LOG(Error, "Failed to create the trace '" + m_sFilename + '\'')
+	}
+
+	// Done
+	m_bFinished = true;
+}
@@ -0,0 +1,209 @@
+/*********************************************************\
+ *  File: TraceCapture.h                                 *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_TRACECAPTURE_H__
+#define __DUNGEON_TRACECAPTURE_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "Tools/Profiler.h"
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+class TraceWriterThread;
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Captures the profiler events of all threads over a number of frames and writes them as Chrome trace
+*
+*  @remarks
+*    The capture enables the profiler and drains the event ring buffers of all threads once per frame, so the ring
+*    buffers never overflow during a capture. When the requested number of frames is captured, the events are written
+*    by a writer thread into a JSON file using the Chrome trace event format, which can be opened within Perfetto
+*    (https://ui.perfetto.dev) or "chrome://tracing". Each thread is a track, each frame start is an instant event.
+*
+*    Instead of capturing the following frames, a capture can also write the events which are still within the ring
+*    buffers of the profiler at once (see "HitchRecorder").
+*/
+class TraceCapture {
+
+
+	//[-------------------------------------------------------]
+	//[ Friends                                               ]
+	//[-------------------------------------------------------]
+	friend class TraceWriterThread;
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor, starts the capture
+		*
+		*  @param[in] sFilename
+		*    Name of the JSON file to write
+		*  @param[in] nNumOfFrames
+		*    Number of frames to capture, at least one frame is captured
+		*/
+		TraceCapture(const PLCore::String &sFilename, PLCore::uint32 nNumOfFrames);
+
+		/**
+		*  @brief
+		*    Constructor, writes the events which are still within the ring buffers of the profiler
+		*
+		*  @param[in] sFilename
+		*    Name of the JSON file to write
+		*  @param[in] nStartTime
+		*    Events recorded before this time (in microseconds, "PLCore::System::GetMicroseconds()") are ignored
+		*  @param[in] lstFrameTimes
+		*    Start times of the frames to mark within the trace (in microseconds), ascending
+		*
+		*  @note
+		*    - The writer thread is started at once, "Update()" has nothing to do
+		*/
+		TraceCapture(const PLCore::String &sFilename, PLCore::uint64 nStartTime, const PLCore::Array<PLCore::uint64> &lstFrameTimes);
+
+		/**
+		*  @brief
+		*    Destructor, waits until the file is written
+		*
+		*  @note
+		*    - If the capture is still running, it's stopped and the events captured so far are written
+		*/
+		~TraceCapture();
+
+		/**
+		*  @brief
+		*    Returns the name of the JSON file
+		*
+		*  @return
+		*    The name of the JSON file
+		*/
+		PLCore::String GetFilename() const;
+
+		/**
+		*  @brief
+		*    Captures the events of the frame which was just finished, call this once per frame within the main thread after "Profiler::NextFrame()"
+		*
+		*  @note
+		*    - Starts writing the file when the requested number of frames is captured
+		*/
+		void Update();
+
+		/**
+		*  @brief
+		*    Returns whether or not the capture is finished and the file is written
+		*
+		*  @return
+		*    'true' if the capture is finished and the file is written, else 'false'
+		*/
+		bool IsFinished() const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Captured thread
+		*/
+		struct SThread {
+			PLCore::String					 sName;				/**< Thread name, can be empty */
+			PLCore::uint32					 nReadIndex;		/**< Index of the next event to read from the profiler */
+			PLCore::uint32					 nNumOfLostEvents;	/**< Number of events which were overwritten before they were captured */
+			PLCore::Array<Profiler::SEvent>	 lstEvents;			/**< Captured events */
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		TraceCapture(const TraceCapture &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		TraceCapture &operator =(const TraceCapture &cSource);
+
+		/**
+		*  @brief
+		*    Reads the new events of all threads from the profiler
+		*/
+		void Collect();
+
+		/**
+		*  @brief
+		*    Starts the writer thread
+		*/
+		void StartWriter();
+
+		/**
+		*  @brief
+		*    Writes the captured events, called by the writer thread
+		*/
+		void Write();
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::String				  m_sFilename;		/**< Name of the JSON file */
+		PLCore::uint32				  m_nNumOfFrames;	/**< Number of frames to capture */
+		PLCore::uint64				  m_nStartTime;		/**< Start time of the capture (in microseconds) */
+		PLCore::Array<PLCore::uint64> m_lstFrameTimes;	/**< Start times of the captured frames (in microseconds) */
+		PLCore::Array<SThread*>		  m_lstThreads;		/**< Captured threads, in the order of the profiler */
+		TraceWriterThread			 *m_pWriterThread;	/**< Writer thread, null pointer while capturing */
+		volatile bool				  m_bFinished;		/**< Is the file written? */
+
+
+};
+
+
+#endif // __DUNGEON_TRACECAPTURE_H__
@@ -0,0 +1,300 @@
+/*********************************************************\
+ *  File: WorkerPool.cpp                                 *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/System/System.h>
+#include <PLCore/System/Thread.h>
+#include "Tools/Profiler.h"
+#include "Tools/WorkerPool.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Worker thread of a worker pool
+*/
+class WorkerThread : public Thread {
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cPool
+		*    Owner worker pool
+		*  @param[in] nIndex
+		*    Index of the thread within the pool
+		*/
+		WorkerThread(WorkerPool &cPool, uint32 nIndex) :
+			m_pPool(&cPool),
+			m_nIndex(nIndex)
+		{
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Public virtual PLCore::ThreadFunction functions       ]
+	//[-------------------------------------------------------]
+	public:
+		virtual int Run() override
+		{
+			Profiler::SetThreadName(String::Format("Worker %u", m_nIndex + 1));
+
+			// Execute jobs until the pool shuts down
+			WorkerPool::Job *pJob = m_pPool->WaitForJob();
+			while (pJob) {
+				{
+					ProfilerScope cProfilerScope("Worker job");
+					pJob->Execute();
+				}
+				delete pJob;
+				m_pPool->JobFinished();
+				pJob = m_pPool->WaitForJob();
+			}
+
+			// The next worker thread may use the profiler ring buffer of this thread
+			Profiler::ReleaseThread();
+
+			// Done
+			return 0;
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		WorkerPool *m_pPool;	/**< Owner worker pool, always valid */
+		uint32		m_nIndex;	/**< Index of the thread within the pool */
+
+
+};
+
+
+//[-------------------------------------------------------]
+//[ Public functions                                      ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Constructor
+*/
+WorkerPool::WorkerPool(uint32 nNumOfThreads) :
+	m_cSemaphore(0, 0x7FFFFFFF),
+	m_nNextJob(0),
+	m_nNextUrgentJob(0),
+	m_nNumOfUnfinishedJobs(0),
+	m_bShutdown(false)
+{
+	// Use one less than the number of CPUs, the main thread is busy as well
+	if (!nNumOfThreads) {
+		const uint32 nNumOfCPUs = System::GetInstance()->GetNumOfCPUs();
+		nNumOfThreads = (nNumOfCPUs > 1) ? nNumOfCPUs - 1 : 1;
+	}
+
+	// Start the worker threads
+	for (uint32 i=0; i<nNumOfThreads; i++) {
+		WorkerThread *pThread = new WorkerThread(*this, i);
+		m_lstThreads.Add(pThread);
+		pThread->Start();
+	}
+}
+
+/**
+*  @brief
+*    Destructor
+*/
+WorkerPool::~WorkerPool()
+{
+	// Discard the jobs which were not started yet
+	Cancel();
+
+	// Request the shut down, wake up every worker thread
+	m_cMutex.Lock();
+	m_bShutdown = true;
+	m_cMutex.Unlock();
+	for (uint32 i=0; i<m_lstThreads.GetNumOfElements(); i++)
+		m_cSemaphore.Unlock();
+
+	// Wait for the worker threads and destroy them
+	for (uint32 i=0; i<m_lstThreads.GetNumOfElements(); i++) {
+		m_lstThreads[i]->Join();
+		delete m_lstThreads[i];
+	}
+}
+
+/**
+*  @brief
+*    Returns the number of worker threads
+*/
+uint32 WorkerPool::GetNumOfThreads() const
+{
+	return m_lstThreads.GetNumOfElements();
+}
+
+/**
+*  @brief
+*    Adds a job
+*/
+void WorkerPool::AddJob(Job &cJob, bool bUrgent)
+{
+	m_cMutex.Lock();
+	if (bUrgent)
+		m_lstUrgentJobs.Add(&cJob);
+	else
+		m_lstJobs.Add(&cJob);
+	m_nNumOfUnfinishedJobs++;
+	m_cMutex.Unlock();
+
+	// Wake up a worker thread
+	m_cSemaphore.Unlock();
+}
+
+/**
+*  @brief
+*    Returns the number of jobs which are not finished yet
+*/
+uint32 WorkerPool::GetNumOfUnfinishedJobs()
+{
+	m_cMutex.Lock();
+	const uint32 nNumOfUnfinishedJobs = m_nNumOfUnfinishedJobs;
+	m_cMutex.Unlock();
+	return nNumOfUnfinishedJobs;
+}
+
+/**
+*  @brief
+*    Discards all jobs which were not started yet
+*/
+void WorkerPool::Cancel()
+{
+	m_cMutex.Lock();
+	for (uint32 i=m_nNextJob; i<m_lstJobs.GetNumOfElements(); i++) {
+		delete m_lstJobs[i];
+		m_nNumOfUnfinishedJobs--;
+	}
+	m_lstJobs.Reset();
+	m_nNextJob = 0;
+	for (uint32 i=m_nNextUrgentJob; i<m_lstUrgentJobs.GetNumOfElements(); i++) {
+		delete m_lstUrgentJobs[i];
+		m_nNumOfUnfinishedJobs--;
+	}
+	m_lstUrgentJobs.Reset();
+	m_nNextUrgentJob = 0;
+	m_cMutex.Unlock();
+
+	// The semaphore count is now higher than the number of queued jobs, "WaitForJob()" deals with this
+}
+
+
+//[-------------------------------------------------------]
+//[ Private functions                                     ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Copy constructor
+*/
+WorkerPool::WorkerPool(const WorkerPool &cSource) :
+	m_cSemaphore(0, 0x7FFFFFFF),
+	m_nNextJob(0),
+	m_nNextUrgentJob(0),
+	m_nNumOfUnfinishedJobs(0),
+	m_bShutdown(false)
+{
+	// No implementation because the copy constructor is never used
+}
+
+/**
+*  @brief
+*    Copy operator
+*/
+WorkerPool &WorkerPool::operator =(const WorkerPool &cSource)
+{
+	// No implementation because the copy operator is never used
+	return *this;
+}
+
+/**
+*  @brief
+*    Waits for the next job, called by the worker threads
+*/
+WorkerPool::Job *WorkerPool::WaitForJob()
+{
+	for (;;) {
+		// Wait until there's something to do
+		m_cSemaphore.Lock();
+
+		// Get the next job, urgent ones first - there may be none if jobs were discarded
+		m_cMutex.Lock();
+		if (m_bShutdown) {
+			m_cMutex.Unlock();
+			return nullptr;
+		}
+		Job *pJob = nullptr;
+		if (m_nNextUrgentJob < m_lstUrgentJobs.GetNumOfElements()) {
+			pJob = m_lstUrgentJobs[m_nNextUrgentJob];
+			m_nNextUrgentJob++;
+
+			// Reuse the queue memory as soon as it's drained
+			if (m_nNextUrgentJob == m_lstUrgentJobs.GetNumOfElements()) {
+				m_lstUrgentJobs.Reset();
+				m_nNextUrgentJob = 0;
+			}
+		} else if (m_nNextJob < m_lstJobs.GetNumOfElements()) {
+			pJob = m_lstJobs[m_nNextJob];
+			m_nNextJob++;
+
+			// Reuse the queue memory as soon as it's drained
+			if (m_nNextJob == m_lstJobs.GetNumOfElements()) {
+				m_lstJobs.Reset();
+				m_nNextJob = 0;
+			}
+		}
+		m_cMutex.Unlock();
+		if (pJob)
+			return pJob;
+	}
+}
+
+/**
+*  @brief
+*    Marks a job as finished, called by the worker threads
+*/
+void WorkerPool::JobFinished()
+{
+	m_cMutex.Lock();
+	m_nNumOfUnfinishedJobs--;
+	m_cMutex.Unlock();
+}
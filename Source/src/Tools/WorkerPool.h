@@ -0,0 +1,223 @@
+/*********************************************************\
+ *  File: WorkerPool.h                                   *
+ *
+ *  Copyright (C) 2002-2012 The PixelLight Team (http://www.pixellight.org/)
+ *
+ *  This file is part of PixelLight.
+ *
+ *  PixelLight is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PixelLight is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with PixelLight. If not, see <http://www.gnu.org/licenses/>.
+\*********************************************************/
+
+
+#ifndef __DUNGEON_WORKERPOOL_H__
+#define __DUNGEON_WORKERPOOL_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/System/Mutex.h>
+#include <PLCore/System/Semaphore.h>
+#include <PLCore/Container/Array.h>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+class WorkerThread;
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Pool of worker threads executing jobs in the order they were added
+*
+*  @remarks
+*    Jobs must not touch the scene graph, the renderer or resource managers - PixelLight expects them
+*    to be used by the main thread only. Jobs are meant for file I/O and pure computations.
+*
+*    The application owns a single pool shared by all its users, so there are just as many worker threads as
+*    CPUs. Users therefore track the completion of their own jobs instead of waiting for the whole pool, and
+*    jobs the main thread is waiting for within the current frame are added as urgent jobs so they don't
+*    queue up behind prefetching file I/O.
+*/
+class WorkerPool {
+
+
+	//[-------------------------------------------------------]
+	//[ Friends                                               ]
+	//[-------------------------------------------------------]
+	friend class WorkerThread;
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Abstract job
+		*/
+		class Job {
+
+
+			//[-------------------------------------------------------]
+			//[ Public functions                                      ]
+			//[-------------------------------------------------------]
+			public:
+				/**
+				*  @brief
+				*    Destructor
+				*/
+				virtual ~Job() {}
+
+
+			//[-------------------------------------------------------]
+			//[ Public virtual Job functions                          ]
+			//[-------------------------------------------------------]
+			public:
+				/**
+				*  @brief
+				*    Executes the job, called by a worker thread
+				*/
+				virtual void Execute() = 0;
+
+
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public functions                                      ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] nNumOfThreads
+		*    Number of worker threads, 0 to use one less than the number of CPUs (the main thread is busy as well), at least one
+		*/
+		WorkerPool(PLCore::uint32 nNumOfThreads = 0);
+
+		/**
+		*  @brief
+		*    Destructor
+		*
+		*  @note
+		*    - Jobs which were not started yet are discarded, running jobs are waited for
+		*/
+		~WorkerPool();
+
+		/**
+		*  @brief
+		*    Returns the number of worker threads
+		*
+		*  @return
+		*    The number of worker threads
+		*/
+		PLCore::uint32 GetNumOfThreads() const;
+
+		/**
+		*  @brief
+		*    Adds a job
+		*
+		*  @param[in] cJob
+		*    Job to add, must have been created using "new", the pool takes over the control and destroys it after execution
+		*  @param[in] bUrgent
+		*    Execute the job before all queued jobs which are not urgent?
+		*
+		*  @note
+		*    - Jobs are allowed to add further jobs
+		*/
+		void AddJob(Job &cJob, bool bUrgent = false);
+
+		/**
+		*  @brief
+		*    Returns the number of jobs which are not finished yet
+		*
+		*  @return
+		*    The number of queued and running jobs
+		*/
+		PLCore::uint32 GetNumOfUnfinishedJobs();
+
+		/**
+		*  @brief
+		*    Discards all jobs which were not started yet
+		*/
+		void Cancel();
+
+
+	//[-------------------------------------------------------]
+	//[ Private functions                                     ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Copy constructor
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*/
+		WorkerPool(const WorkerPool &cSource);
+
+		/**
+		*  @brief
+		*    Copy operator
+		*
+		*  @param[in] cSource
+		*    Source to copy from
+		*
+		*  @return
+		*    Reference to this instance
+		*/
+		WorkerPool &operator =(const WorkerPool &cSource);
+
+		/**
+		*  @brief
+		*    Waits for the next job, called by the worker threads
+		*
+		*  @return
+		*    The next job to execute, a null pointer if the worker thread has to shut down
+		*/
+		Job *WaitForJob();
+
+		/**
+		*  @brief
+		*    Marks a job as finished, called by the worker threads
+		*/
+		void JobFinished();
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		PLCore::Array<WorkerThread*> m_lstThreads;				/**< Worker threads */
+		PLCore::Mutex				 m_cMutex;					/**< Mutex protecting the following data */
+		PLCore::Semaphore			 m_cSemaphore;				/**< Counts the queued jobs (plus shut down requests) */
+		PLCore::Array<Job*>			 m_lstJobs;					/**< Queued jobs */
+		PLCore::uint32				 m_nNextJob;				/**< Index of the next queued job within "m_lstJobs" */
+		PLCore::Array<Job*>			 m_lstUrgentJobs;			/**< Queued urgent jobs, executed before the ones within "m_lstJobs" */
+		PLCore::uint32				 m_nNextUrgentJob;			/**< Index of the next queued job within "m_lstUrgentJobs" */
+		PLCore::uint32				 m_nNumOfUnfinishedJobs;	/**< Number of queued and running jobs */
+		bool						 m_bShutdown;				/**< Shut down the worker threads? */
+
+
+};
+
+
+#endif // __DUNGEON_WORKERPOOL_H__